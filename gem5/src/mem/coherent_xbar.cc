@@ -72,7 +72,8 @@ CoherentXBar::CoherentXBar(const CoherentXBarParams *p)
       snoopTraffic(this, "snoopTraffic", "Total snoop traffic (bytes)"),
       snoopFanout(this, "snoop_fanout", "Request fanout histogram"),
       avgBmoLatency(this, "avgBmoLatency", "Average latency added to PM writes"),
-      avgClwbResponseLatency(this, "avgClwbResponseLatency", "Average latency added to PM writes")
+      avgClwbResponseLatency(this, "avgClwbResponseLatency", "Average latency added to PM writes"),
+      pmRequests(this, "pmRequests", "Requests to persistent memory regions (count)")
 {
     
     // create the ports based on the size of the master and slave
@@ -177,6 +178,10 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID slave_port_id)
     DPRINTF(CoherentXBar, "%s: src %s packet %s\n", __func__,
             src_port->name(), pkt->print());
 
+    if (!is_express_snoop && is_paddr_pm(pkt->getAddr())) {
+        pmRequests++;
+    }
+
     // store size and command as they might be modified when
     // forwarding the packet
     unsigned int pkt_size = pkt->hasData() ? pkt->getSize() : 0;
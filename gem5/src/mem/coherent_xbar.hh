@@ -423,6 +423,7 @@ class CoherentXBar : public BaseXBar
     Stats::Distribution snoopFanout;
     Stats::Distribution avgBmoLatency;
     Stats::Distribution avgClwbResponseLatency;
+    Stats::Scalar pmRequests;
 
   public:
 
@@ -58,6 +58,7 @@
 #include "debug/Drain.hh"
 #include "debug/BMO.hh" 
 #include "debug/QOS.hh"
+#include "mem/predictor/PredictionThrottle.hh"
 #include "mem/predictor_backend.hh"
 #include "sim/system.hh"
 
@@ -68,74 +69,22 @@
 using namespace std;    
 using namespace Data;
 
-std::deque<CompletedWriteEntry> 
-DRAMCtrl::pendingPredictionQueue = std::deque<CompletedWriteEntry>();
 std::string DRAMCtrl::enableNonVolatileDump = "";
 std::ofstream DRAMCtrl::myFile = std::ofstream("/ramdisk/nonvolatiledump_dramctrl.txt");
 
 std::unordered_map<Addr, Tick> 
 DRAMCtrl::clwbLatency;
 
-// initialize CounterLog
-std::unordered_map<Addr, DRAMCtrl::CounterLogEntry*> DRAMCtrl::CounterLog;
+std::vector<DRAMCtrl*> DRAMCtrl::bmoChannels;
 
-// Korakit: not used?
-// initialize global_counter
-uint32_t DRAMCtrl::global_counter = 0;
-//Korakit: merged into single metadata write queue?
-
-// initialize CounterWriteQueue
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::CounterWriteQueue;
-std::unordered_set<Addr> DRAMCtrl::CounterWriteQueueAddr;
-
-
-std::unordered_map<Addr, bool> DRAMCtrl::CounterAtomicWait;
-
-// Counter can be colocated with dedup.
-
-// initialize AtomicCounterWriteQueue
-bool DRAMCtrl::hasCounterCacheFlushed = true;
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::AtomicCounterWriteQueue;
-
-// initialize counter cache
-std::unordered_map<unsigned, 
-		std::unordered_map<Addr, DRAMCtrl::CounterCacheEntry*> > DRAMCtrl::CounterCache = std::unordered_map<unsigned, std::unordered_map<Addr, DRAMCtrl::CounterCacheEntry*> >();
-
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::CounterCacheMissQueue;
-std::deque<DRAMCtrl::CounterWriteQueueEntry*> DRAMCtrl::CounterCacheEvictionQueue;
-//std::unordered_set<Addr> DRAMCtrl::CounterCacheMSHR;
-
-// deduplication read
-std::deque<DRAMCtrl::dedupReadQueueEntry*> DRAMCtrl::dedupReadQueue;
-
-// verification cache
-std::unordered_map<Addr, DRAMCtrl::VerificationCacheEntry*> DRAMCtrl::VerificationCache;
-
-std::deque<DRAMCtrl::VerificationWriteQueueEntry*> DRAMCtrl::VerificationCacheMissQueue;
-std::deque<DRAMCtrl::VerificationWriteQueueEntry*> DRAMCtrl::VerificationCacheEvictionQueue;
-std::unordered_set<Addr> DRAMCtrl::VerificationCacheMSHR;
-
-
-///////////////////////////
+/**
+ * The metadata caches, the metadata write queues, the dedup read queue and
+ * the TXOpt buffers are per controller, each channel runs its own BMO engine.
+ */
 
-std::unordered_set<Addr> DRAMCtrl::TXOptAddrBuffer;
-std::unordered_map<std::string, opt_record> DRAMCtrl::TXOptBuffer; 
-std::unordered_map<Addr, std::string> DRAMCtrl::TXOptPmemToOptAddrMap;
-std::unordered_map<Addr, bool> DRAMCtrl::TXOptFlush2Write;
 int TXOptPmemToOptAddrMap_size_max =0;
 //std::unordered_map<Addr, uint64_t> DRAMCtrl::CounterCache;
 
-uint64_t DRAMCtrl::EvictionCnt = 0;
-//uint64_t DRAMCtrl::tot_counter_cache_read = 0;	
-//uint64_t DRAMCtrl::counter_cache_read_hit = 0;
-uint64_t DRAMCtrl::atomic_writes = 0;
-uint64_t DRAMCtrl::atomic_wait = 0;
-uint64_t DRAMCtrl::init_hit_cnt = 0;	
-uint64_t DRAMCtrl::init_cnt = 0;	
-unsigned DRAMCtrl::counter_write_length = 0;
-
-bool DRAMCtrl::hasCounterCacheInit = false;
-bool DRAMCtrl::hasVerificationCacheInit = false;
 /*
 uint64_t DRAMCtrl::TXOptWriteCnt = 0;
 uint64_t DRAMCtrl::nonTXOptWriteCnt = 0;
@@ -271,6 +220,7 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
     
     isDWEnabled = get_env_val(ENABLE_DW);
     isEVEnabled = get_env_val(ENABLE_EV);
+    isPartialBMOEnabled = get_env_val("ENABLE_PARTIAL_BMO");
 
     std::cerr << "isDWEnabled = " << isDWEnabled << std::endl;
     std::cerr << "isEVEnabled = " << isEVEnabled << std::endl;
@@ -288,6 +238,22 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
         std::cerr << "myfile opened at " << std::endl;
         myFile << "Something " << std::endl;
     }
+
+    bmoChannels.push_back(this);
+}
+
+DRAMCtrl *
+DRAMCtrl::getBMOChannel(Addr paddr) {
+    panic_if(bmoChannels.empty(), "No memory controller holds BMO state");
+
+    for (DRAMCtrl *channel : bmoChannels) {
+        if (channel->getAddrRange().contains(paddr)) {
+            return channel;
+        }
+    }
+
+    /* Address is not backed by any controller, use the first channel */
+    return bmoChannels.front();
 }
 
 void
@@ -343,6 +309,11 @@ DRAMCtrl::init()
 }
 
 DRAMCtrl::~DRAMCtrl() {
+    bmoChannels.erase(
+        std::remove(bmoChannels.begin(), bmoChannels.end(), this),
+        bmoChannels.end()
+    );
+
     if (myFile.is_open()) {
         myFile.close();
     }
@@ -734,11 +705,15 @@ DRAMCtrl::checkPendingPredictionQueue() {
         CompletedWriteEntry top = DRAMCtrl::pendingPredictionQueue.front();
         /* Read the metadata caches here, the actual check for hit is done in the backend */
         DPRINTF(BMOLatency, GRN "Accessing caches for address %p" RST "\n", (void*)top.get_addr());
-        this->readCounterCache(top.get_addr());
+        bool counterCacheHit = this->readCounterCache(top.get_addr());
+        top.verificationCacheMisses = 0;
         this->readVerificationCache(top);
+        stats.predictionMetadataFills += !counterCacheHit + top.verificationCacheMisses;
         pendingPredictionQueue.pop_front();
     }
 
+    stats.throttledMetadataFills += PredictionThrottle::drain_avoided_metadata_fills();
+
 }
 
 bool
@@ -749,15 +724,40 @@ DRAMCtrl::isAddrVolatile(Addr addr) {
 
 bool
 DRAMCtrl::isAddrNonVolatile(Addr addr) {
-    bool result = false;
-    if ( addr > 8UL*(1024UL)*(1024UL)*(1024UL) /*8 GiB*/) {
-        result = true;
+    return is_paddr_pm(addr);
+}
+
+size_t
+DRAMCtrl::getPredictedSubBlocks(std::bitset<DATA_CHUNK_COUNT> chunkMatchVec) {
+    const size_t chunksPerSubBlock = BMO_SUB_BLOCK_SIZE/sizeof(DataChunk);
+    size_t result = 0;
+    for (size_t i = 0; i < DATA_CHUNK_COUNT; i += chunksPerSubBlock) {
+        bool allMatch = true;
+        for (size_t j = i; j < i + chunksPerSubBlock; j++) {
+            allMatch = allMatch and chunkMatchVec.test(j);
+        }
+        result += allMatch;
     }
     return result;
 }
 
 Tick
-DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted) {
+DRAMCtrl::getPartialHashFinishTick(Tick startTick, Tick dataGenTick, 
+                                   size_t predictedSubBlocks, Tick hashLatency) {
+    const size_t subBlockCount = (DATA_CHUNK_COUNT*sizeof(DataChunk))/BMO_SUB_BLOCK_SIZE;
+    const Tick subBlockLatency = hashLatency/subBlockCount;
+
+    /* Predicted sub-blocks are absorbed into the hash before the write arrives */
+    Tick precomputedFinishTick = std::max(startTick, dataGenTick)
+                                    + predictedSubBlocks*subBlockLatency;
+    
+    return std::max(precomputedFinishTick, std::max(startTick, curTick()))
+                + (subBlockCount - predictedSubBlocks)*subBlockLatency;
+}
+
+Tick
+DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted,
+                          std::bitset<DATA_CHUNK_COUNT> chunkMatchVec) {
     /**
      * Annotations from the Fig 6 of
      * Liu, Sihang, et al. "Janus: optimizing memory and storage support for non-volatile memory systems." 
@@ -804,6 +804,14 @@ DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry
         timeOfDataGen = curTick();
     }
 
+    /* Partial predictions only credit the fully predicted sub-blocks */
+    size_t predictedSubBlocks = 0;
+    if (not dataPredicted and chunkMatchVec.any()) {
+        predictedSubBlocks = getPredictedSubBlocks(chunkMatchVec);
+        stats.partialDataPredictions++;
+        stats.predictedSubBlocks += predictedSubBlocks;
+    }
+
     if (isEVEnabled) {
         uint64_t addrFinishTick = timeOfAddrGen
                                     + ENCRYPTION_LATENCY
@@ -832,6 +840,16 @@ DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry
 
         dataFinishTick = std::max(independentAddrLatency, dataOnlyFinishTick) + IV_HASH_LATENCY;
 
+        if (predictedSubBlocks > 0) {
+            Tick partialFinishTick = getPartialHashFinishTick(
+                    independentAddrLatency, timeOfDataGen, 
+                    predictedSubBlocks, IV_HASH_LATENCY);
+            Tick unpredictedFinishTick 
+                    = std::max(independentAddrLatency, curTick()) + IV_HASH_LATENCY;
+            stats.partialBMOCredit += unpredictedFinishTick - partialFinishTick;
+            dataFinishTick = partialFinishTick;
+        }
+
         finishTick = std::max(addrOnlyFinishTick, dataFinishTick);
 
         //! SM  Temporary Fix for removing address latency
@@ -861,6 +879,17 @@ DRAMCtrl::getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry
         Tick dataOnlyFinishTick = timeOfDataGen
                                 + DE_DUP_HASH_LATENCY
                                 + (wasCounterCacheHit ? 0 : METADATA_CACHE_MISS_LATENCY);
+
+        if (predictedSubBlocks > 0) {
+            Tick partialFinishTick = getPartialHashFinishTick(
+                    0, timeOfDataGen, predictedSubBlocks, DE_DUP_HASH_LATENCY)
+                    + (wasCounterCacheHit ? 0 : METADATA_CACHE_MISS_LATENCY);
+            Tick unpredictedFinishTick = curTick()
+                    + DE_DUP_HASH_LATENCY
+                    + (wasCounterCacheHit ? 0 : METADATA_CACHE_MISS_LATENCY);
+            stats.partialBMOCredit += unpredictedFinishTick - partialFinishTick;
+            dataOnlyFinishTick = partialFinishTick;
+        }
         // std::cout << "dataOnlyFinishTick = " << dataOnlyFinishTick << std::endl;
         // Number 3
         Tick dependentFinishTick = std::max(addrOnlyFinishTick, dataOnlyFinishTick);
@@ -940,7 +969,8 @@ DRAMCtrl::dumpTrace(PacketPtr pkt) {
 }
 
 void
-DRAMCtrl::emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted) {
+DRAMCtrl::emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted,
+                             std::bitset<DATA_CHUNK_COUNT> chunkMatchVec) {
     DPRINTF(BMO, "Emnulating slowdown\n");
     std::cout << "Emulating slowdown for adddress " << (void*)pkt->req->getPaddr() 
               << " with addrPredicted = " << addrPredicted << " datPredicted  = " 
@@ -957,11 +987,12 @@ DRAMCtrl::emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEn
         completedWriteEntry.set_time_of_addr_gen(curTick());
     }
 
-    if (not dataPredicted) {
+    /* Partial predictions keep the time the predicted chunks were generated */
+    if (not dataPredicted and chunkMatchVec.none()) {
         completedWriteEntry.set_time_of_data_gen(curTick());
     }
 
-    Tick bmoLatency = this->getWriteLatency(pkt, completedWriteEntry, addrPredicted, dataPredicted);
+    Tick bmoLatency = this->getWriteLatency(pkt, completedWriteEntry, addrPredicted, dataPredicted, chunkMatchVec);
     /* Add the address to the clwb slowdown map */
     // std::cout << RED << "Latency = " << bmoLatency << " which had verifcication cache misses = " << pkt->verificationCacheMisses << RST << std::endl;
     DRAMCtrl::clwbLatency[pkt->req->getPaddr()] = bmoLatency;
@@ -1145,7 +1176,29 @@ DRAMCtrl::BMOHandleWriteRequest(PacketPtr pkt) {
         } 
     }
 
-    if (not wasDataPredicted) {
+    /* Find the prediction with the most matching sub-blocks */
+    std::bitset<DATA_CHUNK_COUNT> chunkMatchVec;
+    if (not wasDataPredicted and wasAddrPredicted and isPartialBMOEnabled) {
+        size_t maxSubBlocks = 0;
+        for (auto completedEntry : completedWritesForAddr_q) {
+            if (completedEntry.is_used() 
+                    or not PredictorBackend::isPktEqualCompletedEntryAddr(pkt, completedEntry)
+                    or not completedEntry.has_time_of_data_gen()) {
+                continue;
+            }
+
+            auto matchVec = PredictorBackend::dataChunkMatchVec(completedEntry, pkt);
+            size_t subBlocks = getPredictedSubBlocks(matchVec);
+            if (subBlocks > maxSubBlocks) {
+                maxSubBlocks = subBlocks;
+                chunkMatchVec = matchVec;
+                completedWriteEntry = completedEntry;
+            }
+        }
+        DPRINTF(BMO, "Partial prediction with %d predicted sub-blocks\n", maxSubBlocks);
+    }
+
+    if (not wasDataPredicted and chunkMatchVec.none()) {
         /* If the data was not predicted set all the details of the 
            completedWriteEntry */
         if (completedWritesForAddr_q.empty()) {
@@ -1163,7 +1216,7 @@ DRAMCtrl::BMOHandleWriteRequest(PacketPtr pkt) {
         wasAddrPredicted = true;
     }
 
-    this->emulateBMOSlowdown(pkt, completedWriteEntry, wasAddrPredicted, wasDataPredicted);
+    this->emulateBMOSlowdown(pkt, completedWriteEntry, wasAddrPredicted, wasDataPredicted, chunkMatchVec);
 }
 
 void
@@ -1772,9 +1825,37 @@ DRAMCtrl::doDRAMAccess(DRAMPacket* dram_pkt)
     // the command; need minimum of tBURST between commands
     Tick cmd_at = std::max({col_allowed_at, nextBurstAt, curTick()});
 
+    // PM writes wait for an entry in the on-DIMM write-combining buffer
+    const bool isNVMMediaAccess = nvmMedia.is_enabled() 
+                                    and isAddrNonVolatile(dram_pkt->addr);
+    if (isNVMMediaAccess and not dram_pkt->isRead()) {
+        auto access = nvmMedia.write(dram_pkt->addr, cmd_at);
+        stats.nvmWCBWriteHits += access.bufferHit;
+        stats.nvmMediaWrites += access.mediaWrite;
+        stats.nvmReadModifyWrites += access.readModifyWrite;
+        stats.nvmWriteStallTicks += access.readyTick - cmd_at;
+        cmd_at = access.readyTick;
+    }
+
     // update the packet ready time
     dram_pkt->readyTime = cmd_at + tCL + tBURST;
 
+    // PM reads see the media latency unless the line is still buffered, 
+    // responses are returned in order
+    if (isNVMMediaAccess and dram_pkt->isRead()) {
+        auto access = nvmMedia.read(dram_pkt->addr, cmd_at);
+        stats.nvmWCBReadHits += access.bufferHit;
+        stats.nvmMediaReads += not access.bufferHit;
+        stats.nvmPausedWrites += access.pausedWrite;
+
+        dram_pkt->readyTime = std::max(dram_pkt->readyTime, 
+                                       access.readyTick + tBURST);
+        if (not respQueue.empty()) {
+            dram_pkt->readyTime = std::max(dram_pkt->readyTime, 
+                                           respQueue.back()->readyTime);
+        }
+    }
+
     // update the time for the next read/write burst for each
     // bank (add a max with tCCD/tCCD_L/tCCD_L_WR here)
     Tick dly_to_rd_cmd;
@@ -3162,6 +3243,12 @@ DRAMCtrl::DRAMStats::DRAMStats(DRAMCtrl &_dram)
              "Number of operations (flush) that are not TXOpt-ed"),
     ADD_STAT(extraMemoryAccesses, 
              "Number of operations (flush) that are not TXOpt-ed"),
+    ADD_STAT(predictionMetadataFills,
+             "Metadata cache misses caused by the predictions"),
+    ADD_STAT(throttledMetadataFills,
+             "Metadata cache misses avoided by throttling the predictions"),
+    ADD_STAT(unthrottledMetadataFills,
+             "Metadata cache misses the predictions would cause without throttling"),
     ADD_STAT(TXOptIncomplete, 
              "Total number of OPT complete after write"),
     ADD_STAT(totalBMO, 
@@ -3183,12 +3270,28 @@ DRAMCtrl::DRAMStats::DRAMStats(DRAMCtrl &_dram)
     ADD_STAT(BMOLatencyEmulationCount, "Time in different power states"),
     ADD_STAT(pendingBMOQueueFlushes, "Number of flushes for the pending packets in the read and write queues."),
     ADD_STAT(totalCounterCacheWrite, "Counter cache writes"),
+    ADD_STAT(partialDataPredictions, 
+             "Writes with only a subset of the data chunks predicted"),
+    ADD_STAT(predictedSubBlocks, 
+             "Sub-blocks of partially predicted writes hashed before the write"),
+    ADD_STAT(partialBMOCredit, 
+             "Ticks of BMO latency saved by the partial data predictions"),
     ADD_STAT(bmoFinishAfter, "bmoFinishAfter"),
     ADD_STAT(addrNotPredicted, "addrNotPredicted"),
     ADD_STAT(untimelyPrediction, "untimelyPrediction"),
     ADD_STAT(bmoFinishBefore, "bmoFinishBefore"),
     ADD_STAT(bmoFinishDist, "bmoFinishDist"),
-    ADD_STAT(timeliness, "timeliness")
+    ADD_STAT(timeliness, "timeliness"),
+    ADD_STAT(nvmMediaReads, "Reads served by the NVM media"),
+    ADD_STAT(nvmMediaWrites, "Lines written back to the NVM media"),
+    ADD_STAT(nvmWCBReadHits, "Reads served by the NVM write-combining buffer"),
+    ADD_STAT(nvmWCBWriteHits, 
+             "Writes coalesced in the NVM write-combining buffer"),
+    ADD_STAT(nvmReadModifyWrites, 
+             "NVM media writes of partially written lines"),
+    ADD_STAT(nvmPausedWrites, "NVM media writes paused by a read"),
+    ADD_STAT(nvmWriteStallTicks, 
+             "Ticks writes waited for a free write-combining buffer entry")
 {
 }
 
@@ -3328,6 +3431,8 @@ DRAMCtrl::DRAMStats::regStats()
     masterReadRate = masterReadBytes / simSeconds;
     masterWriteRate = masterWriteBytes / simSeconds;
     masterReadAvgLat = masterReadTotalLat / masterReadAccesses;
+
+    unthrottledMetadataFills = predictionMetadataFills + throttledMetadataFills;
     masterWriteAvgLat = masterWriteTotalLat / masterWriteAccesses;
     
     metadataCacheHitRate = totalCounterCacheReadHit / totalCounterCacheRead * 100;
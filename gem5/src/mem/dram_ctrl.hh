@@ -69,6 +69,7 @@
 #include "enums/MemSched.hh"
 #include "enums/PageManage.hh"
 #include "mem/drampower.hh"
+#include "mem/nvm_media.hh"
 #include "mem/predictor/CompletedWriteEntry.hh"
 #include "mem/predictor/Common.hh"
 #include "mem/qos/mem_ctrl.hh"
@@ -804,6 +805,15 @@ class DRAMCtrl : public QoS::MemCtrl
     bool isDWEnabled = false; // De duplicaiton and wear levelling
     bool isEVEnabled = false; // encryption and verification
 
+    /** 
+     * Credit the data hash of the correctly predicted sub-blocks for
+     * predictions that only match a part of the cacheline.
+     */
+    bool isPartialBMOEnabled = false;
+
+    /* Media timing for the PM addresses, ENABLE_NVM_MEDIA */
+    NVMMedia nvmMedia;
+
     /**
      * Check if the read queue has room for more entries
      *
@@ -1196,6 +1206,9 @@ class DRAMCtrl : public QoS::MemCtrl
         // Stats::Distribution pendingPredictionQueueLength; 
         Stats::Scalar totalCounterCacheReadHit; 
         Stats::Scalar extraMemoryAccesses;
+        Stats::Scalar predictionMetadataFills;
+        Stats::Scalar throttledMetadataFills;
+        Stats::Formula unthrottledMetadataFills;
         Stats::Scalar BMOLatencyEmulationCount; 
         Stats::Scalar totalTXOptOp;
         Stats::Scalar totalNonTXOptOp;
@@ -1218,10 +1231,22 @@ class DRAMCtrl : public QoS::MemCtrl
         Stats::Scalar opt_total_delay;
         Stats::Scalar pendingBMOQueueFlushes;
         Stats::Scalar totalCounterCacheWrite;      
+        Stats::Scalar partialDataPredictions;
+        Stats::Scalar predictedSubBlocks;
+        Stats::Scalar partialBMOCredit;
         Stats::Scalar bmoFinishAfter;
         Stats::Scalar bmoFinishBefore;
         Stats::Distribution bmoFinishDist;
         Stats::Distribution timeliness;
+
+        // NVM media model
+        Stats::Scalar nvmMediaReads;
+        Stats::Scalar nvmMediaWrites;
+        Stats::Scalar nvmWCBReadHits;
+        Stats::Scalar nvmWCBWriteHits;
+        Stats::Scalar nvmReadModifyWrites;
+        Stats::Scalar nvmPausedWrites;
+        Stats::Scalar nvmWriteStallTicks;
     };
 
     DRAMStats stats;
@@ -1289,9 +1314,24 @@ class DRAMCtrl : public QoS::MemCtrl
      *
      */
     bool allRanksDrained() const;
-    static std::deque<CompletedWriteEntry> pendingPredictionQueue;
+
+    /* Predictions waiting to access this controller's metadata caches */
+    std::deque<CompletedWriteEntry> pendingPredictionQueue;
+
+    /* Keyed by the physical address, shared by all the channels */
     static std::unordered_map<Addr, Tick> clwbLatency;
 
+    /**
+     * Returns the controller owning the physical address, predictions and 
+     * metadata cache lookups are routed to this channel. Interleaved 
+     * channels are resolved using their address ranges.
+     */
+    static DRAMCtrl *getBMOChannel(Addr paddr);
+
+  private:
+    /* Every controller that holds BMO state */
+    static std::vector<DRAMCtrl*> bmoChannels;
+
   protected:
 
     Tick recvAtomic(PacketPtr pkt);
@@ -1375,10 +1415,10 @@ class DRAMCtrl : public QoS::MemCtrl
 	}
 
   	// packet - number of writes: one for data and another for counter
-	// note that it is a static variable
-	static std::unordered_map<Addr, CounterLogEntry*> CounterLog;
+	// note that it is kept per controller
+	std::unordered_map<Addr, CounterLogEntry*> CounterLog;
 
-	static uint32_t global_counter;
+	uint32_t global_counter = 0;
 
 	// Write queue for counters
 	// counters are not inserted to the write queue together with the data 
@@ -1401,15 +1441,15 @@ class DRAMCtrl : public QoS::MemCtrl
 		unsigned verification_pkt_count;
 	};
 	
-	static std::deque<CounterWriteQueueEntry*> CounterWriteQueue;
-  static std::deque<VerificationWriteQueueEntry*> VerificationWriteQueue;
+	std::deque<CounterWriteQueueEntry*> CounterWriteQueue;
+  std::deque<VerificationWriteQueueEntry*> VerificationWriteQueue;
 
 	// set of address of pending counter packets	
-	static std::unordered_set<Addr> CounterWriteQueueAddr;
-  static std::unordered_set<Addr> VerificationWriteQueueAddr;
+	std::unordered_set<Addr> CounterWriteQueueAddr;
+  std::unordered_set<Addr> VerificationWriteQueueAddr;
 
 	// addr map to hasDataReceived
-	static std::unordered_map<Addr, bool> CounterAtomicWait;
+	std::unordered_map<Addr, bool> CounterAtomicWait;
 //  Korakit
 //  keep enabled for non-blocking case
 #ifdef TXOPT_ENABLE
@@ -1444,8 +1484,8 @@ class DRAMCtrl : public QoS::MemCtrl
 		// }
 	}
 
-	static bool hasCounterCacheFlushed;
-	static std::deque<CounterWriteQueueEntry*> AtomicCounterWriteQueue;
+	bool hasCounterCacheFlushed = true;
+	std::deque<CounterWriteQueueEntry*> AtomicCounterWriteQueue;
 // Korakit
 // removed, never used
 /*
@@ -1534,26 +1574,26 @@ class DRAMCtrl : public QoS::MemCtrl
 
 
 
-	static std::unordered_map<unsigned, 
+	std::unordered_map<unsigned, 
 						std::unordered_map<Addr, CounterCacheEntry*> > CounterCache;
-	static std::deque<CounterWriteQueueEntry*> CounterCacheMissQueue;	
-	static std::deque<CounterWriteQueueEntry*> CounterCacheEvictionQueue;
-  static std::unordered_set<Addr> CounterCacheMSHR;
-  static std::unordered_map<Addr, VerificationCacheEntry*> VerificationCache;  //verification cache
-  static std::deque<VerificationWriteQueueEntry*> VerificationCacheMissQueue;
-	static std::deque<VerificationWriteQueueEntry*> VerificationCacheEvictionQueue;
-  static std::unordered_set<Addr> VerificationCacheMSHR;
-  static std::deque<dedupReadQueueEntry*> dedupReadQueue;
+	std::deque<CounterWriteQueueEntry*> CounterCacheMissQueue;	
+	std::deque<CounterWriteQueueEntry*> CounterCacheEvictionQueue;
+  std::unordered_set<Addr> CounterCacheMSHR;
+  std::unordered_map<Addr, VerificationCacheEntry*> VerificationCache;  //verification cache
+  std::deque<VerificationWriteQueueEntry*> VerificationCacheMissQueue;
+	std::deque<VerificationWriteQueueEntry*> VerificationCacheEvictionQueue;
+  std::unordered_set<Addr> VerificationCacheMSHR;
+  std::deque<dedupReadQueueEntry*> dedupReadQueue;
 
   // Queue that temporarily going to hold writes before read and write operations on the caches are 
   // performed
 	static const unsigned num_sets = COUNTER_CACHE_SIZE / NUM_WAY;
 
-	static uint64_t EvictionCnt;	
+	uint64_t EvictionCnt = 0;
 	//static uint64_t tot_counter_cache_read;	
 	//static uint64_t counter_cache_read_hit;
-	static uint64_t atomic_writes;
-	static uint64_t atomic_wait;
+	uint64_t atomic_writes = 0;
+	uint64_t atomic_wait = 0;
 
 
 	// find set
@@ -1568,7 +1608,7 @@ class DRAMCtrl : public QoS::MemCtrl
 
 public:
 	// Counter hash stores dedup and encryption info
-	static bool isCounterCacheHit(Addr _addr) {
+	bool isCounterCacheHit(Addr _addr) {
 
 		unsigned index = getIndex(_addr);
 		if (CounterCache.find(index) != CounterCache.end()) {
@@ -1581,7 +1621,7 @@ public:
 	}
 
 
-  static bool isVerificationCacheHit(Addr _addr) {
+  bool isVerificationCacheHit(Addr _addr) {
     if (VerificationCache.find(_addr) != VerificationCache.end()) {
       return true;
     }
@@ -1636,11 +1676,11 @@ private:
 	}
 
 
-	static bool hasCounterCacheInit;
-	static uint64_t init_cnt;
-	static uint64_t init_hit_cnt;
+	bool hasCounterCacheInit = false;
+	uint64_t init_cnt = 0;
+	uint64_t init_hit_cnt = 0;
 
-  static bool hasVerificationCacheInit;
+  bool hasVerificationCacheInit = false;
 
   bool isAddrVolatile(Addr addr);
   bool isAddrNonVolatile(Addr addr);
@@ -1648,8 +1688,21 @@ private:
   void BMOHandleRequest(PacketPtr pkt);
   void BMOHandleWriteRequest(PacketPtr pkt);
   void BMOHandleReadRequest(PacketPtr pkt);
-  Tick getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted);
-  void emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted);
+  Tick getWriteLatency(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted,
+                       std::bitset<DATA_CHUNK_COUNT> chunkMatchVec = std::bitset<DATA_CHUNK_COUNT>());
+  void emulateBMOSlowdown(PacketPtr pkt, CompletedWriteEntry completedWriteEntry, bool addrPredicted, bool dataPredicted,
+                          std::bitset<DATA_CHUNK_COUNT> chunkMatchVec = std::bitset<DATA_CHUNK_COUNT>());
+
+  /** Returns the number of sub-blocks with all of their data chunks predicted */
+  static size_t getPredictedSubBlocks(std::bitset<DATA_CHUNK_COUNT> chunkMatchVec);
+
+  /** 
+   * Finish tick of an incremental hash over the sub-blocks, the predicted
+   * sub-blocks are hashed starting at dataGenTick and the rest once the 
+   * write arrives.
+   */
+  Tick getPartialHashFinishTick(Tick startTick, Tick dataGenTick, 
+                                size_t predictedSubBlocks, Tick hashLatency);
 
 	void initCounterCache(Addr max_addr) {
 		DPRINTF(myflag3, "@@ max_paddr=%llx\n", max_addr);
@@ -2150,7 +2203,7 @@ private:
 	}
 
 	//static unsigned counter_read_length;
-	static unsigned counter_write_length;
+	unsigned counter_write_length = 0;
 
 	bool counterWriteQueueFull(unsigned request_size) {
 	  DPRINTF(myflag, "counterWriteQueue full? %d\n", counter_write_length + request_size > COUNTER_WRITE_QUEUE_SIZE);
@@ -2163,13 +2216,13 @@ private:
 			  (counter_write_length == COUNTER_WRITE_QUEUE_SIZE);
 	}
 	//Korakit: from address set to address -> opt_record map
-	static std::unordered_set<Addr> TXOptAddrBuffer;
+	std::unordered_set<Addr> TXOptAddrBuffer;
 	
-	static std::unordered_map<std::string, opt_record> TXOptBuffer;			//indexed by opt_record's address concat with segID
-	static std::unordered_map<Addr, bool> TXOptFlush2Write;
+	std::unordered_map<std::string, opt_record> TXOptBuffer;			//indexed by opt_record's address concat with segID
+	std::unordered_map<Addr, bool> TXOptFlush2Write;
 	//Korakit
 	//Map for looking up by pmem Address for the actual write.
-	static std::unordered_map<Addr, std::string> TXOptPmemToOptAddrMap;	//indexed by pmem address
+	std::unordered_map<Addr, std::string> TXOptPmemToOptAddrMap;	//indexed by pmem address
 
   
 	// Replaced by stats
@@ -0,0 +1,148 @@
+#include "mem/nvm_media.hh"
+
+#include <algorithm>
+#include <iostream>
+
+#include "base/logging.hh"
+#include "mem/predictor/Common.hh"
+#include "sim/core.hh"
+
+NVMMedia::NVMMedia() {
+    this->enabled = get_env_val("ENABLE_NVM_MEDIA");
+
+    /* 0 is a valid setting for the latencies and the pausing knobs */
+    this->readLatency
+        = get_env_ulong("NVM_READ_LATENCY", 170) * SimClock::Int::ns;
+    this->writeLatency
+        = get_env_ulong("NVM_WRITE_LATENCY", 500) * SimClock::Int::ns;
+    this->pauseOverhead
+        = get_env_ulong("NVM_WRITE_PAUSE_OVERHEAD", 20) * SimClock::Int::ns;
+    this->granularity = std::stoul(get_env_str("NVM_MEDIA_GRANULARITY", "256"));
+    this->wcbEntries = std::stoul(get_env_str("NVM_WCB_ENTRIES", "64"));
+    this->writePausing = get_env_ulong("NVM_WRITE_PAUSING", 1) != 0;
+
+    panic_if(this->granularity < SUB_LINE_SIZE
+                or this->granularity % SUB_LINE_SIZE != 0
+                or this->granularity/SUB_LINE_SIZE > 64,
+             "NVM_MEDIA_GRANULARITY %d must be a multiple of %d and at most %d",
+             this->granularity, SUB_LINE_SIZE, 64*SUB_LINE_SIZE);
+    panic_if(this->wcbEntries == 0, "NVM_WCB_ENTRIES cannot be 0");
+
+    this->readOccupancy
+        = occupancy(get_env_float("NVM_READ_BANDWIDTH", 6600));
+    this->writeOccupancy
+        = occupancy(get_env_float("NVM_WRITE_BANDWIDTH", 2300));
+
+    if (this->enabled) {
+        std::cout << "NVM media model: read = " << this->readLatency
+                  << " write = " << this->writeLatency
+                  << " granularity = " << this->granularity
+                  << " wcb entries = " << this->wcbEntries
+                  << " write pausing = " << this->writePausing << std::endl;
+    }
+}
+
+Tick
+NVMMedia::occupancy(double bandwidthMBps) const {
+    panic_if(bandwidthMBps <= 0, "NVM media bandwidth must be positive");
+
+    /* 1 MB/s transfers one byte every microsecond */
+    return (Tick)(this->granularity * SimClock::Int::us / bandwidthMBps);
+}
+
+uint64_t
+NVMMedia::sub_line_bit(Addr addr) const {
+    return 1UL << ((addr % this->granularity)/SUB_LINE_SIZE);
+}
+
+uint64_t
+NVMMedia::full_line_mask() const {
+    const size_t subLines = this->granularity/SUB_LINE_SIZE;
+    return subLines == 64 ? ~0UL : (1UL << subLines) - 1;
+}
+
+NVMMedia::NVMMediaAccess
+NVMMedia::read(Addr addr, Tick when) {
+    NVMMediaAccess result;
+
+    /* Data still in the write-combining buffer is served from the DIMM */
+    auto line = this->wcb.find(media_line(addr));
+    if (line != this->wcb.end() and (line->second.writtenMask & sub_line_bit(addr))) {
+        result.bufferHit = true;
+        result.readyTick = when;
+        return result;
+    }
+
+    Tick start = std::max(when, this->mediaBusyUntil);
+
+    /* A media write is still in progress */
+    if (this->activeWriteEnd > start) {
+        if (this->writePausing and start >= this->activeWriteStart) {
+            start += this->pauseOverhead;
+            this->activeWriteEnd += this->readOccupancy + this->pauseOverhead;
+            result.pausedWrite = true;
+        } else {
+            start = this->activeWriteEnd;
+        }
+    }
+
+    this->mediaBusyUntil = std::max(this->mediaBusyUntil, start + this->readOccupancy);
+    result.readyTick = start + this->readLatency;
+    return result;
+}
+
+NVMMedia::NVMMediaAccess
+NVMMedia::write(Addr addr, Tick when) {
+    NVMMediaAccess result;
+    const Addr lineAddr = media_line(addr);
+
+    /* Coalesce with the line in the buffer */
+    auto line = this->wcb.find(lineAddr);
+    if (line != this->wcb.end()) {
+        line->second.writtenMask |= sub_line_bit(addr);
+        this->wcbLRU.splice(this->wcbLRU.begin(), this->wcbLRU, line->second.lruPos);
+        result.bufferHit = true;
+        result.readyTick = when;
+        return result;
+    }
+
+    Tick accepted = when;
+    if (this->wcb.size() >= this->wcbEntries) {
+        accepted = std::max(when, evict(when, result));
+    }
+
+    this->wcbLRU.push_front(lineAddr);
+    WCBLine &newLine = this->wcb[lineAddr];
+    newLine.writtenMask = sub_line_bit(addr);
+    newLine.lruPos = this->wcbLRU.begin();
+
+    result.readyTick = accepted;
+    return result;
+}
+
+Tick
+NVMMedia::evict(Tick when, NVMMediaAccess &result) {
+    const Addr victim = this->wcbLRU.back();
+    const uint64_t writtenMask = this->wcb.at(victim).writtenMask;
+    this->wcbLRU.pop_back();
+    this->wcb.erase(victim);
+
+    Tick start = std::max(when, this->mediaBusyUntil);
+    Tick busy = this->writeOccupancy;
+
+    /* Partially written lines read the rest of the line from the media */
+    if (writtenMask != full_line_mask()) {
+        busy += this->readOccupancy;
+        result.readModifyWrite = true;
+    }
+
+    this->mediaBusyUntil = start + busy;
+    this->activeWriteStart = start;
+    this->activeWriteEnd = std::max(this->activeWriteEnd, 
+                                    start + busy - this->writeOccupancy
+                                          + this->writeLatency);
+    result.mediaWrite = true;
+
+    /* Buffer slot is free once the line starts its way to the media */
+    return start;
+}
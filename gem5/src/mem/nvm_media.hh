@@ -0,0 +1,97 @@
+#ifndef SHIFTLAB_MEM_NVM_MEDIA_H__
+#define SHIFTLAB_MEM_NVM_MEDIA_H__
+
+#include "base/types.hh"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Timing model for the persistent memory media behind the DDR interface of
+ * the memory controller.
+ *
+ * The media is accessed at a coarse internal granularity (256 B by default)
+ * and has asymmetric read and write latencies. Writes are first merged in an
+ * on-DIMM write-combining buffer (WCB) and only reach the media when a WCB
+ * line is evicted, partially written lines need a read-modify-write. The
+ * media bandwidth limits how often a new media access can start, and an
+ * in-progress media write can be paused by an incoming read.
+ *
+ * Configured using the environment:
+ *   ENABLE_NVM_MEDIA          Enable the model for the PM addresses
+ *   NVM_READ_LATENCY          Media read latency in ns (default 170)
+ *   NVM_WRITE_LATENCY         Media write latency in ns (default 500)
+ *   NVM_MEDIA_GRANULARITY     Internal access granularity in B (default 256)
+ *   NVM_WCB_ENTRIES           Lines in the write-combining buffer (default 64)
+ *   NVM_READ_BANDWIDTH        Media read bandwidth in MB/s (default 6600)
+ *   NVM_WRITE_BANDWIDTH       Media write bandwidth in MB/s (default 2300)
+ *   NVM_WRITE_PAUSING         Allow reads to pause media writes (default 1)
+ *   NVM_WRITE_PAUSE_OVERHEAD  Cost of pausing a write in ns (default 20)
+ */
+class NVMMedia {
+public:
+    /* Outcome of a single access, used by the controller for its stats */
+    typedef struct NVMMediaAccess {
+        /* Read: data ready, write: line accepted by the WCB */
+        Tick readyTick = 0;
+        bool bufferHit = false;
+        bool pausedWrite = false;
+        bool mediaWrite = false;
+        bool readModifyWrite = false;
+    } NVMMediaAccess;
+
+private:
+    typedef struct WCBLine {
+        /* One bit per 64 B sub-line written since the line was allocated */
+        uint64_t writtenMask = 0;
+        std::list<Addr>::iterator lruPos;
+    } WCBLine;
+
+    bool enabled = false;
+
+    Tick readLatency;
+    Tick writeLatency;
+    Tick pauseOverhead;
+    size_t granularity;
+    size_t wcbEntries;
+    bool writePausing;
+
+    /* Media occupancy of a single read or write of one media line */
+    Tick readOccupancy;
+    Tick writeOccupancy;
+
+    std::unordered_map<Addr, WCBLine> wcb;
+
+    /* Most recently used line at the front */
+    std::list<Addr> wcbLRU;
+
+    /* Tick until which the media cannot start a new access */
+    Tick mediaBusyUntil = 0;
+
+    /* Media write currently in progress, can be paused by a read */
+    Tick activeWriteStart = 0;
+    Tick activeWriteEnd = 0;
+
+    static const size_t SUB_LINE_SIZE = 64;
+
+    Addr media_line(Addr addr) const { return addr - (addr % granularity); }
+    uint64_t sub_line_bit(Addr addr) const;
+    uint64_t full_line_mask() const;
+
+    /* Writes the LRU line back to the media, returns the media start tick */
+    Tick evict(Tick when, NVMMediaAccess &result);
+
+    /* Converts a bandwidth in MB/s to the ticks needed for one media line */
+    Tick occupancy(double bandwidthMBps) const;
+
+public:
+    NVMMedia();
+
+    bool is_enabled() const { return this->enabled; }
+
+    NVMMediaAccess read(Addr addr, Tick when);
+    NVMMediaAccess write(Addr addr, Tick when);
+};
+
+#endif // SHIFTLAB_MEM_NVM_MEDIA_H__
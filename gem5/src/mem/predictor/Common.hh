@@ -4,14 +4,11 @@
 #include "base/types.hh"
 #include "base/logging.hh"
 #include "mem/predictor/Constants.hh"
+#include "mem/predictor/PMRegionRegistry.hh"
 #include "mem/packet.hh"
 
 inline bool is_paddr_pm(Addr paddr) {
-    bool result = false;
-    if ( paddr > 8UL*(1024UL)*(1024UL)*(1024UL) /*8 GiB*/) {
-        result = true;
-    }
-    return result;
+    return PMRegionRegistry::is_paddr_pm(paddr);
 }
 
 inline bool is_paddr_volatile(Addr paddr) {
@@ -19,14 +16,7 @@ inline bool is_paddr_volatile(Addr paddr) {
 }
 
 inline bool is_vaddr_pm(Addr vaddr) {
-    bool result;
-    if ((vaddr >= PMEM_MMAP_HINT) && (vaddr < (2*PMEM_MMAP_HINT))) {
-        result = true;
-    } else {
-        result = false;
-    }
-    
-    return result;
+    return PMRegionRegistry::is_vaddr_pm(vaddr);
 }
 
 inline bool is_vaddr_clwb(const PacketPtr pkt) {
@@ -83,6 +73,20 @@ inline std::string get_env_str(std::string str, std::string defaultVal) {
     return result;
 }
 
+/**
+ * Reads a numeric setting for which 0 is a valid value, get_env_str treats
+ * "0" as unset and would return the default instead
+ */
+inline uint64_t get_env_ulong(std::string str, uint64_t defaultVal) {
+    char *val = std::getenv(str.c_str());
+
+    if (val == nullptr or *val == '\0') {
+        return defaultVal;
+    }
+
+    return std::stoul(std::string(val));
+}
+
 inline float get_env_float(std::string str, float defaultVal) {
     bool exists = get_env_val(str);
 
@@ -22,7 +22,8 @@ private:
         COUNTER_CACHE_HIT       = 1UL << 7,
         ORIGNAL_CACHELINE       = 1UL << 8,
         IHB_PATTERN_MATCH_INDEX = 1UL << 9,
-        TIME_OF_CREATION        = 1UL << 10
+        TIME_OF_CREATION        = 1UL << 10,
+        PREDICTED_WRITEBACK     = 1UL << 11
     };
     
     uint64_t flags = 0UL;
@@ -34,6 +35,9 @@ private:
          timeOfDataGen  = -1,
          timeOfCreation = -1;
 
+    /* Tick at which the clwb for this address is expected */
+    Tick predictedWritebackTick = -1;
+
     size_t ihbPatternMatchIndex;
 
     /** 
@@ -44,6 +48,9 @@ private:
 
     /* Was the prediction entry used for prediction */
     bool used = false;
+
+    /* Was the address of this prediction written while it was live */
+    bool addrMatched = false;
 public:
     CompletedWriteEntry(): addr(0) {}
 
@@ -97,6 +104,14 @@ public:
         return this->used;
     }
 
+    void mark_addr_matched() {
+        this->addrMatched = true;
+    }
+
+    bool was_addr_matched() const {
+        return this->addrMatched;
+    }
+
     Tick get_time_of_addr_gen() const {
         panic_if(not is_flag_set(flags, Flags::TIME_OF_ADDR_GEN), "");
         return this->timeOfAddrGen;
@@ -155,6 +170,20 @@ public:
         return result;
     }
 
+    Tick get_predicted_writeback_tick() const {
+        panic_if_not(is_flag_set(flags, Flags::PREDICTED_WRITEBACK));
+        return this->predictedWritebackTick;
+    }
+
+    void set_predicted_writeback_tick(Tick tick) {
+        set_flag(flags, Flags::PREDICTED_WRITEBACK);
+        this->predictedWritebackTick = tick;
+    }
+
+    bool has_predicted_writeback_tick() const {
+        return is_flag_set(flags, Flags::PREDICTED_WRITEBACK);
+    }
+
     void set_counter_cache_hit(bool cacheHit) {
         if (cacheHit) {
             set_flag(flags, Flags::COUNTER_CACHE_HIT);
@@ -0,0 +1,83 @@
+#include "mem/predictor/PMRegionRegistry.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+PMRangeMap PMRegionRegistry::virtRanges;
+PMRangeMap PMRegionRegistry::physRanges;
+
+void
+PMRangeMap::add(Addr start, Addr size) {
+    Addr end = start + size;
+
+    /* Merge with a range that ends at or after the start */
+    auto it = this->ranges.upper_bound(start);
+    if (it != this->ranges.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second >= start) {
+            start = prev->first;
+            end = std::max(end, prev->second);
+            it = this->ranges.erase(prev);
+        }
+    }
+
+    /* Merge with all the ranges that start before the end */
+    while (it != this->ranges.end() and it->first <= end) {
+        end = std::max(end, it->second);
+        it = this->ranges.erase(it);
+    }
+
+    this->ranges[start] = end;
+
+    /* The cached range might have been merged */
+    this->lastHitStart = 0;
+    this->lastHitEnd = 0;
+}
+
+bool
+PMRangeMap::contains(Addr addr) const {
+    if (addr >= this->lastHitStart and addr < this->lastHitEnd) {
+        return true;
+    }
+
+    auto it = this->ranges.upper_bound(addr);
+    if (it == this->ranges.begin()) {
+        return false;
+    }
+
+    --it;
+    if (addr < it->second) {
+        this->lastHitStart = it->first;
+        this->lastHitEnd = it->second;
+        return true;
+    }
+
+    return false;
+}
+
+void
+PMRegionRegistry::add_region(Addr vaddr, Addr paddr, Addr size) {
+    virtRanges.add(vaddr, size);
+    physRanges.add(paddr, size);
+
+    std::cout << "Registered PM region vaddr = " << (void*)vaddr
+              << " paddr = " << (void*)paddr
+              << " size = " << size << std::endl;
+}
+
+bool
+PMRegionRegistry::is_vaddr_pm(Addr vaddr) {
+    if (virtRanges.empty()) {
+        return vaddr >= PMEM_MMAP_HINT and vaddr < 2*PMEM_MMAP_HINT;
+    }
+    return virtRanges.contains(vaddr);
+}
+
+bool
+PMRegionRegistry::is_paddr_pm(Addr paddr) {
+    if (physRanges.empty()) {
+        return paddr > LEGACY_PM_PADDR_START;
+    }
+    return physRanges.contains(paddr);
+}
@@ -0,0 +1,57 @@
+#ifndef SHIFTLAB_MEM_PREDICTOR_PM_REGION_REGISTRY_H__
+#define SHIFTLAB_MEM_PREDICTOR_PM_REGION_REGISTRY_H__
+
+#include "base/types.hh"
+#include "mem/predictor/Constants.hh"
+
+#include <map>
+
+/**
+ * Set of non-overlapping [start, end) address ranges. Adjacent and
+ * overlapping ranges are merged on insertion. Lookups first check the range
+ * that matched last and fall back to a binary search.
+ */
+class PMRangeMap {
+private:
+    /* Start address -> end address (exclusive) */
+    std::map<Addr, Addr> ranges;
+
+    mutable Addr lastHitStart = 0;
+    mutable Addr lastHitEnd = 0;
+
+public:
+    void add(Addr start, Addr size);
+    bool contains(Addr addr) const;
+
+    bool empty() const { return this->ranges.empty(); }
+    size_t size() const { return this->ranges.size(); }
+};
+
+/**
+ * System wide registry of the persistent memory regions. Regions are
+ * registered when the simulated process maps persistent memory (the
+ * mmap_persistent syscall, used by pmem_map_file) and are queried by the
+ * predictor, the memory controller and the crossbar to classify addresses.
+ *
+ * Until the first region is registered, the registry falls back to the
+ * fixed layout: virtual addresses in [PMEM_MMAP_HINT, 2*PMEM_MMAP_HINT) and
+ * physical addresses above 8 GiB are persistent.
+ */
+class PMRegionRegistry {
+private:
+    static PMRangeMap virtRanges;
+    static PMRangeMap physRanges;
+
+    static const Addr LEGACY_PM_PADDR_START = 8UL*(1024UL)*(1024UL)*(1024UL);
+
+public:
+    /* Registers a persistent mapping of size bytes */
+    static void add_region(Addr vaddr, Addr paddr, Addr size);
+
+    static bool is_vaddr_pm(Addr vaddr);
+    static bool is_paddr_pm(Addr paddr);
+
+    static size_t get_region_count() { return virtRanges.size(); }
+};
+
+#endif // SHIFTLAB_MEM_PREDICTOR_PM_REGION_REGISTRY_H__
@@ -0,0 +1,120 @@
+#include "mem/predictor/PredictionThrottle.hh"
+
+#include <iostream>
+
+bool                                             PredictionThrottle::enabled = false;
+size_t                                           PredictionThrottle::level = 0;
+std::unordered_map<hash_t,
+                   PredictionThrottle::HashOutcome> PredictionThrottle::hashOutcomes;
+
+uint64_t PredictionThrottle::totalUseful = 0;
+uint64_t PredictionThrottle::totalHarmful = 0;
+uint64_t PredictionThrottle::totalThrottled = 0;
+uint64_t PredictionThrottle::totalProbes = 0;
+uint64_t PredictionThrottle::avoidedMetadataFills = 0;
+uint64_t PredictionThrottle::intervalUseful = 0;
+uint64_t PredictionThrottle::intervalHarmful = 0;
+
+size_t PredictionThrottle::INTERVAL = 256;
+size_t PredictionThrottle::MIN_SAMPLES = 8;
+size_t PredictionThrottle::PROBE_PERIOD = 16;
+
+void
+PredictionThrottle::init() {
+    enabled = get_env_val("ENABLE_PRED_THROTTLE");
+    INTERVAL = std::stoul(get_env_str("PRED_THROTTLE_INTERVAL", "256"));
+    MIN_SAMPLES = get_env_ulong("PRED_THROTTLE_MIN_SAMPLES", 8);
+    PROBE_PERIOD = std::stoul(get_env_str("PRED_THROTTLE_PROBE_PERIOD", "16"));
+
+    if (PROBE_PERIOD == 0) {
+        PROBE_PERIOD = 1;
+    }
+
+    std::cout << "Prediction throttling = " << enabled << std::endl;
+}
+
+bool
+PredictionThrottle::should_issue(hash_t hash) {
+    if (not enabled or level == 0) {
+        return true;
+    }
+
+    HashOutcome &outcome = hashOutcomes[hash];
+    const uint32_t samples = outcome.useful + outcome.harmful;
+
+    /*
+     * Not enough history, only the most aggressive level blocks these. A
+     * hash without any outcome has no history even if MIN_SAMPLES is 0.
+     */
+    if (samples == 0 or samples < MIN_SAMPLES) {
+        return level < MAX_LEVEL;
+    }
+
+    /* Level 1 requires 25% accuracy, level 2 50% and level 3 75% */
+    const size_t accuracy = (100 * outcome.useful)/samples;
+    if (accuracy >= 25 * level) {
+        return true;
+    }
+
+    /* Issue an occasional probe so that the hash can recover */
+    outcome.suppressed++;
+    if ((outcome.suppressed % PROBE_PERIOD) == 0) {
+        totalProbes++;
+        return true;
+    }
+
+    totalThrottled++;
+    return false;
+}
+
+void
+PredictionThrottle::record_useful(hash_t hash) {
+    totalUseful++;
+    intervalUseful++;
+
+    HashOutcome &outcome = hashOutcomes[hash];
+    outcome.useful++;
+    saturate(outcome);
+
+    if (intervalUseful + intervalHarmful >= INTERVAL) {
+        end_interval();
+    }
+}
+
+void
+PredictionThrottle::record_harmful(hash_t hash) {
+    totalHarmful++;
+    intervalHarmful++;
+
+    HashOutcome &outcome = hashOutcomes[hash];
+    outcome.harmful++;
+    saturate(outcome);
+
+    if (intervalUseful + intervalHarmful >= INTERVAL) {
+        end_interval();
+    }
+}
+
+void
+PredictionThrottle::saturate(HashOutcome &outcome) {
+    if (outcome.useful + outcome.harmful >= OUTCOME_SATURATION) {
+        outcome.useful >>= 1;
+        outcome.harmful >>= 1;
+    }
+}
+
+void
+PredictionThrottle::end_interval() {
+    const size_t accuracy
+        = (100 * intervalUseful)/(intervalUseful + intervalHarmful);
+
+    /* Same thresholds as feedback directed prefetching */
+    if (accuracy < 40 and level < MAX_LEVEL) {
+        level++;
+    } else if (accuracy > 75 and level > 0) {
+        level--;
+    }
+
+    intervalUseful = 0;
+    intervalHarmful = 0;
+}
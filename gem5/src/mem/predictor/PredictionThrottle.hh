@@ -0,0 +1,88 @@
+#ifndef SHIFTLAB_MEM_PREDICTOR_PREDICTION_THROTTLE_H__
+#define SHIFTLAB_MEM_PREDICTOR_PREDICTION_THROTTLE_H__
+
+#include "mem/predictor/Common.hh"
+#include "mem/predictor/Declarations.hh"
+
+#include <string>
+#include <unordered_map>
+
+/**
+ * Feedback directed throttling for the predictions sent to the backend.
+ *
+ * Every prediction added to the result buffer reads the metadata caches in
+ * the memory controller. Predictions that are never matched by a write only
+ * pollute those caches. The throttle tracks the useful (address written while
+ * the prediction was live) and harmful (evicted unused) outcomes per
+ * generator hash and globally. The global accuracy over an interval selects
+ * a throttle level, each level requires a higher per-hash accuracy before
+ * the prediction is allowed to access the metadata caches.
+ *
+ * Enabled using ENABLE_PRED_THROTTLE.
+ */
+class PredictionThrottle {
+public:
+    typedef struct HashOutcome {
+        uint32_t useful = 0;
+        uint32_t harmful = 0;
+        uint64_t suppressed = 0;
+    } HashOutcome;
+
+    static bool enabled;
+
+    /** Current throttle level, 0 issues every prediction */
+    static size_t level;
+    static const size_t MAX_LEVEL = 3;
+
+    static std::unordered_map<hash_t, HashOutcome> hashOutcomes;
+
+    /* Global counters, read by the backend to update its statistics */
+    static uint64_t totalUseful;
+    static uint64_t totalHarmful;
+    static uint64_t totalThrottled;
+    static uint64_t totalProbes;
+
+    /**
+     * Metadata cache misses the suppressed predictions would have caused,
+     * drained by the memory controller into its statistics.
+     */
+    static uint64_t avoidedMetadataFills;
+
+    static void init();
+
+    /**
+     * Returns true if the prediction generated by the hash should access the
+     * metadata caches.
+     */
+    static bool should_issue(hash_t hash);
+
+    static void record_useful(hash_t hash);
+    static void record_harmful(hash_t hash);
+
+    static uint64_t drain_avoided_metadata_fills() {
+        uint64_t result = avoidedMetadataFills;
+        avoidedMetadataFills = 0;
+        return result;
+    }
+
+private:
+    static uint64_t intervalUseful;
+    static uint64_t intervalHarmful;
+
+    /** Number of outcomes after which the throttle level is re-evaluated */
+    static size_t INTERVAL;
+
+    /** Outcomes needed before the per-hash accuracy is trusted */
+    static size_t MIN_SAMPLES;
+
+    /** Every PROBE_PERIOD'th suppressed prediction is issued anyway */
+    static size_t PROBE_PERIOD;
+
+    /** Per-hash counters are halved once their sum reaches this value */
+    static const uint32_t OUTCOME_SATURATION = 64;
+
+    static void end_interval();
+    static void saturate(HashOutcome &outcome);
+};
+
+#endif // SHIFTLAB_MEM_PREDICTOR_PREDICTION_THROTTLE_H__
@@ -7,6 +7,7 @@
 #include "mem/predictor/LastFoundKeyEntry.hh"
 #include "mem/predictor/PredictorTable.hh"
 #include "mem/predictor/SharedArea.hh"
+#include "mem/predictor/TagePredictorTable.hh"
 #include "mem/predictor_backend.hh"
 
 #define ALL_SUYASH__
@@ -38,6 +39,11 @@ PredictorTable::add(PredictorTableEntry elem) {
     panic_if_not(elem.has_orig_cacheline());
     DataStore::add(elem);
 
+    /* The hash of the entry is the history key captured by the WHB */
+    if (this->is_tage_enabled()) {
+        return this->tagePredictor->add(elem.get_hash(), elem);
+    }
+
     this->tick();
 
     /* Set the insertion order of the element */
@@ -97,6 +103,9 @@ PredictorTable::contains(hash_t pc) {
 size_t 
 PredictorTable::get_size() {
     DataStore::get_size();
+    if (this->is_tage_enabled()) {
+        return this->tagePredictor->get_size();
+    }
     return this->predictorTable.size();
 }
 
@@ -143,6 +152,10 @@ rotl (T v, unsigned int b)
 
 hash_t 
 PredictorTable::get_path_hash() const {
+    if (this->is_tage_enabled()) {
+        return this->tagePredictor->get_path_hash();
+    }
+
     hash_t result = 0ul;
 
     // auto mask_upper_32_bits = [](hash_t hash) { return (hash << 32) >> 32; };
@@ -155,6 +168,10 @@ PredictorTable::get_path_hash() const {
 
 PredictorTableEntry
 PredictorTable::get_with_hash(hash_t hash) {
+    if (this->is_tage_enabled()) {
+        return this->tagePredictor->get_with_hash(hash);
+    }
+
     // std::cout << " Trying to get hash " << std::endl;
     PredictorTableEntry result;
     bool found = false;
@@ -207,6 +224,16 @@ PredictorTable::update_ihb(PacketPtr pkt) {
     // std::cout << "PC added, new hash = " << this->get_path_hash() << std::endl;
     this->lastFoundHashes.clear();
 
+    /* Longest matching history provides the prediction */
+    if (this->is_tage_enabled()) {
+        hash_t providerHash = this->tagePredictor->update_history(pc);
+        if (providerHash != 0) {
+            result = true;
+            this->lastFoundHashes.push_back(providerHash);
+        }
+        return result;
+    }
+
     /* Overwrite everything for the path based */
     if (this->has_hash(this->get_path_hash())) {
         // std::cout << GRN << "Found hash " << this->get_path_hash() << RST << std::endl;
@@ -324,6 +351,10 @@ PredictorTable::dump() {
 
 bool 
 PredictorTable::has_hash(hash_t hash) const {
+    if (this->is_tage_enabled()) {
+        return this->tagePredictor->has_hash(hash);
+    }
+
     bool result = false;
     // std::cout << "Predictor table size = " << this->predictorTable.size() << std::endl;
     for (auto entry : this->predictorTable) {
@@ -335,3 +366,15 @@ PredictorTable::has_hash(hash_t hash) const {
     }
     return result;
 }
+
+void 
+PredictorTable::init_tage_predictor(std::string name) {
+    this->tagePredictor = new TagePredictorTable(name + ".tage");
+}
+
+void 
+PredictorTable::notify_tage_prediction(hash_t hash, bool addrPrediction, 
+                                       bool dataPrediction) {
+    this->tagePredictor->notify_correct_prediction(hash, addrPrediction, 
+                                                   dataPrediction);
+}
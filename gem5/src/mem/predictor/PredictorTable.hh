@@ -30,6 +30,8 @@
 #include "mem/predictor/Declarations.hh"
 #include "mem/predictor/PCQueue.hh"
 
+class TagePredictorTable;
+
 class PredictorTableEntry {
 public:
     static const int DATA_T_SIZE = 64/sizeof(ChunkInfo::Content::data);
@@ -450,6 +452,15 @@ protected:
     const std::string ENABLE_CONST_0_PREDICTION_STR = "ENABLE_CONST_0_PREDICTION";
     const std::string PATH_HISTORY_SIZE_STR = "PATH_HISTORY_SIZE";
     size_t PATH_HISTORY_SIZE = 4;
+
+    /** 
+     * Multi-length tagged tables used instead of the single path hash when
+     * ENABLE_TAGE_PREDICTOR is set, nullptr otherwise.
+     */
+    const std::string ENABLE_TAGE_PREDICTOR_STR = "ENABLE_TAGE_PREDICTOR";
+    TagePredictorTable *tagePredictor = nullptr;
+
+    void notify_tage_prediction(hash_t hash, bool addrPrediction, bool dataPrediction);
 public:
     SimpleFixedSizeQueue<PC_t> *pathHistory;
 
@@ -537,6 +548,10 @@ public:
                   << this->MAX_SIZE 
                   << RST << "\n\n\n========\n";
         ihbPatternMatchIdVec = std::vector<size_t>(10);
+
+        if (get_env_val(ENABLE_TAGE_PREDICTOR_STR)) {
+            this->init_tage_predictor(name);
+        }
     }
     ~PredictorTable() {
         // delete indexHistoryBuffer;
@@ -555,6 +570,12 @@ public:
     /* Returns the XOR'd value of all the PCs in the path history */
     hash_t get_path_hash() const;
 
+    void init_tage_predictor(std::string name);
+
+    bool is_tage_enabled() const {
+        return this->tagePredictor != nullptr;
+    }
+
     PredictorTableEntry& get() override { unimplemented__(""); }
     PredictorTableEntry get_with_hash(hash_t hash);
 
@@ -608,6 +629,11 @@ public:
      */
     void notify_correct_prediction(hash_t hash, bool addrPrediction, bool dataPrediction) {
         notifications++;
+        if (this->is_tage_enabled()) {
+            this->notify_tage_prediction(hash, addrPrediction, dataPrediction);
+            return;
+        }
+
         if (this->predictorTable.find(hash) != this->predictorTable.end()) {
             this->predictorTable[hash].notify_confidence(addrPrediction, dataPrediction);
         }
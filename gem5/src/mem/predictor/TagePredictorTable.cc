@@ -0,0 +1,341 @@
+#include "base/trace.hh"
+#include "debug/PredictorTable.hh"
+#include "mem/predictor/SharedArea.hh"
+#include "mem/predictor/TagePredictorTable.hh"
+
+#include <cmath>
+
+TagePredictorTable::TagePredictorTable(std::string name) : name(name) {
+    TABLE_COUNT = std::stoul(get_env_str(TAGE_TABLE_COUNT_STR, "4"));
+    TABLE_SIZE = std::stoul(get_env_str(TAGE_TABLE_SIZE_STR, "32"));
+    MIN_HISTORY = std::stoul(get_env_str(TAGE_MIN_HISTORY_STR, "2"));
+    MAX_HISTORY = std::stoul(get_env_str(TAGE_MAX_HISTORY_STR, "32"));
+    TAG_BITS = std::stoul(get_env_str(TAGE_TAG_BITS_STR, "12"));
+    USEFUL_RESET_PERIOD
+        = std::stoul(get_env_str(TAGE_USEFUL_RESET_PERIOD_STR, "1024"));
+
+    panic_if(TABLE_COUNT == 0, "TAGE predictor needs at least one table");
+    panic_if(MIN_HISTORY == 0 or MIN_HISTORY > MAX_HISTORY,
+             "Invalid TAGE history lengths [%d, %d]", MIN_HISTORY, MAX_HISTORY);
+
+    /* Each table has the same share of the total predictor table size */
+    SharedArea::init_size_multiplier();
+    TABLE_SIZE = std::max<size_t>(1, TABLE_SIZE * SharedArea::sizeMultiplier);
+    SNAPSHOT_COUNT *= SharedArea::sizeMultiplier;
+
+    /* L(i) = MIN_HISTORY * (MAX_HISTORY/MIN_HISTORY)^(i/(TABLE_COUNT-1)) */
+    for (size_t i = 0; i < TABLE_COUNT; i++) {
+        double ratio = TABLE_COUNT == 1
+                            ? 0
+                            : (double)i/(double)(TABLE_COUNT - 1);
+        size_t len = (size_t)(MIN_HISTORY
+                        * std::pow((double)MAX_HISTORY/MIN_HISTORY, ratio)
+                        + 0.5);
+        if (not historyLengths.empty() and len <= historyLengths.back()) {
+            len = historyLengths.back() + 1;
+        }
+        historyLengths.push_back(len);
+    }
+
+    tables = std::vector<std::vector<TageEntry>>(
+                TABLE_COUNT, std::vector<TageEntry>(TABLE_SIZE));
+    pathHistory = new SimpleFixedSizeQueue<PC_t>(historyLengths.back());
+
+    tableHits
+        .init(TABLE_COUNT)
+        .name(name + ".tableHits")
+        .desc("Number of lookups provided by each of the TAGE tables.");
+    tableAllocations
+        .init(TABLE_COUNT)
+        .name(name + ".tableAllocations")
+        .desc("Number of entries allocated in each of the TAGE tables.");
+    for (size_t i = 0; i < TABLE_COUNT; i++) {
+        std::string histLen = std::to_string(historyLengths[i]);
+        tableHits.subname(i, "hist" + histLen);
+        tableHits.subdesc(i, "Lookups provided by the table using a history "
+                             "of " + histLen + " PCs");
+        tableAllocations.subname(i, "hist" + histLen);
+    }
+    lookupMisses
+        .name(name + ".lookupMisses")
+        .desc("Number of lookups that did not match any of the TAGE tables.");
+    altProviderUsed
+        .name(name + ".altProviderUsed")
+        .desc("Number of times the alternate provider was used due to a newly "
+              "allocated, low confidence, provider entry.");
+    providerAgreements
+        .name(name + ".providerAgreements")
+        .desc("Number of trainings where the provider already held the pattern.");
+    providerReplacements
+        .name(name + ".providerReplacements")
+        .desc("Number of low confidence provider entries replaced in place.");
+    allocationFailures
+        .name(name + ".allocationFailures")
+        .desc("Number of mispredictions that could not allocate an entry in a "
+              "longer table.");
+    missingSnapshots
+        .name(name + ".missingSnapshots")
+        .desc("Number of trainings dropped since the history snapshot was "
+              "already evicted.");
+    usefulResets
+        .name(name + ".usefulResets")
+        .desc("Number of times the usefulness counters were aged.");
+
+    std::cout << "TAGE predictor table, history lengths = <";
+    for (size_t i = 0; i < TABLE_COUNT; i++) {
+        std::cout << historyLengths[i] << (i == TABLE_COUNT - 1 ? "" : ", ");
+    }
+    std::cout << ">, table size = " << TABLE_SIZE << std::endl;
+
+    this->record_snapshot();
+}
+
+hash_t
+TagePredictorTable::hash_history(size_t len) const {
+    hash_t result = 0ul;
+    const size_t size = this->pathHistory->get_size();
+
+    /* Index 0 is the most recent PC */
+    for (size_t i = 0; i < len and i < size; i++) {
+        hash_t pc = this->pathHistory->get(size - 1 - i);
+        const size_t rot = i % 64;
+        result ^= rot == 0 ? pc : ((pc << rot) | (pc >> (64 - rot)));
+    }
+    return result;
+}
+
+TageHistorySnapshot
+TagePredictorTable::compute_snapshot() const {
+    TageHistorySnapshot result;
+    const hash_t tagMask = (1ul << TAG_BITS) - 1;
+
+    for (size_t i = 0; i < TABLE_COUNT; i++) {
+        hash_t hash = this->hash_history(historyLengths[i]);
+
+        /* Fold the history into index and tag, mix with the table id */
+        hash_t folded = hash ^ (hash >> 17) ^ (hash >> 31);
+        size_t index = (folded ^ (i * 0x9E3779B97F4A7C15ul)) % TABLE_SIZE;
+        hash_t tag = ((folded >> 7) ^ (hash >> 43)) & tagMask;
+
+        result.indices.push_back(index);
+        result.tags.push_back(tag);
+
+        /* Unique (non-zero) identifier of the entry at this table and index */
+        result.hashes.push_back(
+            ((hash_t)(i + 1) << 56) ^ ((hash_t)index << TAG_BITS) ^ tag);
+    }
+    return result;
+}
+
+void
+TagePredictorTable::record_snapshot() {
+    this->currentKey = this->hash_history(historyLengths.back())
+                        ^ this->pathHistory->get_size();
+
+    if (this->snapshots.find(currentKey) == this->snapshots.end()) {
+        this->snapshotOrder.push_back(currentKey);
+    }
+    this->snapshots[currentKey] = this->compute_snapshot();
+
+    while (this->snapshotOrder.size() > SNAPSHOT_COUNT) {
+        this->snapshots.erase(this->snapshotOrder.front());
+        this->snapshotOrder.pop_front();
+    }
+}
+
+int
+TagePredictorTable::find_provider(const TageHistorySnapshot &snapshot,
+                                  int below) const {
+    for (int i = below - 1; i >= 0; i--) {
+        const TageEntry &entry = this->tables[i][snapshot.indices[i]];
+        if (entry.valid and entry.tag == snapshot.tags[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+hash_t
+TagePredictorTable::update_history(PC_t pc) {
+    this->pathHistory->push_back(pc);
+    this->record_snapshot();
+
+    const TageHistorySnapshot &snapshot = this->snapshots.at(currentKey);
+    int provider = this->find_provider(snapshot, TABLE_COUNT);
+
+    if (provider == -1) {
+        this->lookupMisses++;
+        return 0;
+    }
+
+    /* Newly allocated entries are not trusted over a shorter match */
+    TageEntry &providerEntry = this->tables[provider][snapshot.indices[provider]];
+    if (providerEntry.useful == 0
+            and providerEntry.entry.addrConf() <= LOW_CONF_TRESH) {
+        int alt = this->find_provider(snapshot, provider);
+        if (alt != -1) {
+            this->altProviderUsed++;
+            provider = alt;
+        }
+    }
+
+    this->tableHits[provider]++;
+    DPRINTF(PredictorTable, "TAGE hit in table %d (history = %d)\n",
+            provider, historyLengths[provider]);
+    return snapshot.hashes[provider];
+}
+
+bool
+TagePredictorTable::same_pattern(PredictorTableEntry &a,
+                                 PredictorTableEntry &b) const {
+    if (a.get_addr_chunk().get_generating_pc()
+            != b.get_addr_chunk().get_generating_pc()) {
+        return false;
+    }
+
+    for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
+        ChunkInfo &chunkA = a.get_datachunks()[i];
+        ChunkInfo &chunkB = b.get_datachunks()[i];
+        if (chunkA.is_valid() != chunkB.is_valid()) {
+            return false;
+        }
+        if (chunkA.is_valid()
+                and chunkA.get_generating_pc() != chunkB.get_generating_pc()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+TagePredictorTable::add(hash_t key, PredictorTableEntry elem) {
+    if (this->snapshots.find(key) == this->snapshots.end()) {
+        this->missingSnapshots++;
+        return false;
+    }
+
+    const TageHistorySnapshot snapshot = this->snapshots.at(key);
+    int provider = this->find_provider(snapshot, TABLE_COUNT);
+
+    if (provider != -1) {
+        TageEntry &providerEntry
+                = this->tables[provider][snapshot.indices[provider]];
+
+        if (this->same_pattern(providerEntry.entry, elem)) {
+            this->providerAgreements++;
+            providerEntry.entry.addrConf.add(1);
+            return true;
+        }
+
+        /* The provider mispredicted the pattern */
+        providerEntry.entry.dataConf.sub(1);
+        if (providerEntry.entry.addrConf() <= LOW_CONF_TRESH
+                or providerEntry.entry.dataConf() <= LOW_CONF_TRESH) {
+            this->providerReplacements++;
+            elem.set_hash(snapshot.hashes[provider]);
+            providerEntry.entry = elem;
+            providerEntry.entry.addrConf = elem.addrConf;
+            providerEntry.entry.dataConf = elem.dataConf;
+            providerEntry.useful = 0;
+        }
+    }
+
+    /* Allocate in the first table with a longer history that is not useful */
+    bool allocated = false;
+    for (size_t i = provider + 1; i < TABLE_COUNT; i++) {
+        TageEntry &candidate = this->tables[i][snapshot.indices[i]];
+        if (not candidate.valid or candidate.useful == 0) {
+            elem.set_hash(snapshot.hashes[i]);
+            candidate.valid = true;
+            candidate.tag = snapshot.tags[i];
+            candidate.useful = 0;
+            candidate.entry = elem;
+            candidate.entry.addrConf = elem.addrConf;
+            candidate.entry.dataConf = elem.dataConf;
+
+            this->tableAllocations[i]++;
+            allocated = true;
+            break;
+        }
+    }
+
+    /* Make room for the future allocations */
+    if (not allocated and provider + 1 < (int)TABLE_COUNT) {
+        this->allocationFailures++;
+        for (size_t i = provider + 1; i < TABLE_COUNT; i++) {
+            TageEntry &candidate = this->tables[i][snapshot.indices[i]];
+            if (candidate.useful > 0) {
+                candidate.useful--;
+            }
+        }
+    }
+
+    this->allocationCount++;
+    if ((this->allocationCount % USEFUL_RESET_PERIOD) == 0) {
+        this->age_useful_counters();
+    }
+    return allocated;
+}
+
+void
+TagePredictorTable::age_useful_counters() {
+    this->usefulResets++;
+    for (auto &table : this->tables) {
+        for (auto &entry : table) {
+            entry.useful >>= 1;
+        }
+    }
+}
+
+TageEntry *
+TagePredictorTable::find_entry(hash_t hash) {
+    const size_t tableId = (hash >> 56) - 1;
+    const size_t index = (hash >> TAG_BITS) & ((1ul << (56 - TAG_BITS)) - 1);
+
+    if (tableId >= TABLE_COUNT or index >= TABLE_SIZE) {
+        return nullptr;
+    }
+
+    TageEntry &entry = this->tables[tableId][index];
+    if (not entry.valid or entry.entry.get_hash() != hash) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+bool
+TagePredictorTable::has_hash(hash_t hash) {
+    return this->find_entry(hash) != nullptr;
+}
+
+PredictorTableEntry
+TagePredictorTable::get_with_hash(hash_t hash) {
+    TageEntry *entry = this->find_entry(hash);
+    panic_if(entry == nullptr, "Unable to find any match for hash %p", hash);
+    return entry->entry;
+}
+
+void
+TagePredictorTable::notify_correct_prediction(hash_t hash, bool addrPrediction,
+                                              bool dataPrediction) {
+    TageEntry *entry = this->find_entry(hash);
+    if (entry == nullptr) {
+        return;
+    }
+
+    entry->entry.notify_confidence(addrPrediction, dataPrediction);
+    if (dataPrediction and entry->useful < USEFUL_MAX) {
+        entry->useful++;
+    }
+}
+
+size_t
+TagePredictorTable::get_size() const {
+    size_t result = 0;
+    for (auto &table : this->tables) {
+        for (auto &entry : table) {
+            result += entry.valid;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,137 @@
+#ifndef SHIFTLAB_TAGE_PREDICTOR_TABLE_H__
+#define SHIFTLAB_TAGE_PREDICTOR_TABLE_H__
+
+#include "base/statistics.hh"
+#include "mem/predictor/Common.hh"
+#include "mem/predictor/Declarations.hh"
+#include "mem/predictor/PredictorTable.hh"
+#include "mem/predictor/SimpleFixedSizeQueue.hh"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Single entry of one of the tagged tables. Holds the prediction along with
+ * the partial tag and the usefulness counter used for replacement.
+ */
+class TageEntry {
+public:
+    bool valid = false;
+    hash_t tag = 0;
+    uint8_t useful = 0;
+    PredictorTableEntry entry;
+};
+
+/**
+ * Set of per-table indices and tags for a single point in the path history.
+ * Captured when the history changes so that the training done at the end of
+ * the cacheline accumulation uses the history that preceded the write.
+ */
+class TageHistorySnapshot {
+public:
+    std::vector<size_t> indices;
+    std::vector<hash_t> tags;
+    std::vector<hash_t> hashes;
+};
+
+/**
+ * TAGE style predictor table. Holds a set of tagged tables, each indexed
+ * using a different, geometrically increasing, length of the path history.
+ * Lookups use the longest matching table (the provider), training allocates
+ * a new entry in a longer table when the provider disagrees with the
+ * observed pattern.
+ *
+ * Works as a drop-in replacement for the single path hash used by
+ * PredictorTable, enabled using ENABLE_TAGE_PREDICTOR.
+ */
+class TagePredictorTable {
+private:
+    std::string name;
+
+    size_t TABLE_COUNT = 4;
+    size_t TABLE_SIZE = 32;
+    size_t MIN_HISTORY = 2;
+    size_t MAX_HISTORY = 32;
+    size_t TAG_BITS = 12;
+    size_t USEFUL_MAX = 3;
+
+    /** Number of allocations after which the usefulness counters are aged */
+    size_t USEFUL_RESET_PERIOD = 1024;
+
+    /** Maximum number of history snapshots kept for training */
+    size_t SNAPSHOT_COUNT = 512;
+
+    const std::string TAGE_TABLE_COUNT_STR = "TAGE_TABLE_COUNT";
+    const std::string TAGE_TABLE_SIZE_STR = "TAGE_TABLE_SIZE";
+    const std::string TAGE_MIN_HISTORY_STR = "TAGE_MIN_HISTORY";
+    const std::string TAGE_MAX_HISTORY_STR = "TAGE_MAX_HISTORY";
+    const std::string TAGE_TAG_BITS_STR = "TAGE_TAG_BITS";
+    const std::string TAGE_USEFUL_RESET_PERIOD_STR = "TAGE_USEFUL_RESET_PERIOD";
+
+    static const size_t LOW_CONF_TRESH = 1;
+
+    /* Geometric history length used by each of the tables */
+    std::vector<size_t> historyLengths;
+    std::vector<std::vector<TageEntry>> tables;
+
+    SimpleFixedSizeQueue<PC_t> *pathHistory;
+
+    /* Snapshot of the indices for each of the recently seen history keys */
+    std::unordered_map<hash_t, TageHistorySnapshot> snapshots;
+    std::deque<hash_t> snapshotOrder;
+
+    hash_t currentKey = 0;
+    size_t allocationCount = 0;
+
+    /* Hashes the most recent 'len' PCs of the path history */
+    hash_t hash_history(size_t len) const;
+
+    TageHistorySnapshot compute_snapshot() const;
+    void record_snapshot();
+
+    /* Returns the table id of the longest match, -1 if none found */
+    int find_provider(const TageHistorySnapshot &snapshot, int below) const;
+
+    bool same_pattern(PredictorTableEntry &a, PredictorTableEntry &b) const;
+
+    TageEntry *find_entry(hash_t hash);
+    void age_useful_counters();
+
+protected:
+    Stats::Vector tableHits;
+    Stats::Vector tableAllocations;
+    Stats::Scalar lookupMisses;
+    Stats::Scalar altProviderUsed;
+    Stats::Scalar providerAgreements;
+    Stats::Scalar providerReplacements;
+    Stats::Scalar allocationFailures;
+    Stats::Scalar missingSnapshots;
+    Stats::Scalar usefulResets;
+
+public:
+    TagePredictorTable(std::string name);
+
+    /**
+     * Adds the PC to the path history and looks up the tables.
+     * @return Hash of the provider entry, 0 if none of the tables matched
+     */
+    hash_t update_history(PC_t pc);
+
+    /* Key used to identify the current history during training */
+    hash_t get_path_hash() const { return this->currentKey; }
+
+    /* Trains the tables using the history identified by the key */
+    bool add(hash_t key, PredictorTableEntry elem);
+
+    bool has_hash(hash_t hash);
+    PredictorTableEntry get_with_hash(hash_t hash);
+
+    void notify_correct_prediction(hash_t hash, bool addrPrediction,
+                                   bool dataPrediction);
+
+    size_t get_size() const;
+};
+
+#endif // SHIFTLAB_TAGE_PREDICTOR_TABLE_H__
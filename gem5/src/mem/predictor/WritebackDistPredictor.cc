@@ -0,0 +1,56 @@
+#include "mem/predictor/SharedArea.hh"
+#include "mem/predictor/WritebackDistPredictor.hh"
+
+WritebackDistPredictor::WritebackDistPredictor() {
+    std::string keyType = get_env_str("WB_DIST_PREDICTOR_KEY", "pc");
+    panic_if(keyType != "pc" and keyType != "path",
+             "Unknown WB_DIST_PREDICTOR_KEY %s, expected pc or path",
+             keyType.c_str());
+    this->keyType = keyType == "pc" ? KeyType::PC : KeyType::PATH;
+
+    this->MAX_SIZE = std::stoul(get_env_str("WB_DIST_TABLE_SIZE", "256"));
+    SharedArea::init_size_multiplier();
+    this->MAX_SIZE *= SharedArea::sizeMultiplier;
+}
+
+void
+WritebackDistPredictor::train(hash_t key, Tick distance) {
+    if (this->table.find(key) == this->table.end()) {
+        /* Table is at capacity, evict the oldest key */
+        if (this->table.size() >= MAX_SIZE and not this->insertionOrder.empty()) {
+            this->table.erase(this->insertionOrder.front());
+            this->insertionOrder.pop_front();
+        }
+
+        WritebackDistEntry entry;
+        entry.avgDistance = distance;
+        this->table[key] = entry;
+        this->insertionOrder.push_back(key);
+        return;
+    }
+
+    WritebackDistEntry &entry = this->table.at(key);
+    Tick delta = distance > entry.avgDistance
+                    ? distance - entry.avgDistance
+                    : entry.avgDistance - distance;
+
+    if (delta * 100 <= entry.avgDistance * TOLERANCE_PERCENT) {
+        entry.conf.add(1);
+    } else {
+        entry.conf.sub(1);
+    }
+
+    /* Exponential moving average with a weight of 1/4 for the new sample */
+    entry.avgDistance = (3 * entry.avgDistance + distance)/4;
+}
+
+bool
+WritebackDistPredictor::predict(hash_t key, Tick &distance) const {
+    auto entry = this->table.find(key);
+    if (entry == this->table.end() or entry->second.conf() < CONF_THRESH) {
+        return false;
+    }
+
+    distance = entry->second.avgDistance;
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef SHIFTLAB_MEM_PREDICTOR_WRITEBACK_DIST_PREDICTOR_H__
+#define SHIFTLAB_MEM_PREDICTOR_WRITEBACK_DIST_PREDICTOR_H__
+
+#include "base/types.hh"
+#include "mem/predictor/Common.hh"
+#include "mem/predictor/Declarations.hh"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Predicts the distance (in ticks) between the last store to a cacheline and
+ * the clwb that writes it back. Entries are indexed either by the PC of the
+ * store or by the path hash at the time of the store, and hold a running
+ * average of the observed distances along with a confidence counter.
+ */
+class WritebackDistPredictor {
+public:
+    enum class KeyType {
+        PC,
+        PATH
+    };
+
+private:
+    typedef struct WritebackDistEntry {
+        Tick avgDistance = 0;
+        Confidence conf = Confidence(0, 3, 0);
+    } WritebackDistEntry;
+
+    std::unordered_map<hash_t, WritebackDistEntry> table;
+    std::deque<hash_t> insertionOrder;
+
+    size_t MAX_SIZE = 256;
+
+    /** Minimum confidence before a prediction is made */
+    static const uint32_t CONF_THRESH = 2;
+
+    /** Observed distance within this percentage of the average is a hit */
+    static const Tick TOLERANCE_PERCENT = 25;
+
+    KeyType keyType = KeyType::PC;
+
+public:
+    WritebackDistPredictor();
+
+    KeyType get_key_type() const { return this->keyType; }
+
+    /* Updates the entry for the key with the observed distance */
+    void train(hash_t key, Tick distance);
+
+    /**
+     * Returns true and sets the distance if a confident prediction exists
+     * for the key.
+     */
+    bool predict(hash_t key, Tick &distance) const;
+
+    size_t get_size() const { return this->table.size(); }
+};
+
+#endif // SHIFTLAB_MEM_PREDICTOR_WRITEBACK_DIST_PREDICTOR_H__
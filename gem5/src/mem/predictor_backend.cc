@@ -60,6 +60,7 @@
 #include "mem/predictor/Common.hh"
 #include "mem/predictor/Constants.hh"
 #include "mem/predictor/Declarations.hh"
+#include "mem/predictor/PredictionThrottle.hh"
 #include "mem/predictor/SharedArea.hh"
 #include "mem/predictor_backend.hh"
 #include "params/PredictorBackend.hh"
@@ -183,6 +184,23 @@ PredictorBackend::PredictorBackend(Params *p)
             .name(p->name + ".writebackDistStatMicro")
             .desc("writebackDistStat")
             .init(0, 1000, 1);
+        usefulPredictions
+            .name(parentName + ".usefulPredictions")
+            .desc("Predictions whose address was written while they were in the result buffer.");
+        harmfulPredictions
+            .name(parentName + ".harmfulPredictions")
+            .desc("Predictions evicted from the result buffer without their address being written.");
+        throttledPredictions
+            .name(parentName + ".throttledPredictions")
+            .desc("Predictions suppressed by the throttle before accessing the metadata caches.");
+        throttleProbes
+            .name(parentName + ".throttleProbes")
+            .desc("Low accuracy predictions issued anyway to re-evaluate their hash.");
+        throttleLevel
+            .name(parentName + ".throttleLevel")
+            .desc("Throttle level at the end of the simulation.");
+
+        PredictionThrottle::init();
 
         usePredictor = get_env_val("USE_PREDICTOR");
 
@@ -213,6 +231,7 @@ PredictorBackend::PredictorBackend(Params *p)
 
 PredictorBackend::~PredictorBackend() {
     this->resultBufferCapacityEvictions = PredictorBackend::capacityEvictionStatic;
+    this->updateThrottleStats();
 }
 
 Port &
@@ -281,6 +300,7 @@ PredictorBackend::PBSlavePort::recvTimingReq(PacketPtr pkt)
 
 
     pb.resultBufferCapacityEvictions = PredictorBackend::capacityEvictionStatic;
+    pb.updateThrottleStats();
     /* Handle the request in the predictor backend */
     pb.predictorHandleRequest(pkt);
 
@@ -573,18 +593,28 @@ PredictorBackend::addCompletedWrite(CompletedWriteEntry entry) {
         /* Cache hits for the meta data caches are set here while the actual access is done from the DRAMCtrl */
         Addr addr = entry.get_addr(), paddr = 0;
         EmulationPageTable::pageTableStaticObj->translate(addr, paddr);
+        /* Metadata for the address lives in the channel that owns it */
+        DRAMCtrl *bmoChannel = DRAMCtrl::getBMOChannel(paddr);
+        bool isCounterCacheHit = bmoChannel->isCounterCacheHit(paddr);
+        bool isVerificationCacheHit = bmoChannel->isVerificationCacheHit(paddr);
+
+        /* Low value predictions are dropped before they touch the metadata caches */
+        if (not PredictionThrottle::should_issue(entry.get_generator_hash())) {
+            PredictionThrottle::avoidedMetadataFills 
+                += !isCounterCacheHit + !isVerificationCacheHit;
+            return;
+        }
+
         PredictorBackend::addrMatches[paddr]++;
         // paddr = getCompWriteKey(entry.get_addr());
         // std::cout << "Trying to insert addresss = " << print_ptr(16) << paddr << std::endl;
         // std::cout << "Changing address from " << (void*)entry.get_addr() << " to " << (void*)paddr << std::endl;
         entry.set_addr(paddr);
-        bool isCounterCacheHit = DRAMCtrl::isCounterCacheHit(paddr);
         entry.set_counter_cache_hit(isCounterCacheHit);
-        bool isVerificationCacheHit = DRAMCtrl::isVerificationCacheHit(paddr);
         entry.set_verification_cache_hit(isVerificationCacheHit);
 
 
-        DRAMCtrl::pendingPredictionQueue.push_back(entry);
+        bmoChannel->pendingPredictionQueue.push_back(entry);
 
         // DPRINTFR(PredictorBackendLogic, "Inserting new prediction for address %p and cacheline %s\n", paddr, entry.get_cacheline().to_string());
 	completedWrites[paddr].push_back(entry);
@@ -602,6 +632,10 @@ PredictorBackend::addCompletedWrite(CompletedWriteEntry entry) {
 
             completedWrites[paddr].pop_front();
 
+            if (not entryToEvict.is_used() and not entryToEvict.was_addr_matched()) {
+                PredictionThrottle::record_harmful(entryToEvict.get_generator_hash());
+            }
+
             /* send feedback */
             PredictorBackend::broadcastPrediction(entryToEvict.get_generator_hash(), false, false);
             PredictorBackend::capacityEvictionStatic++;
@@ -683,6 +717,12 @@ PredictorBackend::addCompletedWrite(CompletedWriteEntry entry) {
 	    for (auto compWriteQ : PredictorBackend::completedWrites) {
 		uint64_t curIndex = 0;
 		for (auto write : compWriteQ.second) {
+		    /* Keep the entries whose writeback is predicted to come soon */
+		    if (write.has_predicted_writeback_tick()
+                    and write.get_predicted_writeback_tick() > curTick()) {
+                curIndex++;
+                continue;
+		    }
 
 		    if (25000000 < (curTick() - write.get_time_of_creation())
                     and write.get_cacheline().get_datachunks()[0].is_free_prediction()) {
@@ -708,6 +748,11 @@ PredictorBackend::addCompletedWrite(CompletedWriteEntry entry) {
 	if (oldestAddr != 0) {
 	    std::cout << "Removed entry at address " << (void*)oldestAddr
 		      << (curTick() - oldestTick) << std::endl;
+            for (auto write : PredictorBackend::completedWrites.at(oldestAddr)) {
+                if (not write.is_used() and not write.was_addr_matched()) {
+                    PredictionThrottle::record_harmful(write.get_generator_hash());
+                }
+            }
 	    PredictorBackend::completedWrites.erase(oldestAddr);
         PredictorBackend::capacityEvictionStatic++;
 	}
@@ -810,6 +855,15 @@ PredictorBackend::broadcastPrediction(hash_t hash, bool addrPredicted, bool data
     }
 }
 
+void 
+PredictorBackend::updateThrottleStats() {
+    this->usefulPredictions = PredictionThrottle::totalUseful;
+    this->harmfulPredictions = PredictionThrottle::totalHarmful;
+    this->throttledPredictions = PredictionThrottle::totalThrottled;
+    this->throttleProbes = PredictionThrottle::totalProbes;
+    this->throttleLevel = PredictionThrottle::level;
+}
+
 void 
 PredictorBackend::update_stats_for_const_pred(CompletedWriteEntry completedEntry) {
     for (int i = 0; i < DATA_CHUNK_COUNT; i++) {
@@ -1111,6 +1165,12 @@ PredictorBackend::handleNonVolatileWrite(PacketPtr pkt) {
             
             if (isPktEqualCompletedEntryAddr(pkt,  completedEntry) 
                     and not completedEntry.is_used()) {
+                /* The metadata read for this prediction served an actual write */
+                if (not completedWrite_iter->was_addr_matched()) {
+                    completedWrite_iter->mark_addr_matched();
+                    PredictionThrottle::record_useful(confKey);
+                }
+
                 avgDataMatchForAddrMatch += getMatchingChunkCount(pkt, completedEntry);
                 predStr << GRN "======= Predicted " RST << "\n";
                 // predStr << "For addr = " << (void*)pkt->req->getPaddr() << std::endl;
@@ -360,6 +360,13 @@ class PredictorBackend : public ClockedObject
     Stats::Distribution writebackDistStat;
     Stats::Distribution writebackDistStatMicro;
 
+    /* Feedback for the prediction throttle, see PredictionThrottle */
+    Stats::Scalar usefulPredictions;
+    Stats::Scalar harmfulPredictions;
+    Stats::Scalar throttledPredictions;
+    Stats::Scalar throttleProbes;
+    Stats::Scalar throttleLevel;
+
     std::ofstream hashStats;
 
     static size_t RESULT_BUFFER_MAX_SIZE;
@@ -410,10 +417,11 @@ class PredictorBackend : public ClockedObject
     static void initConf(hash_t hash);
     static bool predictorEnabled;
     void update_stats_for_const_pred(CompletedWriteEntry completedEntry);
+    void updateThrottleStats();
     static Addr getCompletedAddrToEvict();
     void invalidateAllAddr();
     static std::unordered_map<PC_t, int> addrMatches;
-    std::bitset<DATA_CHUNK_COUNT> dataChunkMatchVec(CompletedWriteEntry completedEntry, PacketPtr ptr);
+    static std::bitset<DATA_CHUNK_COUNT> dataChunkMatchVec(CompletedWriteEntry completedEntry, PacketPtr ptr);
     std::bitset<DATA_CHUNK_COUNT> dataChunkConstVec(CompletedWriteEntry completedEntry);
     
     void updateConstChunks(hash_t maxDataMatchHash, Addr_t addr, PacketPtr pkt);
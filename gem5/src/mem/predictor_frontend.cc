@@ -103,7 +103,10 @@ PredictorFrontend::PredictorFrontend(Params *p)
                  512*SharedArea::sizeMultiplier),
                 //!  1024*SharedArea::sizeMultiplier),
       predictorTable(p->name + ".pred_t"),
-      pendingTable(p->name + ".pend_t", &this->writeHistoryBuffer)
+      pendingTable(p->name + ".pend_t", &this->writeHistoryBuffer),
+      predictorBatchEvent([this]{ predictorHandleBatch(); },
+                          p->name + ".predictorBatchEvent", false,
+                          Event::CPU_Tick_Pri + 1)
 {
     bothAddrDataNotFound
         .name(p->name + ".bothAddrDataNotFound")
@@ -208,10 +211,33 @@ PredictorFrontend::PredictorFrontend(Params *p)
         .name(p->name + ".writebackDistStatMicro")
         .desc("writebackDistStat")
         .init(0, 1000, 1);
+    duplicatePredictorReqs
+        .name(p->name + ".duplicatePredictorReqs")
+        .desc("Duplicate deliveries of a request within a tick, ignored by the predictor");
+    predictorBatchSize
+        .name(p->name + ".predictorBatchSize")
+        .desc("Number of distinct requests handled by the predictor per tick")
+        .init(1, 16, 1);
     whbTimeLen
         .name(p->name + ".whbTimeLen")
         .desc("")
         .init(0,10,1000);
+    wbDistPredictions
+        .name(p->name + ".wbDistPredictions")
+        .desc("Stores with a confident writeback distance prediction");
+    wbDeadlineBeforeClwb
+        .name(p->name + ".wbDeadlineBeforeClwb")
+        .desc("Predicted writeback deadlines that expired before the clwb");
+    wbDeadlineAfterClwb
+        .name(p->name + ".wbDeadlineAfterClwb")
+        .desc("Predicted writeback deadlines that expired after the clwb");
+    wbDeadlineErrorKiloTicks
+        .name(p->name + ".wbDeadlineErrorKiloTicks")
+        .desc("Absolute error of the predicted writeback deadline in kilo ticks")
+        .init(0, 1000, 10);
+    earlyBMOTriggers
+        .name(p->name + ".earlyBMOTriggers")
+        .desc("Accumulator lines retired early due to the predicted writeback");
 
     char* envResult = std::getenv("ENABLE_VOLATILE_DUMP");
 
@@ -230,6 +256,9 @@ PredictorFrontend::PredictorFrontend(Params *p)
     disablePerPCConfidence = get_env_val("DISABLE_PER_PC_CONFIDENCE");
     disableFreePrediction = get_env_val("DISABLE_FREE_PREDICTION");
     disableFancyAddrPred = get_env_val("DISABLE_FANCY_ADDR_PRED");
+    enableWbDistPredictor = get_env_val("ENABLE_WB_DIST_PREDICTOR");
+    WB_DIST_LEAD_TICKS = get_env_ulong("WB_DIST_LEAD_TICKS", 100000);
+    std::cout << "Writeback distance predictor = " << enableWbDistPredictor << std::endl;
     std::cout << "Using cacheline accumulator size = " << CL_ACC_SIZE << std::endl;
     cacheLineAccumulatorSize += CL_ACC_SIZE;
 
@@ -345,15 +374,7 @@ PredictorFrontend::PFSlavePort::recvTimingReq(PacketPtr pkt)
     if (retryReq)
         return false;
 
-    /** For some reason recvTimingReq is called twice within the same tick value,
-     *  keeping track of the tick value prevents this.
-     */
-    if (curTick() != pf.lastPredictorTick) {
-        pf.predictorHandleRequest(pkt);
-        pf.lastPredictorTick = curTick();
-    }
 
-    
     DPRINTF(PredictorFrontendInterface, "Response queue size: %d outresp: %d\n",
             transmitList.size(), outstandingResponses);
 
@@ -384,6 +405,11 @@ PredictorFrontend::PFSlavePort::recvTimingReq(PacketPtr pkt)
         }
 
         if (!retryReq) {
+            /** Only accepted requests reach the predictor, a rejected request
+             *  is seen again when the master retries it.
+             */
+            pf.enqueuePredictorRequest(pkt);
+
             // technically the packet only reaches us after the header
             // delay, and typically we also need to deserialise any
             // payload (unless the two sides of the bridge are
@@ -674,7 +700,20 @@ PredictorFrontend::cachelineAccumulatorRetireTick() {
 
         for (std::pair<Addr_t, CacheLine> cacheline : this->cacheLineAccumulator) {
             Tick age = curTick() - cacheline.second.get_time_of_last_update();
-            if (age > ACC_ENTRY_RETIRE_THRESHOLD) {
+
+            /* Retire the line early if its clwb is predicted to arrive soon */
+            bool wbImminent = false;
+            auto wbTick = this->predictedWritebackTick.find(cacheline.first);
+            if (wbTick != this->predictedWritebackTick.end()
+                    and wbTick->second <= curTick() + WB_DIST_LEAD_TICKS) {
+                wbImminent = true;
+            }
+
+            if (age > ACC_ENTRY_RETIRE_THRESHOLD
+                    or (wbImminent and cacheline.second.is_dirty())) {
+                if (age <= ACC_ENTRY_RETIRE_THRESHOLD) {
+                    this->earlyBMOTriggers++;
+                }
                 retireQueue.push_back(cacheline.first);
                 Addr paddr;
                 EmulationPageTable::pageTableStaticObj->translate(cacheline.first, paddr);
@@ -714,6 +753,12 @@ PredictorFrontend::cachelineAccumulatorRetireTick() {
                 entriesToSend.back().set_time_of_data_gen(curTick());
                 entriesToSend.back().set_time_of_creation(curTick());
                 entriesToSend.back().set_orig_cacheline(cacheData);
+                if (this->predictedWritebackTick.find(addr) 
+                        != this->predictedWritebackTick.end()) {
+                    entriesToSend.back().set_predicted_writeback_tick(
+                        this->predictedWritebackTick.at(addr)
+                    );
+                }
 
                 // std::cout << "Retiring with cacheline: " << cacheData.to_string().c_str()  << std::endl;
 
@@ -1362,6 +1407,15 @@ PredictorFrontend::sendWritesToBackend(std::deque<PendingTableEntryParent*> &com
             curTick()
         );
 
+        /* Prioritize the entry in the result buffer if the line's writeback 
+           is expected */
+        auto wbTick = this->predictedWritebackTick.find(
+            cacheline_align(predictedWrite->addr.get_target_addr())
+        );
+        if (wbTick != this->predictedWritebackTick.end()) {
+            entryToInsert.set_predicted_writeback_tick(wbTick->second);
+        }
+
         this->handleConstPredictions(entryToInsert);
 
         this->predictedWriteCount++;   
@@ -1475,6 +1529,59 @@ PredictorFrontend::updatePendingTable(const PacketPtr pkt) {
     }
 
 
+hash_t
+PredictorFrontend::getWbDistKey(const PacketPtr pkt) {
+    if (wbDistPredictor.get_key_type() == WritebackDistPredictor::KeyType::PATH) {
+        return this->predictorTable.get_path_hash();
+    }
+    return hash_t(pkt->req->getPC());
+}
+
+void
+PredictorFrontend::handleWbDistStore(const PacketPtr pkt) {
+    if (not pkt->req->hasPC()) {
+        return;
+    }
+
+    const Addr_t cachelineAddr = cacheline_align(pkt->req->getVaddr());
+    const hash_t key = getWbDistKey(pkt);
+    this->wbDistKeyMap[cachelineAddr] = key;
+
+    Tick distance = 0;
+    if (this->wbDistPredictor.predict(key, distance)) {
+        this->wbDistPredictions++;
+        this->predictedWritebackTick[cachelineAddr] = curTick() + distance;
+    } else {
+        this->predictedWritebackTick.erase(cachelineAddr);
+    }
+}
+
+void
+PredictorFrontend::handleWbDistClwb(Addr_t cachelineAddr) {
+    auto key = this->wbDistKeyMap.find(cachelineAddr);
+    auto lastWrite = this->writebackDistMap.find(cachelineAddr);
+
+    /* clwb to a line without any tracked store */
+    if (key == this->wbDistKeyMap.end() or lastWrite == this->writebackDistMap.end()) {
+        return;
+    }
+
+    this->wbDistPredictor.train(key->second, curTick() - lastWrite->second);
+    this->wbDistKeyMap.erase(key);
+
+    auto wbTick = this->predictedWritebackTick.find(cachelineAddr);
+    if (wbTick != this->predictedWritebackTick.end()) {
+        if (wbTick->second <= curTick()) {
+            this->wbDeadlineBeforeClwb++;
+            this->wbDeadlineErrorKiloTicks.sample((curTick() - wbTick->second)/1000);
+        } else {
+            this->wbDeadlineAfterClwb++;
+            this->wbDeadlineErrorKiloTicks.sample((wbTick->second - curTick())/1000);
+        }
+        this->predictedWritebackTick.erase(wbTick);
+    }
+}
+
 void
 PredictorFrontend::handleWrite(const PacketPtr pkt) {
     Addr_t addr = pkt->req->getVaddr();
@@ -1497,8 +1604,16 @@ PredictorFrontend::handleWrite(const PacketPtr pkt) {
                 //     0//UINT64_MAX
                 // );
             }
+
+            if (enableWbDistPredictor) {
+                handleWbDistClwb(cacheline_align(addr));
+            }
         } else {
             writebackDistMap[cacheline_align(addr)] = curTick();
+
+            if (enableWbDistPredictor) {
+                handleWbDistStore(pkt);
+            }
         }
     }
     
@@ -1676,6 +1791,47 @@ PredictorFrontend::dumpTrace(PacketPtr pkt) {
     }
 }
 
+void
+PredictorFrontend::enqueuePredictorRequest(const PacketPtr pkt) {
+    if (curTick() != this->predictorBatchTick) {
+        panic_if_not(this->predictorBatch.empty());
+        this->predictorBatchReqs.clear();
+        this->predictorBatchTick = curTick();
+    }
+
+    /* The same request delivered again within the tick */
+    if (not this->predictorBatchReqs.insert(pkt->req).second) {
+        this->duplicatePredictorReqs++;
+        return;
+    }
+
+    /* The packet is handed to the cache right after this call, which may
+     * respond to it or delete it before the batch runs, so the predictor
+     * works on a copy that owns its payload. */
+    PacketPtr snapshot = new Packet(pkt, false, false);
+    snapshot->senderState = nullptr;
+    if (pkt->hasData()) {
+        snapshot->allocate();
+        snapshot->setData(pkt->getConstPtr<uint8_t>());
+    }
+    this->predictorBatch.emplace_back(snapshot);
+
+    if (not this->predictorBatchEvent.scheduled()) {
+        schedule(this->predictorBatchEvent, curTick());
+    }
+}
+
+void
+PredictorFrontend::predictorHandleBatch() {
+    this->predictorBatchSize.sample(this->predictorBatch.size());
+
+    for (auto &pkt : this->predictorBatch) {
+        this->predictorHandleRequest(pkt.get());
+    }
+
+    this->predictorBatch.clear();
+}
+
 void
 PredictorFrontend::predictorHandleRequest(const PacketPtr pkt) {
     this->dumpTrace(pkt);
@@ -52,6 +52,9 @@
 #define SHIFTLAB_PREDICTOR_FRONTEND_H__
 
 #include <deque>
+#include <memory>
+#include <unordered_set>
+#include <vector>
 
 #include "base/types.hh"
 #include "mem/port.hh"
@@ -80,6 +83,7 @@
 #include "predictor/WriteHistoryBuffer.hh"
 #include "predictor/PendingTable.hh"
 #include "predictor/PredictorTable.hh"
+#include "predictor/WritebackDistPredictor.hh"
 #include "sim/sim_object.hh"
 
 #include <fstream>
@@ -101,7 +105,6 @@
 class PredictorFrontend : public ClockedObject
 {
   private:
-    Tick lastPredictorTick = 0;
     size_t CL_ACC_SIZE = 4;
     // Tick ACC_RETIRE_TICK_PERIOD = 100*1000; // 100 ns
     Tick ACC_RETIRE_TICK_PERIOD = 10*1000; // 100 ns
@@ -109,6 +112,13 @@ class PredictorFrontend : public ClockedObject
     Tick ACC_ENTRY_RETIRE_THRESHOLD = 500*1000; // 1000 ns
     bool disableFreePrediction = false;
     AddrPredictor addrPredictor;
+
+    /* Predicts the store to clwb distance, ENABLE_WB_DIST_PREDICTOR */
+    bool enableWbDistPredictor = false;
+    WritebackDistPredictor wbDistPredictor;
+
+    /** Lines are retired this many ticks before their predicted clwb */
+    Tick WB_DIST_LEAD_TICKS = 100*1000; // 100 ns
   public:
     std::ofstream myFile;
   protected:
@@ -416,6 +426,11 @@ class PredictorFrontend : public ClockedObject
     Stats::Distribution whbTimeLen;
     Stats::Distribution writebackDistStat;
     Stats::Distribution writebackDistStatMicro;
+    Stats::Scalar wbDistPredictions;
+    Stats::Scalar wbDeadlineBeforeClwb;
+    Stats::Scalar wbDeadlineAfterClwb;
+    Stats::Distribution wbDeadlineErrorKiloTicks;
+    Stats::Scalar earlyBMOTriggers;
 
     std::ofstream genHash;
   public:
@@ -433,6 +448,18 @@ class PredictorFrontend : public ClockedObject
     PredictorFrontend(Params *p);
     
     void predictorHandleRequest(PacketPtr pkt);
+
+    /**
+     * Queues the packet for the predictor, packets are processed in a single 
+     * batch at the end of the tick. Duplicate deliveries of the same request
+     * within the tick are dropped.
+    */
+    void enqueuePredictorRequest(PacketPtr pkt);
+
+    /**
+     * Processes all the distinct requests received in the current tick
+    */
+    void predictorHandleBatch();
     void refreshPredictorTable(PacketPtr pkt);
 
     /**
@@ -485,12 +512,43 @@ class PredictorFrontend : public ClockedObject
     /* For finding write to writeback distance */
     std::unordered_map<Addr_t, Tick> writebackDistMap;
 
+    /* Writeback distance predictor key of the last store to each line */
+    std::unordered_map<Addr_t, hash_t> wbDistKeyMap;
+
+    /* Predicted tick of the clwb for each line with a confident prediction */
+    std::unordered_map<Addr_t, Tick> predictedWritebackTick;
+
+    /* Key used for the writeback distance predictor for the store */
+    hash_t getWbDistKey(PacketPtr pkt);
+
+    /* Trains the writeback distance predictor and samples the deadline error */
+    void handleWbDistClwb(Addr_t cachelineAddr);
+
+    /* Records the key for the store and predicts the line's writeback tick */
+    void handleWbDistStore(PacketPtr pkt);
+
     /**
      * Marks the indices in the write history buffer as used
      * @param Indices: Unordered Map with keys representing write history buffer
      *                 indices to be marked as used
     */
     void markIHBEntriesAsUsed(std::unordered_map<size_t, bool> indices);
+
+  private:
+    /* Copies of the requests received in the current tick, in arrival
+     * order, the forwarded packets are not ours to keep */
+    std::vector<std::unique_ptr<Packet>> predictorBatch;
+
+    /* Requests already queued in the current tick, held until the tick
+     * changes so that a finished request cannot be recycled meanwhile */
+    std::unordered_set<RequestPtr> predictorBatchReqs;
+    Tick predictorBatchTick = MaxTick;
+
+    /* Runs after the CPUs have issued all the stores for the tick */
+    EventFunctionWrapper predictorBatchEvent;
+
+    Stats::Scalar duplicatePredictorReqs;
+    Stats::Distribution predictorBatchSize;
 };
 
 
@@ -63,6 +63,7 @@
 #include "config/the_isa.hh"
 #include "cpu/thread_context.hh"
 #include "mem/page_table.hh"
+#include "mem/predictor/PMRegionRegistry.hh"
 #include "mem/se_translating_port_proxy.hh"
 #include "params/Process.hh"
 #include "sim/emul_driver.hh"
@@ -327,6 +328,7 @@ Addr Process::allocatePersistentMem(Addr vaddr, int64_t size, bool clobber)
     Addr paddr = system->allocPersistentPages(npages);
     //Addr paddr = system->allocPhysPages(npages);
     pTable->map(vaddr, paddr, size, clobber ? (uint32_t)EmulationPageTable::Clobber : 0);
+    PMRegionRegistry::add_region(vaddr, paddr, npages * PageBytes);
    
     if (vaddr > 0x10000000000UL and vaddr < 2* 0x10000000000UL) {
         std::cout << __func__ << ": Allocated persistent memory, start = " << vaddr << std::endl;
@@ -22,6 +22,10 @@
 
 #define BLOCK_READ_LATENCY (100000UL)
 
+// Granularity of the incremental (Merkle style) data hash, used to credit
+// partially predicted cachelines
+#define BMO_SUB_BLOCK_SIZE (16UL)
+
 //#define DUP_RATE 50
 
 #ifdef COMPRESSION
@@ -2,51 +2,71 @@
 #include "stdio.h"
 #include <libpmem.h>
 #include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
 #include <stdio.h>
+#include <atomic>
 
 #define PMEMFILE "/mnt/ramdisk/tatp"
 
 void *pmem_base_addr = NULL;
 
-void *pmalloc(size_t length)
+/* Overridden by JANUS_PMEM_FILE, e.g. for native runs on a tmpfs */
+static const char *pool_path(void)
+{
+	const char *path = getenv("JANUS_PMEM_FILE");
+	return path != NULL ? path : PMEMFILE;
+}
+
+static pthread_once_t pmalloc_once = PTHREAD_ONCE_INIT;
+static std::atomic<size_t> pool_size(0);
+
+/* Maps the pool file and formats it for the arena allocator */
+static void map_and_format_pool(void)
 {
+	size_t size = pool_size.load();
+	pmem_base_addr = pmem_map_file(pool_path(), size, PMEM_FILE_CREATE, 0x666, 0, 0);
 	if (pmem_base_addr == NULL)
 	{
-		size_t filesize = length * 2;
-		pmem_base_addr = pmem_map_file(PMEMFILE, filesize, PMEM_FILE_CREATE, 0x666, 0, 0);
-		if (pmem_base_addr == NULL)
-		{
-			fprintf(stderr, "[%s] Error %s, %lu", __func__, PMEMFILE, filesize);
-			perror("pmem_map_file");
-		}
-		assert(pmem_base_addr != nullptr);
+		fprintf(stderr, "[%s] Error %s, %lu", __func__, pool_path(), size);
+		perror("pmem_map_file");
 	}
-	void *toRet = pmem_base_addr;
-	pmem_base_addr = ((char *)pmem_base_addr) + length;
-	return toRet;
+	assert(pmem_base_addr != nullptr);
+
+	int ret = pma_create(pmem_base_addr, size);
+	assert(ret == 0);
 }
 
-void cache_flush(void *addr, size_t size)
+/* Safe to call from any number of threads, the first caller picks the size */
+static void map_pool(size_t size)
 {
-#if PMEM_NO_FLUSH == 0
-	uint64_t startAddr = (((uint64_t)addr) >> 6) * 64UL;
-	uint64_t endAddr = (((uint64_t)addr + (uint64_t)size + 63UL) >> 6) * 64UL;
+	size_t unset = 0;
+	pool_size.compare_exchange_strong(unset, size);
+	pthread_once(&pmalloc_once, map_and_format_pool);
+}
 
-	for (uint64_t curAddr = startAddr; curAddr < endAddr; curAddr += 64UL)
-	{
-		_mm_clwb((void *)curAddr);
-	}
-#endif
+void *pmalloc(size_t length)
+{
+	map_pool(PMA_POOL_SIZE(length * 2, 1));
+	return pma_alloc(length);
+}
+
+void pfree(void *ptr)
+{
+	pma_free(ptr);
+}
+
+void cache_flush(void *addr, size_t size)
+{
+	flush_range(addr, size);
 }
 
 void flush_caches(void *addr, size_t size)
 {
-#if PMEM_NO_FLUSH == 0
 	cache_flush(addr, size);
-#endif
 }
 
 void s_fence(void)
 {
-	_mm_sfence();
+	flush_fence();
 }
@@ -13,7 +13,8 @@ typedef struct
   short byte2_1, byte2_2, byte2_3, byte2_4, byte2_5, byte2_6, byte2_7, byte2_8, byte2_9, byte2_10; // randomly generated values 0->255
   unsigned msc_location;                                                                           // Randomly generated value 1->((2^32)-1)
   unsigned vlr_location;                                                                           // Randomly generated value 1->((2^32)-1)
-  char padding[40];
+  unsigned version;                                                                                // Even when idle, odd while a writer updates the entry
+  char padding[36];
 } subscriber_entry;
 
 typedef struct
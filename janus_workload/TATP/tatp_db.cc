@@ -9,8 +9,14 @@ This file defines the various transactions in TATP.
 #include <cstdlib> // For rand
 #include <iostream>
 #include <pthread.h>
+#include <sched.h>
+#include <cstring>
 #include "../common/common.h"
 #define NUM_RNDM_SEEDS 1280
+// One line of seeds per thread, so threads do not share seed lines
+#define SEED_STRIDE 8
+
+static const char *lock_mode_names[] = {"subscriber", "striped", "optimistic"};
 
 pthread_mutex_t print_lock;
 
@@ -35,7 +41,12 @@ void TATP_DB::initialize(unsigned num_subscribers, int nthreads)
 	size_t backupsz = nthreads * sizeof(subscriber_entry);
 	size_t validsz = nthreads * sizeof(VALID_BIT_TYPE);
 
-	size_t total_alloc_size = stsz + aitsz + sftsz + cftsz + backupsz + validsz;
+	size_t logsz = 0;
+#ifdef _ENABLE_LOG_ENGINE
+	logsz = nthreads * engine_log_t::area_size();
+#endif
+
+	size_t total_alloc_size = stsz + aitsz + sftsz + cftsz + backupsz + validsz + logsz;
 
 #ifdef _ENABLE_LIBPMEMOBJ
 	pmem::obj::transaction::run(pool, [&]
@@ -68,18 +79,61 @@ void TATP_DB::initialize(unsigned num_subscribers, int nthreads)
 
 	backup = (subscriber_entry *)((size_t)pool + stsz + aitsz + sftsz + cftsz);
 	valid = (VALID_BIT_TYPE *)((size_t)pool + stsz + aitsz + sftsz + cftsz + backupsz);
+
+#ifdef _ENABLE_LOG_ENGINE
+	tx_logs = new engine_log_t[nthreads];
+	for (int i = 0; i < nthreads; i++)
+	{
+		tx_logs[i].init((void *)((size_t)pool + stsz + aitsz + sftsz + cftsz + backupsz + validsz + i * engine_log_t::area_size()));
+	}
 #endif
-	lock_ = (pthread_mutex_t *)malloc(num_subscribers * sizeof(pthread_mutex_t));
+#endif
+	lock_mode = TATP_LOCK_SUBSCRIBER;
+	lock_ = NULL;
+	stripes = NULL;
+	char *mode = getenv("TATP_LOCK_MODE");
+	if (mode != NULL)
+	{
+		for (int i = TATP_LOCK_SUBSCRIBER; i <= TATP_LOCK_OPTIMISTIC; i++)
+		{
+			if (strcmp(mode, lock_mode_names[i]) == 0)
+			{
+				lock_mode = (tatp_lock_mode)i;
+			}
+		}
+	}
 
 	pthread_mutex_init(&print_lock, NULL);
-	for (int i = 0; i < num_subscribers; i++)
+	if (lock_mode == TATP_LOCK_SUBSCRIBER)
 	{
-		pthread_mutex_init(&lock_[i], NULL);
+		lock_ = (pthread_mutex_t *)malloc(num_subscribers * sizeof(pthread_mutex_t));
+		for (int i = 0; i < num_subscribers; i++)
+		{
+			pthread_mutex_init(&lock_[i], NULL);
+		}
 	}
+	else if (lock_mode == TATP_LOCK_STRIPED)
+	{
+		// Rounded up to a power of two so the stripe is a mask of the id
+		unsigned long nstripes = 1;
+		char *env = getenv("TATP_LOCK_STRIPES");
+		unsigned long requested = env != NULL ? strtoul(env, NULL, 10) : TATP_DEFAULT_LOCK_STRIPES;
+		while (nstripes < requested)
+		{
+			nstripes <<= 1;
+		}
+		stripe_mask = nstripes - 1;
+		stripes = (stripe_lock *)aligned_alloc(sizeof(stripe_lock), nstripes * sizeof(stripe_lock));
+		for (unsigned long i = 0; i < nstripes; i++)
+		{
+			pthread_mutex_init(&stripes[i].mutex, NULL);
+		}
+	}
+	std::cout << "[initialize] lock mode: " << lock_mode_name() << std::endl;
 
-	subscriber_rndm_seeds = (unsigned long *)malloc(NUM_RNDM_SEEDS * sizeof(unsigned long));
-	vlr_rndm_seeds = (unsigned long *)malloc(NUM_RNDM_SEEDS * sizeof(unsigned long));
-	rndm_seeds = (unsigned long *)malloc(NUM_RNDM_SEEDS * sizeof(unsigned long));
+	subscriber_rndm_seeds = (unsigned long *)aligned_alloc(64, NUM_RNDM_SEEDS * sizeof(unsigned long));
+	vlr_rndm_seeds = (unsigned long *)aligned_alloc(64, NUM_RNDM_SEEDS * sizeof(unsigned long));
+	rndm_seeds = (unsigned long *)aligned_alloc(64, NUM_RNDM_SEEDS * sizeof(unsigned long));
 	for (int i = 0; i < NUM_RNDM_SEEDS; i++)
 	{
 		subscriber_rndm_seeds[i] = getRand() % (NUM_RNDM_SEEDS * 10) + 1;
@@ -92,6 +146,7 @@ void TATP_DB::initialize(unsigned num_subscribers, int nthreads)
 TATP_DB::~TATP_DB()
 {
 	free(lock_);
+	free(stripes);
 	free(subscriber_rndm_seeds);
 	free(vlr_rndm_seeds);
 	free(rndm_seeds);
@@ -164,6 +219,7 @@ void TATP_DB::populate_tables(unsigned from, unsigned to)
 void TATP_DB::fill_subscriber_entry(unsigned _s_id)
 {
 	subscriber_table[_s_id].s_id = _s_id;
+	subscriber_table[_s_id].version = 0;
 	convert_to_string(_s_id, 15, subscriber_table[_s_id].sub_nbr);
 
 	subscriber_table[_s_id].bit_1 = (short)(getRand() % 2);
@@ -312,8 +368,7 @@ void TATP_DB::update_subscriber_data(int thread_id)
 
 void TATP_DB::backup_location(int thread_id, long subId)
 {
-	memcpy(&backup[thread_id], &subscriber_table[subId], sizeof(subscriber_entry));
-	flush_caches(&backup[thread_id], sizeof(subscriber_entry));
+	flush_memcpy(&backup[thread_id], &subscriber_table[subId], sizeof(subscriber_entry));
 	s_fence();
 
 	/* Set the valid bit to 1 */
@@ -331,16 +386,24 @@ void TATP_DB::discard_backup(int thread_id, long subId)
 	s_fence();
 }
 
-void TATP_DB::update_location(long subId, uint64_t vlr)
+void TATP_DB::update_location(int thread_id, long subId, uint64_t vlr)
 {
 #ifdef _ENABLE_LIBPMEMOBJ
 	pmem::obj::transaction::snapshot(&subscriber_table[subId].vlr_location);
 #endif
 
+#ifdef _ENABLE_LOG_ENGINE
+	// Logged and applied at the commit fence
+	unsigned vlr_location = vlr;
+	tx_logs[thread_id].write(&subscriber_table[subId].vlr_location, vlr_location);
+	tx_logs[thread_id].commit();
+#else
 	subscriber_table[subId].vlr_location = vlr;
+#endif
 
 #ifdef _ENABLE_LIBPMEMOBJ
 #elif _ENABLE_VOLATILE
+#elif _ENABLE_LOG_ENGINE
 #else
 	flush_caches(&subscriber_table[subId], sizeof(subscriber_table[subId]));
 	s_fence();
@@ -349,6 +412,61 @@ void TATP_DB::update_location(long subId, uint64_t vlr)
 	return;
 }
 
+void TATP_DB::lock_subscriber(long subId)
+{
+	switch (lock_mode)
+	{
+	case TATP_LOCK_SUBSCRIBER:
+		pthread_mutex_lock(&lock_[subId]);
+		break;
+	case TATP_LOCK_STRIPED:
+		pthread_mutex_lock(&stripes[subId & stripe_mask].mutex);
+		break;
+	case TATP_LOCK_OPTIMISTIC:
+	{
+		// Take the entry by moving its version from even to odd, the
+		// version shares the line with vlr_location so no other line moves
+		unsigned *version = &subscriber_table[subId].version;
+		for (int spins = 1;; spins++)
+		{
+			unsigned v = __atomic_load_n(version, __ATOMIC_RELAXED);
+			if ((v & 1) == 0 && __atomic_compare_exchange_n(version, &v, v + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+			// The writer may be descheduled when threads outnumber cores
+			if (spins % 64 == 0)
+			{
+				sched_yield();
+			}
+			_mm_pause();
+		}
+		break;
+	}
+	}
+}
+
+void TATP_DB::unlock_subscriber(long subId)
+{
+	switch (lock_mode)
+	{
+	case TATP_LOCK_SUBSCRIBER:
+		pthread_mutex_unlock(&lock_[subId]);
+		break;
+	case TATP_LOCK_STRIPED:
+		pthread_mutex_unlock(&stripes[subId & stripe_mask].mutex);
+		break;
+	case TATP_LOCK_OPTIMISTIC:
+		__atomic_fetch_add(&subscriber_table[subId].version, 1, __ATOMIC_RELEASE);
+		break;
+	}
+}
+
+const char *TATP_DB::lock_mode_name()
+{
+	return lock_mode_names[lock_mode];
+}
+
 void TATP_DB::insert_call_forwarding(int thread_id)
 {
 	return;
@@ -375,7 +493,7 @@ unsigned long TATP_DB::get_random(int thread_id)
 {
 	// return (getRand()%65536 | min + getRand()%(max - min + 1)) % (max - min + 1) + min;
 	unsigned long tmp;
-	tmp = rndm_seeds[thread_id * 10] = (rndm_seeds[thread_id * 10] * 16807) % 2147483647;
+	tmp = rndm_seeds[thread_id * SEED_STRIDE] = (rndm_seeds[thread_id * SEED_STRIDE] * 16807) % 2147483647;
 	return tmp;
 }
 
@@ -383,21 +501,21 @@ unsigned long TATP_DB::get_random(int thread_id, int min, int max)
 {
 	// return (getRand()%65536 | min + getRand()%(max - min + 1)) % (max - min + 1) + min;
 	unsigned long tmp;
-	tmp = rndm_seeds[thread_id * 10] = (rndm_seeds[thread_id * 10] * 16807) % 2147483647;
+	tmp = rndm_seeds[thread_id * SEED_STRIDE] = (rndm_seeds[thread_id * SEED_STRIDE] * 16807) % 2147483647;
 	return (min + tmp % (max - min + 1));
 }
 
 unsigned long TATP_DB::get_random_s_id(int thread_id)
 {
-	// unsigned long tmp;
-	// printf("tmp=%d total_subscriber=%ld resulting in = %lu", tmp, total_subscribers, tmp % total_subscribers);
-	int tmp = rand();
+	// rand() serializes the threads on the glibc lock, use the per-thread seed
+	unsigned long tmp;
+	tmp = subscriber_rndm_seeds[thread_id * SEED_STRIDE] = (subscriber_rndm_seeds[thread_id * SEED_STRIDE] * 16807) % 2147483647;
 	return (tmp) % (total_subscribers);
 }
 
 unsigned long TATP_DB::get_random_vlr(int thread_id)
 {
 	unsigned long tmp;
-	tmp = vlr_rndm_seeds[thread_id * 10] = (vlr_rndm_seeds[thread_id * 10] * 16807) % 2147483647;
+	tmp = vlr_rndm_seeds[thread_id * SEED_STRIDE] = (vlr_rndm_seeds[thread_id * SEED_STRIDE] * 16807) % 2147483647;
 	return (1 + tmp % (1LL << 32));
 }
@@ -17,6 +17,21 @@ the database.
 typedef uint64_t VALID_BIT_TYPE;
 #define LOAD_THREADS 1
 
+// Locking of update_location, selected with TATP_LOCK_MODE
+enum tatp_lock_mode
+{
+	TATP_LOCK_SUBSCRIBER = 0, // One mutex per subscriber
+	TATP_LOCK_STRIPED,		  // Subscribers hashed over TATP_LOCK_STRIPES padded mutexes
+	TATP_LOCK_OPTIMISTIC,	  // Versioned write on the subscriber entry, no lock array
+};
+
+#define TATP_DEFAULT_LOCK_STRIPES 1024
+
+struct alignas(64) stripe_lock
+{
+	pthread_mutex_t mutex;
+};
+
 class TATP_DB;
 
 #ifdef _ENABLE_LIBPMEMOBJ
@@ -33,6 +48,17 @@ extern pmem::obj::persistent_ptr<TATP_DB> table;
 #define PMDK_POOL_SIZE (1UL << 32)
 #endif
 
+// Redo and undo+redo logging share the log engine
+#if defined(_ENABLE_REDO_LOGGING) || defined(_ENABLE_HYBRID_LOGGING)
+#define _ENABLE_LOG_ENGINE 1
+#include "../common/log_engine.h"
+#ifdef _ENABLE_REDO_LOGGING
+typedef tx_log<LOG_REDO> engine_log_t;
+#else
+typedef tx_log<LOG_HYBRID> engine_log_t;
+#endif
+#endif
+
 class TATP_DB
 {
 
@@ -52,6 +78,10 @@ private:
 	unsigned long *vlr_rndm_seeds;
 	unsigned long *rndm_seeds;
 
+	tatp_lock_mode lock_mode;
+	unsigned long stripe_mask;
+	stripe_lock *stripes;
+
 public:
 #ifdef _ENABLE_LIBPMEMOBJ
 	pmem::obj::persistent_ptr<subscriber_entry[]> subscriber_table;
@@ -61,7 +91,10 @@ public:
 	subscriber_entry *backup;
 #endif
 	VALID_BIT_TYPE *valid;
-	pthread_mutex_t *lock_;			   // Lock per subscriber to protect the update
+#ifdef _ENABLE_LOG_ENGINE
+	engine_log_t *tx_logs; // Per-thread redo or undo+redo log
+#endif
+	pthread_mutex_t *lock_;			   // Lock per subscriber to protect the update, TATP_LOCK_SUBSCRIBER only
 	TATP_DB(unsigned num_subscribers); // Constructs and sizes tables as per num_subscribers
 	~TATP_DB();
 
@@ -87,7 +120,11 @@ public:
 	void backup_location(int thread_id, long subId);
 	void discard_backup(int thread_id, long subId);
 	// Tx: updates location for a random subscriber
-	void update_location(long subId, uint64_t vlr);
+	void update_location(int thread_id, long subId, uint64_t vlr);
+	// Serializes the updates of a subscriber according to the lock mode
+	void lock_subscriber(long subId);
+	void unlock_subscriber(long subId);
+	const char *lock_mode_name();
 	// Tx: Inserts into call forwarding table for a random user
 	void insert_call_forwarding(int thread_id);
 	// Tx: Deletes call forwarding for a random user
@@ -25,6 +25,9 @@ This file is the TATP benchmark, performs various transactions as per the specif
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#ifdef PMBENCH
+#include "../m5ops.h"
+#endif
 #include <libpmemobj++/make_persistent.hpp>
 #include <libpmemobj++/p.hpp>
 #include <libpmemobj++/persistent_ptr.hpp>
@@ -86,6 +89,8 @@ void init_db(uint64_t num_subscribers, uint64_t nthreads)
 uint64_t update_locations(uint64_t nops, uint64_t id)
 {
 	uint64_t ops = 0;
+	// Thread ids start at 1, per-thread backup and log slots at 0
+	uint64_t tid = id - 1;
 	fprintf(stdout, "Running received.\n");
 	while (!stop)
 	{
@@ -93,19 +98,22 @@ uint64_t update_locations(uint64_t nops, uint64_t id)
 		long subId = my_tatp_db->get_random_s_id(id);
 		uint64_t vlr = my_tatp_db->get_random_vlr(id);
 
-		pthread_mutex_lock(&my_tatp_db->lock_[subId]);
+#ifdef PMBENCH
+		/* One region per transaction, as the TPCC markers */
+		m5_work_begin(0, tid);
+#endif
+		my_tatp_db->lock_subscriber(subId);
 
 #ifdef _ENABLE_LOGGING
 		// Backup memory is within thread local.
 		// But don't allow other thread to change it to avoid stale backup.
 		// my_tatp_db->backup_location(id, subId);
-		memcpy(&my_tatp_db->backup[id], &my_tatp_db->subscriber_table[subId], sizeof(subscriber_entry));
-		flush_caches(&my_tatp_db->backup[id], sizeof(subscriber_entry));
+		flush_memcpy(&my_tatp_db->backup[tid], &my_tatp_db->subscriber_table[subId], sizeof(subscriber_entry));
 		s_fence();
 
 		/* Set the valid bit to 1 */
-		my_tatp_db->valid[id] = 1;
-		flush_caches(&my_tatp_db->valid[id], sizeof(VALID_BIT_TYPE));
+		my_tatp_db->valid[tid] = 1;
+		flush_caches(&my_tatp_db->valid[tid], sizeof(VALID_BIT_TYPE));
 		s_fence();
 #endif
 
@@ -113,7 +121,7 @@ uint64_t update_locations(uint64_t nops, uint64_t id)
 		try
 		{
 			pmem::obj::transaction::run(pool, [&]
-										{ table->update_location(subId, vlr); });
+										{ table->update_location(tid, subId, vlr); });
 		}
 		catch (const std::runtime_error &e)
 		{
@@ -128,18 +136,21 @@ uint64_t update_locations(uint64_t nops, uint64_t id)
 			return 1;
 		}
 #else
-		my_tatp_db->update_location(subId, vlr);
+		my_tatp_db->update_location(tid, subId, vlr);
 #endif
 
-		pthread_mutex_unlock(&my_tatp_db->lock_[subId]);
+		my_tatp_db->unlock_subscriber(subId);
 
 #ifdef _ENABLE_LOGGING
 		// Backup memory is within thread local.
 		// Don't have to be inside the critial section.
 		// my_tatp_db->discard_backup(id, subId);
-		my_tatp_db->valid[id] = 0;
-		flush_caches(&my_tatp_db->valid[id], sizeof(VALID_BIT_TYPE));
+		my_tatp_db->valid[tid] = 0;
+		flush_caches(&my_tatp_db->valid[tid], sizeof(VALID_BIT_TYPE));
 		s_fence();
+#endif
+#ifdef PMBENCH
+		m5_work_end(0, tid);
 #endif
 		ops++;
 	}
@@ -246,7 +257,8 @@ static inline void set_cpu(int cpu)
 	int n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
 	if (cpu < n_cpus)
 	{
-		int cpu_use = cores[cpu];
+		// Past the mapped cores, threads are pinned in order
+		int cpu_use = cpu < (int)sizeof(cores) ? cores[cpu] : cpu;
 		cpu_set_t mask;
 		CPU_ZERO(&mask);
 		CPU_SET(cpu_use, &mask);
@@ -0,0 +1,35 @@
+#!/bin/bash
+# Thread scaling of update_location for each lock mode, native runs.
+# Results are appended to tatp_scale.csv.
+
+domain=(adr eadr)
+binary=(volt undo)
+lock_modes=(subscriber striped optimistic)
+repeats=3
+nsubscriber=1000000
+duration=10
+nthreads=(1 2 4 8 16 32)
+
+if [[ ! -s tatp_scale.csv ]]; then
+	echo "lock_mode,binary,nsubscriber,total_ops,nthread,duration,throughput,mtput" >tatp_scale.csv
+fi
+
+for nthread in "${nthreads[@]}"; do
+	for i in $(seq $repeats); do
+		for d in "${domain[@]}"; do
+			for b in "${binary[@]}"; do
+				for m in "${lock_modes[@]}"; do
+					sudo rm -f /mnt/ramdisk/*
+					if [[ $d == "eadr" ]]; then
+						flush=1
+					else
+						flush=0
+					fi
+					# NSUBSCRIBER NOPS NTHREADS DURATION
+					result=$(sudo PMEM_NO_FLUSH=$flush TATP_LOCK_MODE="$m" ./tatp."$d"."$b" $nsubscriber 0 "$nthread" $duration | grep "^./tatp" | tail -n 1)
+					echo "$m,$result" | tee -a tatp_scale.csv
+				done
+			done
+		done
+	done
+done
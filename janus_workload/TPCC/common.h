@@ -3,6 +3,8 @@
 #include <x86intrin.h>
 #include <immintrin.h>
 #include <stdint.h>
+#include "../common/flush.h"
+#include "../common/pm_arena.h"
 
 #include <sys/mman.h>
 #include <sys/syscall.h>
@@ -22,6 +24,7 @@ extern "C"
 
 	void *mmap_persistent(void *start, size_t length, int prot, int flags, int fd, off_t offset);
 	void *pmalloc(size_t length);
+	void pfree(void *ptr);
 	void *aligned_malloc(size_t alignment, size_t size);
 
 	void cache_flush(void *addr, size_t size);
@@ -11,12 +11,24 @@ This file defines the various functions of the tpcc database
 #include <queue>
 #include <cstring>	 // For memcpy
 #include <algorithm> // for sort
+#include <cassert>
+#include <cstdio>
 #include "tpcc_db.h"
 #include "common.h"
 //#define NEW_ORDER_LOCK 10;
 #define TPCC_DEBUG 0
 #define NUM_RNDM_SEEDS 1280
 
+static inline int order_indx(int w_id, int d_id, int o_id)
+{
+	return (w_id - 1) * N_DISTRICT_PER_WAREHOUSE * N_ORDER_PER_DISTRICT + (d_id - 1) * N_ORDER_PER_DISTRICT + (o_id - 1) % N_ORDER_PER_DISTRICT;
+}
+
+static inline int order_line_indx(int w_id, int d_id, int o_id, int ol_num)
+{
+	return order_indx(w_id, d_id, o_id) * N_ORDER_LINE_PER_ORDER + ol_num;
+}
+
 TPCC_DB::TPCC_DB(uint64_t nwarehouse, uint64_t nitems) : num_warehouses(nwarehouse), num_items(nitems)
 {
 	// std::cout << "Entering " << __FUNCTION__ << std::endl;
@@ -55,6 +67,9 @@ void TPCC_DB::initialize(uint64_t nthreads, uint64_t nwarehouse, uint64_t nitems
 	{
 		total_mem += (sizeof(struct backUpLog));
 	}
+#ifdef _ENABLE_LOG_ENGINE
+	total_mem += (nthreads * engine_log_t::area_size());
+#endif
 	std::cout << "Total Allocated Memory: " << total_mem / (1UL << 20) << " MB \n";
 #ifdef _ENABLE_LIBPMEMOBJ
 	pmem::obj::transaction::run(pool, [&]
@@ -107,7 +122,16 @@ void TPCC_DB::initialize(uint64_t nthreads, uint64_t nwarehouse, uint64_t nitems
 	for (uint64_t i = 0; i < nthreads; i++)
 	{
 		backUpInst[i] = (struct backUpLog *)pmalloc(sizeof(struct backUpLog));
+		backUpInst[i]->undo_tail = 0;
+		backUpInst[i]->undo_next = 0;
+	}
+#ifdef _ENABLE_LOG_ENGINE
+	tx_logs = new engine_log_t[nthreads];
+	for (uint64_t i = 0; i < nthreads; i++)
+	{
+		tx_logs[i].init(pmalloc(engine_log_t::area_size()));
 	}
+#endif
 #endif
 
 	for (int i = 0; i < 3000; i++)
@@ -140,6 +164,12 @@ void TPCC_DB::initialize(uint64_t nthreads, uint64_t nwarehouse, uint64_t nitems
 		// srand(i);
 		rndm_seeds[i] = rand_local(1, NUM_RNDM_SEEDS * 10);
 	}
+
+	locks = new pthread_mutex_t[nwarehouse];
+	for (uint64_t i = 0; i < nwarehouse; i++)
+	{
+		pthread_mutex_init(&locks[i], NULL);
+	}
 }
 
 void TPCC_DB::deinitialize()
@@ -192,6 +222,9 @@ void TPCC_DB::populate_tables()
 			for (int k = 2100; k < 3000; k++)
 			{
 				fill_new_order_entry(i + 1, j + 1, k + 1, 0);
+#ifdef _ENABLE_LOG_ENGINE
+				tx_commit(0);
+#endif
 			}
 		}
 	}
@@ -275,6 +308,7 @@ void TPCC_DB::fill_district_entry(int _d_w_id, int _d_id)
 	district[indx].d_tax = (rand_local(0, 20)) / 100.0;
 	district[indx].d_ytd = 30000.0;
 	district[indx].d_next_o_id = 3001;
+	district[indx].d_next_delivery_o_id = 2101;
 }
 
 void TPCC_DB::fill_customer_entry(int _c_w_id, int _c_d_id, int _c_id)
@@ -328,7 +362,7 @@ void TPCC_DB::fill_order_entry(int _o_w_id, int _o_d_id, int _o_id)
 {
 	int indx = (_o_w_id - 1) * 10 * 3000 + (_o_d_id - 1) * 3000 + (_o_id - 1);
 	order[indx].o_id = _o_id;
-	order[indx].o_c_id = random_3000[_o_id];
+	order[indx].o_c_id = random_3000[_o_id - 1] + 1;
 	order[indx].o_d_id = _o_d_id;
 	order[indx].o_w_id = _o_w_id;
 	fill_time(order[indx].o_entry_d);
@@ -494,7 +528,7 @@ void TPCC_DB::new_order_tx(int tid, int w_id, int d_id, int c_id, int *item_ids,
 
 	// district
 	int d_indx = w_indx * N_DISTRICT_PER_WAREHOUSE + (d_id - 1);
-	int d_o_id = (district[d_indx].d_next_o_id % 15) + 1;
+	int d_o_id = district[d_indx].d_next_o_id;
 
 	// customer
 	int c_indx = d_indx * N_CUSTOMER_PER_DISTRICT + (c_id - 1);
@@ -512,28 +546,27 @@ void TPCC_DB::new_order_tx(int tid, int w_id, int d_id, int c_id, int *item_ids,
 	backUpInst[tid]->fill_new_order_line_entry_valid = 0;
 	backUpInst[tid]->update_order_entry_back_valid = 0;
 	backUpInst[tid]->update_stock_entry_num_valid = 0;
-	flush_caches(&backUpInst[tid]->district_back_valid, sizeof(backUpInst[tid]->district_back_valid));
-	flush_caches(&backUpInst[tid]->fill_new_order_line_entry_valid, sizeof(backUpInst[tid]->fill_new_order_line_entry_valid));
-	flush_caches(&backUpInst[tid]->fill_new_order_entry_back_valid, sizeof(backUpInst[tid]->fill_new_order_entry_back_valid));
-	flush_caches(&backUpInst[tid]->update_order_entry_back_valid, sizeof(backUpInst[tid]->update_order_entry_back_valid));
-	flush_caches(&backUpInst[tid]->update_stock_entry_num_valid, sizeof(backUpInst[tid]->update_stock_entry_num_valid));
-	s_fence();
+	flush_defer(&backUpInst[tid]->district_back_valid, sizeof(backUpInst[tid]->district_back_valid));
+	flush_defer(&backUpInst[tid]->fill_new_order_line_entry_valid, sizeof(backUpInst[tid]->fill_new_order_line_entry_valid));
+	flush_defer(&backUpInst[tid]->fill_new_order_entry_back_valid, sizeof(backUpInst[tid]->fill_new_order_entry_back_valid));
+	flush_defer(&backUpInst[tid]->update_order_entry_back_valid, sizeof(backUpInst[tid]->update_order_entry_back_valid));
+	flush_defer(&backUpInst[tid]->update_stock_entry_num_valid, sizeof(backUpInst[tid]->update_stock_entry_num_valid));
+	flush_commit();
 	backUpInst[tid]->log_valid = 1;
 	flush_caches((void *)&backUpInst[tid]->log_valid, (unsigned)sizeof(backUpInst[tid]->log_valid));
 	s_fence();
 
 	// do backup
-	copy_district_info(backUpInst[tid]->district_back, district[d_indx]);
-	flush_caches(&backUpInst[tid]->district_back, sizeof(backUpInst[tid]->district_back));
-	flush_caches((void *)&district[d_indx].d_next_o_id, (unsigned)sizeof(district[d_indx].d_next_o_id));
-	s_fence();
+	flush_memcpy_defer(&backUpInst[tid]->district_back, &district[d_indx], sizeof(backUpInst[tid]->district_back));
+	flush_defer((void *)&district[d_indx].d_next_o_id, (unsigned)sizeof(district[d_indx].d_next_o_id));
+	flush_commit();
 #endif
 
 #ifdef _ENABLE_LIBPMEMOBJ
 	pmem::obj::transaction::snapshot(&district[d_indx]);
 #endif
 
-	district[d_indx].d_next_o_id++;
+	tx_write(tid, district[d_indx].d_next_o_id, d_o_id + 1);
 
 	// ~= create_neworder
 	fill_new_order_entry(w_id, d_id, d_o_id, tid);
@@ -550,6 +583,10 @@ void TPCC_DB::new_order_tx(int tid, int w_id, int d_id, int c_id, int *item_ids,
 		fill_new_order_line_entry(tid, w_id, d_id, d_o_id, i, item_ids[i]);
 	}
 
+#ifdef _ENABLE_LOG_ENGINE
+	tx_commit(tid);
+#endif
+
 #ifdef _ENABLE_LOGGING
 	// invalidate log entries
 	backUpInst[tid]->log_valid = 0;
@@ -580,10 +617,9 @@ void TPCC_DB::fill_new_order_entry(int _no_w_id, int _no_d_id, int _no_o_id, int
 	// do backup
 #ifdef _ENABLE_LOGGING
 	backUpInst[tid]->fill_new_order_entry_indx = indx;
-	copy_new_order_info(backUpInst[tid]->new_order_entry_back, new_order[indx]);
-	flush_caches((void *)&backUpInst[tid]->fill_new_order_entry_indx, (unsigned)sizeof(backUpInst[tid]->fill_new_order_entry_indx));
-	flush_caches((void *)&backUpInst[tid]->new_order_entry_back, (unsigned)sizeof(backUpInst[tid]->new_order_entry_back));
-	s_fence();
+	flush_memcpy_defer(&backUpInst[tid]->new_order_entry_back, &new_order[indx], sizeof(backUpInst[tid]->new_order_entry_back));
+	flush_defer((void *)&backUpInst[tid]->fill_new_order_entry_indx, (unsigned)sizeof(backUpInst[tid]->fill_new_order_entry_indx));
+	flush_commit();
 	backUpInst[tid]->fill_new_order_entry_back_valid = 1;
 	flush_caches(&backUpInst[tid]->fill_new_order_entry_back_valid, sizeof(backUpInst[tid]->fill_new_order_entry_back_valid));
 	s_fence();
@@ -594,12 +630,15 @@ void TPCC_DB::fill_new_order_entry(int _no_w_id, int _no_d_id, int _no_o_id, int
 #endif
 
 	/* Main Updates */
-	new_order[indx].no_o_id = _no_o_id;
-	new_order[indx].no_d_id = _no_d_id;
-	new_order[indx].no_w_id = _no_w_id;
+	new_order_entry no = new_order[indx];
+	no.no_o_id = _no_o_id;
+	no.no_d_id = _no_d_id;
+	no.no_w_id = _no_w_id;
+	tx_write(tid, new_order[indx], no);
 
 #ifdef _ENABLE_LIBPMEMOBJ
 #elif _ENABLE_VOLATILE
+#elif _ENABLE_LOG_ENGINE
 #else
 	flush_caches((void *)&new_order[indx], (unsigned)sizeof(new_order[indx]));
 	s_fence();
@@ -612,10 +651,9 @@ void TPCC_DB::update_order_entry(int tid, int _w_id, short _d_id, int _o_id, int
 
 #ifdef _ENABLE_LOGGING
 	backUpInst[tid]->update_order_entry_indx = indx;
-	backUpInst[tid]->order_entry_back = order[indx];
-	flush_caches((void *)&backUpInst[tid]->update_order_entry_indx, (unsigned)sizeof(backUpInst[tid]->update_order_entry_indx));
-	flush_caches((void *)&backUpInst[tid]->order_entry_back, (unsigned)sizeof(backUpInst[tid]->order_entry_back));
-	s_fence();
+	flush_memcpy_defer(&backUpInst[tid]->order_entry_back, &order[indx], sizeof(backUpInst[tid]->order_entry_back));
+	flush_defer((void *)&backUpInst[tid]->update_order_entry_indx, (unsigned)sizeof(backUpInst[tid]->update_order_entry_indx));
+	flush_commit();
 
 	backUpInst[tid]->update_order_entry_back_valid = 1;
 	flush_caches((void *)&backUpInst[tid]->update_order_entry_back_valid, sizeof(backUpInst[tid]->update_order_entry_back_valid));
@@ -627,17 +665,20 @@ void TPCC_DB::update_order_entry(int tid, int _w_id, short _d_id, int _o_id, int
 #endif
 
 	/* Main Updates */
-	order[indx].o_id = _o_id;
-	order[indx].o_d_id = _d_id;
-	order[indx].o_w_id = _w_id;
-	order[indx].o_c_id = _c_id;
-	fill_time(order[indx].o_entry_d);
-	order[indx].o_carrier_id = 0;
-	order[indx].o_ol_cnt = _ol_cnt;
-	order[indx].o_all_local = 1;
+	order_entry o = order[indx];
+	o.o_id = _o_id;
+	o.o_d_id = _d_id;
+	o.o_w_id = _w_id;
+	o.o_c_id = _c_id;
+	fill_time(o.o_entry_d);
+	o.o_carrier_id = 0;
+	o.o_ol_cnt = _ol_cnt;
+	o.o_all_local = 1;
+	tx_write(tid, order[indx], o);
 
 #ifdef _ENABLE_LIBPMEMOBJ
 #elif _ENABLE_VOLATILE
+#elif _ENABLE_LOG_ENGINE
 #else
 	flush_caches((void *)&order[indx], (unsigned)sizeof(order[indx]));
 	s_fence();
@@ -652,12 +693,11 @@ void TPCC_DB::update_stock_entry(int tid, int _w_id, int _i_id, int _d_id, float
 	int ol_quantity = 7;
 #ifdef _ENABLE_LOGGING
 	backUpInst[tid]->update_stock_entry_indx[itr] = indx;
-	copy_stock_info(backUpInst[tid]->stock_entry_back[itr], stock[indx]);
+	flush_memcpy_defer(&backUpInst[tid]->stock_entry_back[itr], &stock[indx], sizeof(backUpInst[tid]->stock_entry_back[itr]));
 	backUpInst[tid]->update_stock_entry_num_valid |= (1UL << (itr + 1)); // bitset
-	flush_caches((void *)&backUpInst[tid]->update_stock_entry_indx[itr], (unsigned)sizeof(backUpInst[tid]->update_stock_entry_indx[itr]));
-	flush_caches((void *)&backUpInst[tid]->stock_entry_back[itr], (unsigned)sizeof(backUpInst[tid]->stock_entry_back[itr]));
-	flush_caches((void *)&backUpInst[tid]->update_stock_entry_num_valid, (unsigned)sizeof(backUpInst[tid]->update_stock_entry_num_valid));
-	s_fence();
+	flush_defer((void *)&backUpInst[tid]->update_stock_entry_indx[itr], (unsigned)sizeof(backUpInst[tid]->update_stock_entry_indx[itr]));
+	flush_defer((void *)&backUpInst[tid]->update_stock_entry_num_valid, (unsigned)sizeof(backUpInst[tid]->update_stock_entry_num_valid));
+	flush_commit();
 #endif
 
 #ifdef _ENABLE_LIBPMEMOBJ
@@ -665,20 +705,18 @@ void TPCC_DB::update_stock_entry(int tid, int _w_id, int _i_id, int _d_id, float
 #endif
 
 	/* Main Updates */
-	if (stock[indx].s_quantity - ol_quantity > 10)
-	{
-		stock[indx].s_quantity -= ol_quantity;
-	}
-	else
+	float s_quantity = stock[indx].s_quantity - ol_quantity;
+	if (s_quantity <= 10)
 	{
-		stock[indx].s_quantity -= ol_quantity;
-		stock[indx].s_quantity += 91;
+		s_quantity += 91;
 	}
-	stock[indx].s_ytd += ol_quantity;
-	stock[indx].s_order_cnt += 1;
+	tx_write(tid, stock[indx].s_quantity, s_quantity);
+	tx_write(tid, stock[indx].s_ytd, stock[indx].s_ytd + ol_quantity);
+	tx_write(tid, stock[indx].s_order_cnt, stock[indx].s_order_cnt + 1);
 
 #ifdef _ENABLE_LIBPMEMOBJ
 #elif _ENABLE_VOLATILE
+#elif _ENABLE_LOG_ENGINE
 #else
 	flush_caches((void *)&stock[indx], (unsigned)sizeof(stock[indx]));
 	s_fence();
@@ -691,21 +729,23 @@ void TPCC_DB::update_stock_entry(int tid, int _w_id, int _i_id, int _d_id, float
 
 void TPCC_DB::fill_new_order_line_entry(int tid, int _ol_w_id, int _ol_d_id, int _ol_o_id, int ol_num, int ol_i_id)
 {
-	int indx = (_ol_w_id - 1) * N_DISTRICT_PER_WAREHOUSE * N_ORDER_PER_DISTRICT * N_ORDER_LINE_PER_ORDER + (_ol_d_id - 1) * N_ORDER_PER_DISTRICT * N_ORDER_LINE_PER_ORDER + (_ol_o_id - 1) * N_ORDER_LINE_PER_ORDER + ol_num;
+	int indx = order_line_indx(_ol_w_id, _ol_d_id, _ol_o_id, ol_num);
 
 #ifdef _ENABLE_LIBPMEMOBJ
 	pmem::obj::transaction::snapshot(&order_line[indx]);
 #endif
 
-	order_line[indx].ol_o_id = _ol_o_id;
-	order_line[indx].ol_d_id = _ol_d_id;
-	order_line[indx].ol_w_id = _ol_w_id;
-	order_line[indx].ol_number = ol_num;
-	order_line[indx].ol_i_id = ol_i_id;
-	order_line[indx].ol_supply_w_id = _ol_w_id;
-	order_line[indx].ol_delivery_d = 0;
-	order_line[indx].ol_amount = rand_local(1, 999999) / 100.0;
-	order_line[indx].ol_quantity = 5.0;
+	order_line_entry ol = order_line[indx];
+	ol.ol_o_id = _ol_o_id;
+	ol.ol_d_id = _ol_d_id;
+	ol.ol_w_id = _ol_w_id;
+	ol.ol_number = ol_num;
+	ol.ol_i_id = ol_i_id;
+	ol.ol_supply_w_id = _ol_w_id;
+	ol.ol_delivery_d = 0;
+	ol.ol_amount = rand_local(1, 999999) / 100.0;
+	ol.ol_quantity = 5.0;
+	tx_write(tid, order_line[indx], ol);
 	// random_a_string(24, 24, order_line[indx].ol_dist_info);
 
 #ifdef _ENABLE_LOGGING
@@ -716,12 +756,281 @@ void TPCC_DB::fill_new_order_line_entry(int tid, int _ol_w_id, int _ol_d_id, int
 
 #ifdef _ENABLE_LIBPMEMOBJ
 #elif _ENABLE_VOLATILE
+#elif _ENABLE_LOG_ENGINE
 #else
 	flush_caches((void *)&order_line[indx], (unsigned)sizeof(order_line[indx]));
 	s_fence();
 #endif
 }
 
+void TPCC_DB::payment_tx(int tid, int w_id, int d_id, int c_id, float h_amount)
+{
+	int w_indx = (w_id - 1);
+	int d_indx = w_indx * N_DISTRICT_PER_WAREHOUSE + (d_id - 1);
+	int c_indx = d_indx * N_CUSTOMER_PER_DISTRICT + (c_id - 1);
+
+	// One history slot per customer, overwritten by each payment
+	int h_indx = c_indx;
+	bool bad_credit = customer[c_indx].c_credit[0] == 'B';
+
+	log_undo(tid, &warehouse[w_indx].w_ytd, sizeof(warehouse[w_indx].w_ytd));
+	log_undo(tid, &district[d_indx].d_ytd, sizeof(district[d_indx].d_ytd));
+	// c_balance, c_ytd_payment and c_payment_cnt
+	log_undo(tid, &customer[c_indx].c_balance, 3 * sizeof(float));
+	if (bad_credit)
+	{
+		log_undo(tid, customer[c_indx].c_data, sizeof(customer[c_indx].c_data));
+	}
+	log_undo(tid, &history[h_indx], sizeof(history_entry));
+	log_undo_commit(tid);
+
+	/* Main Updates */
+	tx_write(tid, warehouse[w_indx].w_ytd, warehouse[w_indx].w_ytd + h_amount);
+	persist_entry(&warehouse[w_indx].w_ytd, sizeof(warehouse[w_indx].w_ytd));
+
+	tx_write(tid, district[d_indx].d_ytd, district[d_indx].d_ytd + h_amount);
+	persist_entry(&district[d_indx].d_ytd, sizeof(district[d_indx].d_ytd));
+
+	tx_write(tid, customer[c_indx].c_balance, customer[c_indx].c_balance - h_amount);
+	tx_write(tid, customer[c_indx].c_ytd_payment, customer[c_indx].c_ytd_payment + h_amount);
+	tx_write(tid, customer[c_indx].c_payment_cnt, customer[c_indx].c_payment_cnt + 1);
+	persist_entry(&customer[c_indx].c_balance, 3 * sizeof(float));
+
+	if (bad_credit)
+	{
+		// Prepend the payment to c_data, the oldest data falls off the end
+		char c_data[sizeof(customer[c_indx].c_data)];
+		int len = snprintf(c_data, sizeof(c_data), "%d %d %d %d %d %.2f | ", c_id, d_id, w_id, d_id, w_id, h_amount);
+		memcpy(c_data + len, customer[c_indx].c_data, sizeof(c_data) - len);
+		tx_write(tid, customer[c_indx].c_data, c_data, sizeof(c_data));
+		persist_entry(customer[c_indx].c_data, sizeof(customer[c_indx].c_data));
+	}
+
+	history_entry h = history[h_indx];
+	h.h_c_id = c_id;
+	h.h_c_d_id = d_id;
+	h.h_c_w_id = w_id;
+	h.h_d_id = d_id;
+	h.h_w_id = w_id;
+	fill_time(h.h_date);
+	h.h_amount = h_amount;
+	memcpy(h.h_data, warehouse[w_indx].w_name, 10);
+	memset(h.h_data + 10, ' ', 4);
+	memcpy(h.h_data + 14, district[d_indx].d_name, 10);
+	tx_write(tid, history[h_indx], h);
+	persist_entry(&history[h_indx], sizeof(history_entry));
+
+	tx_commit(tid);
+	log_undo_clear(tid);
+}
+
+int TPCC_DB::order_status_tx(int tid, int w_id, int d_id, int c_id)
+{
+	int d_indx = (w_id - 1) * N_DISTRICT_PER_WAREHOUSE + (d_id - 1);
+	int c_indx = d_indx * N_CUSTOMER_PER_DISTRICT + (c_id - 1);
+	int next_o_id = district[d_indx].d_next_o_id;
+
+	// Most recent order of the customer, the last order if none is found
+	int o_id = next_o_id - 1;
+	for (int i = 1; i <= N_ORDER_STATUS_SCAN && next_o_id - i >= 1; i++)
+	{
+		if (order[order_indx(w_id, d_id, next_o_id - i)].o_c_id == c_id)
+		{
+			o_id = next_o_id - i;
+			break;
+		}
+	}
+
+	int o_indx = order_indx(w_id, d_id, o_id);
+	int ol_cnt = std::min((int)order[o_indx].o_ol_cnt, N_ORDER_LINE_PER_ORDER);
+	float total_amount = customer[c_indx].c_balance;
+	for (int i = 0; i < ol_cnt; i++)
+	{
+		total_amount += order_line[order_line_indx(w_id, d_id, o_id, i)].ol_amount;
+	}
+
+	if (TPCC_DEBUG)
+		std::cout << "order status: " << c_id << ", " << o_id << ", " << total_amount << std::endl;
+
+	return ol_cnt;
+}
+
+int TPCC_DB::delivery_tx(int tid, int w_id, int o_carrier_id)
+{
+	int delivered = 0;
+
+	for (int d_id = 1; d_id <= N_DISTRICT_PER_WAREHOUSE; d_id++)
+	{
+		int d_indx = (w_id - 1) * N_DISTRICT_PER_WAREHOUSE + (d_id - 1);
+		int o_id = district[d_indx].d_next_delivery_o_id;
+		int next_o_id = district[d_indx].d_next_o_id;
+
+		// Undelivered orders older than the new order ring were overwritten
+		if (next_o_id - o_id > N_NEW_ORDER_PER_DISTRICT)
+		{
+			o_id = next_o_id - N_NEW_ORDER_PER_DISTRICT;
+		}
+		if (o_id >= next_o_id)
+		{
+			continue;
+		}
+
+		int no_indx = d_indx * N_NEW_ORDER_PER_DISTRICT + (o_id - 2101) % N_NEW_ORDER_PER_DISTRICT;
+		int o_indx = order_indx(w_id, d_id, o_id);
+		int ol_indx = order_line_indx(w_id, d_id, o_id, 0);
+		int ol_cnt = std::min((int)order[o_indx].o_ol_cnt, N_ORDER_LINE_PER_ORDER);
+
+		int c_indx = d_indx * N_CUSTOMER_PER_DISTRICT + (order[o_indx].o_c_id - 1);
+
+		log_undo(tid, &new_order[no_indx], sizeof(new_order_entry));
+		log_undo(tid, &order[o_indx].o_carrier_id, sizeof(order[o_indx].o_carrier_id));
+		log_undo(tid, &order_line[ol_indx], ol_cnt * sizeof(order_line_entry));
+		// c_balance, c_ytd_payment, c_payment_cnt and c_delivery_cnt
+		log_undo(tid, &customer[c_indx].c_balance, 4 * sizeof(float));
+		log_undo(tid, &district[d_indx].d_next_delivery_o_id, sizeof(district[d_indx].d_next_delivery_o_id));
+		log_undo_commit(tid);
+
+		/* Main Updates */
+		tx_write(tid, new_order[no_indx].no_o_id, 0);
+		persist_entry(&new_order[no_indx], sizeof(new_order_entry));
+
+		tx_write(tid, order[o_indx].o_carrier_id, (short)o_carrier_id);
+		persist_entry(&order[o_indx].o_carrier_id, sizeof(order[o_indx].o_carrier_id));
+
+		float total_amount = 0.0;
+		for (int i = 0; i < ol_cnt; i++)
+		{
+			long long ol_delivery_d;
+			fill_time(ol_delivery_d);
+			tx_write(tid, order_line[ol_indx + i].ol_delivery_d, ol_delivery_d);
+			total_amount += order_line[ol_indx + i].ol_amount;
+		}
+		persist_entry(&order_line[ol_indx], ol_cnt * sizeof(order_line_entry));
+
+		tx_write(tid, customer[c_indx].c_balance, customer[c_indx].c_balance + total_amount);
+		tx_write(tid, customer[c_indx].c_delivery_cnt, customer[c_indx].c_delivery_cnt + 1);
+		persist_entry(&customer[c_indx].c_balance, 4 * sizeof(float));
+
+		tx_write(tid, district[d_indx].d_next_delivery_o_id, o_id + 1);
+		persist_entry(&district[d_indx].d_next_delivery_o_id, sizeof(district[d_indx].d_next_delivery_o_id));
+
+		tx_commit(tid);
+		delivered++;
+	}
+
+	log_undo_clear(tid);
+	return delivered;
+}
+
+int TPCC_DB::stock_level_tx(int tid, int w_id, int d_id, int threshold)
+{
+	int d_indx = (w_id - 1) * N_DISTRICT_PER_WAREHOUSE + (d_id - 1);
+	int next_o_id = district[d_indx].d_next_o_id;
+	int item_ids[N_STOCK_LEVEL_ORDERS * N_ORDER_LINE_PER_ORDER];
+	int nitems_seen = 0;
+	int low_stock = 0;
+
+	for (int o_id = std::max(1, next_o_id - N_STOCK_LEVEL_ORDERS); o_id < next_o_id; o_id++)
+	{
+		int ol_cnt = std::min((int)order[order_indx(w_id, d_id, o_id)].o_ol_cnt, N_ORDER_LINE_PER_ORDER);
+		for (int i = 0; i < ol_cnt; i++)
+		{
+			int i_id = order_line[order_line_indx(w_id, d_id, o_id, i)].ol_i_id;
+			if (i_id < 1 || i_id > (int)num_items || std::find(item_ids, item_ids + nitems_seen, i_id) != item_ids + nitems_seen)
+			{
+				continue;
+			}
+			item_ids[nitems_seen++] = i_id;
+
+			if (stock[(w_id - 1) * num_items + i_id - 1].s_quantity < threshold)
+			{
+				low_stock++;
+			}
+		}
+	}
+
+	return low_stock;
+}
+
+/* Undo logging */
+void TPCC_DB::log_undo(int tid, void *addr, size_t size)
+{
+#ifdef _ENABLE_LOGGING
+	struct backUpLog *log = backUpInst[tid];
+	size_t record_size = sizeof(struct undo_record) + ((size + 7) & ~7UL);
+	assert(log->undo_next + record_size <= UNDO_LOG_SIZE);
+
+	struct undo_record *record = (struct undo_record *)&log->undo_log[log->undo_next];
+	record->addr = (uint64_t)addr;
+	record->size = size;
+	flush_memcpy_defer(record + 1, addr, size);
+	flush_defer(record, sizeof(struct undo_record));
+	log->undo_next += record_size;
+#elif defined(_ENABLE_LIBPMEMOBJ)
+	pmem::obj::transaction::snapshot((char *)addr, size);
+#endif
+}
+
+void TPCC_DB::log_undo_commit(int tid)
+{
+#ifdef _ENABLE_LOGGING
+	// Records first, then the tail that makes them valid
+	flush_commit();
+	backUpInst[tid]->undo_tail = backUpInst[tid]->undo_next;
+	flush_caches(&backUpInst[tid]->undo_tail, sizeof(backUpInst[tid]->undo_tail));
+	s_fence();
+#endif
+}
+
+void TPCC_DB::log_undo_clear(int tid)
+{
+#ifdef _ENABLE_LOGGING
+	backUpInst[tid]->undo_tail = 0;
+	backUpInst[tid]->undo_next = 0;
+	flush_caches(&backUpInst[tid]->undo_tail, sizeof(backUpInst[tid]->undo_tail));
+	s_fence();
+#endif
+}
+
+void TPCC_DB::persist_entry(void *addr, size_t size)
+{
+#ifdef _ENABLE_LIBPMEMOBJ
+#elif _ENABLE_VOLATILE
+#elif _ENABLE_LOG_ENGINE
+#else
+	flush_defer(addr, size);
+#endif
+}
+
+void TPCC_DB::persist_commit()
+{
+#ifdef _ENABLE_LIBPMEMOBJ
+#elif _ENABLE_VOLATILE
+#elif _ENABLE_LOG_ENGINE
+#else
+	flush_commit();
+#endif
+}
+
+void TPCC_DB::tx_write(int tid, void *dst, const void *src, size_t size)
+{
+#ifdef _ENABLE_LOG_ENGINE
+	tx_logs[tid].write(dst, src, size);
+#else
+	memcpy(dst, src, size);
+#endif
+}
+
+/* Commit point of a transaction, a single fence for the log engine */
+void TPCC_DB::tx_commit(int tid)
+{
+#ifdef _ENABLE_LOG_ENGINE
+	tx_logs[tid].commit();
+#else
+	persist_commit();
+#endif
+}
+
 /* Multi-threading */
 void TPCC_DB::acquire_locks(int tid, queue_t &requestedLocks)
 {
@@ -749,6 +1058,16 @@ void TPCC_DB::release_locks(int tid)
 	}
 }
 
+void TPCC_DB::lock_warehouse(int w_id)
+{
+	pthread_mutex_lock(&locks[w_id - 1]);
+}
+
+void TPCC_DB::unlock_warehouse(int w_id)
+{
+	pthread_mutex_unlock(&locks[w_id - 1]);
+}
+
 /* Debug Related */
 void TPCC_DB::printStackPointer(int *sp, int tid)
 {
@@ -26,12 +26,40 @@ extern pmem::obj::persistent_ptr<TPCC_DB> table;
 #define PMDK_POOL_SIZE (1UL << 32)
 #endif
 
+// Redo and undo+redo logging share the log engine, writes go through tx_write
+#if defined(_ENABLE_REDO_LOGGING) || defined(_ENABLE_HYBRID_LOGGING)
+#define _ENABLE_LOG_ENGINE 1
+#include "../common/log_engine.h"
+#ifdef _ENABLE_REDO_LOGGING
+typedef tx_log<LOG_REDO> engine_log_t;
+#else
+typedef tx_log<LOG_HYBRID> engine_log_t;
+#endif
+#endif
+
 #define N_DISTRICT_PER_WAREHOUSE 10
 #define N_CUSTOMER_PER_DISTRICT 3000
 #define N_ORDER_PER_DISTRICT 3000
 #define N_ORDER_LINE_PER_ORDER 15
 #define N_NEW_ORDER_PER_DISTRICT 900
 
+// Orders scanned by Order-Status and Stock-Level
+#define N_ORDER_STATUS_SCAN 100
+#define N_STOCK_LEVEL_ORDERS 20
+
+// Undo log of the transactions other than New-Order
+#define UNDO_LOG_SIZE (32 * 1024)
+
+enum tpcc_tx_type
+{
+	TPCC_NEW_ORDER = 0,
+	TPCC_PAYMENT,
+	TPCC_ORDER_STATUS,
+	TPCC_DELIVERY,
+	TPCC_STOCK_LEVEL,
+	TPCC_NUM_TX_TYPES
+};
+
 typedef simple_queue queue_t;
 
 struct backUpLog
@@ -62,6 +90,17 @@ struct backUpLog
 
 	// global log valid
 	uint64_t log_valid;
+
+	// Payment and Delivery, a sequence of {addr, size, data} records
+	uint64_t undo_tail;
+	uint64_t undo_next; // records not yet committed, recovery only trusts undo_tail
+	char undo_log[UNDO_LOG_SIZE];
+};
+
+struct undo_record
+{
+	uint64_t addr;
+	uint64_t size;
 };
 
 class TPCC_DB
@@ -102,6 +141,9 @@ private:
 	queue_t *perTxLocks;		   // Array of queues of locks held by active Tx
 	pthread_mutex_t *locks;		   // Array of locks held by the TxEngn. RDSs acquire locks through the TxEngn
 	struct backUpLog **backUpInst; // Pointer to per-thread log location
+#ifdef _ENABLE_LOG_ENGINE
+	engine_log_t *tx_logs; // Per-thread redo or undo+redo log
+#endif
 	unsigned g_seed;
 
 public:
@@ -147,10 +189,38 @@ public:
 	void new_order_tx(int tid, int w_id, int d_id, int c_id, int *item_ids, int ol_cnt);
 	void update_order_entry(int tid, int _w_id, short _d_id, int _o_id, int _c_id, int _ol_cnt);
 	void update_stock_entry(int tid, int _w_id, int _i_id, int _d_id, float &amount, int itr);
+	void payment_tx(int tid, int w_id, int d_id, int c_id, float h_amount);
+	int order_status_tx(int tid, int w_id, int d_id, int c_id);
+	int delivery_tx(int tid, int w_id, int o_carrier_id);
+	int stock_level_tx(int tid, int w_id, int d_id, int threshold);
+
+	/* Undo logging of Payment and Delivery */
+	void log_undo(int tid, void *addr, size_t size);
+	void log_undo_commit(int tid);
+	void log_undo_clear(int tid);
+
+	/* Flushes an updated entry, written back by persist_commit */
+	void persist_entry(void *addr, size_t size);
+	void persist_commit();
+
+	/* Transactional writes, staged in the log engine when enabled */
+	template <typename T>
+	void tx_write(int tid, T &field, const T &value)
+	{
+#ifdef _ENABLE_LOG_ENGINE
+		tx_logs[tid].write(&field, value);
+#else
+		field = value;
+#endif
+	}
+	void tx_write(int tid, void *dst, const void *src, size_t size);
+	void tx_commit(int tid);
 
 	/* Multi-threading */
 	void acquire_locks(int thread_id, queue_t &reqLocks);
 	void release_locks(int thread_id);
+	void lock_warehouse(int w_id);
+	void unlock_warehouse(int w_id);
 
 	/* Debug Related */
 	void printStackPointer(int *sp, int thread_id);
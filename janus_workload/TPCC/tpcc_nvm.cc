@@ -16,12 +16,20 @@ This file models the TPCC benchmark.
 #include <string>
 #include <fstream>
 #include <assert.h>
+#include <algorithm>
 #include "common.h"
 #include "tpcc_db.h"
+#if defined(GEM5) || defined(PMBENCH)
+#include "../m5ops.h"
+#endif
 
 std::atomic<bool> stop;
-uint64_t new_orders(uint64_t tid, uint64_t nwarehouse, uint64_t num_items);
-uint64_t new_orders_nops(uint64_t tid, uint64_t nwarehouse, uint64_t nops, uint64_t num_items);
+struct thread_data;
+uint64_t run_tx_mix(struct thread_data *tData, uint64_t nops);
+
+/* Standard mix, can be overridden with TPCC_MIX="NO,P,OS,D,SL" */
+static int tx_mix[TPCC_NUM_TX_TYPES] = {45, 43, 4, 4, 4};
+static const char *tx_names[TPCC_NUM_TX_TYPES] = {"new_order", "payment", "order_status", "delivery", "stock_level"};
 
 #ifdef _ENABLE_LIBPMEMOBJ
 pmem::obj::pool<TPCC_DB> pool;
@@ -122,6 +130,49 @@ static inline void set_cpu(int cpu)
 	}
 }
 
+/* Latency of one transaction type, power of two buckets in ns */
+struct tx_stats
+{
+	uint64_t count = 0;
+	uint64_t total_ns = 0;
+	uint64_t max_ns = 0;
+	uint64_t hist[64] = {};
+
+	void add(uint64_t ns)
+	{
+		count++;
+		total_ns += ns;
+		max_ns = std::max(max_ns, ns);
+		hist[63 - __builtin_clzll(ns | 1)]++;
+	}
+
+	void merge(const tx_stats &other)
+	{
+		count += other.count;
+		total_ns += other.total_ns;
+		max_ns = std::max(max_ns, other.max_ns);
+		for (int i = 0; i < 64; i++)
+		{
+			hist[i] += other.hist[i];
+		}
+	}
+
+	/* Upper bound of the bucket holding the given percentile */
+	uint64_t percentile_ns(double p) const
+	{
+		uint64_t seen = 0;
+		for (int i = 0; i < 64; i++)
+		{
+			seen += hist[i];
+			if (seen >= p * count)
+			{
+				return std::min(2UL << i, max_ns);
+			}
+		}
+		return max_ns;
+	}
+};
+
 struct thread_data
 {
 	uint64_t tid;
@@ -129,6 +180,8 @@ struct thread_data
 	uint64_t nops; // if execute exactly nops
 	uint64_t nwarehouse;
 	uint64_t num_items;
+	bool lock_warehouse; // more threads than warehouses
+	tx_stats stats[TPCC_NUM_TX_TYPES];
 };
 
 /* An operation every thread runs during the execution */
@@ -136,8 +189,6 @@ void *threadTimedRun(void *arg)
 {
 	struct thread_data *tData = (struct thread_data *)arg;
 	uint64_t tid = tData->tid;
-	uint64_t nwarehouse = tData->nwarehouse;
-	uint64_t num_items = tData->num_items;
 
 	// Set CPU affinity
 	set_cpu(tid);
@@ -145,7 +196,7 @@ void *threadTimedRun(void *arg)
 	barrier_cross(&init_barrier);
 	barrier_cross(&barrier_global);
 
-	tData->ops = new_orders(tid, nwarehouse, num_items);
+	tData->ops = run_tx_mix(tData, 0);
 
 	return NULL;
 }
@@ -155,8 +206,6 @@ void *threadOpRun(void *arg)
 	struct thread_data *tData = (struct thread_data *)arg;
 	uint64_t tid = tData->tid;
 	uint64_t nops = tData->nops;
-	uint64_t nwarehouse = tData->nwarehouse;
-	uint64_t num_items = tData->num_items;
 
 	// Set CPU affinity
 	set_cpu(tid);
@@ -164,11 +213,64 @@ void *threadOpRun(void *arg)
 	barrier_cross(&init_barrier);
 	barrier_cross(&barrier_global);
 
-	tData->ops = new_orders_nops(tid, nops, nwarehouse, num_items);
+	tData->ops = run_tx_mix(tData, nops);
 
 	return NULL;
 }
 
+static void parse_tx_mix()
+{
+	char *env = getenv("TPCC_MIX");
+	if (env == NULL)
+	{
+		return;
+	}
+
+	int mix[TPCC_NUM_TX_TYPES];
+	if (sscanf(env, "%d,%d,%d,%d,%d", &mix[0], &mix[1], &mix[2], &mix[3], &mix[4]) != TPCC_NUM_TX_TYPES)
+	{
+		fprintf(stderr, "Ignoring TPCC_MIX=%s, expected NO,P,OS,D,SL\n", env);
+		return;
+	}
+
+	int total = 0;
+	for (int i = 0; i < TPCC_NUM_TX_TYPES; i++)
+	{
+		assert(mix[i] >= 0);
+		total += mix[i];
+	}
+	assert(total > 0);
+	std::copy(mix, mix + TPCC_NUM_TX_TYPES, tx_mix);
+}
+
+/* Throughput and latency of each transaction type */
+static void report_tx_stats(char *argv[], uint64_t nwarehouse, uint64_t nitems, uint64_t nthreads, double exectime, thread_data *allThreadsData)
+{
+	std::ofstream ftx;
+	ftx.open("tpcc_tx.csv", std::ios_base::app);
+	if (ftx.tellp() == 0)
+	{
+		ftx << "binary,nwarehouse,nitems,nthread,tx,count,exec_time,throughput,avg_lat_us,p50_lat_us,p99_lat_us,max_lat_us\n";
+	}
+
+	for (int type = 0; type < TPCC_NUM_TX_TYPES; type++)
+	{
+		tx_stats stats;
+		for (uint64_t i = 0; i < nthreads; i++)
+		{
+			stats.merge(allThreadsData[i].stats[type]);
+		}
+
+		double avg_us = stats.count ? (double)stats.total_ns / stats.count / 1000.0 : 0.0;
+		std::string line = std::string(argv[0]) + "," + std::to_string(nwarehouse) + "," + std::to_string(nitems) + "," + std::to_string(nthreads) + "," + tx_names[type] + "," + std::to_string(stats.count) + "," + std::to_string(exectime) + "," + std::to_string((uint64_t)(stats.count / exectime)) + "," + std::to_string(avg_us) + "," + std::to_string(stats.percentile_ns(0.5) / 1000.0) + "," + std::to_string(stats.percentile_ns(0.99) / 1000.0) + "," + std::to_string(stats.max_ns / 1000.0);
+
+		ftx << line << std::endl;
+		std::cout << line << std::endl;
+	}
+
+	ftx.close();
+}
+
 void run(char *argv[], uint64_t nwarehouse, uint64_t nitems, uint64_t nthreads, uint64_t duration, uint64_t nops)
 {
 	double exectime;
@@ -189,6 +291,7 @@ void run(char *argv[], uint64_t nwarehouse, uint64_t nitems, uint64_t nthreads,
 		allThreadsData[i].nops = nops;
 		allThreadsData[i].nwarehouse = nwarehouse;
 		allThreadsData[i].num_items = nitems;
+		allThreadsData[i].lock_warehouse = nthreads > nwarehouse;
 	}
 	stop = (false);
 
@@ -266,6 +369,8 @@ void run(char *argv[], uint64_t nwarehouse, uint64_t nitems, uint64_t nthreads,
 	std::cerr << argv[0] << "," << std::to_string(nwarehouse) << "," << std::to_string(nitems) << "," << std::to_string(nthreads) << "," << std::to_string(duration) << "," << std::to_string(nops) << "," << std::to_string(totalOps) << "," << std::to_string(exectime) << "," << std::to_string(tput) << "," << std::setprecision(precision) << mtput << std::endl;
 
 	fexec.close();
+
+	report_tx_stats(argv, nwarehouse, nitems, nthreads, exectime, allThreadsData);
 }
 
 #define NUM_ORDERS 100 // 10000000
@@ -334,150 +439,161 @@ void deinit_db(uint64_t nthreads)
 #define OL_MIN 5
 #define OL_RANGE 10
 
-uint64_t new_orders_nops(uint64_t tid, uint64_t nops, uint64_t nwarehouse, uint64_t num_items)
+/* Runs a transaction, inside a libpmemobj transaction if enabled */
+template <typename F>
+static bool run_tx(F tx)
 {
-	long int rand_val;
-	int w_id, d_id, c_id, ol_cnt;
-	int item_ids[15];
-	uint64_t ops = 0;
-	fprintf(stderr, "Execution Started\n");
-	int new_item_id;
-	bool match;
-	int i;
-	for (uint64_t i = 0; i < nops; i++)
-	{
-		rand_val = random();
-		w_id = rand_val % nwarehouse;					   // 4 bits
-		d_id = (rand_val >> 4) % N_DISTRICT_PER_WAREHOUSE; // 4 bits
-		c_id = (rand_val >> 8) % N_CUSTOMER_PER_DISTRICT;  // 4 bits
-
-		// Create orderline
-		// ol_cnt = get_random(tid, 5, 15);
-		ol_cnt = (rand_val >> 12) % OL_RANGE + OL_MIN; // 4 bits
-		for (i = 0; i < ol_cnt; i++)
-		{
-			do
-			{
-				match = false;
-				new_item_id = random() % num_items;
-				// new_item_id = (rand_val >> (16 + i) % num_items;
-				for (int j = 0; j < i; j++)
-				{
-					if (new_item_id == item_ids[j])
-					{
-						match = true;
-						break;
-					}
-				}
-			} while (match);
-			item_ids[i] = new_item_id;
-		}
-
-		// std::sort(item_ids, item_ids + ol_cnt);
 #ifdef _ENABLE_LIBPMEMOBJ
-		try
-		{
-			// pmem::obj::transaction::run(pool, [&]
-			// table->update_location(subId, vlr);
-			// 							{ table->update_location(subId, vlr); });
-			pmem::obj::transaction::run(pool, [&]
-										{ table->new_order_tx(tid, w_id, d_id, c_id, item_ids, ol_cnt); });
-		}
-		catch (const std::runtime_error &e)
-		{
-			std::cerr << "Exception: " << e.what()
-					  << std::endl;
-			return 1;
-		}
-		catch (const std::logic_error &e)
-		{
-			std::cerr << "Exception: " << e.what()
-					  << std::endl;
-			return 1;
-		}
+	try
+	{
+		pmem::obj::transaction::run(pool, tx);
+	}
+	catch (const std::runtime_error &e)
+	{
+		std::cerr << "Exception: " << e.what()
+				  << std::endl;
+		return false;
+	}
+	catch (const std::logic_error &e)
+	{
+		std::cerr << "Exception: " << e.what()
+				  << std::endl;
+		return false;
+	}
 #else
-		tpcc_db->new_order_tx(tid, w_id, d_id, c_id, item_ids, ol_cnt);
+	tx();
 #endif
+	return true;
+}
 
-		ops++;
+static inline uint64_t now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static inline int rand_range(unsigned int *seed, int min, int max)
+{
+	return min + rand_r(seed) % (max - min + 1);
+}
+
+static int pick_tx_type(unsigned int *seed)
+{
+	int total = 0;
+	for (int i = 0; i < TPCC_NUM_TX_TYPES; i++)
+	{
+		total += tx_mix[i];
 	}
-	fprintf(stderr, "Execution finished. Returning: %lu\n", ops);
 
-	return ops;
+	int r = rand_r(seed) % total;
+	for (int i = 0; i < TPCC_NUM_TX_TYPES; i++)
+	{
+		if (r < tx_mix[i])
+		{
+			return i;
+		}
+		r -= tx_mix[i];
+	}
+	return TPCC_NEW_ORDER;
 }
 
-uint64_t new_orders(uint64_t tid, uint64_t nwarehouse, uint64_t num_items)
+/* Runs nops transactions of the mix, or until stop if nops is 0 */
+uint64_t run_tx_mix(struct thread_data *tData, uint64_t nops)
 {
-	long int rand_val;
-	int w_id, d_id, c_id, ol_cnt;
-	int item_ids[15];
+	uint64_t tid = tData->tid;
+	uint64_t num_items = tData->num_items;
+	unsigned int seed = tid + 1;
+	int item_ids[N_ORDER_LINE_PER_ORDER];
 	uint64_t ops = 0;
-	fprintf(stderr, "Running received. RAND_MAX=%d\n", RAND_MAX);
-	pthread_mutex_t tmp;
-	pthread_mutex_init(&tmp, NULL);
-	pthread_mutex_lock(&tmp);
-	int new_item_id;
-	bool match;
-	int i;
-	while (!stop)
+
+	// Every thread works on its home warehouse
+	int w_id = tid % tData->nwarehouse + 1;
+
+#ifdef _ENABLE_LIBPMEMOBJ
+	TPCC_DB *db = table.get();
+#else
+	TPCC_DB *db = tpcc_db;
+#endif
+
+	fprintf(stderr, "Execution Started, warehouse %d\n", w_id);
+	while (nops != 0 ? ops < nops : !stop)
 	{
-		rand_val = random();
-		w_id = (((uint64_t)rand_val) % nwarehouse) + 1;			 // 4 bits
-		d_id = ((rand_val >> 4) % N_DISTRICT_PER_WAREHOUSE) + 1; // 4 bits
-		c_id = ((rand_val >> 8) % N_CUSTOMER_PER_DISTRICT) + 1;	 // 4 bits
-
-		// Create orderline
-		// ol_cnt = get_random(tid, 5, 15);
-		ol_cnt = (rand_val >> 12) % OL_RANGE + OL_MIN; // 4 bits
-		for (i = 0; i < ol_cnt; i++)
+		int type = pick_tx_type(&seed);
+		int d_id = rand_range(&seed, 1, N_DISTRICT_PER_WAREHOUSE);
+		int c_id = rand_range(&seed, 1, N_CUSTOMER_PER_DISTRICT);
+		bool ok = true;
+
+		int ol_cnt = 0;
+		if (type == TPCC_NEW_ORDER)
 		{
-			do
+			ol_cnt = rand_range(&seed, OL_MIN, OL_MIN + OL_RANGE - 1);
+			for (int i = 0; i < ol_cnt; i++)
 			{
-				match = false;
-				new_item_id = (random() % num_items) + 1;
-				for (int j = 0; j < i; j++)
+				int new_item_id;
+				do
 				{
-					if (new_item_id == item_ids[j])
-					{
-						match = true;
-						break;
-					}
-				}
-			} while (match);
-			item_ids[i] = new_item_id;
+					new_item_id = rand_range(&seed, 1, num_items);
+				} while (std::find(item_ids, item_ids + i, new_item_id) != item_ids + i);
+				item_ids[i] = new_item_id;
+			}
 		}
 
-		// std::sort(item_ids, item_ids + ol_cnt);
+		if (tData->lock_warehouse)
+		{
+			db->lock_warehouse(w_id);
+		}
+#if defined(GEM5) || defined(PMBENCH)
+		m5_work_begin(type, tid);
+#endif
+		uint64_t start = now_ns();
 
-#ifdef _ENABLE_LIBPMEMOBJ
-		try
+		switch (type)
+		{
+		case TPCC_NEW_ORDER:
+			ok = run_tx([&]
+						{ db->new_order_tx(tid, w_id, d_id, c_id, item_ids, ol_cnt); });
+			break;
+		case TPCC_PAYMENT:
 		{
-			// pmem::obj::transaction::run(pool, [&]
-			// table->update_location(subId, vlr);
-			// 							{ table->update_location(subId, vlr); });
-			pmem::obj::transaction::run(pool, [&]
-										{ table->new_order_tx(tid, w_id, d_id, c_id, item_ids, ol_cnt); });
+			float h_amount = rand_range(&seed, 100, 500000) / 100.0;
+			ok = run_tx([&]
+						{ db->payment_tx(tid, w_id, d_id, c_id, h_amount); });
+			break;
 		}
-		catch (const std::runtime_error &e)
+		case TPCC_ORDER_STATUS:
+			db->order_status_tx(tid, w_id, d_id, c_id);
+			break;
+		case TPCC_DELIVERY:
 		{
-			std::cerr << "Exception: " << e.what()
-					  << std::endl;
-			return 1;
+			int o_carrier_id = rand_range(&seed, 1, 10);
+			ok = run_tx([&]
+						{ db->delivery_tx(tid, w_id, o_carrier_id); });
+			break;
+		}
+		case TPCC_STOCK_LEVEL:
+			db->stock_level_tx(tid, w_id, d_id, rand_range(&seed, 10, 20));
+			break;
 		}
-		catch (const std::logic_error &e)
+
+		uint64_t latency = now_ns() - start;
+#if defined(GEM5) || defined(PMBENCH)
+		m5_work_end(type, tid);
+#endif
+		if (tData->lock_warehouse)
+		{
+			db->unlock_warehouse(w_id);
+		}
+
+		if (!ok)
 		{
-			std::cerr << "Exception: " << e.what()
-					  << std::endl;
 			return 1;
 		}
-#else
-		tpcc_db->new_order_tx(tid, w_id, d_id, c_id, item_ids, ol_cnt);
-#endif
 
+		tData->stats[type].add(latency);
 		ops++;
 	}
-	fprintf(stderr, "Stop received. Returning: %lu\n", ops);
-	pthread_mutex_unlock(&tmp);
+	fprintf(stderr, "Execution finished. Returning: %lu\n", ops);
 
 	return ops;
 }
@@ -494,6 +610,14 @@ int main(int argc, char *argv[])
 	printf("Logging Enabled\n");
 #endif
 
+#ifdef _ENABLE_REDO_LOGGING
+	printf("Redo Logging Enabled\n");
+#endif
+
+#ifdef _ENABLE_HYBRID_LOGGING
+	printf("Undo+Redo Logging Enabled\n");
+#endif
+
 #ifdef _ENABLE_LIBPMEMOBJ
 	printf("Libpmemobj Enabled\n");
 #endif
@@ -506,7 +630,7 @@ int main(int argc, char *argv[])
 
 	assert(duration != 0 || nops != 0);
 
-	uint64_t nlocks = nwarehouse * 10 + nwarehouse * nitems;
+	parse_tx_mix();
 
 	init_db(nthreads, nwarehouse, nitems);
 
@@ -66,9 +66,9 @@ ArraySwap::swap(unsigned a, unsigned b) {
 	// flush counter cache and set commit
 	
 	//s_fence();
-	cache_flush(&start[a], sizeof(item_t));
-	cache_flush(&start[b], sizeof(item_t));
-	s_fence();
+	flush_defer(&start[a], sizeof(item_t));
+	flush_defer(&start[b], sizeof(item_t));
+	flush_commit();
 	
 	backup_valid = 0;
 	cache_flush(&backup_valid, sizeof(backup_valid));
@@ -0,0 +1,509 @@
+/*
+ * pmbench -- runs the evaluated workloads natively and reports JSON results.
+ *
+ * Workloads are the native builds of the gem5 workloads (see workloads.cfg),
+ * linked with roi.o in place of the gem5 work markers. Each run is a child
+ * process on a pool in a DAX or tmpfs directory:
+ *
+ *   - the whole process is counted by perf events opened on the child,
+ *   - the regions of interest are counted by roi.o, which also reports the
+ *     line flushes and fences of the janus workloads.
+ *
+ * Per operation figures use the region of interest counts when the workload
+ * marks one, the whole process counts otherwise.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <linux/perf_event.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct workload
+{
+	std::string name;
+	/* Operations per run, 0 to count the regions of interest */
+	uint64_t ops;
+	std::vector<std::string> argv;
+};
+
+struct perf_counter
+{
+	std::string name;
+	uint32_t type;
+	uint64_t config;
+	int fd;
+};
+
+struct run_result
+{
+	std::string name;
+	unsigned repeat;
+	int status;
+	double wall_s;
+	uint64_t ops;
+	std::map<std::string, uint64_t> process;
+	std::map<std::string, uint64_t> roi;
+};
+
+struct options
+{
+	std::string config = "workloads.cfg";
+	std::string root = "../..";
+	std::string pmem_dir = "/dev/shm";
+	std::string output;
+	unsigned repeats = 1;
+	bool verbose = false;
+	bool force_pmem = true;
+	std::vector<std::pair<std::string, uint64_t>> raw_events;
+	std::vector<std::string> selected;
+};
+
+static options opts;
+
+static uint64_t now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+}
+
+static std::string replace_all(std::string str, const std::string &from, const std::string &to)
+{
+	for (size_t pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos + to.size()))
+	{
+		str.replace(pos, from.size(), to);
+	}
+	return str;
+}
+
+static std::string expand(const std::string &str)
+{
+	return replace_all(replace_all(str, "{root}", opts.root), "{pmem}", opts.pmem_dir);
+}
+
+/* One workload per line: name ops binary [args...], # starts a comment */
+static std::vector<workload> load_config(const std::string &path)
+{
+	std::vector<workload> workloads;
+	std::ifstream file(path);
+	std::string line;
+	unsigned lineno = 0;
+
+	if (!file)
+	{
+		fprintf(stderr, "[%s] Cannot open %s\n", __func__, path.c_str());
+		exit(1);
+	}
+
+	while (std::getline(file, line))
+	{
+		lineno++;
+		line = line.substr(0, line.find('#'));
+
+		std::istringstream fields(line);
+		workload w;
+		std::string arg;
+		if (!(fields >> w.name))
+		{
+			continue;
+		}
+		if (!(fields >> w.ops))
+		{
+			fprintf(stderr, "[%s] %s:%u: expected an operation count\n", __func__, path.c_str(), lineno);
+			exit(1);
+		}
+		while (fields >> arg)
+		{
+			w.argv.push_back(expand(arg));
+		}
+		if (w.argv.empty())
+		{
+			fprintf(stderr, "[%s] %s:%u: expected a binary\n", __func__, path.c_str(), lineno);
+			exit(1);
+		}
+		workloads.push_back(w);
+	}
+	return workloads;
+}
+
+static std::vector<perf_counter> process_counters()
+{
+	std::vector<perf_counter> counters = {
+		{"task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1},
+		{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1},
+		{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1},
+		{"stores", PERF_TYPE_HW_CACHE,
+		 PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_WRITE << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16), -1},
+	};
+	for (auto &raw : opts.raw_events)
+	{
+		counters.push_back({raw.first, PERF_TYPE_RAW, raw.second, -1});
+	}
+	return counters;
+}
+
+/* Counts the child and its threads from its exec on, not grouped so they can be inherited */
+static void open_counters(std::vector<perf_counter> &counters, pid_t pid)
+{
+	for (auto &c : counters)
+	{
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = c.type;
+		attr.config = c.config;
+		attr.disabled = 1;
+		attr.enable_on_exec = 1;
+		attr.inherit = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		c.fd = syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+		if (c.fd < 0 && opts.verbose)
+		{
+			fprintf(stderr, "[%s] %s not available: %s\n", __func__, c.name.c_str(), strerror(errno));
+		}
+	}
+}
+
+static void read_counters(std::vector<perf_counter> &counters, std::map<std::string, uint64_t> &values)
+{
+	for (auto &c : counters)
+	{
+		uint64_t value;
+		if (c.fd >= 0 && read(c.fd, &value, sizeof(value)) == sizeof(value))
+		{
+			values[c.name] = value;
+		}
+		if (c.fd >= 0)
+		{
+			close(c.fd);
+		}
+	}
+}
+
+static void read_roi(const std::string &path, std::map<std::string, uint64_t> &values)
+{
+	std::ifstream file(path);
+	std::string key;
+	uint64_t value;
+
+	while (file >> key >> value)
+	{
+		values[key] = value;
+	}
+}
+
+/* Pools are rebuilt by every run, drop the ones left by the previous run */
+static void remove_pools(const workload &w, const std::string &janus_pool)
+{
+	unlink(janus_pool.c_str());
+	for (size_t i = 1; i < w.argv.size(); i++)
+	{
+		if (w.argv[i].compare(0, opts.pmem_dir.size() + 1, opts.pmem_dir + "/") == 0)
+		{
+			unlink(w.argv[i].c_str());
+		}
+	}
+}
+
+static run_result run_workload(const workload &w, unsigned repeat)
+{
+	run_result result;
+	result.name = w.name;
+	result.repeat = repeat;
+
+	std::string roi_file = opts.pmem_dir + "/pmbench_" + w.name + ".roi";
+	std::string janus_pool = opts.pmem_dir + "/pmbench_" + w.name + ".pool";
+	remove_pools(w, janus_pool);
+	unlink(roi_file.c_str());
+
+	/* The child waits on the pipe until its counters are opened */
+	int go[2];
+	if (pipe(go) != 0)
+	{
+		perror("pipe");
+		exit(1);
+	}
+
+	uint64_t start = now_ns();
+	pid_t pid = fork();
+	if (pid < 0)
+	{
+		perror("fork");
+		exit(1);
+	}
+	if (pid == 0)
+	{
+		char token;
+		close(go[1]);
+		if (read(go[0], &token, 1) != 1)
+		{
+			_exit(127);
+		}
+		close(go[0]);
+
+		/* Workloads append their CSV reports to the working directory */
+		if (chdir(opts.pmem_dir.c_str()) != 0)
+		{
+			_exit(127);
+		}
+		setenv("PMBENCH_ROI_FILE", roi_file.c_str(), 1);
+		setenv("JANUS_PMEM_FILE", janus_pool.c_str(), 1);
+		if (opts.force_pmem)
+		{
+			/* tmpfs is not DAX, keep the cacheline flushes instead of msync */
+			setenv("PMEM_IS_PMEM_FORCE", "1", 1);
+		}
+		if (!opts.verbose)
+		{
+			int null = open("/dev/null", O_WRONLY);
+			dup2(null, STDOUT_FILENO);
+			dup2(null, STDERR_FILENO);
+			close(null);
+		}
+
+		std::vector<char *> argv;
+		for (auto &arg : w.argv)
+		{
+			argv.push_back((char *)arg.c_str());
+		}
+		argv.push_back(NULL);
+		execv(argv[0], argv.data());
+		fprintf(stderr, "execv %s: %s\n", argv[0], strerror(errno));
+		_exit(127);
+	}
+
+	close(go[0]);
+	std::vector<perf_counter> counters = process_counters();
+	open_counters(counters, pid);
+	if (write(go[1], "x", 1) != 1)
+	{
+		perror("write");
+	}
+	close(go[1]);
+
+	int status;
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+	{
+	}
+	result.wall_s = (now_ns() - start) / 1e9;
+	result.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+	read_counters(counters, result.process);
+	read_roi(roi_file, result.roi);
+	remove_pools(w, janus_pool);
+	unlink(roi_file.c_str());
+
+	result.ops = w.ops;
+	if (result.ops == 0 && result.roi.count("regions"))
+	{
+		result.ops = result.roi["regions"];
+	}
+	return result;
+}
+
+static void json_counters(std::ostream &out, const std::map<std::string, uint64_t> &values)
+{
+	out << "{";
+	const char *sep = "";
+	for (auto &v : values)
+	{
+		out << sep << "\"" << v.first << "\": " << v.second;
+		sep = ", ";
+	}
+	out << "}";
+}
+
+static void json_result(std::ostream &out, const run_result &r)
+{
+	bool has_roi = r.roi.count("regions") && r.roi.at("regions") != 0;
+	const std::map<std::string, uint64_t> &basis = has_roi ? r.roi : r.process;
+
+	out << "    {\"name\": \"" << r.name << "\", \"repeat\": " << r.repeat
+		<< ", \"status\": " << r.status << ", \"wall_s\": " << r.wall_s << ", \"ops\": " << r.ops << ",\n";
+	out << "     \"process\": ";
+	json_counters(out, r.process);
+	out << ",\n     \"roi\": ";
+	json_counters(out, r.roi);
+	out << ",\n     \"per_op_basis\": \"" << (has_roi ? "roi" : "process") << "\", \"per_op\": {";
+
+	const char *sep = "";
+	if (r.ops != 0)
+	{
+		for (auto &v : basis)
+		{
+			if (v.first == "regions")
+			{
+				continue;
+			}
+			out << sep << "\"" << v.first << "\": " << (double)v.second / r.ops;
+			sep = ", ";
+		}
+	}
+	out << "}";
+
+	double seconds = has_roi ? r.roi.at("ns") / 1e9 : r.wall_s;
+	if (r.ops != 0 && seconds > 0)
+	{
+		/* Region time is summed over the threads */
+		out << ", \"ops_per_s\": " << r.ops / seconds;
+	}
+	out << "}";
+}
+
+static void write_json(std::ostream &out, const std::vector<run_result> &results)
+{
+	struct utsname uts;
+	uname(&uts);
+
+	out << "{\n  \"host\": \"" << uts.nodename << "\", \"kernel\": \"" << uts.release
+		<< "\", \"pmem_dir\": \"" << opts.pmem_dir << "\", \"repeats\": " << opts.repeats << ",\n";
+	out << "  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		json_result(out, results[i]);
+		out << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+			"usage: %s [-c config] [-r repo root] [-p pmem dir] [-n repeats] [-o out.json]\n"
+			"          [-e name=rawconfig]... [-N] [-v] [workload...]\n"
+			"  -c  workload list, default workloads.cfg\n"
+			"  -r  replaces {root} in the workload list, default ../..\n"
+			"  -p  DAX or tmpfs directory of the pools, replaces {pmem}, default /dev/shm\n"
+			"  -e  extra raw perf event, e.g. -e clwb=<hex config>, also counted in the regions\n"
+			"  -N  do not set PMEM_IS_PMEM_FORCE (msync instead of flushes on non-DAX files)\n"
+			"  -v  show the workload output\n",
+			prog);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	std::string raw_env;
+
+	while ((opt = getopt(argc, argv, "c:r:p:n:o:e:Nvh")) != -1)
+	{
+		switch (opt)
+		{
+		case 'c':
+			opts.config = optarg;
+			break;
+		case 'r':
+			opts.root = optarg;
+			break;
+		case 'p':
+			opts.pmem_dir = optarg;
+			break;
+		case 'n':
+			opts.repeats = atoi(optarg);
+			break;
+		case 'o':
+			opts.output = optarg;
+			break;
+		case 'e':
+		{
+			char *sep = strchr(optarg, '=');
+			if (sep == NULL)
+			{
+				usage(argv[0]);
+			}
+			opts.raw_events.push_back({std::string(optarg, sep - optarg), strtoull(sep + 1, NULL, 16)});
+			raw_env += (raw_env.empty() ? "" : ",") + std::string(optarg);
+			break;
+		}
+		case 'N':
+			opts.force_pmem = false;
+			break;
+		case 'v':
+			opts.verbose = true;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	for (int i = optind; i < argc; i++)
+	{
+		opts.selected.push_back(argv[i]);
+	}
+	/* The workloads run from the pmem directory */
+	for (std::string *dir : {&opts.root, &opts.pmem_dir})
+	{
+		char *path = realpath(dir->c_str(), NULL);
+		if (path == NULL)
+		{
+			fprintf(stderr, "[%s] %s: %s\n", __func__, dir->c_str(), strerror(errno));
+			return 1;
+		}
+		*dir = path;
+		free(path);
+	}
+	if (!raw_env.empty())
+	{
+		/* Inherited by the workloads, read by roi.o */
+		setenv("PMBENCH_RAW_EVENTS", raw_env.c_str(), 1);
+	}
+
+	std::vector<workload> workloads = load_config(opts.config);
+	std::vector<run_result> results;
+
+	for (auto &w : workloads)
+	{
+		bool selected = opts.selected.empty();
+		for (auto &name : opts.selected)
+		{
+			selected |= name == w.name;
+		}
+		if (!selected)
+		{
+			continue;
+		}
+		if (access(w.argv[0].c_str(), X_OK) != 0)
+		{
+			fprintf(stderr, "[%s] Skipping %s, %s is not built\n", __func__, w.name.c_str(), w.argv[0].c_str());
+			continue;
+		}
+
+		for (unsigned i = 0; i < opts.repeats; i++)
+		{
+			run_result r = run_workload(w, i);
+			fprintf(stderr, "%s #%u: status %d, %.3f s, %lu ops\n", r.name.c_str(), i, r.status, r.wall_s, r.ops);
+			results.push_back(r);
+		}
+	}
+
+	if (opts.output.empty())
+	{
+		write_json(std::cout, results);
+	}
+	else
+	{
+		std::ofstream out(opts.output);
+		write_json(out, results);
+	}
+	return 0;
+}
@@ -0,0 +1,312 @@
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Native stand-in for the gem5 work markers, linked instead of m5op_x86.o.
+ *
+ * The region between m5_work_begin and m5_work_end is counted per thread with
+ * a perf event group that is only enabled inside the region. Threads fold
+ * their counts into the process totals when they exit, the totals are written
+ * to $PMBENCH_ROI_FILE at process exit for pmbench to pick up.
+ *
+ * Workloads linking the janus flush library also get the line flushes and
+ * fences issued inside the regions, the library is referenced weakly so the
+ * PMDK workloads link without it.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+	uint64_t flush_line_count(void) __attribute__((weak));
+	uint64_t flush_fence_count(void) __attribute__((weak));
+#ifdef __cplusplus
+}
+#endif
+
+#define ROI_MAX_EVENTS (8)
+
+struct roi_event
+{
+	char name[32];
+	uint32_t type;
+	uint64_t config;
+};
+
+struct roi_counters
+{
+	uint64_t regions;
+	uint64_t ns;
+	uint64_t flush_lines;
+	uint64_t fences;
+	uint64_t events[ROI_MAX_EVENTS];
+};
+
+struct roi_thread
+{
+	int initialized;
+	int group_fd;
+	int nopen;
+	int fds[ROI_MAX_EVENTS];
+	/* Slot of each opened group member in the read buffer, -1 if not open */
+	int slot[ROI_MAX_EVENTS];
+	unsigned depth;
+	uint64_t begin_ns;
+	uint64_t begin_flush_lines;
+	uint64_t begin_fences;
+	struct roi_counters counters;
+};
+
+static struct roi_event events[ROI_MAX_EVENTS];
+static int nevents = 0;
+/* Set once an event failed to open in some thread, its total is unreliable */
+static int event_failed[ROI_MAX_EVENTS];
+
+static struct roi_counters totals;
+static pthread_mutex_t totals_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_key;
+
+static __thread struct roi_thread thread_roi;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+}
+
+static void add_event(const char *name, uint32_t type, uint64_t config)
+{
+	if (nevents == ROI_MAX_EVENTS)
+	{
+		fprintf(stderr, "[%s] Ignoring %s, at most %d events\n", __func__, name, ROI_MAX_EVENTS);
+		return;
+	}
+	snprintf(events[nevents].name, sizeof(events[nevents].name), "%s", name);
+	events[nevents].type = type;
+	events[nevents].config = config;
+	nevents++;
+}
+
+/* PMBENCH_RAW_EVENTS=name=config[,name=config...], config in hex */
+static void parse_raw_events(const char *env)
+{
+	char *list = strdup(env);
+	char *save = NULL;
+
+	for (char *item = strtok_r(list, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save))
+	{
+		char *sep = strchr(item, '=');
+		if (sep == NULL)
+		{
+			fprintf(stderr, "[%s] Ignoring raw event %s, expected name=config\n", __func__, item);
+			continue;
+		}
+		*sep = '\0';
+		add_event(item, PERF_TYPE_RAW, strtoull(sep + 1, NULL, 16));
+	}
+	free(list);
+}
+
+static void fold_thread(void *arg);
+
+static void init_process(void)
+{
+	add_event("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	add_event("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	/* Retired stores on the cores that implement it */
+	add_event("stores", PERF_TYPE_HW_CACHE,
+			  PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_WRITE << 8) |
+				  (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16));
+
+	char *env = getenv("PMBENCH_RAW_EVENTS");
+	if (env != NULL)
+	{
+		parse_raw_events(env);
+	}
+
+	pthread_key_create(&thread_key, fold_thread);
+}
+
+static void init_thread(struct roi_thread *t)
+{
+	pthread_once(&init_once, init_process);
+
+	t->initialized = 1;
+	t->group_fd = -1;
+	t->nopen = 0;
+
+	for (int i = 0; i < nevents; i++)
+	{
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = events[i].type;
+		attr.config = events[i].config;
+		attr.disabled = t->group_fd == -1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+
+		int fd = syscall(SYS_perf_event_open, &attr, 0, -1, t->group_fd, 0);
+		if (fd < 0)
+		{
+			t->slot[i] = -1;
+			__atomic_store_n(&event_failed[i], 1, __ATOMIC_RELAXED);
+			continue;
+		}
+		if (t->group_fd == -1)
+		{
+			t->group_fd = fd;
+		}
+		t->fds[t->nopen] = fd;
+		t->slot[i] = t->nopen++;
+	}
+
+	/* Folded into the totals by the key destructor at thread exit */
+	pthread_setspecific(thread_key, t);
+}
+
+static void read_group(struct roi_thread *t, uint64_t *values)
+{
+	uint64_t buf[1 + ROI_MAX_EVENTS];
+
+	memset(values, 0, sizeof(uint64_t) * ROI_MAX_EVENTS);
+	if (t->group_fd == -1 || read(t->group_fd, buf, sizeof(uint64_t) * (1 + t->nopen)) <= 0)
+	{
+		return;
+	}
+	for (int i = 0; i < nevents; i++)
+	{
+		if (t->slot[i] != -1)
+		{
+			values[i] = buf[1 + t->slot[i]];
+		}
+	}
+}
+
+static void fold_thread(void *arg)
+{
+	struct roi_thread *t = (struct roi_thread *)arg;
+	uint64_t values[ROI_MAX_EVENTS];
+
+	/* Counters only run inside regions, their value is the thread total */
+	read_group(t, values);
+
+	pthread_mutex_lock(&totals_lock);
+	totals.regions += t->counters.regions;
+	totals.ns += t->counters.ns;
+	totals.flush_lines += t->counters.flush_lines;
+	totals.fences += t->counters.fences;
+	for (int i = 0; i < nevents; i++)
+	{
+		totals.events[i] += values[i];
+	}
+	pthread_mutex_unlock(&totals_lock);
+
+	for (int i = 0; i < t->nopen; i++)
+	{
+		close(t->fds[i]);
+	}
+	memset(t, 0, sizeof(*t));
+}
+
+void m5_work_begin(uint64_t workid, uint64_t threadid)
+{
+	struct roi_thread *t = &thread_roi;
+	(void)workid;
+	(void)threadid;
+
+	if (!t->initialized)
+	{
+		init_thread(t);
+	}
+	if (t->depth++ != 0)
+	{
+		return;
+	}
+
+	t->begin_flush_lines = flush_line_count ? flush_line_count() : 0;
+	t->begin_fences = flush_fence_count ? flush_fence_count() : 0;
+	t->begin_ns = now_ns();
+	if (t->group_fd != -1)
+	{
+		ioctl(t->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+void m5_work_end(uint64_t workid, uint64_t threadid)
+{
+	struct roi_thread *t = &thread_roi;
+	(void)workid;
+	(void)threadid;
+
+	if (t->depth == 0 || --t->depth != 0)
+	{
+		return;
+	}
+
+	if (t->group_fd != -1)
+	{
+		ioctl(t->group_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	}
+	t->counters.ns += now_ns() - t->begin_ns;
+	t->counters.regions++;
+	if (flush_line_count)
+	{
+		t->counters.flush_lines += flush_line_count() - t->begin_flush_lines;
+	}
+	if (flush_fence_count)
+	{
+		t->counters.fences += flush_fence_count() - t->begin_fences;
+	}
+}
+
+__attribute__((destructor)) static void write_totals(void)
+{
+	char *path = getenv("PMBENCH_ROI_FILE");
+
+	/* The main thread is not folded by the key destructor */
+	if (thread_roi.initialized)
+	{
+		fold_thread(&thread_roi);
+	}
+	if (path == NULL)
+	{
+		return;
+	}
+
+	FILE *file = fopen(path, "w");
+	if (file == NULL)
+	{
+		perror("fopen PMBENCH_ROI_FILE");
+		return;
+	}
+
+	pthread_mutex_lock(&totals_lock);
+	fprintf(file, "regions %lu\n", (unsigned long)totals.regions);
+	fprintf(file, "ns %lu\n", (unsigned long)totals.ns);
+	if (flush_line_count)
+	{
+		fprintf(file, "flush_lines %lu\n", (unsigned long)totals.flush_lines);
+		fprintf(file, "fences %lu\n", (unsigned long)totals.fences);
+	}
+	for (int i = 0; i < nevents; i++)
+	{
+		if (!event_failed[i])
+		{
+			fprintf(file, "%s %lu\n", events[i].name, (unsigned long)totals.events[i]);
+		}
+	}
+	pthread_mutex_unlock(&totals_lock);
+	fclose(file);
+}
@@ -2,8 +2,14 @@
 #include "stdio.h"
 #include <libpmem.h>
 #include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#ifdef _ENABLE_PMEM2
+#include <fcntl.h>
+#include <libpmem2.h>
+#include <unistd.h>
+#endif
 void *pmem_base_addr = NULL;
-uint64_t current_offset = 0UL;
 
 #ifdef GEM5
 #define PMEM_START_ADDR (NULL)
@@ -14,63 +20,119 @@ uint64_t current_offset = 0UL;
 #define PMEMFILE "/mnt/ramdisk/tatp"
 #define PMEMSIZE (1UL << 34)
 
+/* Overridden by JANUS_PMEM_FILE, e.g. for native runs on a tmpfs */
+static const char *pool_path(void)
+{
+	const char *path = getenv("JANUS_PMEM_FILE");
+	return path != NULL ? path : PMEMFILE;
+}
+
+#ifdef _ENABLE_PMEM2
+/*
+ * Maps the pool through libpmem2. Cache line granularity is enough for the
+ * flush library, when the platform flushes the caches on power loss (byte
+ * granularity) the flushes are skipped altogether.
+ */
+static void *map_pool(size_t size)
+{
+	struct pmem2_config *cfg;
+	struct pmem2_source *src;
+	struct pmem2_map *map;
+
+	int fd = open(pool_path(), O_CREAT | O_RDWR, 0666);
+	if (fd < 0 || ftruncate(fd, (off_t)size) != 0)
+	{
+		perror("open pool");
+		return NULL;
+	}
+	if (pmem2_config_new(&cfg) != 0 || pmem2_source_from_fd(&src, fd) != 0)
+	{
+		fprintf(stderr, "pmem2: %s\n", pmem2_errormsg());
+		close(fd);
+		return NULL;
+	}
+	pmem2_config_set_required_store_granularity(cfg, PMEM2_GRANULARITY_CACHE_LINE);
+	int ret = pmem2_map(cfg, src, &map);
+	pmem2_source_delete(&src);
+	pmem2_config_delete(&cfg);
+	/* The mapping stays valid after the descriptor is closed */
+	close(fd);
+	if (ret != 0)
+	{
+		fprintf(stderr, "pmem2_map: %s\n", pmem2_errormsg());
+		return NULL;
+	}
+	if (pmem2_map_get_store_granularity(map) == PMEM2_GRANULARITY_BYTE)
+	{
+		flush_set_backend(FLUSH_BACKEND_NONE);
+	}
+	return pmem2_map_get_address(map);
+}
+#else
+static void *map_pool(size_t size)
+{
+	return pmem_map_file(pool_path(), size, PMEM_FILE_CREATE, 0x666, 0, 0);
+}
+#endif
+
 void *mmap_persistent(void *start, size_t length, int prot, int flags, int fd, off_t offset)
 {
 	// printf("Using syscall id %d\n", MMAP_PERSISTENT);
 	// return (void*)syscall(MMAP_PERSISTENT, start, length, prot, flags, fd, offset);
-	return pmem_map_file(PMEMFILE, PMEMSIZE, PMEM_FILE_CREATE, 0x666, 0, 0);
+	return map_pool(PMEMSIZE);
 }
 
-void *pmalloc(size_t length)
+static pthread_once_t pmalloc_once = PTHREAD_ONCE_INIT;
+
+static void map_and_format_pool(void)
 {
-	// void *ptr = (void*)NULL;
-	// ptr = mmap_persistent((void*)PMEM_START_ADDR, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
-	// printf("Allocation at %p for size %zu returned %p\n", (void*)PMEM_START_ADDR, length, (void*)ptr);
+	// pmem_base_addr = mmap_persistent(NULL, 1024UL*1024UL*1024UL, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
+	pmem_base_addr = map_pool(PMEMSIZE);
+	assert(pmem_base_addr != nullptr);
 
-	void *toRet = pmem_base_addr;
-	pmem_base_addr = ((char *)pmem_base_addr) + length;
-	return toRet;
+	/* Workloads rebuild their data every run, start from an empty pool */
+	int ret = pma_create(pmem_base_addr, PMEMSIZE);
+	assert(ret == 0);
 }
 
-/*
-// We need this to bypass buggy pmalloc.
-void *pmalloc(size_t length) {
-//  return malloc(length);
-  void* alloc_pmem_base = (void*)((uint64_t)pmem_base_addr +current_offset);
-  current_offset += length;
-  return alloc_pmem_base;
+/* Safe to call from any number of threads, the pool is set up only once */
+void init_pmalloc()
+{
+	pthread_once(&pmalloc_once, map_and_format_pool);
 }
-*/
 
-void init_pmalloc()
+void *pmalloc(size_t length)
 {
-	// pmem_base_addr = mmap_persistent(NULL, 1024UL*1024UL*1024UL, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
-	pmem_base_addr = pmem_map_file(PMEMFILE, PMEMSIZE, PMEM_FILE_CREATE, 0x666, 0, 0);
-	assert(pmem_base_addr != nullptr);
+	init_pmalloc();
+	return pma_alloc(length);
+}
+
+void pfree(void *ptr)
+{
+	pma_free(ptr);
 }
 
 void *aligned_malloc(size_t alignment, size_t size)
 {
+	/* Allocations are line aligned, larger alignments cannot be freed */
+	if (alignment <= PMA_LINE_SIZE)
+	{
+		return pmalloc(size);
+	}
 	return (void *)(((uint64_t)pmalloc(size + alignment) + alignment - 1UL) / alignment * alignment);
 }
 
 void cache_flush(void *addr, size_t size)
 {
-	// uint64_t startAddr = (((uint64_t)addr) >> 6) * 64UL;
-	// uint64_t endAddr = (((uint64_t)addr + (uint64_t)size + 63UL) >> 6) * 64UL;
-
-	// for (uint64_t curAddr = startAddr; curAddr < endAddr; curAddr += 64UL)
-	// {
-	// 	_mm_clwb((void *)curAddr);
-	// }
+	flush_range(addr, size);
 }
 
 void flush_caches(void *addr, size_t size)
 {
-	// cache_flush(addr, size);
+	cache_flush(addr, size);
 }
 
 void s_fence(void)
 {
-	_mm_sfence();
+	flush_fence();
 }
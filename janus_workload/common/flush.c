@@ -0,0 +1,279 @@
+#include "flush.h"
+#include <immintrin.h>
+#include <x86intrin.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PMEM_NO_FLUSH
+#define PMEM_NO_FLUSH 0
+#endif
+
+#define BACKEND_UNINITIALIZED (-1)
+
+static int selected_backend = BACKEND_UNINITIALIZED;
+
+static __thread struct flush_set thread_set;
+static __thread uint64_t thread_line_flushes;
+static __thread uint64_t thread_fences;
+
+static const char *backend_names[] = {"clwb", "clflushopt", "clflush", "nt", "none"};
+
+static void init_backend(void)
+{
+	int backend = PMEM_NO_FLUSH ? FLUSH_BACKEND_NONE : FLUSH_BACKEND_CLWB;
+	char *env = getenv("JANUS_FLUSH_BACKEND");
+
+	if (env != NULL)
+	{
+		int found = 0;
+		for (int i = 0; i <= FLUSH_BACKEND_NONE; i++)
+		{
+			if (strcmp(env, backend_names[i]) == 0)
+			{
+				backend = i;
+				found = 1;
+			}
+		}
+		if (!found)
+		{
+			fprintf(stderr, "[%s] Unknown JANUS_FLUSH_BACKEND %s, using %s\n",
+					__func__, env, backend_names[backend]);
+		}
+	}
+
+	selected_backend = backend;
+}
+
+void flush_set_backend(enum flush_backend backend)
+{
+	selected_backend = backend;
+}
+
+enum flush_backend flush_get_backend(void)
+{
+	if (selected_backend == BACKEND_UNINITIALIZED)
+	{
+		init_backend();
+	}
+	return (enum flush_backend)selected_backend;
+}
+
+const char *flush_backend_name(enum flush_backend backend)
+{
+	return backend_names[backend];
+}
+
+__attribute__((target("clwb"))) static void flush_line_clwb(uintptr_t line)
+{
+	_mm_clwb((void *)line);
+}
+
+__attribute__((target("clflushopt"))) static void flush_line_clflushopt(uintptr_t line)
+{
+	_mm_clflushopt((void *)line);
+}
+
+static void flush_line(enum flush_backend backend, uintptr_t line)
+{
+	switch (backend)
+	{
+	case FLUSH_BACKEND_CLWB:
+	case FLUSH_BACKEND_NT:
+		flush_line_clwb(line);
+		break;
+	case FLUSH_BACKEND_CLFLUSHOPT:
+		flush_line_clflushopt(line);
+		break;
+	case FLUSH_BACKEND_CLFLUSH:
+		_mm_clflush((void *)line);
+		break;
+	case FLUSH_BACKEND_NONE:
+		return;
+	}
+	thread_line_flushes++;
+}
+
+void flush_range(const void *addr, size_t size)
+{
+	enum flush_backend backend = flush_get_backend();
+	if (backend == FLUSH_BACKEND_NONE || size == 0)
+	{
+		return;
+	}
+
+	uintptr_t start = ((uintptr_t)addr) & ~(FLUSH_LINE_SIZE - 1);
+	uintptr_t end = (uintptr_t)addr + size;
+
+	for (uintptr_t line = start; line < end; line += FLUSH_LINE_SIZE)
+	{
+		flush_line(backend, line);
+	}
+}
+
+void flush_fence(void)
+{
+	/* Kept with the none backend, eADR runs still order their stores */
+	_mm_sfence();
+	thread_fences++;
+}
+
+/* Writes back the lines of [addr, addr + size) now or through the thread's set */
+static void flush_or_defer(const void *addr, size_t size, int defer)
+{
+	if (defer)
+	{
+		flush_defer(addr, size);
+	}
+	else
+	{
+		flush_range(addr, size);
+	}
+}
+
+static void copy_nt(void *dst, const void *src, size_t size, int defer)
+{
+	/* Aligned 8 byte words use streaming stores, the rest is flushed */
+	char *d = (char *)dst;
+	const char *s = (const char *)src;
+	size_t head = (8 - ((uintptr_t)d & 7)) & 7;
+	if (head > size)
+	{
+		head = size;
+	}
+
+	if (head != 0)
+	{
+		memcpy(d, s, head);
+		flush_or_defer(d, head, defer);
+		d += head;
+		s += head;
+		size -= head;
+	}
+
+	for (; size >= 8; size -= 8, d += 8, s += 8)
+	{
+		long long word;
+		memcpy(&word, s, 8);
+		_mm_stream_si64((long long *)d, word);
+	}
+
+	if (size != 0)
+	{
+		memcpy(d, s, size);
+		flush_or_defer(d, size, defer);
+	}
+}
+
+void flush_memcpy(void *dst, const void *src, size_t size)
+{
+	if (flush_get_backend() != FLUSH_BACKEND_NT)
+	{
+		memcpy(dst, src, size);
+		flush_range(dst, size);
+		return;
+	}
+	copy_nt(dst, src, size, 0);
+}
+
+void flush_memcpy_defer(void *dst, const void *src, size_t size)
+{
+	if (flush_get_backend() != FLUSH_BACKEND_NT)
+	{
+		memcpy(dst, src, size);
+		flush_defer(dst, size);
+		return;
+	}
+	copy_nt(dst, src, size, 1);
+}
+
+void flush_set_init(struct flush_set *set)
+{
+	set->count = 0;
+}
+
+static void flush_set_drain(struct flush_set *set)
+{
+	enum flush_backend backend = flush_get_backend();
+	for (size_t i = 0; i < set->count; i++)
+	{
+		flush_line(backend, set->lines[i]);
+	}
+	set->count = 0;
+}
+
+static void flush_set_insert(struct flush_set *set, uintptr_t line)
+{
+	/* Binary search for the insertion point, duplicates are coalesced */
+	size_t lo = 0, hi = set->count;
+	while (lo < hi)
+	{
+		size_t mid = (lo + hi) / 2;
+		if (set->lines[mid] < line)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	if (lo < set->count && set->lines[lo] == line)
+	{
+		return;
+	}
+
+	/* Flushing early is safe, only the fence is deferred */
+	if (set->count == FLUSH_SET_CAPACITY)
+	{
+		flush_set_drain(set);
+		lo = 0;
+	}
+
+	memmove(&set->lines[lo + 1], &set->lines[lo], (set->count - lo) * sizeof(uintptr_t));
+	set->lines[lo] = line;
+	set->count++;
+}
+
+void flush_set_add(struct flush_set *set, const void *addr, size_t size)
+{
+	if (flush_get_backend() == FLUSH_BACKEND_NONE || size == 0)
+	{
+		return;
+	}
+
+	uintptr_t start = ((uintptr_t)addr) & ~(FLUSH_LINE_SIZE - 1);
+	uintptr_t end = (uintptr_t)addr + size;
+
+	for (uintptr_t line = start; line < end; line += FLUSH_LINE_SIZE)
+	{
+		flush_set_insert(set, line);
+	}
+}
+
+void flush_set_commit(struct flush_set *set)
+{
+	flush_set_drain(set);
+	flush_fence();
+}
+
+void flush_defer(const void *addr, size_t size)
+{
+	flush_set_add(&thread_set, addr, size);
+}
+
+void flush_commit(void)
+{
+	flush_set_commit(&thread_set);
+}
+
+uint64_t flush_line_count(void)
+{
+	return thread_line_flushes;
+}
+
+uint64_t flush_fence_count(void)
+{
+	return thread_fences;
+}
@@ -0,0 +1,78 @@
+#ifndef _FLUSH_H_
+#define _FLUSH_H_
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Cacheline flush library shared by the janus workloads.
+ *
+ * The backend is selected using the JANUS_FLUSH_BACKEND environment variable
+ * (clwb, clflushopt, clflush, nt or none) or flush_set_backend(), clwb is the
+ * default. Builds with PMEM_NO_FLUSH (eADR) default to none.
+ *
+ * Flushes can either be issued immediately (flush_range) or deferred into a
+ * flush set. A flush set coalesces the lines of all the ranges added to it
+ * and writes them back in a single pass followed by a single sfence. Each
+ * thread has an implicit flush set used by flush_defer/flush_commit.
+ *
+ * The workloads write their logs and backup copies with flush_memcpy or
+ * flush_memcpy_defer, which is where the nt backend differs from clwb.
+ */
+
+#define FLUSH_LINE_SIZE (64UL)
+#define FLUSH_SET_CAPACITY (256)
+
+enum flush_backend
+{
+	FLUSH_BACKEND_CLWB = 0,
+	FLUSH_BACKEND_CLFLUSHOPT,
+	FLUSH_BACKEND_CLFLUSH,
+	/* Stores are made non-temporal, flushes of cached data use clwb */
+	FLUSH_BACKEND_NT,
+	FLUSH_BACKEND_NONE,
+};
+
+struct flush_set
+{
+	/* Line aligned addresses, sorted and without duplicates */
+	uintptr_t lines[FLUSH_SET_CAPACITY];
+	size_t count;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+	void flush_set_backend(enum flush_backend backend);
+	enum flush_backend flush_get_backend(void);
+	const char *flush_backend_name(enum flush_backend backend);
+
+	/* Writes back all the lines covering [addr, addr + size), no fence */
+	void flush_range(const void *addr, size_t size);
+
+	/* Orders the preceding flushes and non-temporal stores */
+	void flush_fence(void);
+
+	/* Copies to persistent memory using the selected backend, no fence */
+	void flush_memcpy(void *dst, const void *src, size_t size);
+
+	/* Same, the lines that need a writeback go to the thread's flush set */
+	void flush_memcpy_defer(void *dst, const void *src, size_t size);
+
+	void flush_set_init(struct flush_set *set);
+	void flush_set_add(struct flush_set *set, const void *addr, size_t size);
+
+	/* Flushes all the lines in the set followed by a single fence */
+	void flush_set_commit(struct flush_set *set);
+
+	/* Per-thread flush set */
+	void flush_defer(const void *addr, size_t size);
+	void flush_commit(void);
+
+	/* Number of line flushes and fences issued by the calling thread */
+	uint64_t flush_line_count(void);
+	uint64_t flush_fence_count(void);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,311 @@
+#ifndef _LOG_ENGINE_H_
+#define _LOG_ENGINE_H_
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flush.h"
+
+/*
+ * Per-thread persistent transaction log shared by the janus workloads.
+ *
+ * Writes made through a log are staged and become visible at commit. Log
+ * records are appended to a deferred flush set, so a transaction pays for
+ * its log with fences at commit only:
+ *
+ *   LOG_REDO    Records hold the new value. The records and the commit
+ *               record are persisted by a single fence, then the writes are
+ *               applied in place. The in-place lines are written back by the
+ *               next fence of the thread (no-force).
+ *
+ *   LOG_HYBRID  Records hold the old and the new value. One fence persists
+ *               the records, the writes are applied in place before the
+ *               commit record is persisted by a second fence. The undo
+ *               images cover in-place lines evicted before the commit, the
+ *               redo images the lines not yet written back after it.
+ *
+ * The log area is split in two halves used by alternate transactions. A half
+ * is reused once the next transaction's commit fence has written back the
+ * in-place lines of the transaction that used it.
+ */
+
+enum log_protocol
+{
+	LOG_REDO,
+	LOG_HYBRID,
+};
+
+template <log_protocol Protocol, size_t LogSize = 64 * 1024, size_t MaxWrites = 512>
+class tx_log
+{
+private:
+	enum record_kind
+	{
+		RECORD_WRITE = 1,
+		RECORD_COMMIT,
+	};
+
+	struct record
+	{
+		uint64_t addr;
+		uint32_t size;
+		uint32_t kind;
+		uint64_t seq;
+		uint64_t checksum;
+	};
+
+	struct pending_write
+	{
+		void *addr;
+		size_t size;
+		/* Offset of the new value in the current half */
+		size_t redo_offset;
+	};
+
+	static const size_t HALF_SIZE = LogSize / 2;
+
+	char *area = NULL;
+	uint64_t seq = 1;
+	size_t tail = 0;
+	size_t npending = 0;
+	pending_write pending[MaxWrites];
+
+	static size_t align8(size_t size)
+	{
+		return (size + 7) & ~7UL;
+	}
+
+	static uint64_t hash(uint64_t h, const void *data, size_t size)
+	{
+		const unsigned char *bytes = (const unsigned char *)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			h = (h ^ bytes[i]) * 0x100000001b3UL;
+		}
+		return h;
+	}
+
+	static uint64_t record_checksum(const record *rec)
+	{
+		uint64_t h = 0xcbf29ce484222325UL;
+		h = hash(h, &rec->addr, sizeof(rec->addr));
+		h = hash(h, &rec->size, sizeof(rec->size));
+		h = hash(h, &rec->kind, sizeof(rec->kind));
+		h = hash(h, &rec->seq, sizeof(rec->seq));
+		return hash(h, rec + 1, images_size(rec->kind, rec->size));
+	}
+
+	static size_t images_size(uint32_t kind, size_t size)
+	{
+		if (kind != RECORD_WRITE)
+		{
+			return 0;
+		}
+		return Protocol == LOG_HYBRID ? 2 * align8(size) : align8(size);
+	}
+
+	char *half_base() const
+	{
+		return area + (seq % 2) * HALF_SIZE;
+	}
+
+	record *append(uint32_t kind, void *addr, size_t size)
+	{
+		size_t record_size = sizeof(record) + images_size(kind, size);
+		if (tail + record_size > HALF_SIZE)
+		{
+			fprintf(stderr, "[%s] Transaction does not fit in a %lu B log half\n", __func__, HALF_SIZE);
+			abort();
+		}
+
+		record *rec = (record *)(half_base() + tail);
+		rec->addr = (uint64_t)addr;
+		rec->size = size;
+		rec->kind = kind;
+		rec->seq = seq;
+		tail += record_size;
+		return rec;
+	}
+
+	/* The images were copied with flush_memcpy_defer, which leaves the header
+	 * and the padding after each image, both covered by the checksum */
+	void seal(record *rec)
+	{
+		rec->checksum = record_checksum(rec);
+		flush_defer(rec, sizeof(record));
+
+		char *image = (char *)(rec + 1);
+		char *end = image + images_size(rec->kind, rec->size);
+		for (; image < end; image += align8(rec->size))
+		{
+			flush_defer(image + rec->size, align8(rec->size) - rec->size);
+		}
+	}
+
+	void apply_writes()
+	{
+		for (size_t i = 0; i < npending; i++)
+		{
+			flush_memcpy_defer(pending[i].addr, half_base() + pending[i].redo_offset, pending[i].size);
+		}
+	}
+
+	/* Records of the transaction that used the half, stops at a torn one */
+	static size_t scan_half(char *base, uint64_t &half_seq, bool &committed)
+	{
+		size_t offset = 0;
+		half_seq = 0;
+		committed = false;
+
+		while (offset + sizeof(record) <= HALF_SIZE)
+		{
+			record *rec = (record *)(base + offset);
+			if ((rec->kind != RECORD_WRITE && rec->kind != RECORD_COMMIT) ||
+				offset + sizeof(record) + images_size(rec->kind, rec->size) > HALF_SIZE ||
+				(half_seq != 0 && rec->seq != half_seq) || rec->checksum != record_checksum(rec))
+			{
+				break;
+			}
+			half_seq = rec->seq;
+			offset += sizeof(record) + images_size(rec->kind, rec->size);
+			if (rec->kind == RECORD_COMMIT)
+			{
+				committed = true;
+				break;
+			}
+		}
+		return offset;
+	}
+
+	static void replay_half(char *base, size_t length, bool committed)
+	{
+		/* Committed: redo forward, otherwise undo backward */
+		record *records[MaxWrites];
+		size_t nrecords = 0;
+		for (size_t offset = 0; offset < length;)
+		{
+			record *rec = (record *)(base + offset);
+			if (rec->kind == RECORD_WRITE && nrecords < MaxWrites)
+			{
+				records[nrecords++] = rec;
+			}
+			offset += sizeof(record) + images_size(rec->kind, rec->size);
+		}
+
+		for (size_t i = 0; i < nrecords; i++)
+		{
+			record *rec = committed ? records[i] : records[nrecords - 1 - i];
+			char *images = (char *)(rec + 1);
+			char *image = (committed && Protocol == LOG_HYBRID) ? images + align8(rec->size) : images;
+			if (!committed && Protocol == LOG_REDO)
+			{
+				continue;
+			}
+			flush_memcpy((void *)rec->addr, image, rec->size);
+		}
+	}
+
+public:
+	static size_t area_size()
+	{
+		return LogSize;
+	}
+
+	/* area is a persistent region of area_size() bytes */
+	void init(void *log_area)
+	{
+		area = (char *)log_area;
+		memset(area, 0, LogSize);
+		flush_range(area, LogSize);
+		flush_fence();
+		seq = 1;
+		tail = 0;
+		npending = 0;
+	}
+
+	/* Stages a write of size bytes from src to addr */
+	void write(void *addr, const void *src, size_t size)
+	{
+		assert(npending < MaxWrites);
+
+		record *rec = append(RECORD_WRITE, addr, size);
+		char *images = (char *)(rec + 1);
+		if (Protocol == LOG_HYBRID)
+		{
+			flush_memcpy_defer(images, addr, size);
+			images += align8(size);
+		}
+		flush_memcpy_defer(images, src, size);
+		seal(rec);
+
+		pending[npending].addr = addr;
+		pending[npending].size = size;
+		pending[npending].redo_offset = images - half_base();
+		npending++;
+	}
+
+	template <typename T>
+	void write(T *addr, const T &value)
+	{
+		write((void *)addr, &value, sizeof(T));
+	}
+
+	void commit()
+	{
+		if (npending == 0)
+		{
+			return;
+		}
+
+		if (Protocol == LOG_REDO)
+		{
+			seal(append(RECORD_COMMIT, NULL, 0));
+			flush_commit();
+			apply_writes();
+		}
+		else
+		{
+			flush_commit();
+			apply_writes();
+
+			/* In-place lines stay in the flush set for the next fence */
+			record *rec = append(RECORD_COMMIT, NULL, 0);
+			rec->checksum = record_checksum(rec);
+			flush_range(rec, sizeof(record));
+			flush_fence();
+		}
+
+		seq++;
+		tail = 0;
+		npending = 0;
+	}
+
+	/* Rolls the log area forward or back after a crash */
+	static void recover(void *log_area)
+	{
+		char *halves[2] = {(char *)log_area, (char *)log_area + HALF_SIZE};
+		uint64_t seqs[2];
+		bool committed[2];
+		size_t lengths[2];
+
+		for (int i = 0; i < 2; i++)
+		{
+			lengths[i] = scan_half(halves[i], seqs[i], committed[i]);
+		}
+
+		/* Older transaction first */
+		int first = seqs[0] <= seqs[1] ? 0 : 1;
+		for (int i = 0; i < 2; i++)
+		{
+			int half = (first + i) % 2;
+			if (lengths[half] != 0)
+			{
+				replay_half(halves[half], lengths[half], committed[half]);
+			}
+		}
+		flush_fence();
+	}
+};
+
+#endif
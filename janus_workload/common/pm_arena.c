@@ -0,0 +1,378 @@
+#include "pm_arena.h"
+#include "flush.h"
+#include <immintrin.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PMA_MAGIC (0x4a414e55534d4131UL)
+#define PMA_CHUNK_MAGIC (0x4a414e5553434b31UL)
+
+/* Chunk header and allocation bitmap, the blocks of a slab follow it */
+#define PMA_CHUNK_HEADER_SIZE (640UL)
+#define PMA_BITMAP_WORDS (64)
+
+enum chunk_kind
+{
+	CHUNK_SLAB = 1,
+	CHUNK_LARGE,
+	CHUNK_FREE,
+};
+
+struct pool_header
+{
+	uint64_t magic;
+	uint64_t pool_size;
+	uint64_t chunk_size;
+	uint64_t nchunks;
+	/* Chunks below the watermark have a valid chunk header */
+	uint64_t watermark;
+};
+
+struct chunk_header
+{
+	uint64_t magic;
+	uint32_t kind;
+	uint32_t size_class;
+	uint32_t arena;
+	uint32_t nblocks;
+	/* Chunks in the run, 1 for a slab */
+	uint64_t nchunks;
+	/* Pool offset of the next free run */
+	uint64_t next_free;
+	uint64_t reserved[3];
+	uint64_t bitmap[PMA_BITMAP_WORDS];
+};
+
+struct free_block
+{
+	struct free_block *next;
+};
+
+struct size_class_state
+{
+	struct chunk_header *slab;
+	uint32_t next_block;
+	struct free_block *free_list;
+};
+
+static const uint32_t size_classes[] = {
+	64, 128, 192, 256, 320, 384, 448, 512,
+	640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+	2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192,
+	10240, 12288, 14336, 16384};
+
+#define PMA_NUM_CLASSES (sizeof(size_classes) / sizeof(size_classes[0]))
+
+struct arena
+{
+	volatile int lock;
+	struct size_class_state classes[PMA_NUM_CLASSES];
+} __attribute__((aligned(64)));
+
+static struct
+{
+	char *base;
+	struct pool_header *header;
+	volatile int lock;
+	struct chunk_header *free_runs;
+	struct arena arenas[PMA_MAX_ARENAS];
+} pool;
+
+static __thread int thread_arena = -1;
+static int next_arena = 0;
+
+static void pma_lock(volatile int *lock)
+{
+	while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE))
+	{
+		while (__atomic_load_n(lock, __ATOMIC_RELAXED))
+		{
+			_mm_pause();
+		}
+	}
+}
+
+static void pma_unlock(volatile int *lock)
+{
+	__atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+static void persist(const void *addr, size_t size)
+{
+	flush_range(addr, size);
+	flush_fence();
+}
+
+static struct arena *get_arena(void)
+{
+	if (thread_arena < 0)
+	{
+		thread_arena = __atomic_fetch_add(&next_arena, 1, __ATOMIC_RELAXED) % PMA_MAX_ARENAS;
+	}
+	return &pool.arenas[thread_arena];
+}
+
+static struct chunk_header *chunk_at(uint64_t index)
+{
+	return (struct chunk_header *)(pool.base + PMA_HEADER_SIZE + index * PMA_CHUNK_SIZE);
+}
+
+static struct chunk_header *chunk_of(void *ptr)
+{
+	uint64_t offset = (uint64_t)((char *)ptr - pool.base) - PMA_HEADER_SIZE;
+	return chunk_at(offset / PMA_CHUNK_SIZE);
+}
+
+/* Free run links are pool offsets, 0 (the pool header) ends the list */
+static struct chunk_header *run_at(uint64_t offset)
+{
+	return offset ? (struct chunk_header *)(pool.base + offset) : NULL;
+}
+
+static uint64_t run_offset(struct chunk_header *run)
+{
+	return run ? (uint64_t)((char *)run - pool.base) : 0;
+}
+
+static char *slab_block(struct chunk_header *slab, uint32_t index)
+{
+	return (char *)slab + PMA_CHUNK_HEADER_SIZE + (size_t)index * size_classes[slab->size_class];
+}
+
+static int size_class_of(size_t size)
+{
+	for (size_t i = 0; i < PMA_NUM_CLASSES; i++)
+	{
+		if (size <= size_classes[i])
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+static void init_volatile_state(void *base)
+{
+	memset(&pool, 0, sizeof(pool));
+	pool.base = (char *)base;
+	pool.header = (struct pool_header *)base;
+}
+
+/* Writes and persists the header of a run of chunks */
+static void init_chunk(struct chunk_header *chunk, uint32_t kind, uint64_t nchunks,
+					   uint32_t size_class, uint32_t arena)
+{
+	size_t header_size = kind == CHUNK_SLAB ? sizeof(struct chunk_header) : PMA_LINE_SIZE;
+
+	memset(chunk, 0, header_size);
+	chunk->magic = PMA_CHUNK_MAGIC;
+	chunk->kind = kind;
+	chunk->nchunks = nchunks;
+	chunk->size_class = size_class;
+	chunk->arena = arena;
+	if (kind == CHUNK_SLAB)
+	{
+		chunk->nblocks = (PMA_CHUNK_SIZE - PMA_CHUNK_HEADER_SIZE) / size_classes[size_class];
+	}
+	persist(chunk, header_size);
+}
+
+/* Takes a run of chunks from the free runs or from above the watermark */
+static struct chunk_header *take_chunks(uint64_t nchunks, uint32_t kind,
+										uint32_t size_class, uint32_t arena)
+{
+	struct chunk_header *chunk = NULL;
+
+	pma_lock(&pool.lock);
+
+	/* First fit over the free runs, the tail of a larger run stays free */
+	struct chunk_header *prev = NULL;
+	for (struct chunk_header *run = pool.free_runs; run != NULL; prev = run, run = run_at(run->next_free))
+	{
+		if (run->nchunks < nchunks)
+		{
+			continue;
+		}
+
+		uint64_t next = run->next_free;
+		if (run->nchunks > nchunks)
+		{
+			struct chunk_header *rest = (struct chunk_header *)((char *)run + nchunks * PMA_CHUNK_SIZE);
+			init_chunk(rest, CHUNK_FREE, run->nchunks - nchunks, 0, 0);
+			rest->next_free = run->next_free;
+			next = run_offset(rest);
+		}
+
+		if (prev != NULL)
+		{
+			prev->next_free = next;
+		}
+		else
+		{
+			pool.free_runs = run_at(next);
+		}
+		chunk = run;
+		break;
+	}
+
+	if (chunk == NULL)
+	{
+		struct pool_header *header = pool.header;
+		if (header->watermark + nchunks > header->nchunks)
+		{
+			pma_unlock(&pool.lock);
+			return NULL;
+		}
+		chunk = chunk_at(header->watermark);
+		init_chunk(chunk, kind, nchunks, size_class, arena);
+		header->watermark += nchunks;
+		persist(&header->watermark, sizeof(header->watermark));
+	}
+	else
+	{
+		init_chunk(chunk, kind, nchunks, size_class, arena);
+	}
+
+	pma_unlock(&pool.lock);
+	return chunk;
+}
+
+int pma_create(void *base, size_t size)
+{
+	if (size < PMA_HEADER_SIZE + PMA_CHUNK_SIZE)
+	{
+		fprintf(stderr, "[%s] Pool of %lu bytes is too small\n", __func__, size);
+		return -1;
+	}
+
+	init_volatile_state(base);
+
+	struct pool_header *header = pool.header;
+	header->magic = 0;
+	persist(&header->magic, sizeof(header->magic));
+
+	header->pool_size = size;
+	header->chunk_size = PMA_CHUNK_SIZE;
+	header->nchunks = (size - PMA_HEADER_SIZE) / PMA_CHUNK_SIZE;
+	header->watermark = 0;
+	persist(header, sizeof(*header));
+
+	/* Magic last, a partially formatted pool is not valid */
+	header->magic = PMA_MAGIC;
+	persist(&header->magic, sizeof(header->magic));
+	return 0;
+}
+
+static void *alloc_small(int size_class)
+{
+	struct arena *arena = get_arena();
+	struct size_class_state *state = &arena->classes[size_class];
+	char *block;
+
+	pma_lock(&arena->lock);
+	if (state->free_list != NULL)
+	{
+		block = (char *)state->free_list;
+		state->free_list = state->free_list->next;
+	}
+	else
+	{
+		if (state->slab == NULL || state->next_block == state->slab->nblocks)
+		{
+			struct chunk_header *slab = take_chunks(1, CHUNK_SLAB, size_class, (uint32_t)(arena - pool.arenas));
+			if (slab == NULL)
+			{
+				pma_unlock(&arena->lock);
+				return NULL;
+			}
+			state->slab = slab;
+			state->next_block = 0;
+		}
+		block = slab_block(state->slab, state->next_block++);
+	}
+
+	struct chunk_header *slab = chunk_of(block);
+	uint32_t index = (uint32_t)((block - (char *)slab - PMA_CHUNK_HEADER_SIZE) / size_classes[size_class]);
+	slab->bitmap[index / 64] |= 1UL << (index % 64);
+	persist(&slab->bitmap[index / 64], sizeof(uint64_t));
+	pma_unlock(&arena->lock);
+
+	return block;
+}
+
+static void *alloc_large(size_t size)
+{
+	uint64_t nchunks = (size + PMA_LINE_SIZE + PMA_CHUNK_SIZE - 1) / PMA_CHUNK_SIZE;
+	struct chunk_header *run = take_chunks(nchunks, CHUNK_LARGE, 0, 0);
+	if (run == NULL)
+	{
+		return NULL;
+	}
+	return (char *)run + PMA_LINE_SIZE;
+}
+
+void *pma_alloc(size_t size)
+{
+	if (pool.base == NULL)
+	{
+		fprintf(stderr, "[%s] No pool\n", __func__);
+		return NULL;
+	}
+
+	int size_class = size_class_of(size == 0 ? 1 : size);
+	void *ptr = size_class < 0 ? alloc_large(size) : alloc_small(size_class);
+	if (ptr == NULL)
+	{
+		fprintf(stderr, "[%s] Out of persistent memory allocating %lu bytes\n", __func__, size);
+	}
+	return ptr;
+}
+
+void pma_free(void *ptr)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	struct chunk_header *chunk = chunk_of(ptr);
+	if (chunk->kind == CHUNK_LARGE)
+	{
+		/* Free runs are not coalesced, workloads free large blocks rarely */
+		pma_lock(&pool.lock);
+		chunk->kind = CHUNK_FREE;
+		chunk->next_free = run_offset(pool.free_runs);
+		persist(chunk, PMA_LINE_SIZE);
+		pool.free_runs = chunk;
+		pma_unlock(&pool.lock);
+		return;
+	}
+
+	struct arena *arena = &pool.arenas[chunk->arena % PMA_MAX_ARENAS];
+	struct size_class_state *state = &arena->classes[chunk->size_class];
+	uint32_t index = (uint32_t)(((char *)ptr - (char *)chunk - PMA_CHUNK_HEADER_SIZE) / size_classes[chunk->size_class]);
+
+	pma_lock(&arena->lock);
+	chunk->bitmap[index / 64] &= ~(1UL << (index % 64));
+	persist(&chunk->bitmap[index / 64], sizeof(uint64_t));
+
+	struct free_block *block = (struct free_block *)ptr;
+	block->next = state->free_list;
+	state->free_list = block;
+	pma_unlock(&arena->lock);
+}
+
+size_t pma_usable_size(void *ptr)
+{
+	struct chunk_header *chunk = chunk_of(ptr);
+	if (chunk->kind == CHUNK_LARGE)
+	{
+		return chunk->nchunks * PMA_CHUNK_SIZE - PMA_LINE_SIZE;
+	}
+	return size_classes[chunk->size_class];
+}
+
+size_t pma_used_size(void)
+{
+	return PMA_HEADER_SIZE + pool.header->watermark * PMA_CHUNK_SIZE;
+}
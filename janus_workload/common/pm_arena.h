@@ -0,0 +1,51 @@
+#ifndef _PM_ARENA_H_
+#define _PM_ARENA_H_
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Persistent memory allocator used by the janus workloads.
+ *
+ * The pool is split into a header followed by fixed size chunks. A chunk is
+ * either a slab serving a single size class or the start of a run of chunks
+ * serving one large allocation. Small size classes are multiples of the 64B
+ * line so every block is line aligned and no two blocks share a line.
+ *
+ * Threads are spread over PMA_MAX_ARENAS arenas, each with its own lock,
+ * current slabs and free lists, so threads only contend on the global lock
+ * when a new chunk is taken from the pool.
+ *
+ * Persistent state is limited to the pool header (watermark of the chunks in
+ * use) and the chunk headers (kind, size class, owner arena and a bitmap of
+ * the allocated blocks). Pools are never reopened: the workloads rebuild
+ * their data every run and format a new pool with pma_create.
+ */
+
+#define PMA_LINE_SIZE (64UL)
+#define PMA_CHUNK_SIZE (256UL * 1024UL)
+#define PMA_HEADER_SIZE (4096UL)
+#define PMA_MAX_ARENAS (64)
+#define PMA_MAX_SMALL_SIZE (16384UL)
+
+/* Pool size needed to serve data_size bytes spread over nallocs allocations */
+#define PMA_POOL_SIZE(data_size, nallocs)                                  \
+	(PMA_HEADER_SIZE + (data_size) + (data_size) / 64 +                   \
+	 ((nallocs) + 2 * PMA_MAX_ARENAS) * PMA_CHUNK_SIZE)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+	/* Formats a new pool over [base, base + size) */
+	int pma_create(void *base, size_t size);
+
+	void *pma_alloc(size_t size);
+	void pma_free(void *ptr);
+	size_t pma_usable_size(void *ptr);
+
+	/* Bytes handed out from the pool, including the chunk headers */
+	size_t pma_used_size(void);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -97,10 +97,9 @@ void HashTable::insert(hash_table_t* new_item, item_t* temp_item) {
 	//pthread_mutex_lock(locks + val_hash);
 	//printf("get lock=%lu\n", val_hash);
 	hash_table_t* location = start + val_hash;
-	new_item->item = *temp_item;
 	// need cache flush
 	//s_fence();
-	cache_flush(&new_item->item, sizeof(item_t));
+	flush_memcpy(&new_item->item, temp_item, sizeof(item_t));
 	//CounterAtomic::s_barrier();
 	s_fence();
 		
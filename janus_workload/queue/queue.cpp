@@ -47,13 +47,13 @@ int main (int argc, char* argv[]) {
 	
 	id = 0;
 	new_locations = (item_t*)aligned_malloc(64, sizeof(item_t) * num_op);
-#ifdef GEM5	
+#if defined(GEM5) || defined(PMBENCH)
 	m5_work_begin(atoi(argv[1]),0);
 #endif
 	//	TraceBegin();
 	opFunc(&id);
 	//	TraceEnd();
-#ifdef GEM5
+#if defined(GEM5) || defined(PMBENCH)
 
 	m5_work_end(atoi(argv[1]),0);
 #endif
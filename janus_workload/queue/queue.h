@@ -42,10 +42,8 @@ Queue::Queue() {
 
 void
 Queue::enqueue(item_t* new_location, item_t* temp_item, int id) {
-	memcpy(new_location, temp_item, sizeof(item_t));
+	flush_memcpy(new_location, temp_item, sizeof(item_t));
 	((item_t*)(tail))->next = new_location;
-
-	flush_caches(new_location, sizeof(item_t));
 	s_fence();
 
 	tail = (uint64_t)new_location;
@@ -73,6 +73,7 @@
 #define RRAND_R(seed, max, min) (os_rand_r(seed) % ((max) - (min)) + (min))
 
 struct benchmark;
+struct pmemobjpool;
 
 /*
  * benchmark_args - Arguments for benchmark.
@@ -97,6 +98,7 @@ struct benchmark_args {
 	unsigned seed;		 /* PRNG seed */
 	unsigned repeats;	/* number of repeats of one scenario */
 	unsigned min_exe_time;   /* minimal execution time */
+	bool persist_stats;	 /* report persistence traffic per op */
 	bool help;		 /* print help for benchmark */
 	void *opts;		 /* benchmark specific arguments */
 };
@@ -143,11 +145,24 @@ struct thread_results {
 	benchmark_time_t end_op[];
 };
 
+/*
+ * struct persist_stats -- persistence traffic of a pool, see the
+ * stats.persist entry points in pmemobj_ctl_get(3)
+ */
+struct persist_stats {
+	bool counted; /* the benchmark registered its pool */
+	uint64_t lines;
+	uint64_t partial_lines;
+	uint64_t fences;
+	uint64_t log_bytes;
+};
+
 /*
  * struct bench_results -- results of the whole benchmark
  */
 struct bench_results {
 	struct thread_results **thres;
+	struct persist_stats pstats;
 };
 
 /*
@@ -341,6 +356,7 @@ struct benchmark_info {
 
 void *pmembench_get_priv(struct benchmark *bench);
 void pmembench_set_priv(struct benchmark *bench, void *priv);
+void pmembench_set_pool(struct benchmark *bench, struct pmemobjpool *pop);
 struct benchmark_info *pmembench_get_info(struct benchmark *bench);
 int pmembench_register(struct benchmark_info *bench_info);
 
@@ -30,8 +30,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 /*
- * map_bench.cpp -- benchmarks for: ctree, btree, rtree, rbtree, hashmap_atomic
- * and hashmap_tx from examples.
+ * map_bench.cpp -- benchmarks for: ctree, btree, rtree, rbtree, hashmap_atomic,
+ * hashmap_tx, hashmap_cl and skiplist from examples.
  */
 #include <cassert>
 
@@ -45,10 +45,12 @@
 #include "map_btree.h"
 #include "map_ctree.h"
 #include "map_hashmap_atomic.h"
+#include "map_hashmap_cl.h"
 #include "map_hashmap_rp.h"
 #include "map_hashmap_tx.h"
 #include "map_rbtree.h"
 #include "map_rtree.h"
+#include "map_skiplist.h"
 
 /* Values less than 3 is not suitable for current rtree implementation */
 #define FACTOR 3
@@ -79,7 +81,8 @@ static const struct {
 	{"ctree", MAP_CTREE},		{"btree", MAP_BTREE},
 	{"rtree", MAP_RTREE},		{"rbtree", MAP_RBTREE},
 	{"hashmap_tx", MAP_HASHMAP_TX}, {"hashmap_atomic", MAP_HASHMAP_ATOMIC},
-	{"hashmap_rp", MAP_HASHMAP_RP}};
+	{"hashmap_rp", MAP_HASHMAP_RP}, {"hashmap_cl", MAP_HASHMAP_CL},
+	{"skiplist", MAP_SKIPLIST}};
 
 #define MAP_TYPES_NUM (sizeof(map_types) / sizeof(map_types[0]))
 
@@ -89,11 +92,13 @@ struct map_bench_args {
 	char *type;
 	bool ext_tx;
 	bool alloc;
+	size_t batch;
 };
 
 struct map_bench_worker {
 	uint64_t *keys;
 	size_t nkeys;
+	PMEMoid *values; /* values of the current batch */
 };
 
 struct map_bench {
@@ -208,6 +213,71 @@ map_remove_root_op(struct map_bench *map_bench, uint64_t key)
 	return !OID_EQUALS(val, map_bench->root_oid);
 }
 
+/*
+ * map_batch_size -- returns the number of keys in the batch ending at the
+ * specified operation, 0 if the batch does not end there
+ */
+static size_t
+map_batch_size(struct map_bench *map_bench, struct map_bench_worker *tworker,
+	       size_t index)
+{
+	size_t batch = map_bench->margs->batch;
+
+	if ((index + 1) % batch != 0 && index + 1 != tworker->nkeys)
+		return 0;
+
+	return index % batch + 1;
+}
+
+/*
+ * map_remove_batch_op -- remove the batch of keys ending at the specified
+ * operation
+ */
+static int
+map_remove_batch_op(struct map_bench *map_bench,
+		    struct map_bench_worker *tworker, size_t index)
+{
+	size_t n = map_batch_size(map_bench, tworker, index);
+	if (n == 0)
+		return 0;
+
+	const uint64_t *keys = &tworker->keys[index + 1 - n];
+	PMEMoid *values = tworker->values;
+	volatile int ret = 0;
+
+	mutex_lock_nofail(&map_bench->lock);
+
+	if (map_bench->margs->alloc) {
+		TX_BEGIN(map_bench->pop)
+		{
+			ret = map_remove_batch(map_bench->mapc, map_bench->map,
+					       keys, values, n);
+			for (size_t i = 0; i < n; i++) {
+				if (OID_IS_NULL(values[i]))
+					ret = -1;
+				else
+					pmemobj_tx_free(values[i]);
+			}
+		}
+		TX_ONABORT
+		{
+			ret = -1;
+		}
+		TX_END
+	} else {
+		ret = map_remove_batch(map_bench->mapc, map_bench->map, keys,
+				       values, n);
+		for (size_t i = 0; i < n; i++) {
+			if (!OID_EQUALS(values[i], map_bench->root_oid))
+				ret = -1;
+		}
+	}
+
+	mutex_unlock_nofail(&map_bench->lock);
+
+	return ret;
+}
+
 /*
  * map_remove_op -- main operation for map_remove benchmark
  */
@@ -217,6 +287,9 @@ map_remove_op(struct benchmark *bench, struct operation_info *info)
 	auto *map_bench = (struct map_bench *)pmembench_get_priv(bench);
 	auto *tworker = (struct map_bench_worker *)info->worker->priv;
 
+	if (map_bench->margs->batch > 1)
+		return map_remove_batch_op(map_bench, tworker, info->index);
+
 	uint64_t key = tworker->keys[info->index];
 
 	mutex_lock_nofail(&map_bench->lock);
@@ -261,6 +334,50 @@ map_insert_root_op(struct map_bench *map_bench, uint64_t key)
 			  map_bench->root_oid);
 }
 
+/*
+ * map_insert_batch_op -- insert the batch of keys ending at the specified
+ * operation
+ */
+static int
+map_insert_batch_op(struct map_bench *map_bench,
+		    struct map_bench_worker *tworker, size_t index)
+{
+	size_t n = map_batch_size(map_bench, tworker, index);
+	if (n == 0)
+		return 0;
+
+	const uint64_t *keys = &tworker->keys[index + 1 - n];
+	PMEMoid *values = tworker->values;
+	volatile int ret = 0;
+
+	mutex_lock_nofail(&map_bench->lock);
+
+	if (map_bench->margs->alloc) {
+		TX_BEGIN(map_bench->pop)
+		{
+			for (size_t i = 0; i < n; i++)
+				values[i] = pmemobj_tx_alloc(
+					map_bench->args->dsize, OBJ_TYPE_NUM);
+			ret = map_insert_batch(map_bench->mapc, map_bench->map,
+					       keys, values, n);
+		}
+		TX_ONABORT
+		{
+			ret = -1;
+		}
+		TX_END
+	} else {
+		for (size_t i = 0; i < n; i++)
+			values[i] = map_bench->root_oid;
+		ret = map_insert_batch(map_bench->mapc, map_bench->map, keys,
+				       values, n);
+	}
+
+	mutex_unlock_nofail(&map_bench->lock);
+
+	return ret;
+}
+
 /*
  * map_insert_op -- main operation for map_insert benchmark
  */
@@ -269,6 +386,10 @@ map_insert_op(struct benchmark *bench, struct operation_info *info)
 {
 	auto *map_bench = (struct map_bench *)pmembench_get_priv(bench);
 	auto *tworker = (struct map_bench_worker *)info->worker->priv;
+
+	if (map_bench->margs->batch > 1)
+		return map_insert_batch_op(map_bench, tworker, info->index);
+
 	uint64_t key = tworker->keys[info->index];
 
 	mutex_lock_nofail(&map_bench->lock);
@@ -350,17 +471,28 @@ map_common_init_worker(struct benchmark *bench, struct benchmark_args *args,
 
 	tree = (struct map_bench *)pmembench_get_priv(bench);
 	targs = (struct map_bench_args *)args->opts;
+	if (targs->batch > 1) {
+		tworker->values = (PMEMoid *)malloc(targs->batch *
+						    sizeof(*tworker->values));
+		if (!tworker->values) {
+			perror("malloc");
+			goto err_free_keys;
+		}
+	}
+
 	if (targs->ext_tx) {
 		int ret = pmemobj_tx_begin(tree->pop, nullptr);
 		if (ret) {
 			(void)pmemobj_tx_end();
-			goto err_free_keys;
+			goto err_free_values;
 		}
 	}
 
 	worker->priv = tworker;
 
 	return 0;
+err_free_values:
+	free(tworker->values);
 err_free_keys:
 	free(tworker->keys);
 err_free_worker:
@@ -383,6 +515,7 @@ map_common_free_worker(struct benchmark *bench, struct benchmark_args *args,
 		pmemobj_tx_commit();
 		(void)pmemobj_tx_end();
 	}
+	free(tworker->values);
 	free(tworker->keys);
 	free(tworker);
 }
@@ -602,6 +735,7 @@ map_common_init(struct benchmark *bench, struct benchmark_args *args)
 	map_bench->map = D_RO(map_bench->root)->map;
 
 	pmembench_set_priv(bench, map_bench);
+	pmembench_set_pool(bench, map_bench->pop);
 	return 0;
 err_free_map:
 	map_ctx_free(map_bench->mapc);
@@ -762,7 +896,7 @@ map_get_exit(struct benchmark *bench, struct benchmark_args *args)
 	return map_common_exit(bench, args);
 }
 
-static struct benchmark_clo map_bench_clos[5];
+static struct benchmark_clo map_bench_clos[6];
 
 static struct benchmark_info map_insert_info;
 static struct benchmark_info map_remove_info;
@@ -776,7 +910,8 @@ map_bench_constructor(void)
 	map_bench_clos[0].opt_long = "type";
 	map_bench_clos[0].descr =
 		"Type of container "
-		"[ctree|btree|rtree|rbtree|hashmap_tx|hashmap_atomic]";
+		"[ctree|btree|rtree|rbtree|hashmap_tx|hashmap_atomic|"
+		"hashmap_rp|hashmap_cl|skiplist]";
 
 	map_bench_clos[0].off = clo_field_offset(struct map_bench_args, type);
 	map_bench_clos[0].type = CLO_TYPE_STR;
@@ -822,6 +957,19 @@ map_bench_constructor(void)
 	map_bench_clos[4].off = clo_field_offset(struct map_bench_args, alloc);
 	map_bench_clos[4].type = CLO_TYPE_FLAG;
 
+	map_bench_clos[5].opt_short = 'b';
+	map_bench_clos[5].opt_long = "batch";
+	map_bench_clos[5].descr = "Number of keys inserted or removed "
+				  "in a single transaction";
+	map_bench_clos[5].off = clo_field_offset(struct map_bench_args, batch);
+	map_bench_clos[5].type = CLO_TYPE_UINT;
+	map_bench_clos[5].def = "1";
+	map_bench_clos[5].type_uint.size =
+		clo_field_size(struct map_bench_args, batch);
+	map_bench_clos[5].type_uint.base = CLO_INT_BASE_DEC;
+	map_bench_clos[5].type_uint.min = 1;
+	map_bench_clos[5].type_uint.max = UINT_MAX;
+
 	map_insert_info.name = "map_insert";
 	map_insert_info.brief = "Inserting to tree map";
 	map_insert_info.init = map_common_init;
@@ -55,6 +55,7 @@
 #include "clo_vec.hpp"
 #include "config_reader.hpp"
 #include "file.h"
+#include "libpmemobj.h"
 #include "libpmempool.h"
 #include "mmap.h"
 #include "os.h"
@@ -95,6 +96,7 @@ struct benchmark {
 	struct benchmark_clo *clos;
 	size_t nclos;
 	size_t args_size;
+	PMEMobjpool *pop; /* pool whose persistence traffic is reported */
 };
 
 /*
@@ -123,7 +125,7 @@ static struct version_s {
 static struct bench_list benchmarks;
 
 /* common arguments for benchmarks */
-static struct benchmark_clo pmembench_clos[13];
+static struct benchmark_clo pmembench_clos[14];
 
 /* list of arguments for pmembench */
 static struct benchmark_clo pmembench_opts[2];
@@ -294,6 +296,14 @@ pmembench_constructor(void)
 	pmembench_clos[12].off =
 		clo_field_offset(struct benchmark_args, is_dynamic_poolset);
 	pmembench_clos[12].ignore_in_res = true;
+
+	pmembench_clos[13].opt_long = "persist-stats";
+	pmembench_clos[13].type = CLO_TYPE_FLAG;
+	pmembench_clos[13].descr =
+		"Report cache lines flushed, fences and log bytes per operation";
+	pmembench_clos[13].off =
+		clo_field_offset(struct benchmark_args, persist_stats);
+	pmembench_clos[13].ignore_in_res = true;
 }
 
 /*
@@ -314,6 +324,16 @@ pmembench_set_priv(struct benchmark *bench, void *priv)
 	bench->priv = priv;
 }
 
+/*
+ * pmembench_set_pool -- set the pool whose persistence traffic is reported
+ *	in the --persist-stats mode, called from the benchmark's init
+ */
+void
+pmembench_set_pool(struct benchmark *bench, PMEMobjpool *pop)
+{
+	bench->pop = pop;
+}
+
 /*
  * pmembench_register -- register benchmark
  */
@@ -413,7 +433,7 @@ pmembench_run_worker(struct benchmark *bench, struct worker_info *winfo)
  */
 static void
 pmembench_print_header(struct pmembench *pb, struct benchmark *bench,
-		       struct clo_vec *clovec)
+		       struct clo_vec *clovec, struct benchmark_args *args)
 {
 	if (pb->scenario) {
 		printf("%s: %s [%" PRIu64 "]%s%s%s\n", pb->scenario->name,
@@ -447,11 +467,42 @@ pmembench_print_header(struct pmembench *pb, struct benchmark *bench,
 	if (bench->info->print_bandwidth)
 		printf(";bandwidth[MiB/s]");
 
+	if (args->persist_stats)
+		printf(";lines-per-op;partial-lines-per-op;fences-per-op"
+		       ";log-bytes-per-op");
+
 	if (bench->info->print_extra_headers)
 		bench->info->print_extra_headers();
 	printf("\n");
 }
 
+/*
+ * pmembench_print_persist_stats -- print persistence traffic per operation
+ *	averaged over all repeats
+ */
+static void
+pmembench_print_persist_stats(struct total_results *res)
+{
+	struct persist_stats sum = {};
+
+	for (size_t i = 0; i < res->nrepeats; i++) {
+		struct persist_stats *ps = &res->res[i].pstats;
+		if (!ps->counted) {
+			printf(";-;-;-;-");
+			return;
+		}
+		sum.lines += ps->lines;
+		sum.partial_lines += ps->partial_lines;
+		sum.fences += ps->fences;
+		sum.log_bytes += ps->log_bytes;
+	}
+
+	double nops = (double)(res->nrepeats * res->nthreads * res->nops);
+	printf(";%f;%f;%f;%f", (double)sum.lines / nops,
+	       (double)sum.partial_lines / nops, (double)sum.fences / nops,
+	       (double)sum.log_bytes / nops);
+}
+
 /*
  * pmembench_print_results -- print benchmark's results
  */
@@ -478,6 +529,9 @@ pmembench_print_results(struct benchmark *bench, struct benchmark_args *args,
 	if (bench->info->print_bandwidth)
 		printf(";%f", res->nopsps * args->dsize / 1024 / 1024);
 
+	if (args->persist_stats)
+		pmembench_print_persist_stats(res);
+
 	if (bench->info->print_extra_values)
 		bench->info->print_extra_values(bench, args, res);
 	printf("\n");
@@ -1139,6 +1193,64 @@ pmembench_remove_file(const char *path)
 	return util_file_dir_remove(path);
 }
 
+/*
+ * pmembench_persist_stats_read -- (internal) read the persistence traffic
+ *	counters of the pool
+ */
+static int
+pmembench_persist_stats_read(PMEMobjpool *pop, struct persist_stats *ps)
+{
+	if (pmemobj_ctl_get(pop, "stats.persist.lines", &ps->lines) ||
+	    pmemobj_ctl_get(pop, "stats.persist.partial_lines",
+			    &ps->partial_lines) ||
+	    pmemobj_ctl_get(pop, "stats.persist.fences", &ps->fences) ||
+	    pmemobj_ctl_get(pop, "stats.persist.log_bytes", &ps->log_bytes)) {
+		fprintf(stderr, "pmemobj_ctl_get: %s\n", pmemobj_errormsg());
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * pmembench_persist_stats_begin -- (internal) enable statistics of the pool
+ *	and take the counters at the beginning of the measured run
+ */
+static int
+pmembench_persist_stats_begin(PMEMobjpool *pop, struct persist_stats *ps)
+{
+	int enabled = 1;
+	if (pmemobj_ctl_set(pop, "stats.enabled", &enabled)) {
+		fprintf(stderr, "pmemobj_ctl_set: %s\n", pmemobj_errormsg());
+		return -1;
+	}
+
+	return pmembench_persist_stats_read(pop, ps);
+}
+
+/*
+ * pmembench_persist_stats_end -- (internal) take the difference of the
+ *	counters since the beginning of the measured run and disable statistics
+ */
+static int
+pmembench_persist_stats_end(PMEMobjpool *pop, struct persist_stats *ps)
+{
+	struct persist_stats end;
+	if (pmembench_persist_stats_read(pop, &end))
+		return -1;
+
+	ps->counted = true;
+	ps->lines = end.lines - ps->lines;
+	ps->partial_lines = end.partial_lines - ps->partial_lines;
+	ps->fences = end.fences - ps->fences;
+	ps->log_bytes = end.log_bytes - ps->log_bytes;
+
+	int enabled = 0;
+	(void) pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+
+	return 0;
+}
+
 /*
  * pmembench_single_repeat -- runs benchmark ones
  */
@@ -1172,6 +1284,9 @@ pmembench_single_repeat(struct benchmark *bench, struct benchmark_args *args,
 		}
 	}
 
+	bench->pop = nullptr;
+	memset(&res->pstats, 0, sizeof(res->pstats));
+
 	if (bench->info->init) {
 		if (bench->info->init(bench, args)) {
 			warn("%s: initialization failed", bench->info->name);
@@ -1191,6 +1306,12 @@ pmembench_single_repeat(struct benchmark *bench, struct benchmark_args *args,
 		goto out;
 	}
 
+	if (args->persist_stats && bench->pop &&
+	    (ret = pmembench_persist_stats_begin(bench->pop, &res->pstats)) !=
+		    0) {
+		goto out_workers;
+	}
+
 	unsigned j;
 	for (j = 0; j < args->n_threads; j++) {
 		benchmark_worker_run(workers[j]);
@@ -1206,6 +1327,11 @@ pmembench_single_repeat(struct benchmark *bench, struct benchmark_args *args,
 
 	results_store(res, workers, args->n_threads, args->n_ops_per_thread);
 
+	if (args->persist_stats && bench->pop &&
+	    pmembench_persist_stats_end(bench->pop, &res->pstats) != 0)
+		ret = -1;
+
+out_workers:
 	for (j = 0; j < args->n_threads; j++) {
 		benchmark_worker_exit(workers[j]);
 
@@ -1371,7 +1497,7 @@ pmembench_run(struct pmembench *pb, struct benchmark *bench)
 		return -1;
 	}
 
-	pmembench_print_header(pb, bench, clovec);
+	pmembench_print_header(pb, bench, clovec, args);
 
 	size_t args_i;
 	for (args_i = 0; args_i < clovec->nargs; args_i++) {
@@ -238,6 +238,8 @@ obj_persist_init(struct benchmark *bench, struct benchmark_args *args)
 		do_warmup(ob);
 	}
 
+	pmembench_set_pool(bench, ob->pop);
+
 	return 0;
 
 free_pop:
@@ -1047,6 +1047,8 @@ obj_tx_init(struct benchmark *bench, struct benchmark_args *args)
 		goto free_all;
 	}
 
+	pmembench_set_pool(bench, obj_bench.pop);
+
 	return 0;
 free_all:
 	free(obj_bench.sizes);
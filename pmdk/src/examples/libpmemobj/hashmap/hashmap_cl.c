@@ -0,0 +1,716 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * hashmap_cl.c -- integer hash map with open addressing and cache line sized
+ * buckets
+ *
+ * Every bucket is a single cache line with HM_CL_SLOTS key value slots and a
+ * fingerprint of the key in each slot. A key is stored in its home bucket or,
+ * if that one is full, in one of the next HM_CL_PROBE - 1 buckets, and the
+ * home bucket counts the keys stored away from it. An insert or a remove
+ * writes one or two whole cache lines and nothing else - there is no
+ * per-entry allocation and no element counter.
+ *
+ * Outside of a transaction a slot is written and persisted first and then
+ * published by storing its fingerprint, which needs no log at all. Inside of
+ * a transaction the modified buckets are snapshotted as whole lines instead.
+ * Lookups take no locks, a reader validates the slot it has read against its
+ * fingerprint and key.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <libpmemobj.h>
+#include "hashmap_cl.h"
+#include "hashmap_internal.h"
+
+/* number of key value slots in a bucket */
+#define HM_CL_SLOTS 3
+
+/* number of buckets, starting at the home one, a key can be stored in */
+#define HM_CL_PROBE 4
+
+/* size and alignment of a bucket */
+#define HM_CL_LINE 64
+
+/* fingerprint of a free slot */
+#define HM_CL_FREE 0
+
+/* saturated overflow count of a bucket, see struct bucket */
+#define HM_CL_OVERFLOW_MAX UINT8_MAX
+
+/* multiplier of the fingerprint hash, 2^64 divided by the golden ratio */
+#define HM_CL_FP_COEFF 0x9E3779B97F4A7C15ULL
+
+/* layout definition */
+TOID_DECLARE(struct buckets, HASHMAP_CL_TYPE_OFFSET + 1);
+
+struct slot {
+	uint64_t key;
+	/* offset of the value, values are stored in the pool of the map */
+	uint64_t off;
+};
+
+struct bucket {
+	/* fingerprints of the keys in the slots */
+	uint8_t fp[HM_CL_SLOTS];
+	/*
+	 * number of keys of this bucket stored in the next ones, an upper
+	 * bound: a crash between updating it and the slot leaks an increment,
+	 * which only a rebuild reclaims, so it saturates at HM_CL_OVERFLOW_MAX
+	 * and is never decremented from there instead of wrapping to 0
+	 */
+	uint8_t overflow;
+	uint32_t unused;
+
+	struct slot slot[HM_CL_SLOTS];
+
+	uint8_t padding[HM_CL_LINE - 8 - HM_CL_SLOTS * sizeof(struct slot)];
+};
+
+struct buckets {
+	/* number of buckets */
+	size_t nbuckets;
+	/* buckets, starting at the first cache line boundary */
+	uint8_t data[];
+};
+
+struct hashmap_cl {
+	/* random number generator seed */
+	uint32_t seed;
+
+	/* hash function coefficients */
+	uint32_t hash_fun_a;
+	uint32_t hash_fun_b;
+	uint64_t hash_fun_p;
+
+	/* buckets */
+	TOID(struct buckets) buckets;
+};
+
+/*
+ * buckets_size -- returns the size of the buckets object for len buckets
+ */
+static size_t
+buckets_size(size_t len)
+{
+	/* one more line to align the buckets */
+	return sizeof(struct buckets) + (len + 1) * HM_CL_LINE;
+}
+
+/*
+ * buckets_get -- returns the first bucket
+ */
+static struct bucket *
+buckets_get(TOID(struct buckets) buckets)
+{
+	uintptr_t data = (uintptr_t)D_RW(buckets)->data;
+
+	data = (data + HM_CL_LINE - 1) & ~((uintptr_t)HM_CL_LINE - 1);
+
+	return (struct bucket *)data;
+}
+
+/*
+ * create_hashmap -- hashmap initializer
+ */
+static void
+create_hashmap(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+	uint32_t seed)
+{
+	size_t len = INIT_BUCKETS_NUM;
+
+	TX_BEGIN(pop) {
+		TX_ADD(hashmap);
+
+		D_RW(hashmap)->seed = seed;
+		do {
+			D_RW(hashmap)->hash_fun_a = (uint32_t)rand();
+		} while (D_RW(hashmap)->hash_fun_a == 0);
+		D_RW(hashmap)->hash_fun_b = (uint32_t)rand();
+		D_RW(hashmap)->hash_fun_p = HASH_FUNC_COEFF_P;
+
+		D_RW(hashmap)->buckets = TX_ZALLOC(struct buckets,
+				buckets_size(len));
+		D_RW(D_RW(hashmap)->buckets)->nbuckets = len;
+	} TX_ONABORT {
+		fprintf(stderr, "%s: transaction aborted: %s\n", __func__,
+			pmemobj_errormsg());
+		abort();
+	} TX_END
+}
+
+/*
+ * hash -- the simplest hashing function,
+ * see https://en.wikipedia.org/wiki/Universal_hashing#Hashing_integers
+ */
+static uint64_t
+hash(const TOID(struct hashmap_cl) *hashmap, size_t len, uint64_t value)
+{
+	uint32_t a = D_RO(*hashmap)->hash_fun_a;
+	uint32_t b = D_RO(*hashmap)->hash_fun_b;
+	uint64_t p = D_RO(*hashmap)->hash_fun_p;
+
+	return ((a * value + b) % p) % len;
+}
+
+/*
+ * fingerprint -- returns the fingerprint of the key, never HM_CL_FREE
+ */
+static uint8_t
+fingerprint(uint64_t key)
+{
+	uint8_t fp = (uint8_t)((key * HM_CL_FP_COEFF) >> 56);
+
+	return fp == HM_CL_FREE ? 1 : fp;
+}
+
+/*
+ * overflow_inc -- increments the overflow count of the bucket, unless it is
+ * saturated
+ */
+static void
+overflow_inc(struct bucket *b)
+{
+	if (b->overflow != HM_CL_OVERFLOW_MAX)
+		b->overflow++;
+}
+
+/*
+ * overflow_dec -- decrements the overflow count of the bucket, a saturated
+ * count may hide leaked increments and stays saturated until a rebuild
+ */
+static void
+overflow_dec(struct bucket *b)
+{
+	if (b->overflow != HM_CL_OVERFLOW_MAX)
+		b->overflow--;
+}
+
+/*
+ * bucket_find -- returns the slot holding the key, -1 if there is none
+ *
+ * The slot is read without locks. It is published only after its contents,
+ * and it is validated again once read, so a concurrent remove or reuse of
+ * the slot is not mistaken for the key.
+ */
+static int
+bucket_find(const struct bucket *b, uint64_t key, uint8_t fp, uint64_t *off)
+{
+	for (int i = 0; i < HM_CL_SLOTS; ++i) {
+		if (__atomic_load_n(&b->fp[i], __ATOMIC_ACQUIRE) != fp)
+			continue;
+
+		uint64_t k = b->slot[i].key;
+		uint64_t o = b->slot[i].off;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (k != key || __atomic_load_n(&b->fp[i], __ATOMIC_RELAXED)
+				!= fp || b->slot[i].key != key)
+			continue;
+
+		if (off)
+			*off = o;
+		return i;
+	}
+
+	return -1;
+}
+
+/*
+ * bucket_free_slot -- returns a free slot of the bucket, -1 if it is full
+ */
+static int
+bucket_free_slot(const struct bucket *b)
+{
+	for (int i = 0; i < HM_CL_SLOTS; ++i) {
+		if (b->fp[i] == HM_CL_FREE)
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * hm_cl_find -- returns the bucket holding the key and its slot, NULL if the
+ * key is not in the map
+ */
+static struct bucket *
+hm_cl_find(struct bucket *buckets, size_t len, uint64_t h, uint64_t key,
+	int *slot, uint64_t *off)
+{
+	uint8_t fp = fingerprint(key);
+
+	for (int d = 0; d < HM_CL_PROBE; ++d) {
+		struct bucket *b = &buckets[(h + (uint64_t)d) % len];
+		if ((*slot = bucket_find(b, key, fp, off)) >= 0)
+			return b;
+
+		/* no key of the home bucket is stored away from it */
+		if (buckets[h].overflow == 0)
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+ * hm_cl_free_slot -- returns the first bucket with a free slot the key can be
+ * stored in and the slot, NULL if all of them are full
+ */
+static struct bucket *
+hm_cl_free_slot(struct bucket *buckets, size_t len, uint64_t h, int *slot)
+{
+	for (int d = 0; d < HM_CL_PROBE; ++d) {
+		struct bucket *b = &buckets[(h + (uint64_t)d) % len];
+		if ((*slot = bucket_free_slot(b)) >= 0)
+			return b;
+	}
+
+	return NULL;
+}
+
+/*
+ * bucket_place -- (internal) places the key in a bucket array that is not
+ * yet visible to anyone, returns -1 if there is no room for it
+ */
+static int
+bucket_place(struct bucket *buckets, size_t len, uint64_t h, uint64_t key,
+	uint64_t off)
+{
+	int i;
+	struct bucket *b = hm_cl_free_slot(buckets, len, h, &i);
+	if (b == NULL)
+		return -1;
+
+	if (b != &buckets[h])
+		overflow_inc(&buckets[h]);
+
+	b->slot[i].key = key;
+	b->slot[i].off = off;
+	b->fp[i] = fingerprint(key);
+
+	return 0;
+}
+
+/*
+ * hm_cl_rebuild -- rebuilds the hashmap with at least new_len buckets, the
+ * number of buckets is doubled until all of the keys can be placed
+ */
+static int
+hm_cl_rebuild(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+	size_t new_len)
+{
+	TOID(struct buckets) buckets_old = D_RO(hashmap)->buckets;
+	size_t len_old = D_RO(buckets_old)->nbuckets;
+
+	if (new_len == 0)
+		new_len = len_old;
+
+	int ret = 0;
+	TX_BEGIN(pop) {
+		TOID(struct buckets) buckets_new;
+		struct bucket *old = buckets_get(buckets_old);
+		int placed = 0;
+
+		while (!placed) {
+			buckets_new = TX_ZALLOC(struct buckets,
+					buckets_size(new_len));
+			D_RW(buckets_new)->nbuckets = new_len;
+			struct bucket *bnew = buckets_get(buckets_new);
+
+			placed = 1;
+			for (size_t i = 0; i < len_old && placed; ++i) {
+				for (int s = 0; s < HM_CL_SLOTS; ++s) {
+					if (old[i].fp[s] == HM_CL_FREE)
+						continue;
+
+					uint64_t key = old[i].slot[s].key;
+					uint64_t h = hash(&hashmap, new_len,
+							key);
+					if (bucket_place(bnew, new_len, h, key,
+						old[i].slot[s].off) != 0) {
+						placed = 0;
+						break;
+					}
+				}
+			}
+
+			if (!placed) {
+				TX_FREE(buckets_new);
+				new_len *= 2;
+			}
+		}
+
+		TX_ADD_FIELD(hashmap, buckets);
+		D_RW(hashmap)->buckets = buckets_new;
+		TX_FREE(buckets_old);
+	} TX_ONABORT {
+		fprintf(stderr, "%s: transaction aborted: %s\n", __func__,
+			pmemobj_errormsg());
+		ret = -1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * bucket_publish -- (internal) stores the key in the slot of the bucket,
+ * home is the home bucket of the key if it differs from the bucket
+ */
+static int
+bucket_publish(PMEMobjpool *pop, struct bucket *b, int i, struct bucket *home,
+	uint64_t key, uint64_t off)
+{
+	uint8_t fp = fingerprint(key);
+
+	if (pmemobj_tx_stage() != TX_STAGE_WORK) {
+		/* a stale overflow count only costs lookups more probes */
+		if (home) {
+			overflow_inc(home);
+			pmemobj_persist(pop, &home->overflow,
+				sizeof(home->overflow));
+		}
+
+		b->slot[i].key = key;
+		b->slot[i].off = off;
+		pmemobj_persist(pop, &b->slot[i], sizeof(b->slot[i]));
+
+		__atomic_store_n(&b->fp[i], fp, __ATOMIC_RELEASE);
+		pmemobj_persist(pop, &b->fp[i], sizeof(b->fp[i]));
+
+		return 0;
+	}
+
+	int ret = 0;
+	TX_BEGIN(pop) {
+		if (home) {
+			pmemobj_tx_add_range_direct(home, sizeof(*home));
+			overflow_inc(home);
+		}
+
+		pmemobj_tx_add_range_direct(b, sizeof(*b));
+		b->slot[i].key = key;
+		b->slot[i].off = off;
+		__atomic_store_n(&b->fp[i], fp, __ATOMIC_RELEASE);
+	} TX_ONABORT {
+		fprintf(stderr, "transaction aborted: %s\n",
+			pmemobj_errormsg());
+		ret = -1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * hm_cl_insert -- inserts specified value into the hashmap,
+ * returns:
+ * - 0 if successful,
+ * - 1 if value already existed,
+ * - -1 if something bad happened
+ */
+int
+hm_cl_insert(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+	uint64_t key, PMEMoid value)
+{
+	/* only the offset of the value is stored */
+	if (!OID_IS_NULL(value) &&
+			value.pool_uuid_lo != hashmap.oid.pool_uuid_lo) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	while (1) {
+		TOID(struct buckets) buckets = D_RO(hashmap)->buckets;
+		size_t len = D_RO(buckets)->nbuckets;
+		uint64_t h = hash(&hashmap, len, key);
+		struct bucket *first = buckets_get(buckets);
+		int i;
+
+		if (hm_cl_find(first, len, h, key, &i, NULL) != NULL)
+			return 1;
+
+		struct bucket *b = hm_cl_free_slot(first, len, h, &i);
+		if (b != NULL)
+			return bucket_publish(pop, b, i,
+				b == &first[h] ? NULL : &first[h], key,
+				value.off);
+
+		if (hm_cl_rebuild(pop, hashmap, len * 2) != 0)
+			return -1;
+	}
+}
+
+/*
+ * hm_cl_remove -- removes specified value from the hashmap,
+ * returns:
+ * - key's value if successful,
+ * - OID_NULL if value didn't exist or if something bad happened
+ */
+PMEMoid
+hm_cl_remove(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap, uint64_t key)
+{
+	TOID(struct buckets) buckets = D_RO(hashmap)->buckets;
+	size_t len = D_RO(buckets)->nbuckets;
+	uint64_t h = hash(&hashmap, len, key);
+	struct bucket *home = &buckets_get(buckets)[h];
+	uint64_t off;
+	int i;
+
+	struct bucket *b = hm_cl_find(buckets_get(buckets), len, h, key, &i,
+			&off);
+	if (b == NULL)
+		return OID_NULL;
+
+	PMEMoid retoid = OID_NULL;
+	if (off != 0) {
+		retoid.pool_uuid_lo = hashmap.oid.pool_uuid_lo;
+		retoid.off = off;
+	}
+
+	if (pmemobj_tx_stage() != TX_STAGE_WORK) {
+		__atomic_store_n(&b->fp[i], HM_CL_FREE, __ATOMIC_RELEASE);
+		pmemobj_persist(pop, &b->fp[i], sizeof(b->fp[i]));
+
+		if (b != home) {
+			overflow_dec(home);
+			pmemobj_persist(pop, &home->overflow,
+				sizeof(home->overflow));
+		}
+
+		return retoid;
+	}
+
+	int ret = 0;
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(b, sizeof(*b));
+		__atomic_store_n(&b->fp[i], HM_CL_FREE, __ATOMIC_RELEASE);
+
+		if (b != home) {
+			pmemobj_tx_add_range_direct(home, sizeof(*home));
+			overflow_dec(home);
+		}
+	} TX_ONABORT {
+		fprintf(stderr, "transaction aborted: %s\n",
+			pmemobj_errormsg());
+		ret = -1;
+	} TX_END
+
+	if (ret)
+		return OID_NULL;
+
+	return retoid;
+}
+
+/*
+ * hm_cl_foreach -- prints all values from the hashmap
+ */
+int
+hm_cl_foreach(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+	int (*cb)(uint64_t key, PMEMoid value, void *arg), void *arg)
+{
+	TOID(struct buckets) buckets = D_RO(hashmap)->buckets;
+	struct bucket *b = buckets_get(buckets);
+
+	int ret = 0;
+	for (size_t i = 0; i < D_RO(buckets)->nbuckets; ++i) {
+		for (int s = 0; s < HM_CL_SLOTS; ++s) {
+			if (b[i].fp[s] == HM_CL_FREE)
+				continue;
+
+			PMEMoid value = OID_NULL;
+			if (b[i].slot[s].off != 0) {
+				value.pool_uuid_lo = hashmap.oid.pool_uuid_lo;
+				value.off = b[i].slot[s].off;
+			}
+
+			ret = cb(b[i].slot[s].key, value, arg);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * hm_cl_debug -- prints complete hashmap state
+ */
+static void
+hm_cl_debug(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap, FILE *out)
+{
+	TOID(struct buckets) buckets = D_RO(hashmap)->buckets;
+	struct bucket *b = buckets_get(buckets);
+
+	fprintf(out, "a: %u b: %u p: %" PRIu64 "\n", D_RO(hashmap)->hash_fun_a,
+		D_RO(hashmap)->hash_fun_b, D_RO(hashmap)->hash_fun_p);
+	fprintf(out, "count: %zu, buckets: %zu\n",
+		hm_cl_count(pop, hashmap), D_RO(buckets)->nbuckets);
+
+	for (size_t i = 0; i < D_RO(buckets)->nbuckets; ++i) {
+		int num = 0;
+		for (int s = 0; s < HM_CL_SLOTS; ++s) {
+			if (b[i].fp[s] == HM_CL_FREE)
+				continue;
+
+			if (num++ == 0)
+				fprintf(out, "%zu: ", i);
+			fprintf(out, "%" PRIu64 " ", b[i].slot[s].key);
+		}
+
+		if (num)
+			fprintf(out, "(%d, overflow %u)\n", num,
+				b[i].overflow);
+	}
+}
+
+/*
+ * hm_cl_get -- checks whether specified value is in the hashmap
+ */
+PMEMoid
+hm_cl_get(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap, uint64_t key)
+{
+	TOID(struct buckets) buckets = D_RO(hashmap)->buckets;
+	size_t len = D_RO(buckets)->nbuckets;
+	uint64_t h = hash(&hashmap, len, key);
+	uint64_t off;
+	int i;
+
+	if (hm_cl_find(buckets_get(buckets), len, h, key, &i, &off) == NULL)
+		return OID_NULL;
+
+	PMEMoid value = OID_NULL;
+	if (off != 0) {
+		value.pool_uuid_lo = hashmap.oid.pool_uuid_lo;
+		value.off = off;
+	}
+
+	return value;
+}
+
+/*
+ * hm_cl_lookup -- checks whether specified value exists
+ */
+int
+hm_cl_lookup(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap, uint64_t key)
+{
+	TOID(struct buckets) buckets = D_RO(hashmap)->buckets;
+	size_t len = D_RO(buckets)->nbuckets;
+	uint64_t h = hash(&hashmap, len, key);
+	int i;
+
+	return hm_cl_find(buckets_get(buckets), len, h, key, &i, NULL) != NULL;
+}
+
+/*
+ * hm_cl_count -- returns number of elements, the map keeps no counter so
+ * that inserts and removes do not write to a shared cache line
+ */
+size_t
+hm_cl_count(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap)
+{
+	TOID(struct buckets) buckets = D_RO(hashmap)->buckets;
+	struct bucket *b = buckets_get(buckets);
+
+	size_t count = 0;
+	for (size_t i = 0; i < D_RO(buckets)->nbuckets; ++i) {
+		for (int s = 0; s < HM_CL_SLOTS; ++s)
+			count += b[i].fp[s] != HM_CL_FREE;
+	}
+
+	return count;
+}
+
+/*
+ * hm_cl_init -- recovers hashmap state, called after pmemobj_open
+ */
+int
+hm_cl_init(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap)
+{
+	srand(D_RO(hashmap)->seed);
+	return 0;
+}
+
+/*
+ * hm_cl_create -- allocates new hashmap
+ */
+int
+hm_cl_create(PMEMobjpool *pop, TOID(struct hashmap_cl) *map, void *arg)
+{
+	struct hashmap_args *args = (struct hashmap_args *)arg;
+	int ret = 0;
+	TX_BEGIN(pop) {
+		TX_ADD_DIRECT(map);
+		*map = TX_ZNEW(struct hashmap_cl);
+
+		uint32_t seed = args ? args->seed : 0;
+		create_hashmap(pop, *map, seed);
+	} TX_ONABORT {
+		ret = -1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * hm_cl_check -- checks if specified persistent object is an
+ * instance of hashmap
+ */
+int
+hm_cl_check(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap)
+{
+	return TOID_IS_NULL(hashmap) || !TOID_VALID(hashmap);
+}
+
+/*
+ * hm_cl_cmd -- execute cmd for hashmap
+ */
+int
+hm_cl_cmd(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+		unsigned cmd, uint64_t arg)
+{
+	switch (cmd) {
+		case HASHMAP_CMD_REBUILD:
+			return hm_cl_rebuild(pop, hashmap, arg);
+		case HASHMAP_CMD_DEBUG:
+			if (!arg)
+				return -EINVAL;
+			hm_cl_debug(pop, hashmap, (FILE *)arg);
+			return 0;
+		default:
+			return -EINVAL;
+	}
+}
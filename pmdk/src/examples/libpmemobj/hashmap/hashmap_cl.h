@@ -0,0 +1,69 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * hashmap_cl.h -- open addressing hashmap with cache line sized buckets
+ */
+
+#ifndef HASHMAP_CL_H
+#define HASHMAP_CL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <hashmap.h>
+#include <libpmemobj.h>
+
+#ifndef HASHMAP_CL_TYPE_OFFSET
+#define HASHMAP_CL_TYPE_OFFSET 1024
+#endif
+
+struct hashmap_cl;
+TOID_DECLARE(struct hashmap_cl, HASHMAP_CL_TYPE_OFFSET + 0);
+
+int hm_cl_check(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap);
+int hm_cl_create(PMEMobjpool *pop, TOID(struct hashmap_cl) *map, void *arg);
+int hm_cl_init(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap);
+int hm_cl_insert(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+		uint64_t key, PMEMoid value);
+PMEMoid hm_cl_remove(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+		uint64_t key);
+PMEMoid hm_cl_get(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+		uint64_t key);
+int hm_cl_lookup(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+		uint64_t key);
+int hm_cl_foreach(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+	int (*cb)(uint64_t key, PMEMoid value, void *arg), void *arg);
+size_t hm_cl_count(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap);
+int hm_cl_cmd(PMEMobjpool *pop, TOID(struct hashmap_cl) hashmap,
+		unsigned cmd, uint64_t arg);
+
+#endif /* HASHMAP_CL_H */
@@ -48,12 +48,13 @@
 #include "map_hashmap_atomic.h"
 #include "map_hashmap_tx.h"
 #include "map_hashmap_rp.h"
+#include "map_hashmap_cl.h"
 #include "map_skiplist.h"
 
 //#include "/home/smahar/git/transparent_txopt/helper.h"
 #include <sys/time.h>
 
-#ifdef GEM5
+#if defined(GEM5) || defined(PMBENCH)
 	#include "gem5/m5ops.h"
 #endif
 
@@ -126,6 +127,8 @@ parse_map_type(const char *type)
 		return MAP_HASHMAP_TX;
 	else if (strcmp(type, "hashmap_rp") == 0)
 		return MAP_HASHMAP_RP;
+	else if (strcmp(type, "hashmap_cl") == 0)
+		return MAP_HASHMAP_CL;
 	else if (strcmp(type, "skiplist") == 0)
 		return MAP_SKIPLIST;
 	return NULL;
@@ -137,7 +140,8 @@ int main(int argc, const char *argv[]) {
 	if (argc < 3) {
 		printf("usage: %s "
 			"<ctree|btree|rbtree|hashmap_atomic|hashmap_rp|"
-			"hashmap_tx|skiplist> file-name [nops]\n", argv[0]);
+			"hashmap_tx|hashmap_cl|skiplist> file-name [nops]\n",
+			argv[0]);
 		return 1;
 	}
 
@@ -184,7 +188,7 @@ int main(int argc, const char *argv[]) {
 		perror("cannot allocate map context\n");
 		return 1;
 	}
-	#ifdef GEM5
+	#if defined(GEM5) || defined(PMBENCH)
 		printf("Begining work for workid %d\n", atoi(argv[4]));
 		m5_work_begin(atoi(argv[4]),0);
 	#endif
@@ -209,7 +213,7 @@ int main(int argc, const char *argv[]) {
 		}
 //		TraceEnd();
 //	TraceEnd();
-	#ifdef GEM5
+	#if defined(GEM5) || defined(PMBENCH)
 		printf("Done for workid %d\n", atoi(argv[4]));
 		m5_work_end(atoi(argv[4]),0);
 //		m5_dump_stats(atoi(argv[4]), 0);
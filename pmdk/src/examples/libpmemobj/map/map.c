@@ -33,6 +33,7 @@
 /*
  * map.c -- common interface for maps
  */
+#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <libpmemobj.h>
@@ -46,6 +47,52 @@
 		exit(1);\
 	}
 
+/*
+ * map_batch_entry -- key of a batched operation and its index in the batch
+ */
+struct map_batch_entry {
+	uint64_t key;
+	size_t idx;
+};
+
+/*
+ * map_batch_entry_cmp -- (internal) orders batch entries by key, entries with
+ * equal keys keep their order in the batch
+ */
+static int
+map_batch_entry_cmp(const void *lhs, const void *rhs)
+{
+	const struct map_batch_entry *l = (const struct map_batch_entry *)lhs;
+	const struct map_batch_entry *r = (const struct map_batch_entry *)rhs;
+
+	if (l->key != r->key)
+		return l->key < r->key ? -1 : 1;
+
+	return l->idx < r->idx ? -1 : l->idx > r->idx;
+}
+
+/*
+ * map_batch_sort -- (internal) returns the keys of a batch in ascending order,
+ * so that neighbouring operations touch neighbouring parts of the map
+ */
+static struct map_batch_entry *
+map_batch_sort(const uint64_t *keys, size_t n)
+{
+	struct map_batch_entry *batch =
+		(struct map_batch_entry *)malloc(n * sizeof(*batch));
+	if (!batch)
+		return NULL;
+
+	for (size_t i = 0; i < n; ++i) {
+		batch[i].key = keys[i];
+		batch[i].idx = i;
+	}
+
+	qsort(batch, n, sizeof(*batch), map_batch_entry_cmp);
+
+	return batch;
+}
+
 /*
  * map_ctx_init -- initialize map context
  */
@@ -230,3 +277,89 @@ map_cmd(struct map_ctx *mapc, TOID(struct map) map, unsigned cmd, uint64_t arg)
 	ABORT_NOT_IMPLEMENTED(mapc, cmd);
 	return mapc->ops->cmd(mapc->pop, map, cmd, arg);
 }
+
+/*
+ * map_insert_batch -- insert n key value pairs in a single transaction
+ *
+ * The pairs are inserted in key order. Either all of them are inserted or, if
+ * the transaction aborts, none. Maps whose operations cannot join an outer
+ * transaction insert the pairs one by one.
+ */
+int
+map_insert_batch(struct map_ctx *mapc, TOID(struct map) map,
+		const uint64_t *keys, const PMEMoid *values, size_t n)
+{
+	ABORT_NOT_IMPLEMENTED(mapc, insert);
+	if (n == 0)
+		return 0;
+
+	struct map_batch_entry *batch = map_batch_sort(keys, n);
+	if (!batch)
+		return -1;
+
+	volatile int ret = 0;
+	if (!mapc->ops->tx_nested) {
+		for (size_t i = 0; i < n && ret >= 0; ++i)
+			ret = mapc->ops->insert(mapc->pop, map, batch[i].key,
+				values[batch[i].idx]);
+	} else {
+		TX_BEGIN(mapc->pop) {
+			for (size_t i = 0; i < n; ++i) {
+				if (mapc->ops->insert(mapc->pop, map,
+					batch[i].key, values[batch[i].idx]) < 0)
+					pmemobj_tx_abort(EINVAL);
+			}
+		} TX_ONABORT {
+			ret = -1;
+		} TX_END
+	}
+
+	free(batch);
+
+	return ret < 0 ? -1 : 0;
+}
+
+/*
+ * map_remove_batch -- remove n keys in a single transaction
+ *
+ * The keys are removed in key order. If values is not NULL, the removed
+ * values are stored in it at the index of their key, OID_NULL for the keys
+ * not found in the map.
+ */
+int
+map_remove_batch(struct map_ctx *mapc, TOID(struct map) map,
+		const uint64_t *keys, PMEMoid *values, size_t n)
+{
+	ABORT_NOT_IMPLEMENTED(mapc, remove);
+	if (n == 0)
+		return 0;
+
+	struct map_batch_entry *batch = map_batch_sort(keys, n);
+	if (!batch)
+		return -1;
+
+	volatile int ret = 0;
+	if (!mapc->ops->tx_nested) {
+		for (size_t i = 0; i < n; ++i) {
+			PMEMoid val = mapc->ops->remove(mapc->pop, map,
+				batch[i].key);
+			if (values)
+				values[batch[i].idx] = val;
+		}
+	} else {
+		TX_BEGIN(mapc->pop) {
+			for (size_t i = 0; i < n; ++i) {
+				PMEMoid val = mapc->ops->remove(mapc->pop, map,
+					batch[i].key);
+				if (values)
+					values[batch[i].idx] = val;
+			}
+		} TX_ONABORT {
+			ret = -1;
+		} TX_END
+	}
+
+	free(batch);
+
+	return ret;
+}
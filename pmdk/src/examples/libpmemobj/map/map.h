@@ -80,6 +80,8 @@ struct map_ops {
 	size_t(*count)(PMEMobjpool *pop, TOID(struct map) map);
 	int(*cmd)(PMEMobjpool *pop, TOID(struct map) map,
 		unsigned cmd, uint64_t arg);
+	/* operations are transactional and can join an outer transaction */
+	int tx_nested;
 };
 
 struct map_ctx {
@@ -112,6 +114,10 @@ int map_is_empty(struct map_ctx *mapc, TOID(struct map) map);
 size_t map_count(struct map_ctx *mapc, TOID(struct map) map);
 int map_cmd(struct map_ctx *mapc, TOID(struct map) map,
 	unsigned cmd, uint64_t arg);
+int map_insert_batch(struct map_ctx *mapc, TOID(struct map) map,
+	const uint64_t *keys, const PMEMoid *values, size_t n);
+int map_remove_batch(struct map_ctx *mapc, TOID(struct map) map,
+	const uint64_t *keys, PMEMoid *values, size_t n);
 
 #ifdef __cplusplus
 }
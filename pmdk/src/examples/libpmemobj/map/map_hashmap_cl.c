@@ -0,0 +1,183 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * map_hashmap_cl.c -- common interface for maps
+ */
+
+#include <map.h>
+#include <hashmap_cl.h>
+
+#include "map_hashmap_cl.h"
+
+/*
+ * map_hm_cl_check -- wrapper for hm_cl_check
+ */
+static int
+map_hm_cl_check(PMEMobjpool *pop, TOID(struct map) map)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_check(pop, hashmap_cl);
+}
+
+/*
+ * map_hm_cl_count -- wrapper for hm_cl_count
+ */
+static size_t
+map_hm_cl_count(PMEMobjpool *pop, TOID(struct map) map)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_count(pop, hashmap_cl);
+}
+
+/*
+ * map_hm_cl_init -- wrapper for hm_cl_init
+ */
+static int
+map_hm_cl_init(PMEMobjpool *pop, TOID(struct map) map)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_init(pop, hashmap_cl);
+}
+
+/*
+ * map_hm_cl_create -- wrapper for hm_cl_create
+ */
+static int
+map_hm_cl_create(PMEMobjpool *pop, TOID(struct map) *map, void *arg)
+{
+	TOID(struct hashmap_cl) *hashmap_cl =
+		(TOID(struct hashmap_cl) *)map;
+
+	return hm_cl_create(pop, hashmap_cl, arg);
+}
+
+/*
+ * map_hm_cl_insert -- wrapper for hm_cl_insert
+ */
+static int
+map_hm_cl_insert(PMEMobjpool *pop, TOID(struct map) map,
+		uint64_t key, PMEMoid value)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_insert(pop, hashmap_cl, key, value);
+}
+
+/*
+ * map_hm_cl_remove -- wrapper for hm_cl_remove
+ */
+static PMEMoid
+map_hm_cl_remove(PMEMobjpool *pop, TOID(struct map) map, uint64_t key)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_remove(pop, hashmap_cl, key);
+}
+
+/*
+ * map_hm_cl_get -- wrapper for hm_cl_get
+ */
+static PMEMoid
+map_hm_cl_get(PMEMobjpool *pop, TOID(struct map) map, uint64_t key)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_get(pop, hashmap_cl, key);
+}
+
+/*
+ * map_hm_cl_lookup -- wrapper for hm_cl_lookup
+ */
+static int
+map_hm_cl_lookup(PMEMobjpool *pop, TOID(struct map) map, uint64_t key)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_lookup(pop, hashmap_cl, key);
+}
+
+/*
+ * map_hm_cl_foreach -- wrapper for hm_cl_foreach
+ */
+static int
+map_hm_cl_foreach(PMEMobjpool *pop, TOID(struct map) map,
+		int (*cb)(uint64_t key, PMEMoid value, void *arg),
+		void *arg)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_foreach(pop, hashmap_cl, cb, arg);
+}
+
+/*
+ * map_hm_cl_cmd -- wrapper for hm_cl_cmd
+ */
+static int
+map_hm_cl_cmd(PMEMobjpool *pop, TOID(struct map) map,
+		unsigned cmd, uint64_t arg)
+{
+	TOID(struct hashmap_cl) hashmap_cl;
+	TOID_ASSIGN(hashmap_cl, map.oid);
+
+	return hm_cl_cmd(pop, hashmap_cl, cmd, arg);
+}
+
+struct map_ops hashmap_cl_ops = {
+	/* .check	= */ map_hm_cl_check,
+	/* .create	= */ map_hm_cl_create,
+	/* .delete	= */ NULL,
+	/* .init	= */ map_hm_cl_init,
+	/* .insert	= */ map_hm_cl_insert,
+	/* .insert_new	= */ NULL,
+	/* .remove	= */ map_hm_cl_remove,
+	/* .remove_free	= */ NULL,
+	/* .clear	= */ NULL,
+	/* .get		= */ map_hm_cl_get,
+	/* .lookup	= */ map_hm_cl_lookup,
+	/* .foreach	= */ map_hm_cl_foreach,
+	/* .is_empty	= */ NULL,
+	/* .count	= */ map_hm_cl_count,
+	/* .cmd		= */ map_hm_cl_cmd,
+	/* .tx_nested	= */ 1,
+};
@@ -179,4 +179,5 @@ struct map_ops hashmap_tx_ops = {
 	/* .is_empty	= */ NULL,
 	/* .count	= */ map_hm_tx_count,
 	/* .cmd		= */ map_hm_tx_cmd,
+	/* .tx_nested	= */ 1,
 };
@@ -207,4 +207,5 @@ struct map_ops rbtree_map_ops = {
 	/* .is_empty	= */ map_rbtree_is_empty,
 	/* .count	= */ NULL,
 	/* .cmd		= */ NULL,
+	/* .tx_nested	= */ 1,
 };
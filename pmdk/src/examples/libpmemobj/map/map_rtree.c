@@ -232,4 +232,5 @@ struct map_ops rtree_map_ops = {
 /*	.is_empty	= */map_rtree_is_empty,
 /*	.count		= */NULL,
 /*	.cmd		= */NULL,
+/*	.tx_nested	= */1,
 };
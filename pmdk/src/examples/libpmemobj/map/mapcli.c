@@ -31,6 +31,7 @@
  */
 
 #include <ex_common.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -48,10 +49,12 @@
 #include "map_hashmap_atomic.h"
 #include "map_hashmap_tx.h"
 #include "map_hashmap_rp.h"
+#include "map_hashmap_cl.h"
 #include "map_skiplist.h"
 #include "hashmap/hashmap.h"
 
 #define PM_HASHSET_POOL_SIZE	(160 * 1024 * 1024)
+#define MAX_BATCH_KEYS		64
 
 POBJ_LAYOUT_BEGIN(map);
 POBJ_LAYOUT_ROOT(map, struct root);
@@ -96,6 +99,87 @@ str_remove(const char *str)
 		fprintf(stderr,	"remove: invalid syntax\n");
 }
 
+/*
+ * str_keys -- parses up to max whitespace separated keys, returns their count
+ */
+static size_t
+str_keys(const char *str, uint64_t *keys, size_t max)
+{
+	size_t n = 0;
+	int len;
+	while (n < max && sscanf(str, "%" SCNu64 "%n", &keys[n], &len) > 0) {
+		str += len;
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ * str_insert_batch -- map_insert_batch wrapper which works on strings
+ */
+static void
+str_insert_batch(const char *str)
+{
+	uint64_t keys[MAX_BATCH_KEYS];
+	PMEMoid values[MAX_BATCH_KEYS];
+	size_t n = str_keys(str, keys, MAX_BATCH_KEYS);
+	if (n == 0) {
+		fprintf(stderr, "batch insert: invalid syntax\n");
+		return;
+	}
+
+	for (size_t i = 0; i < n; ++i)
+		values[i] = OID_NULL;
+
+	if (map_insert_batch(mapc, map, keys, values, n))
+		fprintf(stderr, "batch insert: failed\n");
+}
+
+/*
+ * str_remove_batch -- map_remove_batch wrapper which works on strings
+ */
+static void
+str_remove_batch(const char *str)
+{
+	uint64_t keys[MAX_BATCH_KEYS];
+	size_t n = str_keys(str, keys, MAX_BATCH_KEYS);
+	if (n == 0) {
+		fprintf(stderr, "batch remove: invalid syntax\n");
+		return;
+	}
+
+	if (map_remove_batch(mapc, map, keys, NULL, n))
+		fprintf(stderr, "batch remove: failed\n");
+}
+
+/*
+ * str_insert_batch_abort -- inserts a batch of keys in an outer transaction
+ * and aborts it, none of the keys should be left in the map
+ */
+static void
+str_insert_batch_abort(const char *str)
+{
+	uint64_t keys[MAX_BATCH_KEYS];
+	PMEMoid values[MAX_BATCH_KEYS];
+	size_t n = str_keys(str, keys, MAX_BATCH_KEYS);
+	if (n == 0) {
+		fprintf(stderr, "aborted batch insert: invalid syntax\n");
+		return;
+	}
+
+	for (size_t i = 0; i < n; ++i)
+		values[i] = OID_NULL;
+
+	TX_BEGIN(pop) {
+		if (map_insert_batch(mapc, map, keys, values, n))
+			fprintf(stderr, "aborted batch insert: failed\n");
+		pmemobj_tx_abort(ECANCELED);
+	} TX_ONCOMMIT {
+		fprintf(stderr, "aborted batch insert: committed\n");
+	} TX_END
+}
+
 /*
  * str_check -- hs_check wrapper which works on strings
  */
@@ -170,6 +254,9 @@ help(void)
 	printf("h - help\n");
 	printf("i $value - insert $value\n");
 	printf("r $value - remove $value\n");
+	printf("I $value... - insert all $values in one transaction\n");
+	printf("R $value... - remove all $values in one transaction\n");
+	printf("a $value... - insert all $values in an aborted transaction\n");
 	printf("c $value - check $value, returns 0/1\n");
 	printf("n $value - insert $value random values\n");
 	printf("p - print all values\n");
@@ -206,7 +293,7 @@ main(int argc, char *argv[])
 {
 	if (argc < 3 || argc > 4) {
 		printf("usage: %s "
-			"hashmap_tx|hashmap_atomic|hashmap_rp|"
+			"hashmap_tx|hashmap_atomic|hashmap_rp|hashmap_cl|"
 			"ctree|btree|rtree|rbtree|skiplist"
 				" file-name [<seed>]\n", argv[0]);
 		return 1;
@@ -221,6 +308,8 @@ main(int argc, char *argv[])
 		ops = MAP_HASHMAP_ATOMIC;
 	} else if (strcmp(type, "hashmap_rp") == 0) {
 		ops = MAP_HASHMAP_RP;
+	} else if (strcmp(type, "hashmap_cl") == 0) {
+		ops = MAP_HASHMAP_CL;
 	} else if (strcmp(type, "ctree") == 0) {
 		ops = MAP_CTREE;
 	} else if (strcmp(type, "btree") == 0) {
@@ -302,6 +391,15 @@ main(int argc, char *argv[])
 			case 'r':
 				str_remove(buf + 1);
 				break;
+			case 'I':
+				str_insert_batch(buf + 1);
+				break;
+			case 'R':
+				str_remove_batch(buf + 1);
+				break;
+			case 'a':
+				str_insert_batch_abort(buf + 1);
+				break;
 			case 'c':
 				str_check(buf + 1);
 				break;
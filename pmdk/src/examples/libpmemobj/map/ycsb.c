@@ -0,0 +1,876 @@
+/*
+ * Copyright 2015-2018, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * ycsb.c -- YCSB-style key-value driver for the map examples
+ *
+ * The records are loaded first, then the run phase executes the operation
+ * mix of one of the YCSB core workloads:
+ *
+ *	A	50% read, 50% update, zipfian
+ *	B	95% read, 5% update, zipfian
+ *	C	100% read, zipfian
+ *	D	95% read, 5% insert, latest
+ *	E	95% scan, 5% insert, zipfian
+ *	F	50% read, 50% read-modify-write, zipfian
+ *
+ * The maps are not thread-safe, so each thread owns one map holding its
+ * share of the records and no lock is taken. Keys are hashed record
+ * numbers. The maps have no range iterator, a scan reads consecutive
+ * record numbers with point lookups.
+ *
+ * Operations are grouped into transactions of -b operations. The run
+ * phase is the gem5 region of interest in GEM5 builds.
+ */
+
+#include <ex_common.h>
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "map.h"
+#include "map_ctree.h"
+#include "map_btree.h"
+#include "map_rbtree.h"
+#include "map_hashmap_atomic.h"
+#include "map_hashmap_tx.h"
+#include "map_hashmap_rp.h"
+#include "map_hashmap_cl.h"
+#include "map_skiplist.h"
+
+#if defined(GEM5) || defined(PMBENCH)
+	#include "gem5/m5ops.h"
+#endif
+
+POBJ_LAYOUT_BEGIN(ycsb);
+POBJ_LAYOUT_ROOT(ycsb, struct ycsb_root);
+POBJ_LAYOUT_TOID(ycsb, struct ycsb_value);
+POBJ_LAYOUT_END(ycsb);
+
+#define MAX_THREADS 64
+#define ZIPFIAN_THETA 0.99
+
+/* log-linear latency histogram, 16 sub-buckets per power of two */
+#define HIST_SUB_BITS 4
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS (64 * HIST_SUB)
+
+struct ycsb_value {
+	uint64_t size;
+	char data[];
+};
+
+/* one map per thread, padded so the threads do not share lines */
+struct shard {
+	TOID(struct map) map;
+	uint64_t nkeys;
+	uint8_t padding[40];
+};
+
+struct ycsb_root {
+	uint64_t nshards;
+	struct shard shards[MAX_THREADS];
+};
+
+enum key_dist {
+	DIST_UNIFORM,
+	DIST_ZIPFIAN,
+	DIST_LATEST,
+	MAX_DIST
+};
+
+enum op_type {
+	OP_READ,
+	OP_UPDATE,
+	OP_INSERT,
+	OP_SCAN,
+	OP_RMW,
+	MAX_OP
+};
+
+static const char *dist_names[MAX_DIST] = {"uniform", "zipfian", "latest"};
+static const char *op_names[MAX_OP] = {"read", "update", "insert", "scan",
+	"rmw"};
+
+struct workload {
+	char name;
+	unsigned mix[MAX_OP]; /* percent of each operation type */
+	enum key_dist dist;
+};
+
+static const struct workload workloads[] = {
+	{'A', {50, 50, 0, 0, 0}, DIST_ZIPFIAN},
+	{'B', {95, 5, 0, 0, 0}, DIST_ZIPFIAN},
+	{'C', {100, 0, 0, 0, 0}, DIST_ZIPFIAN},
+	{'D', {95, 0, 5, 0, 0}, DIST_LATEST},
+	{'E', {0, 0, 5, 95, 0}, DIST_ZIPFIAN},
+	{'F', {50, 0, 0, 0, 50}, DIST_ZIPFIAN},
+};
+
+struct ycsb_args {
+	const struct workload *workload;
+	enum key_dist dist;
+	uint64_t records;
+	uint64_t ops;
+	unsigned threads;
+	unsigned batch;
+	size_t value_size;
+	unsigned scan_length;
+	int workid;
+};
+
+struct hist {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t max;
+	uint64_t buckets[HIST_BUCKETS];
+};
+
+/* YCSB zipfian generator over [0, n), extended as n grows */
+struct zipf {
+	uint64_t n;
+	double theta;
+	double alpha;
+	double zeta2;
+	double zetan;
+	double eta;
+};
+
+struct worker {
+	pthread_t thread;
+	unsigned id;
+	uint64_t ops;
+	uint64_t rng;
+	uint64_t aborts;
+	uint64_t checksum;
+	struct zipf zipf;
+	struct hist op_lat[MAX_OP];
+	struct hist tx_lat;
+	uint64_t start_ns;
+	uint64_t end_ns;
+};
+
+static PMEMobjpool *pop;
+static struct map_ctx *mapc;
+static struct ycsb_root *root;
+static struct ycsb_args args;
+static pthread_barrier_t start_barrier;
+
+/*
+ * now_ns -- monotonic time in nanoseconds
+ */
+static uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * rng_next -- xorshift64* generator, one state per thread
+ */
+static uint64_t
+rng_next(uint64_t *state)
+{
+	uint64_t x = *state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return x * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * rng_double -- uniform double in [0, 1)
+ */
+static double
+rng_double(uint64_t *state)
+{
+	return (double)(rng_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * fnv64 -- FNV-1a of a 64-bit value, used to scramble keys
+ */
+static uint64_t
+fnv64(uint64_t v)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (int i = 0; i < 8; i++) {
+		h ^= v & 0xff;
+		h *= 0x100000001b3ULL;
+		v >>= 8;
+	}
+	return h;
+}
+
+/*
+ * key_of -- map key of a record number
+ */
+static uint64_t
+key_of(uint64_t record)
+{
+	return fnv64(record);
+}
+
+/*
+ * zipf_grow -- extends the generator to the range [0, n)
+ */
+static void
+zipf_grow(struct zipf *z, uint64_t n)
+{
+	for (uint64_t i = z->n + 1; i <= n; i++)
+		z->zetan += 1.0 / pow((double)i, z->theta);
+	z->n = n;
+	z->eta = (1.0 - pow(2.0 / (double)n, 1.0 - z->theta)) /
+		(1.0 - z->zeta2 / z->zetan);
+}
+
+/*
+ * zipf_init -- initializes the generator over [0, n)
+ */
+static void
+zipf_init(struct zipf *z, uint64_t n, double theta)
+{
+	z->n = 0;
+	z->theta = theta;
+	z->alpha = 1.0 / (1.0 - theta);
+	z->zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+	z->zetan = 0.0;
+	zipf_grow(z, n);
+}
+
+/*
+ * zipf_next -- rank in [0, n), rank 0 being the most popular
+ */
+static uint64_t
+zipf_next(struct zipf *z, uint64_t *rng)
+{
+	double u = rng_double(rng);
+	double uz = u * z->zetan;
+
+	if (uz < 1.0)
+		return 0;
+	if (uz < 1.0 + pow(0.5, z->theta))
+		return 1;
+
+	uint64_t rank = (uint64_t)((double)z->n *
+		pow(z->eta * u - z->eta + 1.0, z->alpha));
+	return rank < z->n ? rank : z->n - 1;
+}
+
+/*
+ * next_record -- picks the record of an operation in [0, nkeys)
+ */
+static uint64_t
+next_record(struct worker *w, uint64_t nkeys)
+{
+	switch (args.dist) {
+	case DIST_UNIFORM:
+		return rng_next(&w->rng) % nkeys;
+	case DIST_ZIPFIAN:
+		if (w->zipf.n != nkeys)
+			zipf_grow(&w->zipf, nkeys);
+		/* scrambled, popular records are spread over the key space */
+		return fnv64(zipf_next(&w->zipf, &w->rng)) % nkeys;
+	case DIST_LATEST:
+		if (w->zipf.n != nkeys)
+			zipf_grow(&w->zipf, nkeys);
+		return nkeys - 1 - zipf_next(&w->zipf, &w->rng);
+	default:
+		abort();
+	}
+}
+
+/*
+ * hist_record -- counts a latency in its log-linear bucket
+ */
+static void
+hist_record(struct hist *h, uint64_t ns)
+{
+	unsigned idx;
+	if (ns < HIST_SUB) {
+		idx = (unsigned)ns;
+	} else {
+		unsigned e = 63 - (unsigned)__builtin_clzll(ns);
+		unsigned sub = (unsigned)(ns >> (e - HIST_SUB_BITS)) &
+			(HIST_SUB - 1);
+		idx = (e - HIST_SUB_BITS + 1) * HIST_SUB + sub;
+	}
+
+	h->buckets[idx]++;
+	h->count++;
+	h->sum += ns;
+	if (ns > h->max)
+		h->max = ns;
+}
+
+/*
+ * hist_value -- lower bound of the values counted in a bucket
+ */
+static uint64_t
+hist_value(unsigned idx)
+{
+	if (idx < HIST_SUB)
+		return idx;
+	unsigned e = idx / HIST_SUB + HIST_SUB_BITS - 1;
+	uint64_t sub = idx % HIST_SUB;
+	return (1ULL << e) | (sub << (e - HIST_SUB_BITS));
+}
+
+/*
+ * hist_percentile -- latency below which p percent of the samples lie
+ */
+static uint64_t
+hist_percentile(const struct hist *h, double p)
+{
+	uint64_t target = (uint64_t)ceil(p / 100.0 * (double)h->count);
+	uint64_t seen = 0;
+
+	for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+		seen += h->buckets[i];
+		if (seen >= target && seen != 0)
+			return hist_value(i);
+	}
+	return h->max;
+}
+
+/*
+ * hist_merge -- adds the samples of src to dst
+ */
+static void
+hist_merge(struct hist *dst, const struct hist *src)
+{
+	dst->count += src->count;
+	dst->sum += src->sum;
+	if (src->max > dst->max)
+		dst->max = src->max;
+	for (unsigned i = 0; i < HIST_BUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+}
+
+/*
+ * fill_value -- fills a value with random bytes
+ */
+static void
+fill_value(char *data, size_t size, uint64_t *rng)
+{
+	for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+		uint64_t v = rng_next(rng);
+		size_t n = size - i < sizeof(v) ? size - i : sizeof(v);
+		memcpy(data + i, &v, n);
+	}
+}
+
+/*
+ * read_record -- looks a record up and reads its whole value
+ */
+static void
+read_record(struct worker *w, struct shard *s, uint64_t record)
+{
+	PMEMoid oid = map_get(mapc, s->map, key_of(record));
+	if (OID_IS_NULL(oid))
+		return;
+
+	struct ycsb_value *v = pmemobj_direct(oid);
+	for (size_t i = 0; i < v->size; i++)
+		w->checksum += (unsigned char)v->data[i];
+}
+
+/*
+ * update_record -- overwrites the value of a record, must be called in a
+ * transaction
+ */
+static void
+update_record(struct worker *w, struct shard *s, uint64_t record)
+{
+	PMEMoid oid = map_get(mapc, s->map, key_of(record));
+	if (OID_IS_NULL(oid))
+		return;
+
+	struct ycsb_value *v = pmemobj_direct(oid);
+	pmemobj_tx_add_range_direct(v->data, v->size);
+	fill_value(v->data, v->size, &w->rng);
+}
+
+/*
+ * insert_record -- appends the next record of the shard, must be called
+ * in a transaction
+ */
+static void
+insert_record(struct worker *w, struct shard *s)
+{
+	TOID(struct ycsb_value) value = TX_ALLOC(struct ycsb_value,
+		sizeof(struct ycsb_value) + args.value_size);
+	D_RW(value)->size = args.value_size;
+	fill_value(D_RW(value)->data, args.value_size, &w->rng);
+
+	map_insert(mapc, s->map, key_of(s->nkeys), value.oid);
+
+	pmemobj_tx_add_range_direct(&s->nkeys, sizeof(s->nkeys));
+	s->nkeys++;
+}
+
+/*
+ * next_op -- draws an operation from the workload mix
+ */
+static enum op_type
+next_op(struct worker *w)
+{
+	unsigned r = (unsigned)(rng_next(&w->rng) % 100);
+	for (int op = 0; op < MAX_OP; op++) {
+		if (r < args.workload->mix[op])
+			return (enum op_type)op;
+		r -= args.workload->mix[op];
+	}
+	return OP_READ;
+}
+
+/*
+ * run_op -- executes one operation on the shard of a thread
+ */
+static void
+run_op(struct worker *w, struct shard *s, enum op_type op)
+{
+	uint64_t record;
+
+	switch (op) {
+	case OP_READ:
+		read_record(w, s, next_record(w, s->nkeys));
+		break;
+	case OP_UPDATE:
+		update_record(w, s, next_record(w, s->nkeys));
+		break;
+	case OP_INSERT:
+		insert_record(w, s);
+		break;
+	case OP_SCAN: {
+		record = next_record(w, s->nkeys);
+		unsigned length = 1 +
+			(unsigned)(rng_next(&w->rng) % args.scan_length);
+		for (unsigned i = 0; i < length; i++)
+			read_record(w, s, (record + i) % s->nkeys);
+		break;
+	}
+	case OP_RMW:
+		record = next_record(w, s->nkeys);
+		read_record(w, s, record);
+		update_record(w, s, record);
+		break;
+	default:
+		abort();
+	}
+}
+
+/*
+ * load_shard -- creates the map of a thread and inserts its records
+ */
+static void
+load_shard(struct worker *w, struct shard *s, uint64_t nrecords)
+{
+	TX_BEGIN(pop) {
+		map_create(mapc, &s->map, NULL);
+	} TX_ONABORT {
+		fprintf(stderr, "cannot create the map of thread %u\n", w->id);
+		exit(1);
+	} TX_END
+
+	while (s->nkeys < nrecords) {
+		TX_BEGIN(pop) {
+			for (unsigned i = 0; i < args.batch &&
+					s->nkeys < nrecords; i++)
+				insert_record(w, s);
+		} TX_ONABORT {
+			fprintf(stderr, "load aborted: %s\n",
+				pmemobj_errormsg());
+			exit(1);
+		} TX_END
+	}
+}
+
+/*
+ * worker_run -- runs the operations of a thread, batched in transactions
+ */
+static void *
+worker_run(void *arg)
+{
+	struct worker *w = arg;
+	struct shard *s = &root->shards[w->id];
+
+	zipf_init(&w->zipf, s->nkeys, ZIPFIAN_THETA);
+
+	pthread_barrier_wait(&start_barrier);
+#ifdef PMBENCH
+	/* Native counters are per thread, each worker is a region */
+	m5_work_begin(args.workid, w->id);
+#endif
+	w->start_ns = now_ns();
+
+	for (uint64_t done = 0; done < w->ops; ) {
+		unsigned n = args.batch;
+		if (w->ops - done < n)
+			n = (unsigned)(w->ops - done);
+
+		uint64_t tx_start = now_ns();
+		TX_BEGIN(pop) {
+			for (unsigned i = 0; i < n; i++) {
+				enum op_type op = next_op(w);
+				uint64_t start = now_ns();
+				run_op(w, s, op);
+				hist_record(&w->op_lat[op], now_ns() - start);
+			}
+		} TX_ONABORT {
+			w->aborts++;
+		} TX_END
+		hist_record(&w->tx_lat, now_ns() - tx_start);
+
+		done += n;
+	}
+
+	w->end_ns = now_ns();
+#ifdef PMBENCH
+	m5_work_end(args.workid, w->id);
+#endif
+	return NULL;
+}
+
+/*
+ * worker_load -- loads the records of a thread
+ */
+static void *
+worker_load(void *arg)
+{
+	struct worker *w = arg;
+	uint64_t nrecords = args.records / args.threads +
+		(w->id < args.records % args.threads);
+
+	load_shard(w, &root->shards[w->id], nrecords);
+	return NULL;
+}
+
+/*
+ * print_hist -- prints a latency summary line
+ */
+static void
+print_hist(const char *name, const struct hist *h)
+{
+	if (h->count == 0)
+		return;
+
+	printf("%-8s %10lu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+		name, h->count,
+		(double)h->sum / (double)h->count / 1000.0,
+		(double)hist_percentile(h, 50.0) / 1000.0,
+		(double)hist_percentile(h, 95.0) / 1000.0,
+		(double)hist_percentile(h, 99.0) / 1000.0,
+		(double)hist_percentile(h, 99.9) / 1000.0,
+		(double)h->max / 1000.0);
+}
+
+/*
+ * report -- merges the results of all threads and prints them
+ */
+static void
+report(const char *type, struct worker *workers, uint64_t elapsed_ns)
+{
+	static struct hist op_lat[MAX_OP];
+	static struct hist tx_lat;
+	uint64_t aborts = 0;
+	uint64_t ops = 0;
+
+	for (unsigned t = 0; t < args.threads; t++) {
+		for (int op = 0; op < MAX_OP; op++)
+			hist_merge(&op_lat[op], &workers[t].op_lat[op]);
+		hist_merge(&tx_lat, &workers[t].tx_lat);
+		aborts += workers[t].aborts;
+		ops += workers[t].ops;
+	}
+
+	double secs = (double)elapsed_ns / 1e9;
+	printf("workload %c map %s dist %s threads %u batch %u records %lu "
+		"value %zu\n", args.workload->name, type, dist_names[args.dist],
+		args.threads, args.batch, args.records, args.value_size);
+	printf("ops %lu time %.3f s throughput %.0f ops/s aborts %lu\n",
+		ops, secs, (double)ops / secs, aborts);
+	printf("%-8s %10s %10s %10s %10s %10s %10s %10s\n", "op", "count",
+		"mean_us", "p50_us", "p95_us", "p99_us", "p999_us", "max_us");
+	for (int op = 0; op < MAX_OP; op++)
+		print_hist(op_names[op], &op_lat[op]);
+	print_hist("tx", &tx_lat);
+}
+
+/*
+ * parse_map_type -- parse type of map
+ */
+static const struct map_ops *
+parse_map_type(const char *type)
+{
+	if (strcmp(type, "ctree") == 0)
+		return MAP_CTREE;
+	else if (strcmp(type, "btree") == 0)
+		return MAP_BTREE;
+	else if (strcmp(type, "rbtree") == 0)
+		return MAP_RBTREE;
+	else if (strcmp(type, "hashmap_atomic") == 0)
+		return MAP_HASHMAP_ATOMIC;
+	else if (strcmp(type, "hashmap_tx") == 0)
+		return MAP_HASHMAP_TX;
+	else if (strcmp(type, "hashmap_rp") == 0)
+		return MAP_HASHMAP_RP;
+	else if (strcmp(type, "hashmap_cl") == 0)
+		return MAP_HASHMAP_CL;
+	else if (strcmp(type, "skiplist") == 0)
+		return MAP_SKIPLIST;
+	return NULL;
+}
+
+/*
+ * usage -- prints usage
+ */
+static void
+usage(const char *prog)
+{
+	printf("usage: %s <ctree|btree|rbtree|hashmap_atomic|hashmap_rp|"
+		"hashmap_tx|hashmap_cl|skiplist> file-name [-w A-F] "
+		"[-r records] [-o ops] [-t threads] [-b ops per tx] "
+		"[-v value size] "
+		"[-d uniform|zipfian|latest] [-s max scan length] "
+		"[-i gem5 work id]\n", prog);
+}
+
+/*
+ * parse_args -- parses the options following the pool file
+ */
+static int
+parse_args(int argc, char *argv[])
+{
+	int dist = -1;
+	int opt;
+
+	args.workload = &workloads[0];
+	args.records = 100000;
+	args.ops = 100000;
+	args.threads = 1;
+	args.batch = 1;
+	args.value_size = 100;
+	args.scan_length = 100;
+	args.workid = 0;
+
+	while ((opt = getopt(argc, argv, "w:r:o:t:b:v:d:s:i:")) != -1) {
+		switch (opt) {
+		case 'w':
+			args.workload = NULL;
+			for (size_t i = 0; i < sizeof(workloads) /
+					sizeof(workloads[0]); i++) {
+				if (workloads[i].name == (optarg[0] & ~0x20))
+					args.workload = &workloads[i];
+			}
+			if (args.workload == NULL || optarg[1] != '\0') {
+				fprintf(stderr, "invalid workload -- '%s'\n",
+					optarg);
+				return -1;
+			}
+			break;
+		case 'r':
+			args.records = strtoull(optarg, NULL, 10);
+			break;
+		case 'o':
+			args.ops = strtoull(optarg, NULL, 10);
+			break;
+		case 't':
+			args.threads = (unsigned)atoi(optarg);
+			break;
+		case 'b':
+			args.batch = (unsigned)atoi(optarg);
+			break;
+		case 'v':
+			args.value_size = strtoull(optarg, NULL, 10);
+			break;
+		case 'd':
+			for (int i = 0; i < MAX_DIST; i++) {
+				if (strcmp(optarg, dist_names[i]) == 0)
+					dist = i;
+			}
+			if (dist < 0) {
+				fprintf(stderr, "invalid distribution -- '%s'\n",
+					optarg);
+				return -1;
+			}
+			break;
+		case 's':
+			args.scan_length = (unsigned)atoi(optarg);
+			break;
+		case 'i':
+			args.workid = atoi(optarg);
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	args.dist = dist < 0 ? args.workload->dist : (enum key_dist)dist;
+
+	if (args.threads == 0 || args.threads > MAX_THREADS) {
+		fprintf(stderr, "number of threads must be in range 1..%d\n",
+			MAX_THREADS);
+		return -1;
+	}
+	if (args.records < args.threads || args.batch == 0 ||
+			args.scan_length == 0) {
+		fprintf(stderr, "records must be at least the number of "
+			"threads, batch and scan length at least 1\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	const char *type = argv[1];
+	const char *path = argv[2];
+	const struct map_ops *map_ops = parse_map_type(type);
+	if (!map_ops) {
+		fprintf(stderr, "invalid container type -- '%s'\n", type);
+		return 1;
+	}
+
+	optind = 3;
+	if (parse_args(argc, argv) != 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (file_exists(path) != 0) {
+		/* values, allocation headers and map nodes of every record */
+		size_t inserts = args.ops * args.workload->mix[OP_INSERT] / 100;
+		size_t pool_size = (args.records + inserts) *
+			(args.value_size + 256) * 2 + PMEMOBJ_MIN_POOL * 8;
+
+		if ((pop = pmemobj_create(path, POBJ_LAYOUT_NAME(ycsb),
+			pool_size, 0666)) == NULL) {
+			perror("failed to create pool\n");
+			return 1;
+		}
+	} else {
+		if ((pop = pmemobj_open(path,
+				POBJ_LAYOUT_NAME(ycsb))) == NULL) {
+			perror("failed to open pool\n");
+			return 1;
+		}
+	}
+
+	root = D_RW(POBJ_ROOT(pop, struct ycsb_root));
+
+	mapc = map_ctx_init(map_ops, pop);
+	if (!mapc) {
+		perror("cannot allocate map context\n");
+		return 1;
+	}
+
+	struct worker *workers = calloc(args.threads, sizeof(*workers));
+	if (workers == NULL) {
+		perror("cannot allocate workers\n");
+		return 1;
+	}
+	for (unsigned t = 0; t < args.threads; t++) {
+		workers[t].id = t;
+		workers[t].rng = fnv64(t + 1);
+		workers[t].ops = args.ops / args.threads +
+			(t < args.ops % args.threads);
+	}
+
+	/* a loaded pool is reused by the following runs */
+	if (root->nshards == 0) {
+		for (unsigned t = 0; t < args.threads; t++)
+			pthread_create(&workers[t].thread, NULL, worker_load,
+				&workers[t]);
+		for (unsigned t = 0; t < args.threads; t++)
+			pthread_join(workers[t].thread, NULL);
+
+		root->nshards = args.threads;
+		pmemobj_persist(pop, &root->nshards, sizeof(root->nshards));
+	} else if (root->nshards != args.threads) {
+		fprintf(stderr, "pool was loaded by %lu threads\n",
+			root->nshards);
+		return 1;
+	}
+
+	pthread_barrier_init(&start_barrier, NULL, args.threads + 1);
+	for (unsigned t = 0; t < args.threads; t++)
+		pthread_create(&workers[t].thread, NULL, worker_run,
+			&workers[t]);
+
+	pthread_barrier_wait(&start_barrier);
+#ifdef GEM5
+	m5_work_begin(args.workid, 0);
+#endif
+
+	for (unsigned t = 0; t < args.threads; t++)
+		pthread_join(workers[t].thread, NULL);
+
+	/* from the first thread to start to the last one to finish */
+	uint64_t start = workers[0].start_ns;
+	uint64_t end = workers[0].end_ns;
+	for (unsigned t = 1; t < args.threads; t++) {
+		if (workers[t].start_ns < start)
+			start = workers[t].start_ns;
+		if (workers[t].end_ns > end)
+			end = workers[t].end_ns;
+	}
+	uint64_t elapsed = end - start;
+#ifdef GEM5
+	m5_work_end(args.workid, 0);
+#endif
+
+	report(type, workers, elapsed);
+
+	pthread_barrier_destroy(&start_barrier);
+	free(workers);
+	map_ctx_free(mapc);
+	pmemobj_close(pop);
+
+	return 0;
+}
@@ -43,11 +43,162 @@
 #ifndef LIBPMEM2_H
 #define LIBPMEM2_H 1
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* XXX placeholder */
+/*
+ * opaque types internal to libpmem2
+ */
+struct pmem2_config;
+struct pmem2_source;
+struct pmem2_map;
+
+/*
+ * error codes, returned negated by all the functions returning int
+ */
+#define PMEM2_E_UNKNOWN				(-100000)
+#define PMEM2_E_NOSUPP				(-100001)
+#define PMEM2_E_INVALID_FILE_HANDLE		(-100004)
+#define PMEM2_E_INVALID_FILE_TYPE		(-100005)
+#define PMEM2_E_MAP_RANGE			(-100006)
+#define PMEM2_E_GRANULARITY_NOT_SET		(-100008)
+#define PMEM2_E_GRANULARITY_NOT_SUPPORTED	(-100009)
+#define PMEM2_E_OFFSET_OUT_OF_RANGE		(-100010)
+#define PMEM2_E_OFFSET_UNALIGNED		(-100011)
+#define PMEM2_E_INVALID_ALIGNMENT_FORMAT	(-100012)
+#define PMEM2_E_INVALID_SIZE_FORMAT		(-100014)
+#define PMEM2_E_LENGTH_UNALIGNED		(-100015)
+#define PMEM2_E_SOURCE_EMPTY			(-100018)
+#define PMEM2_E_INVALID_SHARING_VALUE		(-100019)
+#define PMEM2_E_SRC_DEVDAX_PRIVATE		(-100020)
+#define PMEM2_E_DEEP_FLUSH_RANGE		(-100024)
+#define PMEM2_E_LENGTH_OUT_OF_RANGE		(-100030)
+#define PMEM2_E_INVALID_PROT_FLAG		(-100031)
+
+/*
+ * the smallest unit of stores that is guaranteed to become persistent
+ * after being flushed by the functions returned for a mapping
+ */
+enum pmem2_granularity {
+	/* stores are persistent once visible (eADR) */
+	PMEM2_GRANULARITY_BYTE,
+	/* cache lines have to be flushed (ADR, DAX mapping) */
+	PMEM2_GRANULARITY_CACHE_LINE,
+	/* pages have to be written back with msync(2) (no DAX) */
+	PMEM2_GRANULARITY_PAGE,
+};
+
+enum pmem2_sharing_type {
+	PMEM2_SHARED,
+	PMEM2_PRIVATE,
+};
+
+#define PMEM2_PROT_EXEC		(1U << 29)
+#define PMEM2_PROT_READ		(1U << 30)
+#define PMEM2_PROT_WRITE	(1U << 31)
+#define PMEM2_PROT_NONE		0
+
+/* source */
+
+int pmem2_source_from_fd(struct pmem2_source **src, int fd);
+
+int pmem2_source_from_anon(struct pmem2_source **src, size_t size);
+
+int pmem2_source_delete(struct pmem2_source **src);
+
+int pmem2_source_size(const struct pmem2_source *src, size_t *size);
+
+int pmem2_source_alignment(const struct pmem2_source *src,
+		size_t *alignment);
+
+/* config */
+
+int pmem2_config_new(struct pmem2_config **cfg);
+
+int pmem2_config_delete(struct pmem2_config **cfg);
+
+int pmem2_config_set_offset(struct pmem2_config *cfg, size_t offset);
+
+int pmem2_config_set_length(struct pmem2_config *cfg, size_t length);
+
+int pmem2_config_set_required_store_granularity(struct pmem2_config *cfg,
+		enum pmem2_granularity g);
+
+int pmem2_config_set_sharing(struct pmem2_config *cfg,
+		enum pmem2_sharing_type type);
+
+int pmem2_config_set_protection(struct pmem2_config *cfg, unsigned prot);
+
+/* map */
+
+int pmem2_map(const struct pmem2_config *cfg, const struct pmem2_source *src,
+		struct pmem2_map **map_ptr);
+
+int pmem2_unmap(struct pmem2_map **map_ptr);
+
+void *pmem2_map_get_address(struct pmem2_map *map);
+
+size_t pmem2_map_get_size(struct pmem2_map *map);
+
+enum pmem2_granularity pmem2_map_get_store_granularity(struct pmem2_map *map);
+
+/* flushing */
+
+typedef void (*pmem2_persist_fn)(const void *ptr, size_t size);
+
+typedef void (*pmem2_flush_fn)(const void *ptr, size_t size);
+
+typedef void (*pmem2_drain_fn)(void);
+
+pmem2_persist_fn pmem2_get_persist_fn(struct pmem2_map *map);
+
+pmem2_flush_fn pmem2_get_flush_fn(struct pmem2_map *map);
+
+pmem2_drain_fn pmem2_get_drain_fn(struct pmem2_map *map);
+
+int pmem2_deep_flush(struct pmem2_map *map, void *ptr, size_t size);
+
+/* data transfer, the flags have the same meaning as in libpmem */
+
+#define PMEM2_F_MEM_NODRAIN	(1U << 0)
+
+#define PMEM2_F_MEM_NONTEMPORAL	(1U << 1)
+#define PMEM2_F_MEM_TEMPORAL	(1U << 2)
+
+#define PMEM2_F_MEM_WC		(1U << 3)
+#define PMEM2_F_MEM_WB		(1U << 4)
+
+#define PMEM2_F_MEM_NOFLUSH	(1U << 5)
+
+#define PMEM2_F_MEM_VALID_FLAGS (PMEM2_F_MEM_NODRAIN | \
+		PMEM2_F_MEM_NONTEMPORAL | \
+		PMEM2_F_MEM_TEMPORAL | \
+		PMEM2_F_MEM_WC | \
+		PMEM2_F_MEM_WB | \
+		PMEM2_F_MEM_NOFLUSH)
+
+typedef void *(*pmem2_memmove_fn)(void *pmemdest, const void *src, size_t len,
+		unsigned flags);
+
+typedef void *(*pmem2_memcpy_fn)(void *pmemdest, const void *src, size_t len,
+		unsigned flags);
+
+typedef void *(*pmem2_memset_fn)(void *pmemdest, int c, size_t len,
+		unsigned flags);
+
+pmem2_memmove_fn pmem2_get_memmove_fn(struct pmem2_map *map);
+
+pmem2_memcpy_fn pmem2_get_memcpy_fn(struct pmem2_map *map);
+
+pmem2_memset_fn pmem2_get_memset_fn(struct pmem2_map *map);
+
+/* error handling */
+
+const char *pmem2_errormsg(void);
 
 #ifdef __cplusplus
 }
@@ -122,10 +122,10 @@ is_cpu_feature_present(unsigned func, unsigned reg, unsigned bit)
 }
 
 /*
- * is_cpu_genuine_intel -- checks for genuine Intel CPU
+ * cpu_vendor_is -- (internal) checks the CPUID vendor string
  */
-int
-is_cpu_genuine_intel(void)
+static int
+cpu_vendor_is(const char *expected)
 {
 	unsigned cpuinfo[4] = { 0 };
 
@@ -143,8 +143,28 @@ is_cpu_genuine_intel(void)
 	vendor.cpuinfo[2] = cpuinfo[ECX_IDX];
 
 	LOG(4, "CPU vendor: %s", vendor.name);
-	return (strncmp(vendor.name, "GenuineIntel",
-				sizeof(vendor.name))) == 0;
+	return (strncmp(vendor.name, expected, sizeof(vendor.name))) == 0;
+}
+
+/*
+ * is_cpu_genuine_intel -- checks for genuine Intel CPU
+ */
+int
+is_cpu_genuine_intel(void)
+{
+	return cpu_vendor_is("GenuineIntel");
+}
+
+/*
+ * is_cpu_simulator -- checks for the CPU model of the gem5 simulator
+ */
+int
+is_cpu_simulator(void)
+{
+	int ret = cpu_vendor_is("M5 Simulator");
+	LOG(4, "%srunning in gem5", ret == 0 ? "not " : "");
+
+	return ret;
 }
 
 /*
@@ -38,6 +38,7 @@
  */
 
 int is_cpu_genuine_intel(void);
+int is_cpu_simulator(void);
 int is_cpu_clflush_present(void);
 int is_cpu_clflushopt_present(void);
 int is_cpu_clwb_present(void);
@@ -45,7 +45,7 @@
 
 #include "../../helper_suyash.h"
 
-#define MOVNT_THRESHOLD	256000000UL
+#define MOVNT_THRESHOLD	256
 
 size_t Movnt_threshold = MOVNT_THRESHOLD;
 
@@ -67,10 +67,6 @@ predrain_fence_empty(void)
 
 int sfence_warn_cnt = 1;
 
-#undef SSE2_AVAILABLE 
-#undef AVX_AVAILABLE
-#undef AVX512F_AVAILABLE
-
 static void
 predrain_memory_barrier(void)
 {
@@ -138,11 +134,11 @@ memmove_nodrain_##isa##_##flush(void *dest, const void *src, size_t len, \
 	if (len == 0 || src == dest)\
 		return dest;\
 \
-	if ((flags & PMEM_F_MEM_NOFLUSH) & 0) \
+	if (flags & PMEM_F_MEM_NOFLUSH) \
 		memmove_mov_##isa##_empty(dest, src, len); \
-	else if ((flags & PMEM_F_MEM_MOVNT) & 0)\
+	else if (flags & PMEM_F_MEM_MOVNT)\
 		memmove_movnt_##isa ##_##flush(dest, src, len);\
-	else if ((flags & PMEM_F_MEM_MOV) | 1)\
+	else if (flags & PMEM_F_MEM_MOV)\
 		memmove_mov_##isa##_##flush(dest, src, len);\
 	else if (len < Movnt_threshold)\
 		memmove_mov_##isa##_##flush(dest, src, len);\
@@ -159,13 +155,13 @@ memset_nodrain_##isa##_##flush(void *dest, int c, size_t len, unsigned flags)\
 	if (len == 0)\
 		return dest;\
 \
-	if ((flags & PMEM_F_MEM_NOFLUSH) & 0) \
+	if (flags & PMEM_F_MEM_NOFLUSH) \
 		memset_mov_##isa##_empty(dest, c, len); \
-	else if ((flags & PMEM_F_MEM_MOVNT) & 0)\
+	else if (flags & PMEM_F_MEM_MOVNT)\
 		memset_movnt_##isa##_##flush(dest, c, len);\
-	else if ((flags & PMEM_F_MEM_MOV) | 1)\
+	else if (flags & PMEM_F_MEM_MOV)\
 		memset_mov_##isa##_##flush(dest, c, len);\
-	else if ((len < Movnt_threshold))\
+	else if (len < Movnt_threshold)\
 		memset_mov_##isa##_##flush(dest, c, len);\
 	else\
 		memset_movnt_##isa##_##flush(dest, c, len);\
@@ -295,8 +291,8 @@ use_avx_memcpy_memset(struct pmem_funcs *funcs, enum memcpy_impl *impl)
 	LOG(3, "avx supported");
 
 	char *e = os_getenv("PMEM_AVX");
-	if (e == NULL || strcmp(e, "1") != 0) {
-		LOG(3, "PMEM_AVX not set or not == 1");
+	if (e && strcmp(e, "0") == 0) {
+		LOG(3, "PMEM_AVX forced no avx");
 		return;
 	}
 
@@ -339,8 +335,8 @@ use_avx512f_memcpy_memset(struct pmem_funcs *funcs, enum memcpy_impl *impl)
 	LOG(3, "avx512f supported");
 
 	char *e = os_getenv("PMEM_AVX512F");
-	if (e == NULL || strcmp(e, "1") != 0) {
-		LOG(3, "PMEM_AVX512F not set or not == 1");
+	if (e && strcmp(e, "0") == 0) {
+		LOG(3, "PMEM_AVX512F forced no avx512f");
 		return;
 	}
 
@@ -373,6 +369,27 @@ use_avx512f_memcpy_memset(struct pmem_funcs *funcs, enum memcpy_impl *impl)
 #endif
 }
 
+/*
+ * pmem_simulator_profile -- (internal) check if running on the simulated CPU
+ *
+ * The simulated x86 CPU of gem5 is only used with the generic memmove and
+ * memset, which do cached stores followed by flushes.
+ */
+static int
+pmem_simulator_profile(void)
+{
+	char *e = os_getenv("PMEM_SIMULATOR");
+	if (e && strcmp(e, "1") == 0) {
+		LOG(3, "PMEM_SIMULATOR forced simulator profile");
+		return 1;
+	} else if (e && strcmp(e, "0") == 0) {
+		LOG(3, "PMEM_SIMULATOR forced native profile");
+		return 0;
+	}
+
+	return is_cpu_simulator();
+}
+
 /*
  * pmem_get_cpuinfo -- configure libpmem based on CPUID
  */
@@ -411,11 +428,11 @@ pmem_cpuinfo_to_funcs(struct pmem_funcs *funcs, enum memcpy_impl *impl)
 	}
 
 	char *ptr = os_getenv("PMEM_NO_MOVNT");
-	ptr = "1";
 	if (ptr && strcmp(ptr, "1") == 0) {
 		LOG(3, "PMEM_NO_MOVNT forced no movnt");
+	} else if (pmem_simulator_profile()) {
+		LOG(3, "simulator profile, no movnt");
 	} else {
-		assert(0 && "Tried enabling MOVNT instructions");
 		use_sse2_memcpy_memset(funcs, impl);
 
 		if (is_cpu_avx_present())
@@ -45,7 +45,6 @@
 static force_inline void
 memmove_movnt32x64b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m512i zmm0 = _mm512_loadu_si512((__m512i *)src + 0);
 	__m512i zmm1 = _mm512_loadu_si512((__m512i *)src + 1);
 	__m512i zmm2 = _mm512_loadu_si512((__m512i *)src + 2);
@@ -118,7 +117,6 @@ memmove_movnt32x64b(char *dest, const char *src)
 static force_inline void
 memmove_movnt16x64b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m512i zmm0 = _mm512_loadu_si512((__m512i *)src + 0);
 	__m512i zmm1 = _mm512_loadu_si512((__m512i *)src + 1);
 	__m512i zmm2 = _mm512_loadu_si512((__m512i *)src + 2);
@@ -159,7 +157,6 @@ memmove_movnt16x64b(char *dest, const char *src)
 static force_inline void
 memmove_movnt8x64b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m512i zmm0 = _mm512_loadu_si512((__m512i *)src + 0);
 	__m512i zmm1 = _mm512_loadu_si512((__m512i *)src + 1);
 	__m512i zmm2 = _mm512_loadu_si512((__m512i *)src + 2);
@@ -184,7 +181,6 @@ memmove_movnt8x64b(char *dest, const char *src)
 static force_inline void
 memmove_movnt4x64b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m512i zmm0 = _mm512_loadu_si512((__m512i *)src + 0);
 	__m512i zmm1 = _mm512_loadu_si512((__m512i *)src + 1);
 	__m512i zmm2 = _mm512_loadu_si512((__m512i *)src + 2);
@@ -201,7 +197,6 @@ memmove_movnt4x64b(char *dest, const char *src)
 static force_inline void
 memmove_movnt2x64b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m512i zmm0 = _mm512_loadu_si512((__m512i *)src + 0);
 	__m512i zmm1 = _mm512_loadu_si512((__m512i *)src + 1);
 
@@ -214,7 +209,6 @@ memmove_movnt2x64b(char *dest, const char *src)
 static force_inline void
 memmove_movnt1x64b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m512i zmm0 = _mm512_loadu_si512((__m512i *)src + 0);
 
 	_mm512_stream_si512((__m512i *)dest + 0, zmm0);
@@ -225,7 +219,6 @@ memmove_movnt1x64b(char *dest, const char *src)
 static force_inline void
 memmove_movnt1x32b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m256i zmm0 = _mm256_loadu_si256((__m256i *)src);
 
 	_mm256_stream_si256((__m256i *)dest, zmm0);
@@ -236,7 +229,6 @@ memmove_movnt1x32b(char *dest, const char *src)
 static force_inline void
 memmove_movnt1x16b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	__m128i ymm0 = _mm_loadu_si128((__m128i *)src);
 
 	_mm_stream_si128((__m128i *)dest, ymm0);
@@ -247,7 +239,6 @@ memmove_movnt1x16b(char *dest, const char *src)
 static force_inline void
 memmove_movnt1x8b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	_mm_stream_si64((long long *)dest, *(long long *)src);
 
 	VALGRIND_DO_FLUSH(dest, 8);
@@ -256,7 +247,6 @@ memmove_movnt1x8b(char *dest, const char *src)
 static force_inline void
 memmove_movnt1x4b(char *dest, const char *src)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	_mm_stream_si32((int *)dest, *(int *)src);
 
 	VALGRIND_DO_FLUSH(dest, 4);
@@ -265,7 +255,6 @@ memmove_movnt1x4b(char *dest, const char *src)
 static force_inline void
 memmove_movnt_avx512f_fw(char *dest, const char *src, size_t len)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	size_t cnt = (uint64_t)dest & 63;
 	if (cnt > 0) {
 		cnt = 64 - cnt;
@@ -351,7 +340,6 @@ end:
 static force_inline void
 memmove_movnt_avx512f_bw(char *dest, const char *src, size_t len)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	dest += len;
 	src += len;
 
@@ -450,7 +438,6 @@ end:
 void
 EXPORTED_SYMBOL(char *dest, const char *src, size_t len)
 {
-	printf("Using the %s function at %s:%d\n", __FUNCTION__, __FILE__, __LINE__);
 	if ((uintptr_t)dest - (uintptr_t)src >= len)
 		memmove_movnt_avx512f_fw(dest, src, len);
 	else
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * config.c -- pmem2_config implementation
+ */
+
+#include "alloc.h"
+#include "libpmem2.h"
+#include "out.h"
+#include "pmem2.h"
+
+/*
+ * pmem2_config_init -- initializes the given config with default values
+ */
+void
+pmem2_config_init(struct pmem2_config *cfg)
+{
+	cfg->offset = 0;
+	cfg->length = 0;
+	cfg->requested_max_granularity = PMEM2_GRANULARITY_INVALID;
+	cfg->sharing = PMEM2_SHARED;
+	cfg->protection_flag = PMEM2_PROT_READ | PMEM2_PROT_WRITE;
+}
+
+/*
+ * pmem2_config_new -- allocates and initializes a new config
+ */
+int
+pmem2_config_new(struct pmem2_config **cfg)
+{
+	LOG(3, "cfg %p", cfg);
+
+	*cfg = Malloc(sizeof(**cfg));
+	if (*cfg == NULL) {
+		ERR("!Malloc");
+		return PMEM2_E_ERRNO;
+	}
+
+	pmem2_config_init(*cfg);
+
+	return 0;
+}
+
+/*
+ * pmem2_config_delete -- deletes the config
+ */
+int
+pmem2_config_delete(struct pmem2_config **cfg)
+{
+	LOG(3, "cfg %p", cfg);
+
+	Free(*cfg);
+	*cfg = NULL;
+
+	return 0;
+}
+
+/*
+ * pmem2_config_set_offset -- sets the offset in the source to map from
+ */
+int
+pmem2_config_set_offset(struct pmem2_config *cfg, size_t offset)
+{
+	LOG(3, "cfg %p offset %zu", cfg, offset);
+
+	/* mmap(2) takes a signed offset */
+	if (offset > (size_t)INT64_MAX) {
+		ERR("offset is greater than INT64_MAX");
+		return PMEM2_E_OFFSET_OUT_OF_RANGE;
+	}
+
+	cfg->offset = offset;
+
+	return 0;
+}
+
+/*
+ * pmem2_config_set_length -- sets the length of the mapping
+ */
+int
+pmem2_config_set_length(struct pmem2_config *cfg, size_t length)
+{
+	LOG(3, "cfg %p length %zu", cfg, length);
+
+	cfg->length = length;
+
+	return 0;
+}
+
+/*
+ * pmem2_config_set_required_store_granularity -- sets the coarsest
+ *	granularity the application can work with
+ */
+int
+pmem2_config_set_required_store_granularity(struct pmem2_config *cfg,
+		enum pmem2_granularity g)
+{
+	LOG(3, "cfg %p granularity %d", cfg, g);
+
+	switch (g) {
+		case PMEM2_GRANULARITY_BYTE:
+		case PMEM2_GRANULARITY_CACHE_LINE:
+		case PMEM2_GRANULARITY_PAGE:
+			break;
+		default:
+			ERR("unknown granularity value %d", g);
+			return PMEM2_E_GRANULARITY_NOT_SUPPORTED;
+	}
+
+	cfg->requested_max_granularity = g;
+
+	return 0;
+}
+
+/*
+ * pmem2_config_set_sharing -- sets whether stores reach the source
+ */
+int
+pmem2_config_set_sharing(struct pmem2_config *cfg,
+		enum pmem2_sharing_type type)
+{
+	LOG(3, "cfg %p type %d", cfg, type);
+
+	switch (type) {
+		case PMEM2_SHARED:
+		case PMEM2_PRIVATE:
+			cfg->sharing = type;
+			break;
+		default:
+			ERR("unknown sharing value %d", type);
+			return PMEM2_E_INVALID_SHARING_VALUE;
+	}
+
+	return 0;
+}
+
+/*
+ * pmem2_config_set_protection -- sets the protection of the mapping
+ */
+int
+pmem2_config_set_protection(struct pmem2_config *cfg, unsigned prot)
+{
+	LOG(3, "cfg %p prot %x", cfg, prot);
+
+	unsigned unknown = prot & ~(unsigned)(PMEM2_PROT_READ |
+		PMEM2_PROT_WRITE | PMEM2_PROT_EXEC);
+	if (unknown) {
+		ERR("invalid protection flags %x", unknown);
+		return PMEM2_E_INVALID_PROT_FLAG;
+	}
+
+	cfg->protection_flag = prot;
+
+	return 0;
+}
+
+/*
+ * pmem2_config_validate_length -- checks that the mapped range fits in
+ *	a source of file_len bytes and is properly aligned
+ */
+int
+pmem2_config_validate_length(const struct pmem2_config *cfg,
+	size_t file_len, size_t alignment)
+{
+	ASSERTne(alignment, 0);
+
+	if (file_len == 0) {
+		ERR("source is empty");
+		return PMEM2_E_SOURCE_EMPTY;
+	}
+
+	if (cfg->offset % alignment) {
+		ERR("offset is not a multiple of %zu", alignment);
+		return PMEM2_E_OFFSET_UNALIGNED;
+	}
+
+	if (cfg->length % alignment) {
+		ERR("length is not a multiple of %zu", alignment);
+		return PMEM2_E_LENGTH_UNALIGNED;
+	}
+
+	if (cfg->offset >= file_len) {
+		ERR("offset is beyond the end of the source");
+		return PMEM2_E_MAP_RANGE;
+	}
+
+	if (cfg->length > file_len - cfg->offset) {
+		ERR("mapping would extend beyond the end of the source");
+		return PMEM2_E_MAP_RANGE;
+	}
+
+	return 0;
+}
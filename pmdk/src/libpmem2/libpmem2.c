@@ -51,9 +51,9 @@ ATTR_CONSTRUCTOR
 void
 libpmem2_init(void)
 {
-	/* XXX common_init placeholder */
-	/* XXX LOG(3, NULL); placeholder */
-	/* XXX possible pmem2_init placeholder */
+	common_init(PMEM2_LOG_PREFIX, PMEM2_LOG_LEVEL_VAR, PMEM2_LOG_FILE_VAR,
+			PMEM2_MAJOR_VERSION, PMEM2_MINOR_VERSION);
+	LOG(3, NULL);
 }
 
 /*
@@ -65,6 +65,16 @@ ATTR_DESTRUCTOR
 void
 libpmem2_fini(void)
 {
-	/* XXX LOG(3, NULL); placeholder */
-	/* XXX common_fini placeholder */
+	LOG(3, NULL);
+
+	common_fini();
+}
+
+/*
+ * pmem2_errormsg -- return last error message
+ */
+const char *
+pmem2_errormsg(void)
+{
+	return out_get_errormsg();
 }
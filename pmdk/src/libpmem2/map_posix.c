@@ -0,0 +1,261 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * map_posix.c -- pmem2_map implementation for POSIX systems
+ */
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "alloc.h"
+#include "libpmem2.h"
+#include "mmap.h"
+#include "os.h"
+#include "os_auto_flush.h"
+#include "out.h"
+#include "pmem2.h"
+#include "util.h"
+
+/*
+ * pmem2_is_pmem_forced -- (internal) checks whether PMEM_IS_PMEM_FORCE=1
+ *	declares every file mapping as persistent memory, as in libpmem
+ */
+static int
+pmem2_is_pmem_forced(void)
+{
+	char *env = os_getenv("PMEM_IS_PMEM_FORCE");
+	return env != NULL && atoi(env) == 1;
+}
+
+/*
+ * pmem2_get_available_granularity -- (internal) returns the granularity of
+ *	a mapping of the source
+ *
+ * Stores to anonymous and private mappings never reach the source, they need
+ * no flushes at all. A file mapping reaches the persistence domain from the
+ * CPU caches if it's a device dax or mapped with MAP_SYNC, and from the page
+ * cache otherwise. Platforms that flush the CPU caches on power failure
+ * (eADR) need no cache flushes either.
+ */
+static enum pmem2_granularity
+pmem2_get_available_granularity(const struct pmem2_config *cfg,
+	const struct pmem2_source *src, int map_sync)
+{
+	if (src->type == PMEM2_SOURCE_ANON || cfg->sharing == PMEM2_PRIVATE)
+		return PMEM2_GRANULARITY_BYTE;
+
+	enum pmem2_granularity g;
+	if (pmem2_granularity_from_env(&g)) {
+		LOG(3, "granularity forced to %s", pmem2_granularity_name(g));
+		return g;
+	}
+
+	if (src->value.file.ftype == PMEM2_FTYPE_REG && !map_sync &&
+			!pmem2_is_pmem_forced())
+		return PMEM2_GRANULARITY_PAGE;
+
+	if (os_auto_flush() == 1)
+		return PMEM2_GRANULARITY_BYTE;
+
+	return PMEM2_GRANULARITY_CACHE_LINE;
+}
+
+/*
+ * pmem2_map_prot -- (internal) translates pmem2 protection flags to mmap(2)
+ */
+static int
+pmem2_map_prot(unsigned prot)
+{
+	int proto = PROT_NONE;
+
+	if (prot & PMEM2_PROT_READ)
+		proto |= PROT_READ;
+	if (prot & PMEM2_PROT_WRITE)
+		proto |= PROT_WRITE;
+	if (prot & PMEM2_PROT_EXEC)
+		proto |= PROT_EXEC;
+
+	return proto;
+}
+
+/*
+ * pmem2_map -- maps the range of the source described by the config
+ */
+int
+pmem2_map(const struct pmem2_config *cfg, const struct pmem2_source *src,
+		struct pmem2_map **map_ptr)
+{
+	LOG(3, "cfg %p src %p map_ptr %p", cfg, src, map_ptr);
+
+	*map_ptr = NULL;
+
+	if (cfg->requested_max_granularity == PMEM2_GRANULARITY_INVALID) {
+		ERR("please define the max granularity requested for the "
+			"mapping");
+		return PMEM2_E_GRANULARITY_NOT_SET;
+	}
+
+	size_t file_len;
+	int ret = pmem2_source_size(src, &file_len);
+	if (ret)
+		return ret;
+
+	size_t alignment;
+	ret = pmem2_source_alignment(src, &alignment);
+	if (ret)
+		return ret;
+
+	ret = pmem2_config_validate_length(cfg, file_len, alignment);
+	if (ret)
+		return ret;
+
+	size_t content_length = cfg->length ? cfg->length :
+		file_len - cfg->offset;
+	size_t reserved_length = ALIGN_UP(content_length, alignment);
+
+	int fd = -1;
+	int flags = cfg->sharing == PMEM2_PRIVATE ? MAP_PRIVATE : MAP_SHARED;
+	int *map_sync = NULL;
+	int sync = 0;
+
+	if (src->type == PMEM2_SOURCE_ANON) {
+		flags |= MAP_ANONYMOUS;
+	} else {
+		fd = src->value.file.fd;
+		if (src->value.file.ftype == PMEM2_FTYPE_DEVDAX &&
+				cfg->sharing == PMEM2_PRIVATE) {
+			ERR("device dax cannot be mapped privately");
+			return PMEM2_E_SRC_DEVDAX_PRIVATE;
+		}
+		/* regular files are on DAX only if MAP_SYNC is accepted */
+		if (src->value.file.ftype == PMEM2_FTYPE_REG)
+			map_sync = &sync;
+	}
+
+	char *hint = util_map_hint(reserved_length, alignment);
+	if (hint == MAP_FAILED)
+		hint = NULL;
+
+	void *addr = util_map_sync(hint, reserved_length,
+		pmem2_map_prot(cfg->protection_flag), flags, fd,
+		(os_off_t)cfg->offset, map_sync);
+	if (addr == MAP_FAILED) {
+		ERR("!mmap");
+		if (errno == EINVAL)
+			return PMEM2_E_MAP_RANGE;
+		return PMEM2_E_ERRNO;
+	}
+
+	enum pmem2_granularity available =
+		pmem2_get_available_granularity(cfg, src, sync);
+	if (available > cfg->requested_max_granularity) {
+		ERR("the mapping has %s granularity, %s was requested",
+			pmem2_granularity_name(available),
+			pmem2_granularity_name(
+				cfg->requested_max_granularity));
+		munmap(addr, reserved_length);
+		return PMEM2_E_GRANULARITY_NOT_SUPPORTED;
+	}
+
+	struct pmem2_map *map = Malloc(sizeof(*map));
+	if (map == NULL) {
+		ERR("!Malloc");
+		ret = PMEM2_E_ERRNO;
+		munmap(addr, reserved_length);
+		return ret;
+	}
+
+	map->addr = addr;
+	map->reserved_length = reserved_length;
+	map->content_length = content_length;
+	map->effective_granularity = available;
+	map->source = *src;
+
+	pmem2_set_flush_fns(map);
+	pmem2_set_mem_fns(map);
+
+	LOG(3, "mapped %zu bytes at %p with %s granularity", content_length,
+		addr, pmem2_granularity_name(available));
+
+	*map_ptr = map;
+
+	return 0;
+}
+
+/*
+ * pmem2_unmap -- unmaps the mapping and deletes it
+ */
+int
+pmem2_unmap(struct pmem2_map **map_ptr)
+{
+	LOG(3, "map_ptr %p", map_ptr);
+
+	struct pmem2_map *map = *map_ptr;
+
+	if (munmap(map->addr, map->reserved_length)) {
+		ERR("!munmap");
+		return PMEM2_E_ERRNO;
+	}
+
+	Free(map);
+	*map_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * pmem2_map_get_address -- returns the address of the mapping
+ */
+void *
+pmem2_map_get_address(struct pmem2_map *map)
+{
+	return map->addr;
+}
+
+/*
+ * pmem2_map_get_size -- returns the size of the mapped source range
+ */
+size_t
+pmem2_map_get_size(struct pmem2_map *map)
+{
+	return map->content_length;
+}
+
+/*
+ * pmem2_map_get_store_granularity -- returns the granularity of the mapping
+ */
+enum pmem2_granularity
+pmem2_map_get_store_granularity(struct pmem2_map *map)
+{
+	return map->effective_granularity;
+}
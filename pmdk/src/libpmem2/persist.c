@@ -0,0 +1,340 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * persist.c -- granularity specific flushing and data transfer functions
+ *
+ * The cache line granularity functions are the libpmem ones, which already
+ * pick the cheapest flush instruction the CPU supports.
+ */
+
+#include <string.h>
+
+#include "libpmem.h"
+#include "libpmem2.h"
+#include "out.h"
+#include "pmem2.h"
+
+/*
+ * pmem2_flush_nop -- (internal) flush of a byte granularity mapping
+ */
+static void
+pmem2_flush_nop(const void *ptr, size_t size)
+{
+	/* stores are persistent once visible */
+}
+
+/*
+ * pmem2_drain_nop -- (internal) drain of a page granularity mapping
+ */
+static void
+pmem2_drain_nop(void)
+{
+	/* msync(2) has already waited for the writeback */
+}
+
+/*
+ * pmem2_persist_noflush -- (internal) persist of a byte granularity mapping
+ */
+static void
+pmem2_persist_noflush(const void *ptr, size_t size)
+{
+	/* only orders the preceding non-temporal stores */
+	pmem_drain();
+}
+
+/*
+ * pmem2_persist_pages -- (internal) persist of a page granularity mapping
+ */
+static void
+pmem2_persist_pages(const void *ptr, size_t size)
+{
+	/*
+	 * There's no way to report the failure from a persist function,
+	 * it would be a sign of a broken mapping or of an I/O error.
+	 */
+	if (pmem_msync(ptr, size))
+		FATAL("!msync");
+}
+
+/*
+ * pmem2_memmove_byte -- (internal) memmove to a byte granularity mapping
+ */
+static void *
+pmem2_memmove_byte(void *pmemdest, const void *src, size_t len,
+		unsigned flags)
+{
+	pmem_memmove(pmemdest, src, len, flags | PMEM_F_MEM_NOFLUSH);
+	if (!(flags & PMEM2_F_MEM_NODRAIN))
+		pmem_drain();
+
+	return pmemdest;
+}
+
+/*
+ * pmem2_memcpy_byte -- (internal) memcpy to a byte granularity mapping
+ */
+static void *
+pmem2_memcpy_byte(void *pmemdest, const void *src, size_t len,
+		unsigned flags)
+{
+	pmem_memcpy(pmemdest, src, len, flags | PMEM_F_MEM_NOFLUSH);
+	if (!(flags & PMEM2_F_MEM_NODRAIN))
+		pmem_drain();
+
+	return pmemdest;
+}
+
+/*
+ * pmem2_memset_byte -- (internal) memset of a byte granularity mapping
+ */
+static void *
+pmem2_memset_byte(void *pmemdest, int c, size_t len, unsigned flags)
+{
+	pmem_memset(pmemdest, c, len, flags | PMEM_F_MEM_NOFLUSH);
+	if (!(flags & PMEM2_F_MEM_NODRAIN))
+		pmem_drain();
+
+	return pmemdest;
+}
+
+/*
+ * pmem2_memmove_pages -- (internal) memmove to a page granularity mapping
+ */
+static void *
+pmem2_memmove_pages(void *pmemdest, const void *src, size_t len,
+		unsigned flags)
+{
+	memmove(pmemdest, src, len);
+	if (!(flags & PMEM2_F_MEM_NOFLUSH))
+		pmem2_persist_pages(pmemdest, len);
+
+	return pmemdest;
+}
+
+/*
+ * pmem2_memset_pages -- (internal) memset of a page granularity mapping
+ */
+static void *
+pmem2_memset_pages(void *pmemdest, int c, size_t len, unsigned flags)
+{
+	memset(pmemdest, c, len);
+	if (!(flags & PMEM2_F_MEM_NOFLUSH))
+		pmem2_persist_pages(pmemdest, len);
+
+	return pmemdest;
+}
+
+/*
+ * pmem2_persist_cpu_cache -- (internal) persist of a cache line granularity
+ *	mapping
+ */
+static void
+pmem2_persist_cpu_cache(const void *ptr, size_t size)
+{
+	pmem_persist(ptr, size);
+}
+
+/*
+ * pmem2_deep_flush_page -- (internal) deep flush of a page granularity mapping
+ */
+static int
+pmem2_deep_flush_page(struct pmem2_map *map, void *ptr, size_t size)
+{
+	if (pmem_msync(ptr, size)) {
+		ERR("!msync");
+		return PMEM2_E_ERRNO;
+	}
+
+	return 0;
+}
+
+/*
+ * pmem2_deep_flush_cache -- (internal) deep flush of a mapping backed by
+ *	persistent memory, writes back the CPU caches and the memory
+ *	controller's write pending queues
+ */
+static int
+pmem2_deep_flush_cache(struct pmem2_map *map, void *ptr, size_t size)
+{
+	pmem_deep_flush(ptr, size);
+
+	return 0;
+}
+
+/*
+ * pmem2_deep_flush_nop -- (internal) deep flush of a mapping whose stores
+ *	never reach a persistent source
+ */
+static int
+pmem2_deep_flush_nop(struct pmem2_map *map, void *ptr, size_t size)
+{
+	return 0;
+}
+
+/*
+ * pmem2_set_flush_fns -- sets the flushing functions of the mapping
+ */
+void
+pmem2_set_flush_fns(struct pmem2_map *map)
+{
+	switch (map->effective_granularity) {
+		case PMEM2_GRANULARITY_PAGE:
+			map->persist_fn = pmem2_persist_pages;
+			map->flush_fn = pmem2_persist_pages;
+			map->drain_fn = pmem2_drain_nop;
+			map->deep_flush_fn = pmem2_deep_flush_page;
+			break;
+		case PMEM2_GRANULARITY_CACHE_LINE:
+			map->persist_fn = pmem2_persist_cpu_cache;
+			map->flush_fn = pmem_flush;
+			map->drain_fn = pmem_drain;
+			map->deep_flush_fn = pmem2_deep_flush_cache;
+			break;
+		case PMEM2_GRANULARITY_BYTE:
+			map->persist_fn = pmem2_persist_noflush;
+			map->flush_fn = pmem2_flush_nop;
+			map->drain_fn = pmem_drain;
+			/* the write pending queues still need a deep flush */
+			map->deep_flush_fn = map->source.type ==
+				PMEM2_SOURCE_ANON ? pmem2_deep_flush_nop :
+				pmem2_deep_flush_cache;
+			break;
+		default:
+			ASSERT(0);
+	}
+}
+
+/*
+ * pmem2_set_mem_fns -- sets the data transfer functions of the mapping
+ */
+void
+pmem2_set_mem_fns(struct pmem2_map *map)
+{
+	switch (map->effective_granularity) {
+		case PMEM2_GRANULARITY_PAGE:
+			map->memmove_fn = pmem2_memmove_pages;
+			map->memcpy_fn = pmem2_memmove_pages;
+			map->memset_fn = pmem2_memset_pages;
+			break;
+		case PMEM2_GRANULARITY_CACHE_LINE:
+			map->memmove_fn = pmem_memmove;
+			map->memcpy_fn = pmem_memcpy;
+			map->memset_fn = pmem_memset;
+			break;
+		case PMEM2_GRANULARITY_BYTE:
+			map->memmove_fn = pmem2_memmove_byte;
+			map->memcpy_fn = pmem2_memcpy_byte;
+			map->memset_fn = pmem2_memset_byte;
+			break;
+		default:
+			ASSERT(0);
+	}
+}
+
+/*
+ * pmem2_get_persist_fn -- returns the persist function of the mapping
+ */
+pmem2_persist_fn
+pmem2_get_persist_fn(struct pmem2_map *map)
+{
+	return map->persist_fn;
+}
+
+/*
+ * pmem2_get_flush_fn -- returns the flush function of the mapping
+ */
+pmem2_flush_fn
+pmem2_get_flush_fn(struct pmem2_map *map)
+{
+	return map->flush_fn;
+}
+
+/*
+ * pmem2_get_drain_fn -- returns the drain function of the mapping
+ */
+pmem2_drain_fn
+pmem2_get_drain_fn(struct pmem2_map *map)
+{
+	return map->drain_fn;
+}
+
+/*
+ * pmem2_get_memmove_fn -- returns the memmove function of the mapping
+ */
+pmem2_memmove_fn
+pmem2_get_memmove_fn(struct pmem2_map *map)
+{
+	return map->memmove_fn;
+}
+
+/*
+ * pmem2_get_memcpy_fn -- returns the memcpy function of the mapping
+ */
+pmem2_memcpy_fn
+pmem2_get_memcpy_fn(struct pmem2_map *map)
+{
+	return map->memcpy_fn;
+}
+
+/*
+ * pmem2_get_memset_fn -- returns the memset function of the mapping
+ */
+pmem2_memset_fn
+pmem2_get_memset_fn(struct pmem2_map *map)
+{
+	return map->memset_fn;
+}
+
+/*
+ * pmem2_deep_flush -- flushes the range of the mapping all the way to the
+ *	persistent media
+ */
+int
+pmem2_deep_flush(struct pmem2_map *map, void *ptr, size_t size)
+{
+	LOG(3, "map %p ptr %p size %zu", map, ptr, size);
+
+	uintptr_t map_addr = (uintptr_t)map->addr;
+	uintptr_t map_end = map_addr + map->content_length;
+	uintptr_t flush_addr = (uintptr_t)ptr;
+
+	if (flush_addr < map_addr || flush_addr > map_end ||
+			size > map_end - flush_addr) {
+		ERR("requested deep flush range ptr %p size %zu exceeds the "
+			"mapping %p size %zu", ptr, size, map->addr,
+			map->content_length);
+		return PMEM2_E_DEEP_FLUSH_RANGE;
+	}
+
+	return map->deep_flush_fn(map, ptr, size);
+}
@@ -31,10 +31,78 @@
  */
 
 /*
- * pmem2.c -- pmem2 entry points for libpmem2
+ * pmem2.c -- helpers shared by the libpmem2 entry points
  */
 
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
 #include "libpmem2.h"
+#include "out.h"
+#include "os.h"
 #include "pmem2.h"
 
-/* placeholder */
+/*
+ * pmem2_assert_errno -- returns the negated errno of the last failed call
+ */
+int
+pmem2_assert_errno(void)
+{
+	if (!errno) {
+		ERR("errno is not set");
+		ASSERTinfo(0, "errno is not set");
+		return -EINVAL;
+	}
+
+	return -errno;
+}
+
+static const char * const granularity_names[] = {
+	[PMEM2_GRANULARITY_BYTE] = "BYTE",
+	[PMEM2_GRANULARITY_CACHE_LINE] = "CACHE_LINE",
+	[PMEM2_GRANULARITY_PAGE] = "PAGE",
+};
+
+/*
+ * pmem2_granularity_name -- returns the name of the given granularity
+ */
+const char *
+pmem2_granularity_name(enum pmem2_granularity g)
+{
+	if ((unsigned)g > PMEM2_GRANULARITY_PAGE)
+		return "INVALID";
+
+	return granularity_names[g];
+}
+
+/*
+ * pmem2_granularity_from_env -- reads the granularity forced with
+ *	PMEM2_FORCE_GRANULARITY
+ *
+ * Returns 1 and sets *g if the variable is set to a known granularity,
+ * 0 otherwise.
+ */
+int
+pmem2_granularity_from_env(enum pmem2_granularity *g)
+{
+	char *env = os_getenv("PMEM2_FORCE_GRANULARITY");
+	if (env == NULL)
+		return 0;
+
+	for (unsigned i = 0; i <= PMEM2_GRANULARITY_PAGE; ++i) {
+		if (strcasecmp(env, granularity_names[i]) == 0) {
+			*g = (enum pmem2_granularity)i;
+			return 1;
+		}
+	}
+
+	/* "CL" is accepted as a shorthand of "CACHE_LINE" */
+	if (strcasecmp(env, "CL") == 0) {
+		*g = PMEM2_GRANULARITY_CACHE_LINE;
+		return 1;
+	}
+
+	LOG(2, "ignoring unknown PMEM2_FORCE_GRANULARITY=%s", env);
+	return 0;
+}
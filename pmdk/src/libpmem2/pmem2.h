@@ -36,13 +36,89 @@
 #ifndef PMEM2_H
 #define PMEM2_H
 
+#include <errno.h>
+#include <sys/types.h>
+
 #include "libpmem2.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* placeholder for pmem2.h function declarations */
+#define PMEM2_MAJOR_VERSION 0
+#define PMEM2_MINOR_VERSION 0
+
+#define PMEM2_LOG_PREFIX "libpmem2"
+#define PMEM2_LOG_LEVEL_VAR "PMEM2_LOG_LEVEL"
+#define PMEM2_LOG_FILE_VAR "PMEM2_LOG_FILE"
+
+/* negated errno of the last failed system call */
+#define PMEM2_E_ERRNO (pmem2_assert_errno())
+
+/* marks a granularity that has not been set */
+#define PMEM2_GRANULARITY_INVALID ((enum pmem2_granularity)(-1))
+
+struct pmem2_config {
+	size_t offset;
+	size_t length; /* 0 maps the source up to its end */
+	enum pmem2_granularity requested_max_granularity;
+	enum pmem2_sharing_type sharing;
+	unsigned protection_flag;
+};
+
+enum pmem2_source_type {
+	PMEM2_SOURCE_ANON,
+	PMEM2_SOURCE_FD,
+};
+
+enum pmem2_file_type {
+	PMEM2_FTYPE_REG,
+	PMEM2_FTYPE_DEVDAX,
+};
+
+struct pmem2_source {
+	enum pmem2_source_type type;
+	union {
+		/* PMEM2_SOURCE_ANON */
+		size_t size;
+		/* PMEM2_SOURCE_FD */
+		struct {
+			int fd;
+			enum pmem2_file_type ftype;
+			dev_t st_rdev; /* device of a device dax */
+		} file;
+	} value;
+};
+
+struct pmem2_map {
+	void *addr;
+	size_t reserved_length; /* length of the whole mapping */
+	size_t content_length; /* length of the part backed by the source */
+	enum pmem2_granularity effective_granularity;
+
+	pmem2_persist_fn persist_fn;
+	pmem2_flush_fn flush_fn;
+	pmem2_drain_fn drain_fn;
+	int (*deep_flush_fn)(struct pmem2_map *map, void *ptr, size_t size);
+
+	pmem2_memmove_fn memmove_fn;
+	pmem2_memcpy_fn memcpy_fn;
+	pmem2_memset_fn memset_fn;
+
+	struct pmem2_source source;
+};
+
+int pmem2_assert_errno(void);
+
+void pmem2_config_init(struct pmem2_config *cfg);
+int pmem2_config_validate_length(const struct pmem2_config *cfg,
+	size_t file_len, size_t alignment);
+
+int pmem2_granularity_from_env(enum pmem2_granularity *g);
+const char *pmem2_granularity_name(enum pmem2_granularity g);
+
+void pmem2_set_flush_fns(struct pmem2_map *map);
+void pmem2_set_mem_fns(struct pmem2_map *map);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * source_posix.c -- pmem2_source implementation for POSIX systems
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+
+#include "alloc.h"
+#include "file.h"
+#include "libpmem2.h"
+#include "os.h"
+#include "out.h"
+#include "pmem2.h"
+#include "util.h"
+
+/*
+ * pmem2_source_fd_path -- (internal) returns a path through which the file
+ *	open as fd can be inspected
+ */
+static void
+pmem2_source_fd_path(int fd, char *path, size_t len)
+{
+	snprintf(path, len, "/proc/self/fd/%d", fd);
+}
+
+/*
+ * pmem2_source_from_fd -- creates a source of a mapping from an open file
+ */
+int
+pmem2_source_from_fd(struct pmem2_source **src, int fd)
+{
+	LOG(3, "src %p fd %d", src, fd);
+
+	*src = NULL;
+
+	int flags = fcntl(fd, F_GETFL);
+	if (flags == -1) {
+		ERR("!fcntl");
+		if (errno == EBADF)
+			return PMEM2_E_INVALID_FILE_HANDLE;
+		return PMEM2_E_ERRNO;
+	}
+
+	/* a file that cannot be read cannot be mapped */
+	if ((flags & O_ACCMODE) == O_WRONLY) {
+		ERR("file descriptor is open for writing only");
+		return PMEM2_E_INVALID_FILE_HANDLE;
+	}
+
+	os_stat_t st;
+	if (os_fstat(fd, &st) < 0) {
+		ERR("!fstat");
+		return PMEM2_E_ERRNO;
+	}
+
+	enum pmem2_file_type ftype;
+	if (S_ISREG(st.st_mode)) {
+		ftype = PMEM2_FTYPE_REG;
+	} else if (S_ISCHR(st.st_mode) &&
+			util_stat_get_type(&st) == TYPE_DEVDAX) {
+		ftype = PMEM2_FTYPE_DEVDAX;
+	} else {
+		ERR("file is neither a regular file nor a device dax");
+		return PMEM2_E_INVALID_FILE_TYPE;
+	}
+
+	struct pmem2_source *s = Malloc(sizeof(*s));
+	if (s == NULL) {
+		ERR("!Malloc");
+		return PMEM2_E_ERRNO;
+	}
+
+	s->type = PMEM2_SOURCE_FD;
+	s->value.file.fd = fd;
+	s->value.file.ftype = ftype;
+	s->value.file.st_rdev = st.st_rdev;
+
+	*src = s;
+
+	return 0;
+}
+
+/*
+ * pmem2_source_from_anon -- creates a source of an anonymous mapping
+ */
+int
+pmem2_source_from_anon(struct pmem2_source **src, size_t size)
+{
+	LOG(3, "src %p size %zu", src, size);
+
+	*src = NULL;
+
+	struct pmem2_source *s = Malloc(sizeof(*s));
+	if (s == NULL) {
+		ERR("!Malloc");
+		return PMEM2_E_ERRNO;
+	}
+
+	s->type = PMEM2_SOURCE_ANON;
+	s->value.size = size;
+
+	*src = s;
+
+	return 0;
+}
+
+/*
+ * pmem2_source_delete -- deletes the source, the file stays open
+ */
+int
+pmem2_source_delete(struct pmem2_source **src)
+{
+	LOG(3, "src %p", src);
+
+	Free(*src);
+	*src = NULL;
+
+	return 0;
+}
+
+/*
+ * pmem2_source_size -- returns the size of the source
+ */
+int
+pmem2_source_size(const struct pmem2_source *src, size_t *size)
+{
+	LOG(3, "src %p size %p", src, size);
+
+	if (src->type == PMEM2_SOURCE_ANON) {
+		*size = src->value.size;
+		return 0;
+	}
+
+	if (src->value.file.ftype == PMEM2_FTYPE_DEVDAX) {
+		char path[PATH_MAX];
+		pmem2_source_fd_path(src->value.file.fd, path, sizeof(path));
+
+		ssize_t s = util_file_get_size(path);
+		if (s < 0) {
+			ERR("cannot read the size of the device dax");
+			return PMEM2_E_INVALID_SIZE_FORMAT;
+		}
+
+		*size = (size_t)s;
+		return 0;
+	}
+
+	os_stat_t st;
+	if (os_fstat(src->value.file.fd, &st) < 0) {
+		ERR("!fstat");
+		return PMEM2_E_ERRNO;
+	}
+
+	if (st.st_size < 0) {
+		ERR("kernel says size of regular file is negative (%ld)",
+			st.st_size);
+		return PMEM2_E_INVALID_FILE_HANDLE;
+	}
+
+	*size = (size_t)st.st_size;
+
+	return 0;
+}
+
+/*
+ * pmem2_source_alignment -- returns the alignment required of the offset and
+ *	length of mappings of the source
+ */
+int
+pmem2_source_alignment(const struct pmem2_source *src, size_t *alignment)
+{
+	LOG(3, "src %p alignment %p", src, alignment);
+
+	if (src->type == PMEM2_SOURCE_ANON ||
+			src->value.file.ftype == PMEM2_FTYPE_REG) {
+		*alignment = (size_t)Pagesize;
+		return 0;
+	}
+
+	char path[PATH_MAX];
+	pmem2_source_fd_path(src->value.file.fd, path, sizeof(path));
+
+	size_t align = util_file_device_dax_alignment(path);
+	if (align == 0 || !util_is_pow2(align)) {
+		ERR("invalid device dax alignment %zu", align);
+		return PMEM2_E_INVALID_ALIGNMENT_FORMAT;
+	}
+
+	*alignment = align;
+
+	return 0;
+}
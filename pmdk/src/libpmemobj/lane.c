@@ -72,6 +72,28 @@ lane_info_create(void)
 		FATAL("critnib_new");
 }
 
+/*
+ * lane_info_unbind -- (internal) releases the lane the thread is bound to in
+ *	the sticky mode, if the pool is still open
+ */
+static void
+lane_info_unbind(struct lane_info *info)
+{
+	if (info->bound_lane >= LANE_BIND_FAILED)
+		return;
+
+	PMEMoid oid = {info->pop_uuid_lo, 0};
+	PMEMobjpool *pop = pmemobj_pool_by_oid(oid);
+	if (pop == NULL || pop->lanes_desc.lane_owners == NULL)
+		return;
+
+	/* the record stays allocated until now, so no other thread has its tag */
+	uint64_t tag = (uint64_t)(uintptr_t)info;
+	(void) util_bool_compare_and_swap64(
+		&pop->lanes_desc.lane_owners[info->bound_lane], tag, 0);
+	info->bound_lane = LANE_UNBOUND;
+}
+
 /*
  * lane_info_delete -- (internal) deletes lane info hash table
  */
@@ -87,6 +109,7 @@ lane_info_delete(void)
 	while (head != NULL) {
 		record = head;
 		head = head->next;
+		lane_info_unbind(record);
 		Free(record);
 	}
 
@@ -233,24 +256,25 @@ lane_init(PMEMobjpool *pop, struct lane *lane, struct lane_layout *layout)
 	ASSERTne(lane, NULL);
 
 	lane->layout = layout;
+	memset(&lane->stats, 0, sizeof(lane->stats));
 
 	lane->internal = operation_new((struct ulog *)&layout->internal,
 		LANE_REDO_INTERNAL_SIZE,
-		NULL, NULL, &pop->p_ops,
+		NULL, NULL, &pop->p_ops, pop->stats,
 		LOG_TYPE_REDO);
 	if (lane->internal == NULL)
 		goto error_internal_new;
 
 	lane->external = operation_new((struct ulog *)&layout->external,
 		LANE_REDO_EXTERNAL_SIZE,
-		lane_redo_extend, (ulog_free_fn)pfree, &pop->p_ops,
+		lane_redo_extend, (ulog_free_fn)pfree, &pop->p_ops, pop->stats,
 		LOG_TYPE_REDO);
 	if (lane->external == NULL)
 		goto error_external_new;
 
 	lane->undo = operation_new((struct ulog *)&layout->undo,
 		LANE_UNDO_SIZE,
-		lane_undo_extend, (ulog_free_fn)pfree, &pop->p_ops,
+		lane_undo_extend, (ulog_free_fn)pfree, &pop->p_ops, pop->stats,
 		LOG_TYPE_UNDO);
 	if (lane->undo == NULL)
 		goto error_undo_new;
@@ -292,6 +316,8 @@ lane_boot(PMEMobjpool *pop)
 	}
 
 	pop->lanes_desc.next_lane_idx = 0;
+	pop->lanes_desc.sticky = 0;
+	pop->lanes_desc.prewarm = 0;
 
 	pop->lanes_desc.lane_locks =
 		Zalloc(sizeof(*pop->lanes_desc.lane_locks) * pop->nlanes);
@@ -300,6 +326,13 @@ lane_boot(PMEMobjpool *pop)
 		goto error_locks_malloc;
 	}
 
+	pop->lanes_desc.lane_owners =
+		Zalloc(sizeof(*pop->lanes_desc.lane_owners) * pop->nlanes);
+	if (pop->lanes_desc.lane_owners == NULL) {
+		ERR("!Malloc for lane owners");
+		goto error_owners_malloc;
+	}
+
 	/* add lanes to pmemcheck ignored list */
 	VALGRIND_ADD_TO_GLOBAL_TX_IGNORE((char *)pop + pop->lanes_offset,
 		(sizeof(struct lane_layout) * pop->nlanes));
@@ -319,6 +352,9 @@ lane_boot(PMEMobjpool *pop)
 error_lane_init:
 	for (; i >= 1; --i)
 		lane_destroy(pop, &pop->lanes_desc.lane[i - 1]);
+	Free(pop->lanes_desc.lane_owners);
+	pop->lanes_desc.lane_owners = NULL;
+error_owners_malloc:
 	Free(pop->lanes_desc.lane_locks);
 	pop->lanes_desc.lane_locks = NULL;
 error_locks_malloc:
@@ -364,6 +400,8 @@ lane_cleanup(PMEMobjpool *pop)
 	pop->lanes_desc.lane = NULL;
 	Free(pop->lanes_desc.lane_locks);
 	pop->lanes_desc.lane_locks = NULL;
+	Free(pop->lanes_desc.lane_owners);
+	pop->lanes_desc.lane_owners = NULL;
 
 	lane_info_cleanup(pop);
 }
@@ -446,16 +484,36 @@ lane_check(PMEMobjpool *pop)
 	return 0;
 }
 
+/*
+ * lane_hold_stats -- contention seen by a single lane acquisition
+ */
+struct lane_hold_stats {
+	uint64_t contended;
+	uint64_t yields;
+	uint64_t migrations;
+};
+
 /*
  * get_lane -- (internal) get free lane index
+ *
+ * If owners is not NULL, the lanes bound to other threads are skipped in the
+ * first sweep over the lanes.
  */
 static inline void
-get_lane(uint64_t *locks, struct lane_info *info, uint64_t nlocks)
+get_lane(uint64_t *locks, uint64_t *owners, struct lane_info *info,
+	uint64_t nlocks, struct lane_hold_stats *hs)
 {
+	int skip_bound = owners != NULL;
+
 	info->lane_idx = info->primary;
 	while (1) {
 		do {
 			info->lane_idx %= nlocks;
+			if (skip_bound && owners[info->lane_idx] != 0) {
+				++info->lane_idx;
+				continue;
+			}
+
 			if (likely(util_bool_compare_and_swap64(
 					&locks[info->lane_idx], 0, 1))) {
 				if (info->lane_idx == info->primary) {
@@ -465,10 +523,12 @@ get_lane(uint64_t *locks, struct lane_info *info, uint64_t nlocks)
 					info->primary = info->lane_idx;
 					info->primary_attempts =
 						LANE_PRIMARY_ATTEMPTS;
+					hs->migrations++;
 				}
 				return;
 			}
 
+			hs->contended = 1;
 			if (info->lane_idx == info->primary &&
 					info->primary_attempts > 0) {
 				info->primary_attempts--;
@@ -477,10 +537,92 @@ get_lane(uint64_t *locks, struct lane_info *info, uint64_t nlocks)
 			++info->lane_idx;
 		} while (info->lane_idx < nlocks);
 
+		if (skip_bound) {
+			skip_bound = 0;
+			continue;
+		}
+
+		hs->yields++;
 		sched_yield();
 	}
 }
 
+/*
+ * lane_prewarm -- (internal) faults in the persistent layout of the lane and
+ *	loads it into the cache of the calling thread
+ */
+static void
+lane_prewarm(struct lane *lane)
+{
+	const volatile char *p = (const volatile char *)lane->layout;
+
+	for (size_t off = 0; off < sizeof(struct lane_layout);
+			off += CACHELINE_SIZE)
+		(void) p[off];
+}
+
+/*
+ * lane_bind -- (internal) binds the thread to an unbound lane, starting the
+ *	search from its primary lane
+ */
+static void
+lane_bind(PMEMobjpool *pop, struct lane_info *info)
+{
+	uint64_t *owners = pop->lanes_desc.lane_owners;
+	uint64_t nlanes = pop->lanes_desc.runtime_nlanes;
+	uint64_t tag = (uint64_t)(uintptr_t)info;
+
+	for (uint64_t i = 0; i < nlanes; ++i) {
+		uint64_t idx = (info->primary + i) % nlanes;
+		if (owners[idx] != 0 ||
+		    !util_bool_compare_and_swap64(&owners[idx], 0, tag))
+			continue;
+
+		info->bound_lane = idx;
+		info->primary = idx;
+		if (pop->lanes_desc.prewarm)
+			lane_prewarm(&pop->lanes_desc.lane[idx]);
+
+		return;
+	}
+
+	info->bound_lane = LANE_BIND_FAILED;
+}
+
+/*
+ * get_lane_sticky -- (internal) get the lane the thread is bound to
+ *
+ * The lane is bound on the first hold. While no other thread takes it, which
+ * only happens once all the unbound lanes are busy, the hold is a single
+ * uncontended compare-and-swap on the thread's own lock. A thread that could
+ * not be bound falls back to the shared lanes.
+ */
+static inline void
+get_lane_sticky(PMEMobjpool *pop, struct lane_info *info,
+	struct lane_hold_stats *hs)
+{
+	uint64_t *locks = pop->lanes_desc.lane_locks;
+
+	if (unlikely(info->bound_lane == LANE_UNBOUND))
+		lane_bind(pop, info);
+
+	if (unlikely(info->bound_lane == LANE_BIND_FAILED)) {
+		get_lane(locks, pop->lanes_desc.lane_owners, info,
+			pop->lanes_desc.runtime_nlanes, hs);
+		return;
+	}
+
+	info->lane_idx = info->bound_lane;
+	if (likely(util_bool_compare_and_swap64(&locks[info->lane_idx], 0, 1)))
+		return;
+
+	hs->contended = 1;
+	do {
+		hs->yields++;
+		sched_yield();
+	} while (!util_bool_compare_and_swap64(&locks[info->lane_idx], 0, 1));
+}
+
 /*
  * get_lane_info_record -- (internal) get lane record attached to memory pool
  *	or first free
@@ -511,6 +653,7 @@ get_lane_info_record(PMEMobjpool *pop)
 		info->prev = NULL;
 		info->primary = 0;
 		info->primary_attempts = LANE_PRIMARY_ATTEMPTS;
+		info->bound_lane = LANE_UNBOUND;
 		if (Lane_info_records) {
 			Lane_info_records->prev = info;
 		}
@@ -550,14 +693,29 @@ lane_hold(PMEMobjpool *pop, struct lane **lanep)
 			&pop->lanes_desc.next_lane_idx, LANE_JUMP);
 	} /* handles wraparound */
 
-	uint64_t *llocks = pop->lanes_desc.lane_locks;
+	struct lane_descriptor *desc = &pop->lanes_desc;
+	struct lane *l;
+
 	/* grab next free lane from lanes available at runtime */
 	if (!lane->nest_count++) {
-		get_lane(llocks, lane, pop->lanes_desc.runtime_nlanes);
+		struct lane_hold_stats hs = {0, 0, 0};
+		if (desc->sticky)
+			get_lane_sticky(pop, lane, &hs);
+		else
+			get_lane(desc->lane_locks, NULL, lane,
+				desc->runtime_nlanes, &hs);
+
+		l = &desc->lane[lane->lane_idx];
+		if (pop->stats->enabled) {
+			l->stats.holds++;
+			l->stats.contended += hs.contended;
+			l->stats.yields += hs.yields;
+			l->stats.migrations += hs.migrations;
+		}
+	} else {
+		l = &desc->lane[lane->lane_idx];
 	}
 
-	struct lane *l = &pop->lanes_desc.lane[lane->lane_idx];
-
 	/* reinitialize lane's content only if in outermost hold */
 	if (lanep && lane->nest_count == 1) {
 		VALGRIND_ANNOTATE_NEW_MEMORY(l, sizeof(*l));
@@ -599,3 +757,114 @@ lane_release(PMEMobjpool *pop)
 		}
 	}
 }
+
+/*
+ * lane_stats_get -- sums up the contention statistics of the runtime lanes
+ *	and counts the lanes bound to threads
+ */
+void
+lane_stats_get(PMEMobjpool *pop, struct lane_stats *stats, uint64_t *bound)
+{
+	memset(stats, 0, sizeof(*stats));
+	*bound = 0;
+
+	struct lane_descriptor *desc = &pop->lanes_desc;
+	for (unsigned i = 0; i < desc->runtime_nlanes; ++i) {
+		struct lane_stats *s = &desc->lane[i].stats;
+		stats->holds += s->holds;
+		stats->contended += s->contended;
+		stats->yields += s->yields;
+		stats->migrations += s->migrations;
+		if (desc->lane_owners[i] != 0)
+			(*bound)++;
+	}
+}
+
+/*
+ * CTL_READ_HANDLER(sticky) -- returns whether threads are bound to lanes
+ */
+static int
+CTL_READ_HANDLER(sticky)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	PMEMobjpool *pop = ctx;
+
+	int *arg_out = arg;
+
+	*arg_out = pop->lanes_desc.sticky;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(sticky) -- enables or disables binding threads to lanes
+ */
+static int
+CTL_WRITE_HANDLER(sticky)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	PMEMobjpool *pop = ctx;
+
+	int arg_in = *(int *)arg;
+
+	pop->lanes_desc.sticky = arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(sticky) = CTL_ARG_BOOLEAN;
+
+/*
+ * CTL_READ_HANDLER(prewarm) -- returns whether lanes are pre-warmed
+ */
+static int
+CTL_READ_HANDLER(prewarm)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	PMEMobjpool *pop = ctx;
+
+	int *arg_out = arg;
+
+	*arg_out = pop->lanes_desc.prewarm;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(prewarm) -- enables or disables pre-warming of lanes,
+ *	enabling it faults in the layouts of all the runtime lanes at once
+ */
+static int
+CTL_WRITE_HANDLER(prewarm)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	PMEMobjpool *pop = ctx;
+
+	int arg_in = *(int *)arg;
+
+	pop->lanes_desc.prewarm = arg_in;
+	if (arg_in) {
+		for (unsigned i = 0; i < pop->lanes_desc.runtime_nlanes; ++i)
+			lane_prewarm(&pop->lanes_desc.lane[i]);
+	}
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(prewarm) = CTL_ARG_BOOLEAN;
+
+static const struct ctl_node CTL_NODE(lane)[] = {
+	CTL_LEAF_RW(sticky),
+	CTL_LEAF_RW(prewarm),
+
+	CTL_NODE_END
+};
+
+/*
+ * lane_ctl_register -- registers ctl nodes for "lane" module
+ */
+void
+lane_ctl_register(PMEMobjpool *pop)
+{
+	CTL_REGISTER_MODULE(pop->ctl, lane);
+}
@@ -61,6 +61,10 @@ extern "C" {
 
 #define RLANE_DEFAULT 0
 
+/* values of lane_info.bound_lane when the thread is not bound to a lane */
+#define LANE_UNBOUND UINT64_MAX
+#define LANE_BIND_FAILED (UINT64_MAX - 1)
+
 #define LANE_TOTAL_SIZE 3072 /* 3 * 1024 (sum of 3 old lane sections) */
 /*
  * We have 3 kilobytes to distribute.
@@ -100,11 +104,23 @@ struct lane_layout {
 	struct ULOG(LANE_UNDO_SIZE) undo;
 };
 
+/*
+ * Contention statistics of a lane. They are only updated by the thread
+ * holding the lane, so no atomics are needed.
+ */
+struct lane_stats {
+	uint64_t holds; /* outermost holds */
+	uint64_t contended; /* holds which did not get the lane at once */
+	uint64_t yields; /* sweeps over all the lanes without a free one */
+	uint64_t migrations; /* changes of the primary lane of a thread */
+};
+
 struct lane {
 	struct lane_layout *layout; /* pointer to persistent layout */
 	struct operation_context *internal; /* context for internal ulog */
 	struct operation_context *external; /* context for external ulog */
 	struct operation_context *undo; /* context for undo ulog */
+	struct lane_stats stats;
 };
 
 struct lane_descriptor {
@@ -116,7 +132,14 @@ struct lane_descriptor {
 	unsigned runtime_nlanes;
 	unsigned next_lane_idx;
 	uint64_t *lane_locks;
+	/*
+	 * Threads bound to the lanes in the sticky mode. A bound lane is only
+	 * taken by other threads once there are no unbound lanes left.
+	 */
+	uint64_t *lane_owners;
 	struct lane *lane;
+	int sticky; /* bind each thread to a lane of its own */
+	int prewarm; /* load the ulogs of a lane when a thread binds to it */
 };
 
 typedef int (*section_layout_op)(PMEMobjpool *pop, void *data, unsigned length);
@@ -146,6 +169,9 @@ struct lane_info {
 	uint64_t primary;
 	int primary_attempts;
 
+	/* lane the thread is bound to in the sticky mode */
+	uint64_t bound_lane;
+
 	struct lane_info *prev, *next;
 };
 
@@ -158,6 +184,9 @@ void lane_cleanup(PMEMobjpool *pop);
 int lane_recover_and_section_boot(PMEMobjpool *pop);
 int lane_section_cleanup(PMEMobjpool *pop);
 int lane_check(PMEMobjpool *pop);
+void lane_ctl_register(PMEMobjpool *pop);
+void lane_stats_get(PMEMobjpool *pop, struct lane_stats *stats,
+	uint64_t *bound);
 
 unsigned lane_hold(PMEMobjpool *pop, struct lane **lane);
 void lane_release(PMEMobjpool *pop);
@@ -70,6 +70,7 @@ struct operation_context {
 	ulog_free_fn ulog_free; /* function to free next ulogs */
 
 	const struct pmem_ops *p_ops;
+	struct stats *stats; /* persistence traffic counters, may be NULL */
 	struct pmem_ops t_ops; /* used for transient data processing */
 	struct pmem_ops s_ops; /* used for shadow copy data processing */
 
@@ -83,6 +84,7 @@ struct operation_context {
 	size_t ulog_base_nbytes; /* available bytes in initial ulog log */
 	size_t ulog_capacity; /* sum of capacity, incl all next ulog logs */
 	int ulog_auto_reserve; /* allow or do not to auto ulog reservation */
+	int ulog_line_aligned; /* give buffer entry headers their own line */
 	int ulog_any_user_buffer; /* set if any user buffer is added */
 
 	struct ulog_next next; /* vector of 'next' fields of persistent ulog */
@@ -171,12 +173,13 @@ operation_transient_memcpy(void *base, void *dest, const void *src, size_t len,
 }
 
 /*
- * operation_new -- creates new operation context
+ * operation_new -- creates new operation context, stats is optional
  */
 struct operation_context *
 operation_new(struct ulog *ulog, size_t ulog_base_nbytes,
 	ulog_extend_fn extend, ulog_free_fn ulog_free,
-	const struct pmem_ops *p_ops, enum log_type type)
+	const struct pmem_ops *p_ops, struct stats *stats,
+	enum log_type type)
 {
 	struct operation_context *ctx = Zalloc(sizeof(*ctx));
 	if (ctx == NULL) {
@@ -194,6 +197,7 @@ operation_new(struct ulog *ulog, size_t ulog_base_nbytes,
 	VEC_INIT(&ctx->next);
 	ulog_rebuild_next_vec(ulog, &ctx->next, p_ops);
 	ctx->p_ops = p_ops;
+	ctx->stats = stats;
 	ctx->type = type;
 	ctx->ulog_any_user_buffer = 0;
 
@@ -431,7 +435,8 @@ int
 operation_add_buffer(struct operation_context *ctx,
 	void *dest, void *src, size_t size, ulog_operation_type type)
 {
-	size_t real_size = size + sizeof(struct ulog_entry_buf);
+	size_t header_size = ulog_entry_buf_header_size(ctx->ulog_line_aligned);
+	size_t real_size = size + header_size;
 
 	/* if there's no space left in the log, reserve some more */
 	if (ctx->ulog_curr_capacity == 0) {
@@ -447,7 +452,7 @@ operation_add_buffer(struct operation_context *ctx,
 	}
 
 	size_t curr_size = MIN(real_size, ctx->ulog_curr_capacity);
-	size_t data_size = curr_size - sizeof(struct ulog_entry_buf);
+	size_t data_size = curr_size - header_size;
 	size_t entry_size = ALIGN_UP(curr_size, CACHELINE_SIZE);
 
 	/*
@@ -473,10 +478,14 @@ operation_add_buffer(struct operation_context *ctx,
 		ctx->ulog_curr_offset,
 		ctx->ulog_curr_gen_num,
 		dest, src, data_size,
-		type, ctx->p_ops);
+		type, ctx->ulog_line_aligned, ctx->p_ops);
 	ASSERT(entry_size == ulog_entry_size(&e->base));
 	ASSERT(entry_size <= ctx->ulog_curr_capacity);
 
+	if (ctx->stats != NULL)
+		STATS_INC(ctx->stats, transient, persist_log_bytes,
+			entry_size);
+
 	ctx->total_logged += entry_size;
 	ctx->ulog_curr_offset += entry_size;
 	ctx->ulog_curr_capacity -= entry_size;
@@ -631,6 +640,16 @@ operation_set_auto_reserve(struct operation_context *ctx, int auto_reserve)
 	ctx->ulog_auto_reserve = auto_reserve;
 }
 
+/*
+ * operation_set_line_aligned -- set the layout of buffer entries created
+ *	in the context
+ */
+void
+operation_set_line_aligned(struct operation_context *ctx, int line_aligned)
+{
+	ctx->ulog_line_aligned = line_aligned;
+}
+
 /*
  * operation_set_any_user_buffer -- set ulog_any_user_buffer value for context
  */
@@ -662,6 +681,10 @@ operation_process_persistent_redo(struct operation_context *ctx)
 		ctx->pshadow_ops.offset, ctx->ulog_base_nbytes,
 		&ctx->next, ctx->p_ops);
 
+	if (ctx->stats != NULL)
+		STATS_INC(ctx->stats, transient, persist_log_bytes,
+			ctx->pshadow_ops.offset);
+
 	ulog_process(ctx->pshadow_ops.ulog, OBJ_OFF_IS_VALID_FROM_CTX,
 		ctx->p_ops);
 
@@ -728,6 +751,7 @@ operation_init(struct operation_context *ctx)
 	ctx->ulog_curr = NULL;
 	ctx->total_logged = 0;
 	ctx->ulog_auto_reserve = 1;
+	ctx->ulog_line_aligned = 0;
 	ctx->ulog_any_user_buffer = 0;
 }
 
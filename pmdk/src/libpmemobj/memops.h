@@ -69,11 +69,13 @@ struct user_buffer_def {
 };
 
 struct operation_context;
+struct stats;
 
 struct operation_context *
 operation_new(struct ulog *redo, size_t ulog_base_nbytes,
 	ulog_extend_fn extend, ulog_free_fn ulog_free,
-	const struct pmem_ops *p_ops, enum log_type type);
+	const struct pmem_ops *p_ops, struct stats *stats,
+	enum log_type type);
 
 void operation_init(struct operation_context *ctx);
 void operation_start(struct operation_context *ctx);
@@ -96,6 +98,8 @@ void operation_add_user_buffer(struct operation_context *ctx,
 		struct user_buffer_def *userbuf);
 void operation_set_auto_reserve(struct operation_context *ctx,
 		int auto_reserve);
+void operation_set_line_aligned(struct operation_context *ctx,
+		int line_aligned);
 void operation_set_any_user_buffer(struct operation_context *ctx,
 	int any_user_buffer);
 int operation_get_any_user_buffer(struct operation_context *ctx);
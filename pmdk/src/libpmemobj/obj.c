@@ -193,6 +193,7 @@ obj_ctl_init_and_load(PMEMobjpool *pop)
 		pmalloc_ctl_register(pop);
 		stats_ctl_register(pop);
 		debug_ctl_register(pop);
+		lane_ctl_register(pop);
 	}
 
 	char *env_config = os_getenv(OBJ_CONFIG_ENV_VARIABLE);
@@ -325,11 +326,12 @@ obj_fini(void)
 {
 	LOG(3, NULL);
 
+	/* releasing the sticky lanes of the thread looks the pools up */
+	lane_info_destroy();
 	if (pools_ht)
 		critnib_delete(pools_ht);
 	if (pools_tree)
 		critnib_delete(pools_tree);
-	lane_info_destroy();
 	util_remote_fini();
 
 #ifdef _WIN32
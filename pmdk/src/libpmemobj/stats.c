@@ -45,6 +45,253 @@ static const struct ctl_node CTL_NODE(heap)[] = {
 	CTL_NODE_END
 };
 
+STATS_CTL_HANDLER(transient, committed, tx_committed);
+STATS_CTL_HANDLER(transient, flushed_lines, tx_flushed_lines);
+
+static const struct ctl_node CTL_NODE(tx)[] = {
+	STATS_CTL_LEAF(transient, committed),
+	STATS_CTL_LEAF(transient, flushed_lines),
+
+	CTL_NODE_END
+};
+
+STATS_CTL_HANDLER(transient, lines, persist_flushed_lines);
+STATS_CTL_HANDLER(transient, partial_lines, persist_partial_lines);
+STATS_CTL_HANDLER(transient, fences, persist_fences);
+STATS_CTL_HANDLER(transient, log_bytes, persist_log_bytes);
+
+static const struct ctl_node CTL_NODE(persist)[] = {
+	STATS_CTL_LEAF(transient, lines),
+	STATS_CTL_LEAF(transient, partial_lines),
+	STATS_CTL_LEAF(transient, fences),
+	STATS_CTL_LEAF(transient, log_bytes),
+
+	CTL_NODE_END
+};
+
+/*
+ * LANES_CTL_HANDLER -- defines a read handler for a statistic summed up over
+ *	the runtime lanes
+ */
+#define LANES_CTL_HANDLER(name)\
+static int CTL_READ_HANDLER(lanes_##name)(void *ctx,\
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)\
+{\
+	PMEMobjpool *pop = ctx;\
+	struct lane_stats stats;\
+	uint64_t bound;\
+	lane_stats_get(pop, &stats, &bound);\
+	*(uint64_t *)arg = stats.name;\
+	return 0;\
+}
+
+LANES_CTL_HANDLER(holds);
+LANES_CTL_HANDLER(contended);
+LANES_CTL_HANDLER(yields);
+LANES_CTL_HANDLER(migrations);
+
+/*
+ * CTL_READ_HANDLER(lanes_bound) -- returns the number of lanes bound to
+ *	threads
+ */
+static int
+CTL_READ_HANDLER(lanes_bound)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	PMEMobjpool *pop = ctx;
+	struct lane_stats stats;
+
+	lane_stats_get(pop, &stats, arg);
+
+	return 0;
+}
+
+static const struct ctl_node CTL_NODE(lanes)[] = {
+	STATS_CTL_LEAF(lanes, holds),
+	STATS_CTL_LEAF(lanes, contended),
+	STATS_CTL_LEAF(lanes, yields),
+	STATS_CTL_LEAF(lanes, migrations),
+	STATS_CTL_LEAF(lanes, bound),
+
+	CTL_NODE_END
+};
+
+/*
+ * stats_count_range -- (internal) counts the cache lines written back for
+ *	the range and how many of them the range covers only partially
+ */
+static void
+stats_count_range(struct stats *s, const void *addr, size_t len)
+{
+	if (len == 0)
+		return;
+
+	uintptr_t beg = (uintptr_t)addr;
+	uintptr_t end = beg + len;
+	uint64_t lines = (ALIGN_UP(end, CACHELINE_SIZE) -
+		ALIGN_DOWN(beg, CACHELINE_SIZE)) / CACHELINE_SIZE;
+
+	uint64_t partial = 0;
+	if (beg % CACHELINE_SIZE != 0)
+		partial++;
+	if (end % CACHELINE_SIZE != 0 &&
+	    (lines > 1 || beg % CACHELINE_SIZE == 0))
+		partial++;
+
+	util_fetch_and_add64(&s->transient->persist_flushed_lines, lines);
+	if (partial != 0)
+		util_fetch_and_add64(&s->transient->persist_partial_lines,
+			partial);
+}
+
+/*
+ * stats_count_fence -- (internal) counts a drain
+ */
+static inline void
+stats_count_fence(struct stats *s)
+{
+	util_fetch_and_add64(&s->transient->persist_fences, 1);
+}
+
+/*
+ * stats_count_mem -- (internal) counts the traffic of a mem* operation
+ */
+static void
+stats_count_mem(struct stats *s, const void *dest, size_t len,
+	unsigned flags)
+{
+	if (!(flags & PMEMOBJ_F_MEM_NOFLUSH))
+		stats_count_range(s, dest, len);
+	if (!(flags & (PMEMOBJ_F_MEM_NODRAIN | PMEMOBJ_F_MEM_NOFLUSH)))
+		stats_count_fence(s);
+}
+
+/*
+ * stats_persist -- (internal) counting persist
+ */
+static int
+stats_persist(void *ctx, const void *addr, size_t len, unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+
+	stats_count_range(pop->stats, addr, len);
+	stats_count_fence(pop->stats);
+
+	return pop->stats->ops.persist(ctx, addr, len, flags);
+}
+
+/*
+ * stats_flush -- (internal) counting flush
+ */
+static int
+stats_flush(void *ctx, const void *addr, size_t len, unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+
+	stats_count_range(pop->stats, addr, len);
+
+	return pop->stats->ops.flush(ctx, addr, len, flags);
+}
+
+/*
+ * stats_drain -- (internal) counting drain
+ */
+static void
+stats_drain(void *ctx)
+{
+	PMEMobjpool *pop = ctx;
+
+	stats_count_fence(pop->stats);
+
+	pop->stats->ops.drain(ctx);
+}
+
+/*
+ * stats_memcpy -- (internal) counting memcpy
+ */
+static void *
+stats_memcpy(void *ctx, void *dest, const void *src, size_t len,
+	unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+
+	stats_count_mem(pop->stats, dest, len, flags);
+
+	return pop->stats->ops.memcpy(ctx, dest, src, len, flags);
+}
+
+/*
+ * stats_memmove -- (internal) counting memmove
+ */
+static void *
+stats_memmove(void *ctx, void *dest, const void *src, size_t len,
+	unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+
+	stats_count_mem(pop->stats, dest, len, flags);
+
+	return pop->stats->ops.memmove(ctx, dest, src, len, flags);
+}
+
+/*
+ * stats_memset -- (internal) counting memset
+ */
+static void *
+stats_memset(void *ctx, void *dest, int c, size_t len, unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+
+	stats_count_mem(pop->stats, dest, len, flags);
+
+	return pop->stats->ops.memset(ctx, dest, c, len, flags);
+}
+
+/*
+ * stats_ops_set -- (internal) sets the pool operations
+ */
+static void
+stats_ops_set(struct pmem_ops *p_ops, const struct pmem_ops *ops)
+{
+	p_ops->persist = ops->persist;
+	p_ops->flush = ops->flush;
+	p_ops->drain = ops->drain;
+	p_ops->memcpy = ops->memcpy;
+	p_ops->memmove = ops->memmove;
+	p_ops->memset = ops->memset;
+}
+
+/*
+ * stats_ops_counting -- (internal) installs or removes the counting pool
+ *	operations
+ *
+ * The persistence traffic is counted by wrapping the pool operations, so
+ * that nothing is added to the persist paths while statistics are disabled.
+ * The heap keeps its own copy of the operations, it is switched as well.
+ */
+static void
+stats_ops_counting(PMEMobjpool *pop, int enable)
+{
+	static const struct pmem_ops counting = {
+		.persist = stats_persist,
+		.flush = stats_flush,
+		.drain = stats_drain,
+		.memcpy = stats_memcpy,
+		.memmove = stats_memmove,
+		.memset = stats_memset,
+	};
+
+	struct stats *s = pop->stats;
+	if (enable) {
+		stats_ops_set(&s->ops, &pop->p_ops);
+		stats_ops_set(&pop->p_ops, &counting);
+		stats_ops_set(&pop->heap.p_ops, &counting);
+	} else {
+		stats_ops_set(&pop->p_ops, &s->ops);
+		stats_ops_set(&pop->heap.p_ops, &s->ops);
+	}
+}
+
 /*
  * CTL_READ_HANDLER(enabled) -- returns whether or not statistics are enabled
  */
@@ -72,9 +319,12 @@ CTL_WRITE_HANDLER(enabled)(void *ctx,
 {
 	PMEMobjpool *pop = ctx;
 
-	int arg_in = *(int *)arg;
+	int arg_in = *(int *)arg > 0;
+
+	if (pop->stats->enabled != arg_in)
+		stats_ops_counting(pop, arg_in);
 
-	pop->stats->enabled = arg_in > 0;
+	pop->stats->enabled = arg_in;
 
 	return 0;
 }
@@ -83,6 +333,9 @@ static const struct ctl_argument CTL_ARG(enabled) = CTL_ARG_BOOLEAN;
 
 static const struct ctl_node CTL_NODE(stats)[] = {
 	CTL_CHILD(heap),
+	CTL_CHILD(tx),
+	CTL_CHILD(persist),
+	CTL_CHILD(lanes),
 	CTL_LEAF_RW(enabled),
 
 	CTL_NODE_END
@@ -120,6 +373,9 @@ error_transient_alloc:
 void
 stats_delete(PMEMobjpool *pop, struct stats *s)
 {
+	if (s->enabled)
+		stats_ops_counting(pop, 0);
+
 	pmemops_persist(&pop->p_ops, s->persistent,
 	sizeof(struct stats_persistent));
 	Free(s->transient);
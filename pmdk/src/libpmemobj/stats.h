@@ -38,13 +38,19 @@
 #define LIBPMEMOBJ_STATS_H 1
 
 #include "ctl.h"
+#include "pmemops.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct stats_transient {
-	int unused;
+	uint64_t tx_committed;
+	uint64_t tx_flushed_lines;
+	uint64_t persist_flushed_lines;
+	uint64_t persist_partial_lines;
+	uint64_t persist_fences;
+	uint64_t persist_log_bytes;
 };
 
 struct stats_persistent {
@@ -55,6 +61,7 @@ struct stats {
 	int enabled;
 	struct stats_transient *transient;
 	struct stats_persistent *persistent;
+	struct pmem_ops ops; /* pool operations replaced by the counting ones */
 };
 
 #define STATS_INC(stats, type, name, value) do {\
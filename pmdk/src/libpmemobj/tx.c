@@ -51,6 +51,19 @@ struct tx_data {
 	jmp_buf env;
 };
 
+struct tx_range_def {
+	uint64_t offset;
+	uint64_t size;
+	uint64_t flags;
+};
+
+/*
+ * Number of snapshot ranges kept inline in the transaction before they are
+ * moved into the ranges tree. Most transactions touch only a handful of
+ * ranges, for which a sorted array avoids the tree allocations entirely.
+ */
+#define TX_INLINE_RANGES 16
+
 struct tx {
 	PMEMobjpool *pop;
 	enum pobj_tx_stage stage;
@@ -59,6 +72,10 @@ struct tx {
 	PMDK_SLIST_HEAD(txl, tx_lock_data) tx_locks;
 	PMDK_SLIST_HEAD(txd, tx_data) tx_entries;
 
+	/* sorted by offset, unused once the ranges tree exists */
+	struct tx_range_def inline_ranges[TX_INLINE_RANGES];
+	size_t ninline_ranges;
+	/* created when the inline ranges overflow, NULL until then */
 	struct ravl *ranges;
 
 	VEC(, struct pobj_action) actions;
@@ -104,12 +121,6 @@ struct tx_alloc_args {
 #define ALLOC_ARGS(flags)\
 (struct tx_alloc_args){flags, NULL, 0}
 
-struct tx_range_def {
-	uint64_t offset;
-	uint64_t size;
-	uint64_t flags;
-};
-
 /*
  * tx_range_def_cmp -- compares two snapshot ranges
  */
@@ -127,6 +138,100 @@ tx_range_def_cmp(const void *lhs, const void *rhs)
 	return 0;
 }
 
+/*
+ * tx_ranges_find -- (internal) finds a snapshot range relative to the given
+ *	one, in the inline array or the ranges tree
+ */
+static struct tx_range_def *
+tx_ranges_find(struct tx *tx, const struct tx_range_def *search,
+	enum ravl_predicate p)
+{
+	if (tx->ranges != NULL) {
+		struct ravl_node *n = ravl_find(tx->ranges, search, p);
+		return n ? ravl_data(n) : NULL;
+	}
+
+	ASSERT(!(p & RAVL_PREDICATE_GREATER));
+
+	/* the array is short and sorted, walk it down from the top */
+	for (size_t i = tx->ninline_ranges; i > 0; --i) {
+		struct tx_range_def *r = &tx->inline_ranges[i - 1];
+		if (r->offset > search->offset)
+			continue;
+		if (r->offset == search->offset) {
+			if (p & RAVL_PREDICATE_EQUAL)
+				return r;
+			continue;
+		}
+		return (p & RAVL_PREDICATE_LESS) ? r : NULL;
+	}
+
+	return NULL;
+}
+
+/*
+ * tx_ranges_remove -- (internal) removes a snapshot range previously returned
+ *	by tx_ranges_find
+ */
+static void
+tx_ranges_remove(struct tx *tx, struct tx_range_def *r)
+{
+	if (tx->ranges != NULL) {
+		struct ravl_node *n = ravl_find(tx->ranges, r,
+			RAVL_PREDICATE_EQUAL);
+		ASSERTne(n, NULL);
+		ravl_remove(tx->ranges, n);
+		return;
+	}
+
+	size_t i = (size_t)(r - tx->inline_ranges);
+	ASSERT(i < tx->ninline_ranges);
+	memmove(r, r + 1, (tx->ninline_ranges - i - 1) * sizeof(*r));
+	tx->ninline_ranges--;
+}
+
+/*
+ * tx_ranges_spill -- (internal) moves the inline snapshot ranges into a newly
+ *	created ranges tree
+ */
+static int
+tx_ranges_spill(struct tx *tx)
+{
+	struct ravl *ranges = ravl_new_sized(tx_range_def_cmp,
+		sizeof(struct tx_range_def));
+	if (ranges == NULL)
+		return -1;
+
+	for (size_t i = 0; i < tx->ninline_ranges; ++i) {
+		if (ravl_emplace_copy(ranges, &tx->inline_ranges[i]) != 0) {
+			ravl_delete(ranges);
+			return -1;
+		}
+	}
+
+	tx->ranges = ranges;
+	tx->ninline_ranges = 0;
+
+	return 0;
+}
+
+/*
+ * tx_ranges_delete_cb -- (internal) calls cb on every snapshot range and
+ *	drops all of them
+ */
+static void
+tx_ranges_delete_cb(struct tx *tx, void (*cb)(void *, void *), void *arg)
+{
+	if (tx->ranges != NULL) {
+		ravl_delete_cb(tx->ranges, cb, arg);
+		tx->ranges = NULL;
+	}
+
+	for (size_t i = 0; i < tx->ninline_ranges; ++i)
+		cb(&tx->inline_ranges[i], arg);
+	tx->ninline_ranges = 0;
+}
+
 /*
  * tx_params_new -- creates a new transactional parameters instance and fills it
  *	with default values.
@@ -139,6 +244,7 @@ tx_params_new(void)
 		return NULL;
 
 	tx_params->cache_size = TX_DEFAULT_RANGE_CACHE_SIZE;
+	tx_params->undo_line_aligned = 0;
 
 	return tx_params;
 }
@@ -343,7 +449,7 @@ tx_restore_range(PMEMobjpool *pop, struct tx *tx, struct ulog_entry_buf *range)
 	uint64_t range_offset = ulog_entry_offset(&range->base);
 
 	txr->begin = OBJ_OFF_TO_PTR(pop, range_offset);
-	txr->end = (char *)txr->begin + range->size;
+	txr->end = (char *)txr->begin + ulog_entry_buf_size(range);
 	PMDK_SLIST_INSERT_HEAD(&tx_ranges, txr, tx_range);
 
 	struct tx_lock_data *txl;
@@ -366,7 +472,7 @@ tx_restore_range(PMEMobjpool *pop, struct tx *tx, struct ulog_entry_buf *range)
 		PMDK_SLIST_REMOVE_HEAD(&tx_ranges, tx_range);
 		/* restore partial range data from snapshot */
 		ASSERT((char *)txr->begin >= (char *)dst_ptr);
-		uint8_t *src = &range->data[
+		uint8_t *src = &ulog_entry_buf_data(range)[
 				(char *)txr->begin - (char *)dst_ptr];
 		ASSERT((char *)txr->end >= (char *)txr->begin);
 		size_t size = (size_t)((char *)txr->end - (char *)txr->begin);
@@ -415,16 +521,56 @@ tx_abort_set(PMEMobjpool *pop, struct lane *lane)
 }
 
 /*
- * tx_flush_range -- (internal) flush one range
+ * tx_flush_plan -- state of the commit-time flush of all snapshot ranges
+ *
+ * Ranges are visited in address order, the cache lines they touch are
+ * coalesced into a pending extent so that a line shared by neighbouring
+ * ranges is written back only once.
+ */
+struct tx_flush_plan {
+	PMEMobjpool *pop;
+	uintptr_t begin; /* first line of the pending extent */
+	uintptr_t end; /* line past the pending extent, equal to begin if none */
+	uint64_t lines; /* lines flushed so far */
+};
+
+/*
+ * tx_flush_plan_issue -- (internal) flushes the pending extent
+ */
+static void
+tx_flush_plan_issue(struct tx_flush_plan *plan)
+{
+	if (plan->end == plan->begin)
+		return;
+
+	pmemops_xflush(&plan->pop->p_ops, (void *)plan->begin,
+		plan->end - plan->begin, PMEMOBJ_F_RELAXED);
+	plan->lines += (plan->end - plan->begin) / CACHELINE_SIZE;
+	plan->begin = plan->end;
+}
+
+/*
+ * tx_flush_range -- (internal) add one range to the flush plan
  */
 static void
 tx_flush_range(void *data, void *ctx)
 {
-	PMEMobjpool *pop = ctx;
+	struct tx_flush_plan *plan = ctx;
+	PMEMobjpool *pop = plan->pop;
 	struct tx_range_def *range = data;
-	if (!(range->flags & POBJ_FLAG_NO_FLUSH)) {
-		pmemops_xflush(&pop->p_ops, OBJ_OFF_TO_PTR(pop, range->offset),
-				range->size, PMEMOBJ_F_RELAXED);
+	if (!(range->flags & POBJ_FLAG_NO_FLUSH) && range->size != 0) {
+		uintptr_t addr = (uintptr_t)OBJ_OFF_TO_PTR(pop, range->offset);
+		uintptr_t begin = ALIGN_DOWN(addr, CACHELINE_SIZE);
+		uintptr_t end = ALIGN_UP(addr + range->size, CACHELINE_SIZE);
+
+		ASSERT(begin >= plan->begin);
+		if (begin > plan->end) {
+			tx_flush_plan_issue(plan);
+			plan->begin = begin;
+			plan->end = end;
+		} else if (end > plan->end) {
+			plan->end = end;
+		}
 	}
 	VALGRIND_REMOVE_FROM_TX(OBJ_OFF_TO_PTR(pop, range->offset),
 		range->size);
@@ -451,9 +597,16 @@ tx_pre_commit(struct tx *tx)
 {
 	LOG(5, NULL);
 
-	/* Flush all regions and destroy the whole tree. */
-	ravl_delete_cb(tx->ranges, tx_flush_range, tx->pop);
-	tx->ranges = NULL;
+	/*
+	 * Flush all regions and drop the ranges. Both containers hand out the
+	 * ranges in address order, which lets the plan coalesce them.
+	 */
+	struct tx_flush_plan plan = {tx->pop, 0, 0, 0};
+	tx_ranges_delete_cb(tx, tx_flush_range, &plan);
+	tx_flush_plan_issue(&plan);
+
+	STATS_INC(tx->pop->stats, transient, tx_committed, 1);
+	STATS_INC(tx->pop->stats, transient, tx_flushed_lines, plan.lines);
 }
 
 
@@ -469,10 +622,9 @@ tx_abort(PMEMobjpool *pop, struct lane *lane)
 
 	tx_abort_set(pop, lane);
 
-	ravl_delete_cb(tx->ranges, tx_clean_range, pop);
+	tx_ranges_delete_cb(tx, tx_clean_range, pop);
 	palloc_cancel(&pop->heap,
 		VEC_ARR(&tx->actions), VEC_SIZE(&tx->actions));
-	tx->ranges = NULL;
 }
 
 /*
@@ -572,8 +724,8 @@ release_and_free_tx_locks(struct tx *tx)
 }
 
 /*
- * tx_lane_ranges_insert_def -- (internal) allocates and inserts a new range
- *	definition into the ranges tree
+ * tx_lane_ranges_insert_def -- (internal) inserts a new range definition
+ *	into the inline ranges, moving them into the ranges tree on overflow
  */
 static int
 tx_lane_ranges_insert_def(PMEMobjpool *pop, struct tx *tx,
@@ -582,6 +734,31 @@ tx_lane_ranges_insert_def(PMEMobjpool *pop, struct tx *tx,
 	LOG(3, "rdef->offset %"PRIu64" rdef->size %"PRIu64,
 		rdef->offset, rdef->size);
 
+	if (tx->ranges == NULL) {
+		size_t n = tx->ninline_ranges;
+		if (n < TX_INLINE_RANGES) {
+			/* keep the array sorted, it's short enough to shift */
+			size_t i = n;
+			while (i > 0 && tx->inline_ranges[i - 1].offset >
+					rdef->offset)
+				--i;
+			if (i > 0 && tx->inline_ranges[i - 1].offset ==
+					rdef->offset)
+				FATAL("invalid state of ranges tree");
+
+			memmove(&tx->inline_ranges[i + 1],
+				&tx->inline_ranges[i],
+				(n - i) * sizeof(*rdef));
+			tx->inline_ranges[i] = *rdef;
+			tx->ninline_ranges++;
+
+			return 0;
+		}
+
+		if (tx_ranges_spill(tx) != 0)
+			return -1;
+	}
+
 	int ret = ravl_emplace_copy(tx->ranges, rdef);
 	if (ret && errno == EEXIST)
 		FATAL("invalid state of ranges tree");
@@ -758,6 +935,8 @@ pmemobj_tx_begin(PMEMobjpool *pop, jmp_buf env, ...)
 
 		lane_hold(pop, &tx->lane);
 		operation_start(tx->lane->undo);
+		operation_set_line_aligned(tx->lane->undo,
+			pop->tx_params->undo_line_aligned);
 
 		VEC_INIT(&tx->actions);
 		VEC_INIT(&tx->redo_userbufs);
@@ -765,8 +944,8 @@ pmemobj_tx_begin(PMEMobjpool *pop, jmp_buf env, ...)
 		PMDK_SLIST_INIT(&tx->tx_entries);
 		PMDK_SLIST_INIT(&tx->tx_locks);
 
-		tx->ranges = ravl_new_sized(tx_range_def_cmp,
-			sizeof(struct tx_range_def));
+		tx->ranges = NULL;
+		tx->ninline_ranges = 0;
 
 		tx->pop = pop;
 
@@ -1219,10 +1398,10 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 	 * they can be merged, so search for less or equal elements.
 	 */
 	enum ravl_predicate p = RAVL_PREDICATE_LESS_EQUAL;
-	struct ravl_node *nprev = NULL;
+	struct tx_range_def *fprev = NULL;
 	while (r.size != 0) {
 		search.offset = r.offset + r.size;
-		struct ravl_node *n = ravl_find(tx->ranges, &search, p);
+		struct tx_range_def *f = tx_ranges_find(tx, &search, p);
 		/*
 		 * We have to skip searching for LESS_EQUAL because
 		 * the snapshot we would find is the one that was just
@@ -1230,8 +1409,6 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 		 */
 		p = RAVL_PREDICATE_LESS;
 
-		struct tx_range_def *f = n ? ravl_data(n) : NULL;
-
 		size_t fend = f == NULL ? 0: f->offset + f->size;
 		size_t rend = r.offset + r.size;
 		if (fend == 0 || fend < r.offset) {
@@ -1247,13 +1424,12 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 			 * or	+--- (no overlap)
 			 * or	---+ (adjacent on on right side)
 			 */
-			if (nprev != NULL) {
+			if (fprev != NULL) {
 				/*
 				 * But, if we have an existing adjacent snapshot
 				 * on the right side, we can just extend it to
 				 * include the desired range.
 				 */
-				struct tx_range_def *fprev = ravl_data(nprev);
 				ASSERTeq(rend, fprev->offset);
 				fprev->offset -= r.size;
 				fprev->size += r.size;
@@ -1305,12 +1481,11 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 			 * If there's a snapshot adjacent on right side, merge
 			 * the two ranges together.
 			 */
-			if (nprev != NULL) {
-				struct tx_range_def *fprev = ravl_data(nprev);
+			if (fprev != NULL) {
 				ASSERTeq(rend, fprev->offset);
 				f->size += fprev->size;
 				pmemobj_tx_merge_flags(f, fprev);
-				ravl_remove(tx->ranges, nprev);
+				tx_ranges_remove(tx, fprev);
 			}
 		} else if (fend >= r.offset) {
 			/*
@@ -1329,7 +1504,7 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 			 * on this information without risking overwritting an
 			 * existing one. We have to continue iterating, but we
 			 * keep the information about adjacent snapshots in the
-			 * nprev variable.
+			 * fprev variable.
 			 */
 			size_t overlap = rend - MAX(f->offset, r.offset);
 			r.size -= overlap;
@@ -1338,7 +1513,7 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 			ASSERT(0);
 		}
 
-		nprev = n;
+		fprev = f;
 	}
 
 	if (ret != 0) {
@@ -1744,22 +1919,21 @@ pmemobj_tx_free(PMEMoid oid)
 	struct pobj_action *action;
 
 	struct tx_range_def range = {oid.off, 0, 0};
-	struct ravl_node *n = ravl_find(tx->ranges, &range,
+	struct tx_range_def *r = tx_ranges_find(tx, &range,
 		RAVL_PREDICATE_EQUAL);
 
 	/*
 	 * If attempting to free an object allocated within the same
 	 * transaction, simply cancel the alloc and remove it from the actions.
 	 */
-	if (n != NULL) {
+	if (r != NULL) {
 		VEC_FOREACH_BY_PTR(action, &tx->actions) {
 			if (action->type == POBJ_ACTION_TYPE_HEAP &&
 				action->heap.offset == oid.off) {
-				struct tx_range_def *r = ravl_data(n);
 				void *ptr = OBJ_OFF_TO_PTR(pop, r->offset);
 				VALGRIND_SET_CLEAN(ptr, r->size);
 				VALGRIND_REMOVE_FROM_TX(ptr, r->size);
-				ravl_remove(tx->ranges, n);
+				tx_ranges_remove(tx, r);
 				palloc_cancel(&pop->heap, action, 1);
 				VEC_ERASE_BY_PTR(&tx->actions, action);
 				PMEMOBJ_API_END();
@@ -2147,9 +2321,51 @@ static const struct ctl_node CTL_NODE(post_commit)[] = {
 	CTL_NODE_END
 };
 
+/*
+ * CTL_READ_HANDLER(line_aligned) -- returns the undo log entry layout
+ */
+static int
+CTL_READ_HANDLER(line_aligned)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	PMEMobjpool *pop = ctx;
+
+	int *arg_out = arg;
+
+	*arg_out = pop->tx_params->undo_line_aligned;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(line_aligned) -- sets the undo log entry layout of
+ *	subsequent transactions
+ */
+static int
+CTL_WRITE_HANDLER(line_aligned)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	PMEMobjpool *pop = ctx;
+
+	int arg_in = *(int *)arg;
+
+	pop->tx_params->undo_line_aligned = arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(line_aligned) = CTL_ARG_BOOLEAN;
+
+static const struct ctl_node CTL_NODE(undo)[] = {
+	CTL_LEAF_RW(line_aligned),
+
+	CTL_NODE_END
+};
+
 static const struct ctl_node CTL_NODE(tx)[] = {
 	CTL_CHILD(debug),
 	CTL_CHILD(cache),
+	CTL_CHILD(undo),
 	CTL_CHILD(post_commit),
 
 	CTL_NODE_END
@@ -63,6 +63,7 @@ extern "C" {
 
 struct tx_parameters {
 	size_t cache_size;
+	int undo_line_aligned; /* undo log buffer entry layout */
 };
 
 /*
@@ -97,6 +97,35 @@ ulog_entry_offset(const struct ulog_entry_base *entry)
 	return entry->offset & ULOG_OFFSET_MASK;
 }
 
+/*
+ * ulog_entry_buf_header_size -- returns the space taken by the header of
+ *	a buffer entry in the given layout
+ */
+size_t
+ulog_entry_buf_header_size(int line_aligned)
+{
+	return line_aligned ? CACHELINE_SIZE : sizeof(struct ulog_entry_buf);
+}
+
+/*
+ * ulog_entry_buf_size -- returns the size of the content of a buffer entry
+ */
+uint64_t
+ulog_entry_buf_size(const struct ulog_entry_buf *eb)
+{
+	return eb->size & ~ULOG_ENTRY_BUF_LINE_ALIGNED;
+}
+
+/*
+ * ulog_entry_buf_data -- returns the content of a buffer entry
+ */
+uint8_t *
+ulog_entry_buf_data(struct ulog_entry_buf *eb)
+{
+	return (uint8_t *)eb + ulog_entry_buf_header_size(
+		(eb->size & ULOG_ENTRY_BUF_LINE_ALIGNED) != 0);
+}
+
 /*
  * ulog_entry_size -- returns the size of a ulog entry
  */
@@ -113,8 +142,8 @@ ulog_entry_size(const struct ulog_entry_base *entry)
 		case ULOG_OPERATION_BUF_SET:
 		case ULOG_OPERATION_BUF_CPY:
 			eb = (struct ulog_entry_buf *)entry;
-			return CACHELINE_ALIGN(
-				sizeof(struct ulog_entry_buf) + eb->size);
+			return CACHELINE_ALIGN((size_t)(ulog_entry_buf_data(eb) -
+				(uint8_t *)eb) + ulog_entry_buf_size(eb));
 		default:
 			ASSERT(0);
 	}
@@ -428,11 +457,15 @@ ulog_clobber_entry(const struct ulog_entry_base *e,
 
 /*
  * ulog_entry_buf_create -- atomically creates a buffer entry in the log
+ *
+ * With line_aligned set, the header is given a cacheline of its own and the
+ * content starts on the following one.
  */
 struct ulog_entry_buf *
 ulog_entry_buf_create(struct ulog *ulog, size_t offset, uint64_t gen_num,
 		uint64_t *dest, const void *src, uint64_t size,
-		ulog_operation_type type, const struct pmem_ops *p_ops)
+		ulog_operation_type type, int line_aligned,
+		const struct pmem_ops *p_ops)
 {
 	struct ulog_entry_buf *e =
 		(struct ulog_entry_buf *)(ulog->data + offset);
@@ -440,7 +473,8 @@ ulog_entry_buf_create(struct ulog *ulog, size_t offset, uint64_t gen_num,
 	/*
 	 * Depending on the size of the source buffer, we might need to perform
 	 * up to three separate copies:
-	 *	1. The first cacheline, 24b of metadata and 40b of data
+	 *	1. The first cacheline, 24b of metadata and 40b of data, or
+	 *	24b of metadata and 40b of padding in the line aligned layout
 	 * If there's still data to be logged:
 	 *	2. The entire remainder of data data aligned down to cacheline,
 	 *	for example, if there's 150b left, this step will copy only
@@ -456,10 +490,12 @@ ulog_entry_buf_create(struct ulog *ulog, size_t offset, uint64_t gen_num,
 	b->base.offset = (uint64_t)(dest) - (uint64_t)p_ops->base;
 	b->base.offset |= ULOG_OPERATION(type);
 	b->size = size;
+	if (line_aligned)
+		b->size |= ULOG_ENTRY_BUF_LINE_ALIGNED;
 	b->checksum = 0;
 
 	size_t bdatasize = CACHELINE_SIZE - sizeof(struct ulog_entry_buf);
-	size_t ncopy = MIN(size, bdatasize);
+	size_t ncopy = line_aligned ? 0 : MIN(size, bdatasize);
 	memcpy(b->data, src, ncopy);
 	memset(b->data + ncopy, 0, bdatasize - ncopy);
 
@@ -475,8 +511,11 @@ ulog_entry_buf_create(struct ulog *ulog, size_t offset, uint64_t gen_num,
 		memset(last_cacheline + lcopy, 0, CACHELINE_SIZE - lcopy);
 	}
 
+	uint8_t *edata = (uint8_t *)e +
+		ulog_entry_buf_header_size(line_aligned);
+
 	if (rcopy != 0) {
-		void *dest = e->data + ncopy;
+		void *dest = edata + ncopy;
 		ASSERT(IS_CACHELINE_ALIGNED(dest));
 
 		VALGRIND_ADD_TO_TX(dest, rcopy);
@@ -486,7 +525,7 @@ ulog_entry_buf_create(struct ulog *ulog, size_t offset, uint64_t gen_num,
 	}
 
 	if (lcopy != 0) {
-		void *dest = e->data + ncopy + rcopy;
+		void *dest = edata + ncopy + rcopy;
 		ASSERT(IS_CACHELINE_ALIGNED(dest));
 
 		VALGRIND_ADD_TO_TX(dest, CACHELINE_SIZE);
@@ -521,7 +560,7 @@ ulog_entry_buf_create(struct ulog *ulog, size_t offset, uint64_t gen_num,
 	 */
 #if VG_MEMCHECK_ENABLED
 	if (On_valgrind) {
-		VALGRIND_MAKE_MEM_DEFINED(e->data, ncopy + rcopy + lcopy);
+		VALGRIND_MAKE_MEM_DEFINED(edata, ncopy + rcopy + lcopy);
 		VALGRIND_MAKE_MEM_DEFINED(&e->checksum, sizeof(e->checksum));
 	}
 #endif
@@ -577,18 +616,18 @@ ulog_entry_apply(const struct ulog_entry_base *e, int persist,
 		case ULOG_OPERATION_BUF_SET:
 			eb = (struct ulog_entry_buf *)e;
 
-			dst_size = eb->size;
+			dst_size = ulog_entry_buf_size(eb);
 			VALGRIND_ADD_TO_TX(dst, dst_size);
-			pmemops_memset(p_ops, dst, *eb->data, eb->size,
-				PMEMOBJ_F_RELAXED | PMEMOBJ_F_MEM_NODRAIN);
+			pmemops_memset(p_ops, dst, *ulog_entry_buf_data(eb),
+				dst_size, PMEMOBJ_F_RELAXED | PMEMOBJ_F_MEM_NODRAIN);
 		break;
 		case ULOG_OPERATION_BUF_CPY:
 			eb = (struct ulog_entry_buf *)e;
 
-			dst_size = eb->size;
+			dst_size = ulog_entry_buf_size(eb);
 			VALGRIND_ADD_TO_TX(dst, dst_size);
-			pmemops_memcpy(p_ops, dst, eb->data, eb->size,
-				PMEMOBJ_F_RELAXED | PMEMOBJ_F_MEM_NODRAIN);
+			pmemops_memcpy(p_ops, dst, ulog_entry_buf_data(eb),
+				dst_size, PMEMOBJ_F_RELAXED | PMEMOBJ_F_MEM_NODRAIN);
 		break;
 		default:
 			ASSERT(0);
@@ -61,10 +61,18 @@ struct ulog_entry_val {
 struct ulog_entry_buf {
 	struct ulog_entry_base base; /* offset with operation type flag */
 	uint64_t checksum; /* checksum of the entire log entry */
-	uint64_t size; /* size of the buffer to be modified */
+	uint64_t size; /* size of the buffer to be modified, with layout flag */
 	uint8_t data[]; /* content to fill in */
 };
 
+/*
+ * Set in the size of a buffer entry whose header occupies an entire cacheline
+ * and whose content starts on the next one, instead of right after the
+ * header. Every cacheline of such an entry holds either the header or the
+ * content, never both.
+ */
+#define ULOG_ENTRY_BUF_LINE_ALIGNED (1ULL << 63)
+
 /*
  * This structure *must* be located at a cacheline boundary. To achieve this,
  * the next field is always allocated with extra padding, and then the offset
@@ -175,10 +183,15 @@ struct ulog_entry_val *ulog_entry_val_create(struct ulog *ulog,
 	ulog_operation_type type,
 	const struct pmem_ops *p_ops);
 
+size_t ulog_entry_buf_header_size(int line_aligned);
+uint64_t ulog_entry_buf_size(const struct ulog_entry_buf *eb);
+uint8_t *ulog_entry_buf_data(struct ulog_entry_buf *eb);
+
 struct ulog_entry_buf *
 ulog_entry_buf_create(struct ulog *ulog, size_t offset,
 	uint64_t gen_num, uint64_t *dest, const void *src, uint64_t size,
-	ulog_operation_type type, const struct pmem_ops *p_ops);
+	ulog_operation_type type, int line_aligned,
+	const struct pmem_ops *p_ops);
 
 void ulog_entry_apply(const struct ulog_entry_base *e, int persist,
 	const struct pmem_ops *p_ops);
@@ -1,5 +1,5 @@
 /*
- * Copyright 2017-2019, Intel Corporation
+ * Copyright 2017-2026, Intel Corporation
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions
@@ -36,6 +36,24 @@
 
 #include "unittest.h"
 
+#define STICKY_THREADS 10
+
+/*
+ * tx_worker -- runs a single transaction and exits
+ */
+static void *
+tx_worker(void *arg)
+{
+	PMEMobjpool *pop = arg;
+
+	TX_BEGIN(pop) {
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	return NULL;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -92,6 +110,156 @@ main(int argc, char *argv[])
 	UT_ASSERTeq(ret, 0);
 	UT_ASSERTeq(allocated, oid_size);
 
+	ret = pmemobj_alloc(pop, &oid, 4 * CACHELINE_SIZE, 0, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	char *buf = (char *)pmemobj_direct(oid);
+	char *line = (char *)ALIGN_UP((uintptr_t)buf, CACHELINE_SIZE);
+
+	uint64_t lines;
+	uint64_t partial;
+	uint64_t fences;
+	uint64_t log_bytes;
+	ret = pmemobj_ctl_get(pop, "stats.persist.lines", &lines);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "stats.persist.partial_lines", &partial);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "stats.persist.fences", &fences);
+	UT_ASSERTeq(ret, 0);
+
+	/* two lines, the second one only partially */
+	pmemobj_persist(pop, line, CACHELINE_SIZE + 8);
+
+	uint64_t value;
+	ret = pmemobj_ctl_get(pop, "stats.persist.lines", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, lines + 2);
+	ret = pmemobj_ctl_get(pop, "stats.persist.partial_lines", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, partial + 1);
+	ret = pmemobj_ctl_get(pop, "stats.persist.fences", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, fences + 1);
+
+	ret = pmemobj_ctl_get(pop, "stats.persist.log_bytes", &log_bytes);
+	UT_ASSERTeq(ret, 0);
+
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(line, 8);
+		*line = 1;
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	ret = pmemobj_ctl_get(pop, "stats.persist.log_bytes", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERT(value > log_bytes);
+
+	uint64_t committed;
+	ret = pmemobj_ctl_get(pop, "stats.tx.committed", &committed);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "stats.tx.flushed_lines", &lines);
+	UT_ASSERTeq(ret, 0);
+
+	/* adjacent ranges, the first line is flushed once */
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(line, 8);
+		pmemobj_tx_add_range_direct(line + 8, 8);
+		pmemobj_tx_add_range_direct(line + CACHELINE_SIZE - 8, 16);
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	ret = pmemobj_ctl_get(pop, "stats.tx.flushed_lines", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, lines + 2);
+	lines = value;
+
+	/* overlapping ranges within the second and third line */
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(line + CACHELINE_SIZE,
+			2 * CACHELINE_SIZE);
+		pmemobj_tx_add_range_direct(line + CACHELINE_SIZE + 8, 8);
+		pmemobj_tx_add_range_direct(line + 2 * CACHELINE_SIZE + 16,
+			CACHELINE_SIZE - 16);
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	ret = pmemobj_ctl_get(pop, "stats.tx.flushed_lines", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, lines + 2);
+	lines = value;
+
+	/* the untouched line between two ranges is not flushed */
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(line, 8);
+		pmemobj_tx_add_range_direct(line + 2 * CACHELINE_SIZE, 8);
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	ret = pmemobj_ctl_get(pop, "stats.tx.flushed_lines", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, lines + 2);
+	ret = pmemobj_ctl_get(pop, "stats.tx.committed", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, committed + 3);
+
+	int sticky = 1;
+	ret = pmemobj_ctl_set(pop, "lane.sticky", &sticky);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_set(pop, "lane.prewarm", &sticky);
+	UT_ASSERTeq(ret, 0);
+
+	uint64_t holds;
+	ret = pmemobj_ctl_get(pop, "stats.lanes.holds", &holds);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTne(holds, 0);
+
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(line, 8);
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	ret = pmemobj_ctl_get(pop, "stats.lanes.holds", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERT(value > holds);
+	ret = pmemobj_ctl_get(pop, "stats.lanes.bound", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, 1);
+	ret = pmemobj_ctl_get(pop, "stats.lanes.contended", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, 0);
+
+	/* the lanes of the exited threads are released */
+	for (int i = 0; i < STICKY_THREADS; ++i) {
+		os_thread_t t;
+		os_thread_create(&t, NULL, tx_worker, pop);
+		os_thread_join(&t, NULL);
+
+		ret = pmemobj_ctl_get(pop, "stats.lanes.bound", &value);
+		UT_ASSERTeq(ret, 0);
+		UT_ASSERTeq(value, 1);
+	}
+
+	ret = pmemobj_ctl_get(pop, "stats.lanes.contended", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, 0);
+
+	enabled = 0;
+	ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	ret = pmemobj_ctl_get(pop, "stats.persist.lines", &lines);
+	UT_ASSERTeq(ret, 0);
+
+	pmemobj_persist(pop, line, CACHELINE_SIZE);
+
+	ret = pmemobj_ctl_get(pop, "stats.persist.lines", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, lines);
+
 	pmemobj_close(pop);
 
 	DONE(NULL);
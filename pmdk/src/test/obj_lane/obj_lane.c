@@ -141,7 +141,7 @@ test_lane_hold_release(void)
 	struct ulog *mock_ulog = ZALLOC(SIZEOF_ULOG(1024));
 	struct pmem_ops p_ops;
 	struct operation_context *ctx = operation_new(mock_ulog, 1024,
-		NULL, NULL, &p_ops, LOG_TYPE_REDO);
+		NULL, NULL, &p_ops, NULL, LOG_TYPE_REDO);
 
 	struct lane mock_lane = {
 		.layout = MOCK_LAYOUT,
@@ -156,6 +156,10 @@ test_lane_hold_release(void)
 	pop->p.lanes_desc.runtime_nlanes = 1,
 	pop->p.lanes_desc.lane = &mock_lane;
 	pop->p.lanes_desc.next_lane_idx = 0;
+	pop->p.lanes_desc.sticky = 0;
+	pop->p.lanes_desc.prewarm = 0;
+	pop->p.lanes_desc.lane_owners = NULL;
+	pop->p.stats = ZALLOC(sizeof(struct stats));
 
 	pop->p.lanes_desc.lane_locks = CALLOC(OBJ_NLANES, sizeof(uint64_t));
 	pop->p.lanes_offset = (uint64_t)&pop->l - (uint64_t)&pop->p;
@@ -188,6 +192,7 @@ test_lane_hold_release(void)
 	SIGACTION(SIGABRT, &old, NULL);
 
 	FREE(pop->p.lanes_desc.lane_locks);
+	FREE(pop->p.stats);
 	FREE(pop);
 	operation_delete(ctx);
 	FREE(mock_ulog);
@@ -235,7 +235,8 @@ FUNC_MOCK_RUN_DEFAULT
 	pmemops_persist(p_ops, &Pop->run_id, sizeof(Pop->run_id));
 
 	Lane.external = operation_new((struct ulog *)&Lane.layout->external,
-		LANE_REDO_EXTERNAL_SIZE, NULL, NULL, p_ops, LOG_TYPE_REDO);
+		LANE_REDO_EXTERNAL_SIZE, NULL, NULL, p_ops, NULL,
+		LOG_TYPE_REDO);
 
 	return Pop;
 }
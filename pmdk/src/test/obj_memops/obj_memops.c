@@ -184,7 +184,7 @@ test_redo(PMEMobjpool *pop, struct test_object *object)
 	struct operation_context *ctx = operation_new(
 		(struct ulog *)&object->redo, TEST_ENTRIES,
 		pmalloc_redo_extend, (ulog_free_fn)pfree,
-		&pop->p_ops, LOG_TYPE_REDO);
+		&pop->p_ops, NULL, LOG_TYPE_REDO);
 
 	test_set_entries(pop, ctx, object, 10, FAIL_NONE);
 	clear_test_values(object);
@@ -208,7 +208,7 @@ test_redo(PMEMobjpool *pop, struct test_object *object)
 	/* verify that rebuilding redo_next works */
 	ctx = operation_new(
 		(struct ulog *)&object->redo, TEST_ENTRIES,
-		NULL, test_free_entry, &pop->p_ops, LOG_TYPE_REDO);
+		NULL, test_free_entry, &pop->p_ops, NULL, LOG_TYPE_REDO);
 
 	test_set_entries(pop, ctx, object, 100, 0);
 	clear_test_values(object);
@@ -492,7 +492,7 @@ test_undo_log_reuse()
 	struct operation_context *ctx = operation_new(
 		(struct ulog *)first, ULOG_SIZE,
 		NULL, test_free_entry,
-		&ops, LOG_TYPE_UNDO);
+		&ops, NULL, LOG_TYPE_UNDO);
 
 	size_t nentries = 0;
 	ulog_foreach_entry((struct ulog *)first,
@@ -544,7 +544,7 @@ test_undo(PMEMobjpool *pop, struct test_object *object)
 	struct operation_context *ctx = operation_new(
 		(struct ulog *)&object->undo, TEST_ENTRIES,
 		pmalloc_redo_extend, (ulog_free_fn)pfree,
-		&pop->p_ops, LOG_TYPE_UNDO);
+		&pop->p_ops, NULL, LOG_TYPE_UNDO);
 
 	test_undo_small_single_copy(ctx, object);
 	test_undo_small_single_set(ctx, object);
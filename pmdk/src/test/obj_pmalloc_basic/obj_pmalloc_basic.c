@@ -307,6 +307,7 @@ test_mock_pool_allocs(void)
 
 	struct stats *s = stats_new(mock_pop);
 	UT_ASSERTne(s, NULL);
+	mock_pop->stats = s;
 
 	heap_init(heap_start, heap_size, &mock_pop->heap_size,
 		&mock_pop->p_ops);
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2026, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * obj_ulog_line_aligned.c -- unit test for the tx.undo.line_aligned undo log
+ *	entry layout
+ *
+ * usage: obj_ulog_line_aligned file line_aligned:0|1 cmd:t|i|o
+ *
+ * t - commits and aborts transactions
+ * i - interrupts a transaction in the middle
+ * o - opens the pool left by 'i' and checks that the transaction was rolled
+ *	back
+ */
+#include "unittest.h"
+#include "valgrind_internal.h"
+#if VG_PMEMCHECK_ENABLED
+#define VALGRIND_PMEMCHECK_END_TX VALGRIND_PMC_END_TX
+#else
+#define VALGRIND_PMEMCHECK_END_TX
+#endif
+
+#define LAYOUT_NAME "obj_ulog_line_aligned"
+
+/* bigger than the undo log of a lane, so the log has to be extended */
+#define DATA_SIZE (64 * 1024)
+
+struct root {
+	uint64_t first;
+	char data[DATA_SIZE];
+	uint64_t last;
+};
+
+/* sizes and offsets of the snapshotted ranges, unaligned on purpose */
+static const struct {
+	size_t offset;
+	size_t size;
+} ranges[] = {
+	{1, 1},
+	{9, 8},
+	{100, 63},
+	{200, 64},
+	{300, 65},
+	{513, 1000},
+	{2048, 4096},
+	{8191, DATA_SIZE - 8191},
+};
+
+#define NRANGES (sizeof(ranges) / sizeof(ranges[0]))
+
+/*
+ * set_line_aligned -- sets the ctl and checks that it reads back
+ */
+static void
+set_line_aligned(PMEMobjpool *pop, int line_aligned)
+{
+	int ret = pmemobj_ctl_set(pop, "tx.undo.line_aligned", &line_aligned);
+	UT_ASSERTeq(ret, 0);
+
+	int value = !line_aligned;
+	ret = pmemobj_ctl_get(pop, "tx.undo.line_aligned", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, line_aligned);
+}
+
+/*
+ * pattern -- (internal) returns the byte of the pattern of c at offset i
+ */
+static char
+pattern(char c, size_t i)
+{
+	return (char)(c + (char)(i % 7));
+}
+
+/*
+ * fill -- (internal) fills the root with a pattern derived from c
+ */
+static void
+fill(struct root *rootp, char c)
+{
+	rootp->first = (uint64_t)c;
+	for (size_t i = 0; i < DATA_SIZE; ++i)
+		rootp->data[i] = pattern(c, i);
+	rootp->last = (uint64_t)c;
+}
+
+/*
+ * check -- (internal) checks that the root holds the pattern of c
+ */
+static void
+check(struct root *rootp, char c)
+{
+	UT_ASSERTeq(rootp->first, (uint64_t)c);
+	for (size_t i = 0; i < DATA_SIZE; ++i)
+		UT_ASSERTeq(rootp->data[i], pattern(c, i));
+	UT_ASSERTeq(rootp->last, (uint64_t)c);
+}
+
+/*
+ * modify -- (internal) snapshots the ranges of the root and overwrites them
+ *	with the pattern of c, must be called in a transaction
+ */
+static void
+modify(struct root *rootp, char c)
+{
+	pmemobj_tx_add_range_direct(&rootp->first, sizeof(rootp->first));
+	rootp->first = (uint64_t)c;
+
+	for (size_t r = 0; r < NRANGES; ++r) {
+		pmemobj_tx_add_range_direct(&rootp->data[ranges[r].offset],
+			ranges[r].size);
+	}
+
+	/* the ranges cover everything but a few gaps, fill them too */
+	pmemobj_tx_add_range_direct(rootp->data, DATA_SIZE);
+	for (size_t i = 0; i < DATA_SIZE; ++i)
+		rootp->data[i] = pattern(c, i);
+
+	pmemobj_tx_add_range_direct(&rootp->last, sizeof(rootp->last));
+	rootp->last = (uint64_t)c;
+}
+
+/*
+ * init -- (internal) stores the initial pattern in a committed transaction
+ */
+static void
+init(PMEMobjpool *pop, struct root *rootp)
+{
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(rootp, sizeof(*rootp));
+		fill(rootp, 'a');
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	check(rootp, 'a');
+}
+
+/*
+ * commit_and_abort -- (internal) commits and aborts a transaction that
+ *	modifies the root
+ */
+static void
+commit_and_abort(PMEMobjpool *pop, struct root *rootp, char committed)
+{
+	TX_BEGIN(pop) {
+		modify(rootp, committed);
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	check(rootp, committed);
+
+	TX_BEGIN(pop) {
+		modify(rootp, 'x');
+		pmemobj_tx_abort(ECANCELED);
+	} TX_ONCOMMIT {
+		UT_ASSERT(0);
+	} TX_END
+
+	check(rootp, committed);
+
+	/* an inner abort rolls back the outer transaction too */
+	TX_BEGIN(pop) {
+		modify(rootp, 'y');
+		TX_BEGIN(pop) {
+			modify(rootp, 'z');
+			pmemobj_tx_abort(ECANCELED);
+		} TX_END
+	} TX_ONCOMMIT {
+		UT_ASSERT(0);
+	} TX_END
+
+	check(rootp, committed);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_ulog_line_aligned");
+
+	if (argc != 4 || strchr("01", argv[2][0]) == NULL ||
+			strchr("tio", argv[3][0]) == NULL)
+		UT_FATAL("usage: %s file line_aligned:0|1 cmd:t|i|o", argv[0]);
+
+	const char *path = argv[1];
+	int line_aligned = argv[2][0] == '1';
+	char cmd = argv[3][0];
+
+	PMEMobjpool *pop;
+	if (cmd == 'o') {
+		pop = pmemobj_open(path, LAYOUT_NAME);
+		if (pop == NULL)
+			UT_FATAL("!pmemobj_open: %s", path);
+	} else {
+		pop = pmemobj_create(path, LAYOUT_NAME, 0, S_IWUSR | S_IRUSR);
+		if (pop == NULL)
+			UT_FATAL("!pmemobj_create: %s", path);
+	}
+
+	set_line_aligned(pop, line_aligned);
+
+	PMEMoid root = pmemobj_root(pop, sizeof(struct root));
+	UT_ASSERT(!OID_IS_NULL(root));
+	struct root *rootp = pmemobj_direct(root);
+
+	switch (cmd) {
+		case 't':
+			init(pop, rootp);
+			commit_and_abort(pop, rootp, 'b');
+			break;
+		case 'i':
+			init(pop, rootp);
+			TX_BEGIN(pop) {
+				modify(rootp, 'b');
+				/*
+				 * Persist the modified data, so the rollback
+				 * on open is what restores the initial one.
+				 */
+				pmemobj_persist(pop, rootp, sizeof(*rootp));
+				VALGRIND_PMEMCHECK_END_TX;
+
+				exit(0); /* simulate a crash */
+			} TX_END
+			break;
+		case 'o':
+			check(rootp, 'a');
+			commit_and_abort(pop, rootp, 'c');
+			break;
+	}
+
+	pmemobj_close(pop);
+
+	UT_ASSERTeq(pmemobj_check(path, LAYOUT_NAME), 1);
+
+	DONE(NULL);
+}
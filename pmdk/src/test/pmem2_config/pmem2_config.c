@@ -0,0 +1,343 @@
+/*
+ * Copyright 2026, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * pmem2_config.c -- pmem2_config unittests
+ */
+
+#include <stdint.h>
+
+#include "unittest.h"
+#include "libpmem2.h"
+
+/*
+ * source_from_file -- (internal) opens the file and creates a source of it
+ */
+static struct pmem2_source *
+source_from_file(const char *path, int *fd)
+{
+	struct pmem2_source *src;
+
+	*fd = OPEN(path, O_RDWR);
+	int ret = pmem2_source_from_fd(&src, *fd);
+	UT_ASSERTeq(ret, 0);
+
+	return src;
+}
+
+/*
+ * map_expect -- (internal) maps the file with the config and checks that
+ *	pmem2_map returns the expected value
+ */
+static void
+map_expect(struct pmem2_config *cfg, const char *path, int expected)
+{
+	int fd;
+	struct pmem2_source *src = source_from_file(path, &fd);
+
+	struct pmem2_map *map;
+	int ret = pmem2_map(cfg, src, &map);
+	UT_ASSERTeq(ret, expected);
+	if (ret == 0)
+		UT_ASSERTeq(pmem2_unmap(&map), 0);
+	else
+		UT_ASSERTeq(map, NULL);
+
+	pmem2_source_delete(&src);
+	CLOSE(fd);
+}
+
+/*
+ * file_alignment -- (internal) returns the alignment of the file source
+ */
+static size_t
+file_alignment(const char *path, size_t *size)
+{
+	int fd;
+	struct pmem2_source *src = source_from_file(path, &fd);
+
+	size_t alignment;
+	UT_ASSERTeq(pmem2_source_alignment(src, &alignment), 0);
+	UT_ASSERTeq(pmem2_source_size(src, size), 0);
+
+	pmem2_source_delete(&src);
+	CLOSE(fd);
+
+	return alignment;
+}
+
+/*
+ * config_new -- (internal) creates a config requesting page granularity
+ */
+static struct pmem2_config *
+config_new(void)
+{
+	struct pmem2_config *cfg;
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+	UT_ASSERTeq(pmem2_config_set_required_store_granularity(cfg,
+		PMEM2_GRANULARITY_PAGE), 0);
+
+	return cfg;
+}
+
+/*
+ * test_cfg_create_and_delete_valid -- the config is allocated and freed
+ */
+static int
+test_cfg_create_and_delete_valid(const struct test_case *tc, int argc,
+	char *argv[])
+{
+	struct pmem2_config *cfg;
+
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+	UT_ASSERTne(cfg, NULL);
+
+	UT_ASSERTeq(pmem2_config_delete(&cfg), 0);
+	UT_ASSERTeq(cfg, NULL);
+
+	return 0;
+}
+
+/*
+ * test_set_invalid_values -- setters reject values out of their domain
+ */
+static int
+test_set_invalid_values(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_config *cfg;
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+
+	int ret = pmem2_config_set_offset(cfg, (size_t)INT64_MAX + 1);
+	UT_ASSERTeq(ret, PMEM2_E_OFFSET_OUT_OF_RANGE);
+
+	ret = pmem2_config_set_required_store_granularity(cfg,
+		(enum pmem2_granularity)(PMEM2_GRANULARITY_PAGE + 1));
+	UT_ASSERTeq(ret, PMEM2_E_GRANULARITY_NOT_SUPPORTED);
+
+	ret = pmem2_config_set_sharing(cfg,
+		(enum pmem2_sharing_type)(PMEM2_PRIVATE + 1));
+	UT_ASSERTeq(ret, PMEM2_E_INVALID_SHARING_VALUE);
+
+	ret = pmem2_config_set_protection(cfg, PMEM2_PROT_READ | 1);
+	UT_ASSERTeq(ret, PMEM2_E_INVALID_PROT_FLAG);
+
+	pmem2_config_delete(&cfg);
+
+	return 0;
+}
+
+/*
+ * test_granularity_not_set -- mapping without a required granularity fails
+ */
+static int
+test_granularity_not_set(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_granularity_not_set <file>");
+
+	struct pmem2_config *cfg;
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+
+	map_expect(cfg, argv[0], PMEM2_E_GRANULARITY_NOT_SET);
+
+	pmem2_config_delete(&cfg);
+
+	return 1;
+}
+
+/*
+ * test_offset_unaligned -- the offset has to be a multiple of the alignment
+ */
+static int
+test_offset_unaligned(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_offset_unaligned <file>");
+
+	size_t size;
+	size_t alignment = file_alignment(argv[0], &size);
+
+	struct pmem2_config *cfg = config_new();
+	UT_ASSERTeq(pmem2_config_set_offset(cfg, alignment - 1), 0);
+
+	map_expect(cfg, argv[0], PMEM2_E_OFFSET_UNALIGNED);
+
+	pmem2_config_delete(&cfg);
+
+	return 1;
+}
+
+/*
+ * test_length_unaligned -- the length has to be a multiple of the alignment
+ */
+static int
+test_length_unaligned(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_length_unaligned <file>");
+
+	size_t size;
+	size_t alignment = file_alignment(argv[0], &size);
+
+	struct pmem2_config *cfg = config_new();
+	UT_ASSERTeq(pmem2_config_set_length(cfg, alignment + 1), 0);
+
+	map_expect(cfg, argv[0], PMEM2_E_LENGTH_UNALIGNED);
+
+	pmem2_config_delete(&cfg);
+
+	return 1;
+}
+
+/*
+ * test_offset_out_of_range -- the offset has to be inside of the source
+ */
+static int
+test_offset_out_of_range(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_offset_out_of_range <file>");
+
+	size_t size;
+	file_alignment(argv[0], &size);
+
+	struct pmem2_config *cfg = config_new();
+	UT_ASSERTeq(pmem2_config_set_offset(cfg, size), 0);
+
+	map_expect(cfg, argv[0], PMEM2_E_MAP_RANGE);
+
+	pmem2_config_delete(&cfg);
+
+	return 1;
+}
+
+/*
+ * test_length_out_of_range -- the mapping cannot extend beyond the end of
+ *	the source
+ */
+static int
+test_length_out_of_range(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_length_out_of_range <file>");
+
+	size_t size;
+	size_t alignment = file_alignment(argv[0], &size);
+
+	struct pmem2_config *cfg = config_new();
+	UT_ASSERTeq(pmem2_config_set_offset(cfg, alignment), 0);
+	UT_ASSERTeq(pmem2_config_set_length(cfg, size), 0);
+
+	map_expect(cfg, argv[0], PMEM2_E_MAP_RANGE);
+
+	pmem2_config_delete(&cfg);
+
+	return 1;
+}
+
+/*
+ * test_source_empty -- an empty source cannot be mapped
+ */
+static int
+test_source_empty(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_source_empty <file>");
+
+	struct pmem2_config *cfg = config_new();
+
+	map_expect(cfg, argv[0], PMEM2_E_SOURCE_EMPTY);
+
+	pmem2_config_delete(&cfg);
+
+	return 1;
+}
+
+/*
+ * test_offset_length_valid -- an aligned range inside of the source is
+ *	mapped with the requested length
+ */
+static int
+test_offset_length_valid(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_offset_length_valid <file>");
+
+	size_t size;
+	size_t alignment = file_alignment(argv[0], &size);
+
+	struct pmem2_config *cfg = config_new();
+	UT_ASSERTeq(pmem2_config_set_offset(cfg, alignment), 0);
+	UT_ASSERTeq(pmem2_config_set_length(cfg, size - alignment), 0);
+
+	int fd;
+	struct pmem2_source *src = source_from_file(argv[0], &fd);
+
+	struct pmem2_map *map;
+	UT_ASSERTeq(pmem2_map(cfg, src, &map), 0);
+	UT_ASSERTeq(pmem2_map_get_size(map), size - alignment);
+	UT_ASSERTeq(pmem2_unmap(&map), 0);
+	UT_ASSERTeq(map, NULL);
+
+	pmem2_source_delete(&src);
+	CLOSE(fd);
+	pmem2_config_delete(&cfg);
+
+	return 1;
+}
+
+/*
+ * test_cases -- available test cases
+ */
+static struct test_case test_cases[] = {
+	TEST_CASE(test_cfg_create_and_delete_valid),
+	TEST_CASE(test_set_invalid_values),
+	TEST_CASE(test_granularity_not_set),
+	TEST_CASE(test_offset_unaligned),
+	TEST_CASE(test_length_unaligned),
+	TEST_CASE(test_offset_out_of_range),
+	TEST_CASE(test_length_out_of_range),
+	TEST_CASE(test_source_empty),
+	TEST_CASE(test_offset_length_valid),
+};
+
+#define NTESTS (sizeof(test_cases) / sizeof(test_cases[0]))
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "pmem2_config");
+
+	TEST_CASE_PROCESS(argc, argv, test_cases, NTESTS);
+
+	DONE(NULL);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2026, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * pmem2_deep_flush.c -- pmem2_deep_flush unittests
+ */
+
+#include <stdint.h>
+
+#include "unittest.h"
+#include "libpmem2.h"
+
+static const char * const granularity_names[] = {
+	[PMEM2_GRANULARITY_BYTE] = "byte",
+	[PMEM2_GRANULARITY_CACHE_LINE] = "cache line",
+	[PMEM2_GRANULARITY_PAGE] = "page",
+};
+
+/*
+ * map_source -- (internal) maps the whole source with page granularity
+ */
+static struct pmem2_map *
+map_source(struct pmem2_source *src)
+{
+	struct pmem2_config *cfg;
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+	UT_ASSERTeq(pmem2_config_set_required_store_granularity(cfg,
+		PMEM2_GRANULARITY_PAGE), 0);
+
+	struct pmem2_map *map;
+	int ret = pmem2_map(cfg, src, &map);
+	UT_ASSERTeq(ret, 0);
+
+	pmem2_config_delete(&cfg);
+
+	return map;
+}
+
+/*
+ * check_deep_flush -- (internal) checks the ranges deep flush accepts and
+ *	rejects for the mapping
+ */
+static void
+check_deep_flush(struct pmem2_map *map)
+{
+	char *addr = pmem2_map_get_address(map);
+	size_t size = pmem2_map_get_size(map);
+
+	/* the whole mapping, a part of it and an empty range at its end */
+	UT_ASSERTeq(pmem2_deep_flush(map, addr, size), 0);
+	UT_ASSERTeq(pmem2_deep_flush(map, addr + size / 2, size / 4), 0);
+	UT_ASSERTeq(pmem2_deep_flush(map, addr + size, 0), 0);
+
+	/* ranges starting before or reaching beyond the mapping */
+	UT_ASSERTeq(pmem2_deep_flush(map, addr - 1, 2),
+		PMEM2_E_DEEP_FLUSH_RANGE);
+	UT_ASSERTeq(pmem2_deep_flush(map, addr, size + 1),
+		PMEM2_E_DEEP_FLUSH_RANGE);
+	UT_ASSERTeq(pmem2_deep_flush(map, addr + size - 1, 2),
+		PMEM2_E_DEEP_FLUSH_RANGE);
+	UT_ASSERTeq(pmem2_deep_flush(map, addr + size + 1, 0),
+		PMEM2_E_DEEP_FLUSH_RANGE);
+
+	/* a size that overflows the end address */
+	UT_ASSERTeq(pmem2_deep_flush(map, addr + 1, SIZE_MAX),
+		PMEM2_E_DEEP_FLUSH_RANGE);
+}
+
+/*
+ * test_deep_flush_file -- deep flush of a file mapping
+ */
+static int
+test_deep_flush_file(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_deep_flush_file <file>");
+
+	int fd = OPEN(argv[0], O_RDWR);
+	struct pmem2_source *src;
+	UT_ASSERTeq(pmem2_source_from_fd(&src, fd), 0);
+
+	struct pmem2_map *map = map_source(src);
+	UT_OUT("%s granularity",
+		granularity_names[pmem2_map_get_store_granularity(map)]);
+
+	check_deep_flush(map);
+
+	UT_ASSERTeq(pmem2_unmap(&map), 0);
+	pmem2_source_delete(&src);
+	CLOSE(fd);
+
+	return 1;
+}
+
+/*
+ * test_deep_flush_anon -- deep flush of an anonymous mapping
+ */
+static int
+test_deep_flush_anon(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_source *src;
+	UT_ASSERTeq(pmem2_source_from_anon(&src, 1 << 20), 0);
+
+	struct pmem2_map *map = map_source(src);
+
+	check_deep_flush(map);
+
+	UT_ASSERTeq(pmem2_unmap(&map), 0);
+	pmem2_source_delete(&src);
+
+	return 0;
+}
+
+/*
+ * test_cases -- available test cases
+ */
+static struct test_case test_cases[] = {
+	TEST_CASE(test_deep_flush_file),
+	TEST_CASE(test_deep_flush_anon),
+};
+
+#define NTESTS (sizeof(test_cases) / sizeof(test_cases[0]))
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "pmem2_deep_flush");
+
+	TEST_CASE_PROCESS(argc, argv, test_cases, NTESTS);
+
+	DONE(NULL);
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * pmem2_granularity.c -- test for the store granularity detected by pmem2_map
+ */
+
+#include <string.h>
+
+#include "unittest.h"
+#include "libpmem2.h"
+
+/*
+ * parse_granularity -- (internal) translates the name of a granularity
+ */
+static enum pmem2_granularity
+parse_granularity(const char *str)
+{
+	if (strcmp(str, "BYTE") == 0)
+		return PMEM2_GRANULARITY_BYTE;
+	if (strcmp(str, "CACHE_LINE") == 0)
+		return PMEM2_GRANULARITY_CACHE_LINE;
+	if (strcmp(str, "PAGE") == 0)
+		return PMEM2_GRANULARITY_PAGE;
+
+	UT_FATAL("unknown granularity -- '%s'", str);
+}
+
+/*
+ * map_granularity -- (internal) maps the source with the required
+ *	granularity, returns the result of pmem2_map and the granularity of the
+ *	mapping in *g
+ */
+static int
+map_granularity(struct pmem2_source *src, enum pmem2_granularity required,
+	enum pmem2_granularity *g)
+{
+	struct pmem2_config *cfg;
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+	UT_ASSERTeq(pmem2_config_set_required_store_granularity(cfg,
+		required), 0);
+
+	struct pmem2_map *map;
+	int ret = pmem2_map(cfg, src, &map);
+	if (ret == 0) {
+		*g = pmem2_map_get_store_granularity(map);
+		UT_ASSERTeq(pmem2_unmap(&map), 0);
+	}
+
+	pmem2_config_delete(&cfg);
+
+	return ret;
+}
+
+/*
+ * check_granularity -- (internal) checks that the source is mapped with the
+ *	expected granularity and that a finer required one is rejected
+ */
+static void
+check_granularity(struct pmem2_source *src, enum pmem2_granularity expected)
+{
+	enum pmem2_granularity g;
+
+	/* page granularity is good enough for any mapping */
+	UT_ASSERTeq(map_granularity(src, PMEM2_GRANULARITY_PAGE, &g), 0);
+	UT_ASSERTeq(g, expected);
+
+	UT_ASSERTeq(map_granularity(src, expected, &g), 0);
+	UT_ASSERTeq(g, expected);
+
+	if (expected == PMEM2_GRANULARITY_BYTE)
+		return;
+
+	int ret = map_granularity(src,
+		(enum pmem2_granularity)(expected - 1), &g);
+	UT_ASSERTeq(ret, PMEM2_E_GRANULARITY_NOT_SUPPORTED);
+}
+
+/*
+ * test_granularity -- checks the granularity of a shared mapping of the file
+ */
+static int
+test_granularity(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: test_granularity <file> <granularity>");
+
+	enum pmem2_granularity expected = parse_granularity(argv[1]);
+
+	int fd = OPEN(argv[0], O_RDWR);
+	struct pmem2_source *src;
+	UT_ASSERTeq(pmem2_source_from_fd(&src, fd), 0);
+
+	check_granularity(src, expected);
+
+	pmem2_source_delete(&src);
+	CLOSE(fd);
+
+	return 2;
+}
+
+/*
+ * test_granularity_anon -- anonymous mappings never reach persistent memory,
+ *	they are byte granularity whatever the environment says
+ */
+static int
+test_granularity_anon(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_source *src;
+	UT_ASSERTeq(pmem2_source_from_anon(&src, 1 << 20), 0);
+
+	check_granularity(src, PMEM2_GRANULARITY_BYTE);
+
+	pmem2_source_delete(&src);
+
+	return 0;
+}
+
+/*
+ * test_cases -- available test cases
+ */
+static struct test_case test_cases[] = {
+	TEST_CASE(test_granularity),
+	TEST_CASE(test_granularity_anon),
+};
+
+#define NTESTS (sizeof(test_cases) / sizeof(test_cases[0]))
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "pmem2_granularity");
+
+	TEST_CASE_PROCESS(argc, argv, test_cases, NTESTS);
+
+	DONE(NULL);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2026, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * pmem2_map.c -- pmem2_map unittests for anonymous and private mappings
+ */
+
+#include <string.h>
+
+#include "unittest.h"
+#include "libpmem2.h"
+
+#define ANON_SIZE (1 << 20)
+
+/*
+ * map_valid -- (internal) maps the source, which has to succeed
+ */
+static struct pmem2_map *
+map_valid(struct pmem2_source *src, enum pmem2_granularity required,
+	enum pmem2_sharing_type sharing)
+{
+	struct pmem2_config *cfg;
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+	UT_ASSERTeq(pmem2_config_set_required_store_granularity(cfg,
+		required), 0);
+	UT_ASSERTeq(pmem2_config_set_sharing(cfg, sharing), 0);
+
+	struct pmem2_map *map;
+	int ret = pmem2_map(cfg, src, &map);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTne(map, NULL);
+
+	pmem2_config_delete(&cfg);
+
+	return map;
+}
+
+/*
+ * fill -- (internal) fills the whole mapping with c and persists it
+ */
+static void
+fill(struct pmem2_map *map, int c)
+{
+	pmem2_memset_fn memset_fn = pmem2_get_memset_fn(map);
+	memset_fn(pmem2_map_get_address(map), c, pmem2_map_get_size(map), 0);
+}
+
+/*
+ * check_filled -- (internal) checks that the whole mapping is filled with c
+ */
+static void
+check_filled(struct pmem2_map *map, int c)
+{
+	char *addr = pmem2_map_get_address(map);
+	size_t size = pmem2_map_get_size(map);
+
+	for (size_t i = 0; i < size; ++i)
+		UT_ASSERTeq(addr[i], c);
+}
+
+/*
+ * test_map_anon -- an anonymous mapping is byte granularity, zeroed and
+ *	writable through the persist and mem functions of the mapping
+ */
+static int
+test_map_anon(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_source *src;
+	UT_ASSERTeq(pmem2_source_from_anon(&src, ANON_SIZE), 0);
+
+	struct pmem2_map *map = map_valid(src, PMEM2_GRANULARITY_BYTE,
+		PMEM2_SHARED);
+	UT_ASSERTeq(pmem2_map_get_size(map), ANON_SIZE);
+	UT_ASSERTeq(pmem2_map_get_store_granularity(map),
+		PMEM2_GRANULARITY_BYTE);
+
+	check_filled(map, 0);
+	fill(map, 'A');
+	check_filled(map, 'A');
+
+	char *addr = pmem2_map_get_address(map);
+	char buf[128];
+	memset(buf, 'B', sizeof(buf));
+
+	pmem2_memcpy_fn memcpy_fn = pmem2_get_memcpy_fn(map);
+	memcpy_fn(addr, buf, sizeof(buf), PMEM2_F_MEM_NONTEMPORAL);
+	UT_ASSERTeq(memcmp(addr, buf, sizeof(buf)), 0);
+
+	pmem2_memmove_fn memmove_fn = pmem2_get_memmove_fn(map);
+	memmove_fn(addr + 1, addr, sizeof(buf), PMEM2_F_MEM_NODRAIN);
+	pmem2_get_drain_fn(map)();
+	UT_ASSERTeq(addr[sizeof(buf)], 'B');
+
+	addr[0] = 'C';
+	pmem2_get_flush_fn(map)(addr, 1);
+	pmem2_get_persist_fn(map)(addr, 1);
+
+	UT_ASSERTeq(pmem2_unmap(&map), 0);
+	UT_ASSERTeq(map, NULL);
+	pmem2_source_delete(&src);
+
+	return 0;
+}
+
+/*
+ * test_map_anon_empty -- an anonymous source of size 0 cannot be mapped
+ */
+static int
+test_map_anon_empty(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_source *src;
+	UT_ASSERTeq(pmem2_source_from_anon(&src, 0), 0);
+
+	struct pmem2_config *cfg;
+	UT_ASSERTeq(pmem2_config_new(&cfg), 0);
+	UT_ASSERTeq(pmem2_config_set_required_store_granularity(cfg,
+		PMEM2_GRANULARITY_PAGE), 0);
+
+	struct pmem2_map *map;
+	UT_ASSERTeq(pmem2_map(cfg, src, &map), PMEM2_E_SOURCE_EMPTY);
+	UT_ASSERTeq(map, NULL);
+
+	pmem2_config_delete(&cfg);
+	pmem2_source_delete(&src);
+
+	return 0;
+}
+
+/*
+ * test_map_private -- stores to a private mapping of the file are byte
+ *	granularity and never reach the file
+ */
+static int
+test_map_private(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_map_private <file>");
+
+	int fd = OPEN(argv[0], O_RDWR);
+	struct pmem2_source *src;
+	UT_ASSERTeq(pmem2_source_from_fd(&src, fd), 0);
+
+	struct pmem2_map *map = map_valid(src, PMEM2_GRANULARITY_PAGE,
+		PMEM2_SHARED);
+	fill(map, 'A');
+	UT_ASSERTeq(pmem2_unmap(&map), 0);
+
+	map = map_valid(src, PMEM2_GRANULARITY_BYTE, PMEM2_PRIVATE);
+	UT_ASSERTeq(pmem2_map_get_store_granularity(map),
+		PMEM2_GRANULARITY_BYTE);
+	check_filled(map, 'A');
+	fill(map, 'B');
+	check_filled(map, 'B');
+	UT_ASSERTeq(pmem2_unmap(&map), 0);
+
+	map = map_valid(src, PMEM2_GRANULARITY_PAGE, PMEM2_SHARED);
+	check_filled(map, 'A');
+	UT_ASSERTeq(pmem2_unmap(&map), 0);
+
+	pmem2_source_delete(&src);
+	CLOSE(fd);
+
+	return 1;
+}
+
+/*
+ * test_cases -- available test cases
+ */
+static struct test_case test_cases[] = {
+	TEST_CASE(test_map_anon),
+	TEST_CASE(test_map_anon_empty),
+	TEST_CASE(test_map_private),
+};
+
+#define NTESTS (sizeof(test_cases) / sizeof(test_cases[0]))
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "pmem2_map");
+
+	TEST_CASE_PROCESS(argc, argv, test_cases, NTESTS);
+
+	DONE(NULL);
+}
@@ -127,6 +127,8 @@ LIB_TOOLS="../../tools"
 [ "$PMEMOBJCLI" ] || PMEMOBJCLI=$TOOLS/pmemobjcli/pmemobjcli
 [ "$PMEMDETECT" ] || PMEMDETECT=$TOOLS/pmemdetect/pmemdetect.static-nondebug
 [ "$PMREORDER" ] || PMREORDER=$LIB_TOOLS/pmreorder/pmreorder.py
+[ "$PMREORDER_NATIVE" ] || PMREORDER_NATIVE=$LIB_TOOLS/pmreorder/pmreorder-native
+[ "$PMREORDER_JOBS" ] || PMREORDER_JOBS=1
 [ "$FIP" ] || FIP=$TOOLS/fip/fip
 [ "$DDMAP" ] || DDMAP=$TOOLS/ddmap/ddmap
 [ "$CMPMAP" ] || CMPMAP=$TOOLS/cmpmap/cmpmap
@@ -3438,8 +3440,12 @@ function require_python3()
 #
 function require_pmreorder()
 {
-	# python3 and valgrind are necessary
-	require_python3
+	# python3 and valgrind are necessary, unless the native engine is used
+	if [ "$PMREORDER_ENGINE" == "native" ]; then
+		require_binary $PMREORDER_NATIVE
+	else
+		require_python3
+	fi
 	# pmemcheck is required to generate store_log
 	configure_valgrind pmemcheck force-enable $1
 	# pmreorder tool does not support unicode yet
@@ -3460,7 +3466,12 @@ function pmreorder_run_tool()
 {
 	rm -f pmreorder$UNITTEST_NUM.log
 	disable_exit_on_error
-	$PYTHON_EXE $PMREORDER \
+	if [ "$PMREORDER_ENGINE" == "native" ]; then
+		local pmreorder_cmd="$PMREORDER_NATIVE -j $PMREORDER_JOBS"
+	else
+		local pmreorder_cmd="$PYTHON_EXE $PMREORDER"
+	fi
+	$pmreorder_cmd \
 		-l store_log$UNITTEST_NUM.log \
 		-o pmreorder$UNITTEST_NUM.log \
 		-r $1 \
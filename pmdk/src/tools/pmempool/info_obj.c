@@ -159,7 +159,7 @@ info_obj_redo_entry(struct ulog_entry_base *e, void *arg,
 				"Size: %s ",
 				a->i++,
 				ulog_entry_offset(e),
-				out_get_size_str(eb->size,
+				out_get_size_str(ulog_entry_buf_size(eb),
 					a->pip->args.human));
 			break;
 		default:
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * engines.cpp -- store reordering engines of the native pmreorder
+ *
+ * The engines generate the same sequences as their counterparts in
+ * reorderengines.py. Sequences are passed to the callback one at a time,
+ * so the factorial number of the ReorderFull sequences is never kept in
+ * memory.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "engines.hpp"
+
+static const char *engine_names[MAX_ENGINE_TYPE] = {
+	"NoReorderNoCheck",
+	"ReorderFull",
+	"NoReorderDoCheck",
+	"ReorderAccumulative",
+	"ReorderReverseAccumulative",
+	"ReorderPartial",
+	"ReorderDefault",
+};
+
+/*
+ * engine_name -- returns the name of the engine type
+ */
+const char *
+engine_name(enum engine_type type)
+{
+	return engine_names[type];
+}
+
+/*
+ * engine_from_name -- parses the engine type, returns -1 if it is unknown
+ */
+int
+engine_from_name(const char *name, enum engine_type *type)
+{
+	for (int i = 0; i < MAX_ENGINE_TYPE; ++i) {
+		if (strcmp(engine_names[i], name) == 0) {
+			*type = (enum engine_type)i;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * engine_checks -- returns whether the sequences of the engine are checked
+ */
+bool
+engine_checks(enum engine_type type)
+{
+	return type != ENGINE_NO_REORDER_NO_CHECK;
+}
+
+/*
+ * engine_permutations -- (internal) generates all permutations of the given
+ *	length, in the itertools.permutations order
+ */
+static int
+engine_permutations(size_t nstores, size_t length, std::vector<size_t> &seq,
+		std::vector<bool> &used, const engine_seq_fn &fn)
+{
+	if (seq.size() == length)
+		return fn(seq);
+
+	for (size_t i = 0; i < nstores; ++i) {
+		if (used[i])
+			continue;
+
+		used[i] = true;
+		seq.push_back(i);
+		int ret = engine_permutations(nstores, length, seq, used, fn);
+		seq.pop_back();
+		used[i] = false;
+
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * engine_full -- (internal) all permutations of all lengths
+ */
+static int
+engine_full(size_t nstores, const engine_seq_fn &fn)
+{
+	std::vector<size_t> seq;
+	std::vector<bool> used(nstores, false);
+
+	for (size_t length = 0; length <= nstores; ++length) {
+		int ret = engine_permutations(nstores, length, seq, used, fn);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * engine_accumulative -- (internal) all prefixes, optionally of the reversed
+ *	list of stores
+ */
+static int
+engine_accumulative(size_t nstores, bool reverse, const engine_seq_fn &fn)
+{
+	std::vector<size_t> seq;
+
+	for (size_t i = 0; ; ++i) {
+		int ret = fn(seq);
+		if (ret || i == nstores)
+			return ret;
+
+		seq.push_back(reverse ? nstores - 1 - i : i);
+	}
+}
+
+/*
+ * engine_combinations_capped -- (internal) returns the number of k-element
+ *	combinations of n elements, or cap if there are more
+ */
+static size_t
+engine_combinations_capped(size_t n, size_t k, size_t cap)
+{
+	k = std::min(k, n - k);
+
+	/* C(n, i) grows with i up to n / 2, each step is an exact division */
+	unsigned __int128 c = 1;
+	for (size_t i = 0; i < k; ++i) {
+		c = c * (n - i) / (i + 1);
+		if (c >= cap)
+			return cap;
+	}
+
+	return std::min((size_t)c, cap);
+}
+
+/*
+ * engine_partial -- (internal) a random sample of the first combinations of
+ *	each length, as drawn by RandomPartialReorderEngine
+ */
+static int
+engine_partial(size_t nstores, std::mt19937_64 &rng, const engine_seq_fn &fn)
+{
+	std::vector<size_t> population(nstores + 1);
+	size_t total = 0;
+	for (size_t k = 0; k <= nstores; ++k) {
+		population[k] = engine_combinations_capped(nstores, k,
+				ENGINE_PARTIAL_POPULATION);
+		total += population[k];
+	}
+
+	/* draw without replacement, in the order of drawing */
+	size_t nsamples = std::min((size_t)ENGINE_PARTIAL_SEQUENCES, total);
+	std::vector<size_t> samples;
+	std::uniform_int_distribution<size_t> dist(0, total - 1);
+	while (samples.size() < nsamples) {
+		size_t s = dist(rng);
+		if (std::find(samples.begin(), samples.end(), s) ==
+				samples.end())
+			samples.push_back(s);
+	}
+
+	std::vector<size_t> seq;
+	for (size_t s : samples) {
+		size_t k = 0;
+		while (s >= population[k])
+			s -= population[k++];
+
+		/* the s-th k-element combination in lexicographic order */
+		seq.resize(k);
+		for (size_t i = 0; i < k; ++i)
+			seq[i] = i;
+		for (; s > 0; --s) {
+			size_t i = k;
+			while (seq[i - 1] == nstores - k + i - 1)
+				--i;
+			++seq[i - 1];
+			for (; i < k; ++i)
+				seq[i] = seq[i - 1] + 1;
+		}
+
+		int ret = fn(seq);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * engine_generate -- calls fn for each sequence of stores the engine yields
+ *	for a list of nstores stores
+ */
+int
+engine_generate(enum engine_type type, size_t nstores,
+		std::mt19937_64 &rng, const engine_seq_fn &fn)
+{
+	switch (type) {
+		case ENGINE_REORDER_FULL:
+			return engine_full(nstores, fn);
+		case ENGINE_REORDER_ACCUMULATIVE:
+			return engine_accumulative(nstores, false, fn);
+		case ENGINE_REORDER_REVERSE_ACCUMULATIVE:
+			return engine_accumulative(nstores, true, fn);
+		case ENGINE_REORDER_PARTIAL:
+			return engine_partial(nstores, rng, fn);
+		case ENGINE_NO_REORDER_NO_CHECK:
+		case ENGINE_NO_REORDER_DO_CHECK: {
+			std::vector<size_t> seq(nstores);
+			for (size_t i = 0; i < nstores; ++i)
+				seq[i] = i;
+			return fn(seq);
+		}
+		default:
+			return -1;
+	}
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * engines.hpp -- store reordering engines of the native pmreorder
+ */
+
+#ifndef PMREORDER_ENGINES_HPP
+#define PMREORDER_ENGINES_HPP 1
+
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <vector>
+
+/*
+ * The engine types, in the order of the -r choices. ENGINE_REORDER_DEFAULT
+ * can only be assigned to markers, it restores the engine given with -r.
+ */
+enum engine_type {
+	ENGINE_NO_REORDER_NO_CHECK,
+	ENGINE_REORDER_FULL,
+	ENGINE_NO_REORDER_DO_CHECK,
+	ENGINE_REORDER_ACCUMULATIVE,
+	ENGINE_REORDER_REVERSE_ACCUMULATIVE,
+	ENGINE_REORDER_PARTIAL,
+	ENGINE_REORDER_DEFAULT,
+
+	MAX_ENGINE_TYPE
+};
+
+/* number of sequences drawn by the ReorderPartial engine */
+#define ENGINE_PARTIAL_SEQUENCES 3
+
+/* combinations of each length the ReorderPartial engine draws from */
+#define ENGINE_PARTIAL_POPULATION 1000
+
+/*
+ * A sequence is a list of indexes into the stores passed to the engine,
+ * the callback stops the generation by returning a nonzero value.
+ */
+typedef std::function<int(const std::vector<size_t> &seq)> engine_seq_fn;
+
+const char *engine_name(enum engine_type type);
+int engine_from_name(const char *name, enum engine_type *type);
+bool engine_checks(enum engine_type type);
+int engine_generate(enum engine_type type, size_t nstores,
+		std::mt19937_64 &rng, const engine_seq_fn &fn);
+
+#endif
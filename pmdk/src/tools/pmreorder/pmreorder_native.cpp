@@ -0,0 +1,873 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * pmreorder_native.cpp -- native store reordering engine
+ *
+ * Replays a pmemcheck store log like pmreorder.py does and accepts the same
+ * options. The consistency checks of the reordered sequences can be spread
+ * over several worker processes (-j). Each worker replays the whole log on
+ * its own copy of the registered files and checks every n-th sequence, the
+ * warnings of the workers are merged back into the order of the sequences.
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "engines.hpp"
+#include "replay.hpp"
+#include "trace.hpp"
+
+enum log_level {
+	LOG_DEBUG,
+	LOG_INFO,
+	LOG_WARNING,
+	LOG_ERROR,
+	LOG_CRITICAL,
+
+	MAX_LOG_LEVEL
+};
+
+static const char *log_levels[MAX_LOG_LEVEL] = {
+	"debug", "info", "warning", "error", "critical",
+};
+
+static const char *log_names[MAX_LOG_LEVEL] = {
+	"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL",
+};
+
+/*
+ * Messages go either to the output file, in the format of the python
+ * logging module, or to stdout, where the level is not applied.
+ */
+struct logger {
+	FILE *file;
+	enum log_level level;
+};
+
+/* where a worker puts its messages */
+struct sink {
+	const struct logger *logger;	/* printed right away */
+	FILE *records;			/* merged by the parent */
+};
+
+struct log_record {
+	uint64_t seq;
+	uint32_t level;
+	uint32_t len;
+};
+
+struct args {
+	const char *logfile;
+	const char *checker;
+	std::string path;
+	const char *name;
+	const char *output;
+	enum log_level level;
+	const char *macros;
+	enum engine_type engine;
+	unsigned jobs;
+	uint64_t seed;
+};
+
+enum reorder_state {
+	STATE_INIT,
+	STATE_COLLECTING,
+	STATE_REPLAYING,
+};
+
+/* see CollectingState.move_inner_state */
+enum collect_state {
+	COLLECT_INIT,
+	COLLECT_DIRTY,
+	COLLECT_FLUSH,
+};
+
+struct reorder {
+	struct trace *trace;
+	struct replay replay;
+	struct sink *sink;
+	unsigned worker;
+	unsigned nworkers;
+
+	/* number of the reordered sequences so far, in all workers */
+	uint64_t nseq;
+	std::mt19937_64 rng;
+
+	enum engine_type engine;
+	enum engine_type default_engine;
+	enum reorder_state state;
+	enum collect_state inner;
+
+	/* the collected stores, and the unflushed ones by address */
+	std::vector<struct store> stores;
+	std::multimap<uint64_t, size_t> unflushed;
+	uint64_t max_store_size;
+
+	bool consistent;
+};
+
+/*
+ * logger_write -- prints the message
+ */
+static void
+logger_write(const struct logger *l, enum log_level level,
+		const std::string &text)
+{
+	if (l->file == stdout) {
+		printf("%s: %s\n", log_names[level], text.c_str());
+		return;
+	}
+
+	if (level >= l->level)
+		fprintf(l->file, "%s:pmreorder:%s\n", log_names[level],
+				text.c_str());
+}
+
+/*
+ * sink_log -- logs the message of the seq-th sequence
+ */
+static void
+sink_log(struct sink *s, uint64_t seq, enum log_level level,
+		const std::string &text)
+{
+	if (s->records == NULL) {
+		logger_write(s->logger, level, text);
+		return;
+	}
+
+	struct log_record rec = {seq, (uint32_t)level, (uint32_t)text.size()};
+	fwrite(&rec, sizeof(rec), 1, s->records);
+	fwrite(text.data(), 1, text.size(), s->records);
+}
+
+/*
+ * reorder_collect -- (internal) starts collecting the stores of the next
+ *	barrier, see CollectingState
+ */
+static void
+reorder_collect(struct reorder *r)
+{
+	r->state = STATE_COLLECTING;
+	r->inner = COLLECT_INIT;
+
+	r->unflushed.clear();
+	for (size_t i = 0; i < r->stores.size(); ++i)
+		r->unflushed.emplace(r->stores[i].addr, i);
+}
+
+/*
+ * reorder_flush -- (internal) marks the stores overlapping the flush
+ */
+static void
+reorder_flush(struct reorder *r, uint64_t addr, uint64_t size)
+{
+	uint64_t from = addr > r->max_store_size ?
+		addr - r->max_store_size : 0;
+
+	auto it = r->unflushed.lower_bound(from);
+	while (it != r->unflushed.end() && it->first < addr + size) {
+		struct store *s = &r->stores[it->second];
+		if (s->addr + s->size > addr) {
+			s->flushed = true;
+			it = r->unflushed.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+/*
+ * reorder_check -- (internal) performs the sequence of stores and checks the
+ *	consistency of the files, the sequences are spread over the workers
+ */
+static int
+reorder_check(struct reorder *r, const std::vector<struct store> &stores,
+		const std::vector<size_t> &seq)
+{
+	uint64_t n = r->nseq++;
+	if (n % r->nworkers != r->worker)
+		return 0;
+
+	for (size_t i : seq) {
+		if (replay_store(&r->replay, &stores[i], true)) {
+			replay_revert(&r->replay);
+			return -1;
+		}
+	}
+
+	const struct pool_file *f = replay_check(&r->replay);
+	replay_revert(&r->replay);
+	if (f == NULL)
+		return 0;
+
+	r->consistent = false;
+	sink_log(r->sink, n, LOG_WARNING, "File " + f->name + " inconsistent");
+
+	std::string trace = "Call trace:\n";
+	for (size_t i = 0; i < seq.size(); ++i) {
+		trace += "Store [" + std::to_string(i) + "]:\n";
+		trace += store_trace(&stores[seq[i]]);
+	}
+	sink_log(r->sink, n, LOG_WARNING, trace);
+
+	return 0;
+}
+
+/*
+ * reorder_replay -- (internal) checks the reorderings of the flushed stores
+ *	and performs them, see ReplayingState
+ */
+static int
+reorder_replay(struct reorder *r)
+{
+	std::vector<struct store> flushed;
+	std::vector<struct store> pending;
+	for (auto &s : r->stores)
+		(s.flushed ? flushed : pending).push_back(s);
+	r->stores.swap(pending);
+
+	if (engine_checks(r->engine)) {
+		int ret = engine_generate(r->engine, flushed.size(), r->rng,
+			[&](const std::vector<size_t> &seq) {
+				return reorder_check(r, flushed, seq);
+			});
+		if (ret)
+			return -1;
+	}
+
+	for (auto &s : flushed) {
+		if (replay_store(&r->replay, &s, false))
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * reorder_op -- (internal) advances the state machine, see
+ *	StateMachine.run_all
+ */
+static int
+reorder_op(struct reorder *r, const struct op *op)
+{
+	switch (r->state) {
+		case STATE_COLLECTING:
+			if (op->type == OP_FENCE && r->inner == COLLECT_FLUSH) {
+				r->state = STATE_REPLAYING;
+				return reorder_replay(r);
+			}
+			break;
+		case STATE_INIT:
+		case STATE_REPLAYING:
+			reorder_collect(r);
+			break;
+		default:
+			return -1;
+	}
+
+	if (op->type == OP_STORE && r->inner == COLLECT_INIT)
+		r->inner = COLLECT_DIRTY;
+	else if (op->type == OP_FLUSH && r->inner != COLLECT_FLUSH)
+		r->inner = COLLECT_FLUSH;
+
+	switch (op->type) {
+		case OP_ENGINE:
+			r->engine = op->engine == ENGINE_REORDER_DEFAULT ?
+				r->default_engine : op->engine;
+			break;
+		case OP_FLUSH:
+			reorder_flush(r, op->addr, op->size);
+			break;
+		case OP_STORE:
+			r->unflushed.emplace(op->store.addr, r->stores.size());
+			r->stores.push_back(op->store);
+			if (op->store.size > r->max_store_size)
+				r->max_store_size = op->store.size;
+			break;
+		case OP_REGISTER_FILE:
+			return replay_add_file(&r->replay,
+				std::string(op->name.ptr, op->name.len),
+				op->addr, op->size);
+		case OP_FENCE:
+			break;
+		default:
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * run_worker -- replays the log, returns 0 if all checked sequences were
+ *	consistent, 1 if some were not and 2 on error
+ */
+static int
+run_worker(const struct args *a, struct trace *t, const marker_map *markers,
+		const struct checker *c, struct sink *s, unsigned worker)
+{
+	struct reorder r;
+	r.trace = t;
+	r.sink = s;
+	r.worker = worker;
+	r.nworkers = a->jobs;
+	r.nseq = 0;
+	r.rng.seed(a->seed);
+	r.engine = r.default_engine = a->engine;
+	r.state = STATE_INIT;
+	r.inner = COLLECT_INIT;
+	r.max_store_size = 0;
+	r.consistent = true;
+	replay_init(&r.replay, c, worker);
+
+	trace_rewind(t, markers, a->engine);
+
+	struct op op;
+	int ret;
+	while ((ret = trace_next(t, &op)) > 0) {
+		if (reorder_op(&r, &op)) {
+			ret = -1;
+			break;
+		}
+	}
+
+	replay_fini(&r.replay);
+
+	if (ret < 0)
+		return 2;
+
+	return r.consistent ? 0 : 1;
+}
+
+/*
+ * prescan -- validates the log and collects the registered files
+ */
+static int
+prescan(struct trace *t, const marker_map *markers,
+		enum engine_type engine, std::vector<std::string> &files)
+{
+	struct op op;
+	int ret;
+
+	trace_rewind(t, markers, engine);
+	while ((ret = trace_next(t, &op)) > 0) {
+		if (op.type != OP_REGISTER_FILE)
+			continue;
+
+		std::string name(op.name.ptr, op.name.len);
+		bool known = false;
+		for (auto &f : files)
+			known = known || f == name;
+		if (!known)
+			files.push_back(name);
+	}
+
+	return ret;
+}
+
+/*
+ * merge_records -- prints the messages of the workers in the order of the
+ *	sequences they belong to
+ */
+static void
+merge_records(const struct logger *l, std::vector<FILE *> &records)
+{
+	struct head {
+		bool valid;
+		struct log_record rec;
+	};
+	std::vector<struct head> heads(records.size());
+
+	for (size_t i = 0; i < records.size(); ++i) {
+		rewind(records[i]);
+		heads[i].valid = fread(&heads[i].rec, sizeof(heads[i].rec), 1,
+				records[i]) == 1;
+	}
+
+	std::string text;
+	for (;;) {
+		size_t min = records.size();
+		for (size_t i = 0; i < records.size(); ++i) {
+			if (heads[i].valid && (min == records.size() ||
+					heads[i].rec.seq < heads[min].rec.seq))
+				min = i;
+		}
+		if (min == records.size())
+			break;
+
+		struct head *h = &heads[min];
+		text.resize(h->rec.len);
+		if (fread(&text[0], 1, h->rec.len, records[min]) != h->rec.len)
+			break;
+		logger_write(l, (enum log_level)h->rec.level, text);
+
+		h->valid = fread(&h->rec, sizeof(h->rec), 1,
+				records[min]) == 1;
+	}
+}
+
+/*
+ * run_workers -- replays the log in a.jobs worker processes
+ */
+static int
+run_workers(const struct args *a, struct trace *t, const marker_map *markers,
+		const struct checker *c, const struct logger *l,
+		const std::vector<std::string> &files)
+{
+	int ret = 0;
+	std::vector<FILE *> records;
+	std::vector<std::string> copies;
+	std::vector<pid_t> pids;
+
+	for (unsigned w = 0; w < a->jobs; ++w) {
+		FILE *rec = tmpfile();
+		if (rec == NULL) {
+			perror("tmpfile");
+			ret = 2;
+			goto out;
+		}
+		records.push_back(rec);
+
+		if (w == 0)
+			continue;
+
+		/* the copies have to be made before any worker starts */
+		for (auto &f : files) {
+			copies.push_back(replay_worker_path(f, w));
+			if (replay_copy_file(f, copies.back())) {
+				ret = 2;
+				goto out;
+			}
+		}
+	}
+
+	fflush(NULL);
+	for (unsigned w = 0; w < a->jobs; ++w) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			ret = 2;
+			break;
+		}
+
+		if (pid == 0) {
+			struct sink s = {l, records[w]};
+			int status = run_worker(a, t, markers, c, &s, w);
+			fflush(NULL);
+			_exit(status);
+		}
+		pids.push_back(pid);
+	}
+
+	for (pid_t pid : pids) {
+		int status;
+		while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+			;
+
+		if (!WIFEXITED(status) || WEXITSTATUS(status) > 1)
+			ret = 2;
+		else if (WEXITSTATUS(status) == 1 && ret == 0)
+			ret = 1;
+	}
+
+	if (ret < 2)
+		merge_records(l, records);
+
+out:
+	for (FILE *rec : records)
+		fclose(rec);
+	for (auto &copy : copies)
+		unlink(copy.c_str());
+
+	return ret;
+}
+
+/*
+ * json_string -- (internal) parses a JSON string
+ */
+static bool
+json_string(const char *&p, std::string &out)
+{
+	while (isspace((unsigned char)*p))
+		p++;
+	if (*p++ != '"')
+		return false;
+
+	out.clear();
+	for (; *p != '"'; ++p) {
+		if (*p == '\0')
+			return false;
+		if (*p == '\\') {
+			++p;
+			switch (*p) {
+				case 'n': out += '\n'; break;
+				case 't': out += '\t'; break;
+				case '\0': return false;
+				default: out += *p; break;
+			}
+			continue;
+		}
+		out += *p;
+	}
+	p++;
+
+	return true;
+}
+
+/*
+ * json_token -- (internal) skips whitespace and the expected character
+ */
+static bool
+json_token(const char *&p, char c)
+{
+	while (isspace((unsigned char)*p))
+		p++;
+	if (*p != c)
+		return false;
+	p++;
+
+	return true;
+}
+
+/*
+ * markers_from_file -- (internal) parses the markers of a JSON file, see
+ *	MarkerParser.marker_file_parser
+ */
+static void
+markers_from_file(const char *path, marker_map &markers)
+{
+	std::string json;
+	FILE *f = fopen(path, "r");
+	if (f) {
+		char buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+			json.append(buf, n);
+		fclose(f);
+	}
+
+	const char *p = json.c_str();
+	std::string key, val;
+	bool valid = json_token(p, '{');
+	if (valid && !json_token(p, '}')) {
+		do {
+			valid = json_string(p, key) && json_token(p, ':') &&
+				json_string(p, val);
+			if (valid)
+				markers[key] = val;
+		} while (valid && json_token(p, ','));
+		valid = valid && json_token(p, '}');
+	}
+
+	if (!valid) {
+		markers.clear();
+		printf("Invalid config macros file format:  %s Use: {\"MARKER_NAME1\"=\"ENGINE_TYPE1\",\"MARKER_NAME2\"=\"ENGINE_TYPE2\"}\n",
+				path);
+	}
+}
+
+/*
+ * markers_from_cli -- (internal) parses MARKER=ENGINE pairs, see
+ *	MarkerParser.marker_cli_parser
+ */
+static void
+markers_from_cli(const char *macros, marker_map &markers)
+{
+	std::string list(macros);
+	size_t pos = 0;
+
+	for (;;) {
+		size_t end = list.find(',', pos);
+		std::string pair = list.substr(pos, end - pos);
+		size_t eq = pair.find('=');
+		if (eq == std::string::npos ||
+				pair.find('=', eq + 1) != std::string::npos) {
+			markers.clear();
+			printf("Invalid extended macros format:  %s Use: MARKER_NAME1=ENGINE_TYPE1,MARKER_NAME2=ENGINE_TYPE2\n",
+					macros);
+			return;
+		}
+		markers[pair.substr(0, eq)] = pair.substr(eq + 1);
+
+		if (end == std::string::npos)
+			return;
+		pos = end + 1;
+	}
+}
+
+/*
+ * print_usage -- prints the usage in the format of pmreorder.py
+ */
+static void
+print_usage(FILE *f)
+{
+	fprintf(f,
+		"usage: pmreorder [-h] -l LOGFILE [-c {prog,lib}] -p PATH [PATH ...]\n"
+		"                 [-n NAME] [-o OUTPUT]\n"
+		"                 [-e {debug,info,warning,error,critical}]\n"
+		"                 [-x EXTENDED_MACROS] [-r ENGINE] [-j JOBS]\n"
+		"                 [-s SEED]\n");
+}
+
+/*
+ * print_help -- prints the help message
+ */
+static void
+print_help(void)
+{
+	print_usage(stdout);
+	printf("\nStore reordering tool\n\n"
+		"optional arguments:\n"
+		"  -h, --help            show this help message and exit\n"
+		"  -l, --logfile LOGFILE the pmemcheck log file to process\n"
+		"  -c, --checker {prog,lib}\n"
+		"                        choose consistency checker type\n"
+		"  -p, --path PATH [PATH ...]\n"
+		"                        path to the consistency checker and arguments\n"
+		"  -n, --name NAME       consistency check function for the 'lib' checker\n"
+		"  -o, --output OUTPUT   set the logger output file\n"
+		"  -e, --output-level {debug,info,warning,error,critical}\n"
+		"                        set the output log level\n"
+		"  -x, --extended-macros EXTENDED_MACROS\n"
+		"                        list of pairs MARKER=ENGINE or json config file\n"
+		"  -r, --default-engine ENGINE\n"
+		"                        set default reorder engine default=NoReorderNoCheck\n"
+		"  -j, --jobs JOBS       number of worker processes, 0 for one per CPU\n"
+		"                        default=1\n"
+		"  -s, --seed SEED       seed of the ReorderPartial engine\n");
+}
+
+/*
+ * usage_error -- prints the error and exits like argparse does
+ */
+static void
+usage_error(const char *fmt, const char *arg)
+{
+	print_usage(stderr);
+	fprintf(stderr, "pmreorder: error: ");
+	fprintf(stderr, fmt, arg);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+struct option_def {
+	char short_name;
+	const char *long_name;
+};
+
+static const struct option_def options[] = {
+	{'l', "logfile"},
+	{'c', "checker"},
+	{'p', "path"},
+	{'n', "name"},
+	{'o', "output"},
+	{'e', "output-level"},
+	{'x', "extended-macros"},
+	{'r', "default-engine"},
+	{'j', "jobs"},
+	{'s', "seed"},
+};
+
+/*
+ * parse_args -- parses the command line
+ */
+static void
+parse_args(int argc, char *argv[], struct args *a)
+{
+	a->logfile = NULL;
+	a->checker = "prog";
+	a->name = NULL;
+	a->output = NULL;
+	a->level = LOG_WARNING;
+	a->macros = NULL;
+	a->engine = ENGINE_NO_REORDER_NO_CHECK;
+	a->jobs = 1;
+	a->seed = std::random_device()();
+
+	for (int i = 1; i < argc; ++i) {
+		const char *arg = argv[i];
+		const char *val = NULL;
+		char opt = 0;
+
+		if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+			print_help();
+			exit(0);
+		}
+
+		for (auto &o : options) {
+			size_t len = strlen(o.long_name);
+			if (arg[0] == '-' && arg[1] == o.short_name) {
+				opt = o.short_name;
+				val = arg[2] ? arg + 2 : NULL;
+			} else if (strncmp(arg, "--", 2) == 0 &&
+					strncmp(arg + 2, o.long_name, len) == 0 &&
+					(arg[2 + len] == '\0' ||
+					arg[2 + len] == '=')) {
+				opt = o.short_name;
+				val = arg[2 + len] ? arg + 3 + len : NULL;
+			}
+			if (opt)
+				break;
+		}
+		if (opt == 0)
+			usage_error("unrecognized arguments: %s", arg);
+
+		if (val == NULL) {
+			if (i + 1 == argc)
+				usage_error("argument %s: expected an argument",
+						arg);
+			val = argv[++i];
+		}
+
+		switch (opt) {
+			case 'l':
+				a->logfile = val;
+				break;
+			case 'c':
+				if (strcmp(val, "prog") && strcmp(val, "lib"))
+					usage_error("invalid checker: %s", val);
+				a->checker = val;
+				break;
+			case 'p':
+				/* the arguments of the checker follow */
+				a->path = val;
+				while (i + 1 < argc && argv[i + 1][0] != '-') {
+					a->path += " ";
+					a->path += argv[++i];
+				}
+				break;
+			case 'n':
+				a->name = val;
+				break;
+			case 'o':
+				a->output = val;
+				break;
+			case 'e': {
+				int l = 0;
+				while (l < MAX_LOG_LEVEL &&
+						strcmp(log_levels[l], val))
+					++l;
+				if (l == MAX_LOG_LEVEL)
+					usage_error("invalid output level: %s",
+							val);
+				a->level = (enum log_level)l;
+				break;
+			}
+			case 'x':
+				a->macros = val;
+				break;
+			case 'r':
+				if (engine_from_name(val, &a->engine) ||
+						a->engine == ENGINE_REORDER_DEFAULT)
+					usage_error("invalid engine: %s", val);
+				break;
+			case 'j':
+				a->jobs = (unsigned)strtoul(val, NULL, 10);
+				break;
+			case 's':
+				a->seed = strtoull(val, NULL, 0);
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (a->logfile == NULL)
+		usage_error("the following arguments are required: %s",
+				"-l/--logfile");
+	if (a->path.empty())
+		usage_error("the following arguments are required: %s",
+				"-p/--path");
+
+	if (a->jobs == 0)
+		a->jobs = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct args a;
+	parse_args(argc, argv, &a);
+
+	struct logger l = {stdout, a.level};
+	if (a.output) {
+		l.file = fopen(a.output, "a");
+		if (l.file == NULL) {
+			perror(a.output);
+			return 1;
+		}
+	}
+
+	struct checker c;
+	if (checker_init(&c, a.checker, a.path, a.name))
+		return 1;
+
+	marker_map markers;
+	if (a.macros) {
+		struct stat st;
+		if (stat(a.macros, &st) == 0)
+			markers_from_file(a.macros, markers);
+		else
+			markers_from_cli(a.macros, markers);
+	}
+
+	struct trace t;
+	if (trace_open(&t, a.logfile))
+		return 1;
+
+	/* like pmreorder.py, a malformed log fails before any replay */
+	std::vector<std::string> files;
+	int ret = prescan(&t, &markers, a.engine, files) ? 2 : 0;
+
+	if (ret == 0 && a.jobs == 1) {
+		struct sink s = {&l, NULL};
+		ret = run_worker(&a, &t, &markers, &c, &s, 0);
+	} else if (ret == 0) {
+		ret = run_workers(&a, &t, &markers, &c, &l, files);
+	}
+
+	trace_close(&t);
+	if (l.file != stdout)
+		fclose(l.file);
+
+	return ret == 0 ? 0 : 1;
+}
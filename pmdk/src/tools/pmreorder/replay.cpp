@@ -0,0 +1,381 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * replay.cpp -- replaying stores on the registered files
+ *
+ * Each worker writes to its own copy of the registered files through a
+ * shared mapping, so the consistency checker sees the stores without them
+ * being synced. Before a page is first modified by a reordered sequence it
+ * is saved, reverting the sequence restores the saved pages in the reverse
+ * order. Unlike reverting store by store this is correct for overlapping
+ * stores and for files registered more than once.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "replay.hpp"
+
+#define COPY_BUF_SIZE (1 << 20)
+
+/*
+ * checker_init -- sets up the consistency checker, path_args holds the path
+ *	to the checker followed by its arguments
+ */
+int
+checker_init(struct checker *c, const char *type,
+		const std::string &path_args, const char *name)
+{
+	size_t sep = path_args.find(' ');
+	std::string path = path_args.substr(0, sep);
+
+	if (access(path.c_str(), F_OK)) {
+		printf("Invalid path:%s\n", path.c_str());
+		return -1;
+	}
+
+	if (strcmp(type, "prog") == 0) {
+		c->type = CHECKER_PROG;
+		c->cmd = path_args;
+		c->func = NULL;
+		return 0;
+	}
+
+	c->type = CHECKER_LIB;
+	if (name == NULL) {
+		fprintf(stderr, "pmreorder: the lib checker requires -n\n");
+		return -1;
+	}
+
+	void *lib = dlopen(path.c_str(), RTLD_NOW);
+	if (lib == NULL) {
+		fprintf(stderr, "pmreorder: %s\n", dlerror());
+		return -1;
+	}
+
+	c->func = (checker_func)dlsym(lib, name);
+	if (c->func == NULL) {
+		fprintf(stderr, "pmreorder: %s\n", dlerror());
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * checker_run -- checks the consistency of the file, returns 0 if it is
+ *	consistent
+ */
+int
+checker_run(const struct checker *c, const char *path)
+{
+	if (c->type == CHECKER_LIB)
+		return c->func(path);
+
+	std::string cmd = c->cmd + " " + path;
+	int ret = system(cmd.c_str());
+
+	return ret == -1 ? 1 : ret;
+}
+
+/*
+ * replay_worker_path -- returns the copy of the file the worker writes to,
+ *	worker 0 writes to the registered file itself
+ */
+std::string
+replay_worker_path(const std::string &name, unsigned worker)
+{
+	if (worker == 0)
+		return name;
+
+	return name + ".pmreorder" + std::to_string(worker);
+}
+
+/*
+ * copy_range -- (internal) copies a range of the file
+ */
+static int
+copy_range(int src, int dst, off_t off, off_t end, char *buf)
+{
+	while (off < end) {
+		size_t len = (size_t)std::min((off_t)COPY_BUF_SIZE, end - off);
+		ssize_t rd = pread(src, buf, len, off);
+		if (rd <= 0)
+			return rd == 0 ? 0 : -1;
+
+		for (ssize_t wr = 0; wr < rd; ) {
+			ssize_t ret = pwrite(dst, buf + wr, (size_t)(rd - wr),
+					off + wr);
+			if (ret < 0)
+				return -1;
+			wr += ret;
+		}
+		off += rd;
+	}
+
+	return 0;
+}
+
+/*
+ * replay_copy_file -- copies the file, holes are preserved where the file
+ *	system reports them
+ */
+int
+replay_copy_file(const std::string &src, const std::string &dst)
+{
+	int ret = -1;
+	int sfd = open(src.c_str(), O_RDONLY);
+	if (sfd < 0) {
+		perror(src.c_str());
+		return -1;
+	}
+
+	struct stat st;
+	int dfd = -1;
+	char *buf = NULL;
+	if (fstat(sfd, &st))
+		goto out;
+
+	dfd = open(dst.c_str(), O_RDWR | O_CREAT | O_TRUNC,
+			st.st_mode & 0777);
+	if (dfd < 0 || ftruncate(dfd, st.st_size))
+		goto out;
+
+	buf = (char *)malloc(COPY_BUF_SIZE);
+	if (buf == NULL)
+		goto out;
+
+	for (off_t off = 0; off < st.st_size; ) {
+		off_t data = lseek(sfd, off, SEEK_DATA);
+		if (data < 0) {
+			if (errno == ENXIO)
+				break;
+			/* holes are not supported, copy everything */
+			data = off;
+		}
+
+		off_t hole = lseek(sfd, data, SEEK_HOLE);
+		if (hole < 0)
+			hole = st.st_size;
+
+		if (copy_range(sfd, dfd, data, hole, buf))
+			goto out;
+		off = hole;
+	}
+	ret = 0;
+
+out:
+	if (ret)
+		perror(dst.c_str());
+	free(buf);
+	if (dfd >= 0)
+		close(dfd);
+	close(sfd);
+
+	return ret;
+}
+
+/*
+ * replay_init -- initializes the replay for the worker
+ */
+void
+replay_init(struct replay *r, const struct checker *c, unsigned worker)
+{
+	r->checker = c;
+	r->worker = worker;
+	r->pagesize = (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * replay_fini -- unmaps the registered files
+ */
+void
+replay_fini(struct replay *r)
+{
+	for (auto &f : r->files) {
+		if (f.addr)
+			munmap(f.addr, f.size);
+	}
+	r->files.clear();
+}
+
+/*
+ * replay_add_file -- maps the worker's copy of the registered file
+ */
+int
+replay_add_file(struct replay *r, const std::string &name, uint64_t base,
+		uint64_t size)
+{
+	struct pool_file f;
+	f.name = name;
+	f.path = replay_worker_path(name, r->worker);
+	f.base = base;
+	f.max = base + size;
+	f.addr = NULL;
+
+	int fd = open(f.path.c_str(), O_RDWR);
+	if (fd < 0) {
+		perror(f.path.c_str());
+		return -1;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st)) {
+		perror(f.path.c_str());
+		close(fd);
+		return -1;
+	}
+
+	f.size = (size_t)st.st_size;
+	if (f.size > 0) {
+		void *addr = mmap(NULL, f.size, PROT_READ | PROT_WRITE,
+				MAP_SHARED, fd, 0);
+		if (addr == MAP_FAILED) {
+			perror(f.path.c_str());
+			close(fd);
+			return -1;
+		}
+		f.addr = (uint8_t *)addr;
+	}
+	close(fd);
+
+	r->files.push_back(f);
+
+	return 0;
+}
+
+/*
+ * replay_save -- (internal) saves the pages of the range not saved yet
+ */
+static void
+replay_save(struct replay *r, uint8_t *addr, size_t len)
+{
+	uintptr_t mask = ~((uintptr_t)r->pagesize - 1);
+	uint8_t *page = (uint8_t *)((uintptr_t)addr & mask);
+
+	for (; page < addr + len; page += r->pagesize) {
+		if (!r->saved.insert(page).second)
+			continue;
+
+		size_t offset = r->arena.size();
+		r->arena.resize(offset + r->pagesize);
+		memcpy(r->arena.data() + offset, page, r->pagesize);
+		r->snapshots.push_back({page, offset});
+	}
+}
+
+/*
+ * replay_store -- performs the store on all files it falls into, the pages
+ *	of revertible stores are saved for replay_revert
+ */
+int
+replay_store(struct replay *r, const struct store *s, bool revertible)
+{
+	uint64_t max = s->addr + s->size;
+	bool found = false;
+
+	r->value.resize(s->size);
+	store_value(s, r->value.data());
+
+	for (auto &f : r->files) {
+		if (max <= f.base || s->addr >= f.max)
+			continue;
+		found = true;
+
+		uint64_t from = std::max(s->addr, f.base);
+		uint64_t off = from - f.base;
+		uint64_t end = std::min(std::min(max, f.max) - f.base,
+				(uint64_t)f.size);
+		if (off >= end)
+			continue;
+
+		uint8_t *dst = f.addr + off;
+		if (revertible)
+			replay_save(r, dst, end - off);
+		memcpy(dst, r->value.data() + (from - s->addr), end - off);
+	}
+
+	if (!found) {
+		fprintf(stderr,
+			"pmreorder: No suitable file found for store at 0x%llx size %llu\n",
+			(unsigned long long)s->addr,
+			(unsigned long long)s->size);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * replay_revert -- restores the pages saved since the last revert
+ */
+void
+replay_revert(struct replay *r)
+{
+	for (auto s = r->snapshots.rbegin(); s != r->snapshots.rend(); ++s)
+		memcpy(s->page, r->arena.data() + s->offset, r->pagesize);
+
+	r->snapshots.clear();
+	r->saved.clear();
+	r->arena.clear();
+}
+
+/*
+ * replay_check -- checks the consistency of the registered files, returns
+ *	the first inconsistent one or NULL
+ */
+const struct pool_file *
+replay_check(struct replay *r)
+{
+	for (size_t i = 0; i < r->files.size(); ++i) {
+		const struct pool_file *f = &r->files[i];
+
+		/* a file registered more than once is checked once */
+		bool checked = false;
+		for (size_t j = 0; j < i && !checked; ++j)
+			checked = r->files[j].path == f->path;
+
+		if (!checked && checker_run(r->checker, f->path.c_str()))
+			return f;
+	}
+
+	return NULL;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * replay.hpp -- replaying stores on the registered files
+ */
+
+#ifndef PMREORDER_REPLAY_HPP
+#define PMREORDER_REPLAY_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "trace.hpp"
+
+enum checker_type {
+	CHECKER_PROG,
+	CHECKER_LIB,
+};
+
+/* returns 0 if the file is consistent */
+typedef int (*checker_func)(const char *file_name);
+
+struct checker {
+	enum checker_type type;
+	std::string cmd;	/* CHECKER_PROG: program and its arguments */
+	checker_func func;	/* CHECKER_LIB */
+};
+
+int checker_init(struct checker *c, const char *type,
+		const std::string &path_args, const char *name);
+int checker_run(const struct checker *c, const char *path);
+
+struct pool_file {
+	std::string name;	/* the file registered in the log */
+	std::string path;	/* the copy of the file the worker writes to */
+	uint64_t base;		/* the mapping in the logged process */
+	uint64_t max;
+	uint8_t *addr;		/* the mapping in the worker */
+	size_t size;
+};
+
+struct page_snapshot {
+	uint8_t *page;
+	size_t offset;		/* of the saved page in replay::arena */
+};
+
+struct replay {
+	const struct checker *checker;
+	unsigned worker;
+	size_t pagesize;
+	std::vector<struct pool_file> files;
+
+	/* pages modified since the last revert, in the order of saving */
+	std::vector<struct page_snapshot> snapshots;
+	std::unordered_set<uint8_t *> saved;
+	std::vector<uint8_t> arena;
+	std::vector<uint8_t> value;
+};
+
+std::string replay_worker_path(const std::string &name, unsigned worker);
+int replay_copy_file(const std::string &src, const std::string &dst);
+
+void replay_init(struct replay *r, const struct checker *c, unsigned worker);
+void replay_fini(struct replay *r);
+int replay_add_file(struct replay *r, const std::string &name,
+		uint64_t base, uint64_t size);
+int replay_store(struct replay *r, const struct store *s, bool revertible);
+void replay_revert(struct replay *r);
+const struct pool_file *replay_check(struct replay *r);
+
+#endif
@@ -0,0 +1,407 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * trace.cpp -- pmemcheck store log reader of the native pmreorder
+ *
+ * The store log is mapped and parsed in place, operations are extracted one
+ * at a time in the same way as operationfactory.py does it, including the
+ * stack of the nested engine markers.
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace.hpp"
+
+#define MARKER_BEGIN ".BEGIN"
+#define MARKER_END ".END"
+
+/*
+ * span_trim -- (internal) strips the surrounding whitespace
+ */
+static struct span
+span_trim(struct span s)
+{
+	while (s.len > 0 && isspace((unsigned char)s.ptr[0])) {
+		s.ptr++;
+		s.len--;
+	}
+	while (s.len > 0 && isspace((unsigned char)s.ptr[s.len - 1]))
+		s.len--;
+
+	return s;
+}
+
+/*
+ * span_is -- (internal) checks if the span equals the string, ignoring case
+ */
+static bool
+span_is(struct span s, const char *str)
+{
+	return s.len == strlen(str) && strncasecmp(s.ptr, str, s.len) == 0;
+}
+
+/*
+ * span_ends_with -- (internal) checks if the span ends with the suffix
+ */
+static bool
+span_ends_with(struct span s, const char *suffix)
+{
+	size_t len = strlen(suffix);
+	return s.len >= len &&
+		memcmp(s.ptr + s.len - len, suffix, len) == 0;
+}
+
+/*
+ * span_next -- (internal) returns the part of *s up to the separator and
+ *	removes it from *s together with the separator
+ */
+static struct span
+span_next(struct span *s, char sep)
+{
+	const char *p = (const char *)memchr(s->ptr, sep, s->len);
+	size_t len = p ? (size_t)(p - s->ptr) : s->len;
+	struct span part = {s->ptr, len};
+
+	s->ptr += len;
+	s->len -= len;
+	if (p) {
+		s->ptr++;
+		s->len--;
+	}
+
+	return part;
+}
+
+/*
+ * hex_digit -- (internal) returns the value of a hex digit or -1
+ */
+static int
+hex_digit(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/*
+ * hex_digits -- (internal) strips whitespace and the 0x prefix
+ */
+static struct span
+hex_digits(struct span s)
+{
+	s = span_trim(s);
+	if (s.len >= 2 && s.ptr[0] == '0' && (s.ptr[1] == 'x' || s.ptr[1] == 'X')) {
+		s.ptr += 2;
+		s.len -= 2;
+	}
+
+	return s;
+}
+
+/*
+ * parse_hex -- (internal) parses a hex number
+ */
+static int
+parse_hex(struct span s, uint64_t *val)
+{
+	s = hex_digits(s);
+	if (s.len == 0 || s.len > 16)
+		return -1;
+
+	*val = 0;
+	for (size_t i = 0; i < s.len; ++i) {
+		int d = hex_digit(s.ptr[i]);
+		if (d < 0)
+			return -1;
+		*val = (*val << 4) | (uint64_t)d;
+	}
+
+	return 0;
+}
+
+/*
+ * trace_error -- (internal) reports an invalid element of the log
+ */
+static int
+trace_error(const char *msg, struct span elem)
+{
+	fprintf(stderr, "pmreorder: %s: %.*s\n", msg, (int)elem.len,
+			elem.ptr);
+	return -1;
+}
+
+/*
+ * trace_open -- maps the store log and finds the logged operations
+ */
+int
+trace_open(struct trace *t, const char *path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		perror(path);
+		return -1;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st)) {
+		perror(path);
+		close(fd);
+		return -1;
+	}
+
+	t->size = (size_t)st.st_size;
+	t->addr = NULL;
+	if (t->size > 0) {
+		void *addr = mmap(NULL, t->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) {
+			perror(path);
+			close(fd);
+			return -1;
+		}
+		madvise(addr, t->size, MADV_SEQUENTIAL);
+		t->addr = (const char *)addr;
+	}
+	close(fd);
+
+	/*
+	 * The operations are the elements between the last START and the
+	 * last STOP, without a START they start at the second element.
+	 */
+	const char *start = NULL;
+	const char *stop = NULL;
+	const char *second = NULL;
+	struct span log = {t->addr, t->size};
+	while (log.len > 0) {
+		const char *elem_addr = log.ptr;
+		struct span elem = span_trim(span_next(&log, '|'));
+
+		if (second == NULL && elem_addr != t->addr)
+			second = elem_addr;
+
+		if (span_is(elem, "START"))
+			start = log.ptr;
+		else if (span_is(elem, "STOP"))
+			stop = elem_addr;
+	}
+
+	if (start == NULL)
+		start = second;
+
+	if (start == NULL || stop == NULL || start > stop)
+		t->begin = t->end = t->addr;
+	else {
+		t->begin = start;
+		t->end = stop;
+	}
+	t->pos = t->begin;
+
+	return 0;
+}
+
+/*
+ * trace_close -- unmaps the store log
+ */
+void
+trace_close(struct trace *t)
+{
+	if (t->addr)
+		munmap((void *)t->addr, t->size);
+	t->addr = NULL;
+}
+
+/*
+ * trace_rewind -- starts extracting the operations from the beginning
+ */
+void
+trace_rewind(struct trace *t, const marker_map *markers,
+		enum engine_type default_engine)
+{
+	t->pos = t->begin;
+	t->markers = markers;
+	t->stack.clear();
+	t->stack.push_back({"START", default_engine});
+}
+
+/*
+ * trace_marker -- (internal) handles a marker, see
+ *	OperationFactory.create_operation
+ */
+static int
+trace_marker(struct trace *t, struct span id, struct op *op)
+{
+	op->type = OP_ENGINE;
+
+	if (span_ends_with(id, MARKER_BEGIN)) {
+		struct span name = id;
+		name.len -= strlen(MARKER_BEGIN);
+
+		/* engines are assigned to the part before the first dot */
+		struct span key = id;
+		key = span_next(&key, '.');
+
+		op->engine = t->stack.back().engine;
+		if (t->markers) {
+			auto m = t->markers->find(std::string(key.ptr, key.len));
+			if (m != t->markers->end() &&
+					engine_from_name(m->second.c_str(),
+					&op->engine)) {
+				fprintf(stderr, "pmreorder: Not supported reorder engine: %s\n",
+						m->second.c_str());
+				return -1;
+			}
+		}
+
+		t->stack.push_back({std::string(name.ptr, name.len),
+				op->engine});
+		return 1;
+	}
+
+	if (span_ends_with(id, MARKER_END)) {
+		std::string name(id.ptr, id.len - strlen(MARKER_END));
+		if (t->stack.back().name != name) {
+			fprintf(stderr, "pmreorder: Cannot cross markers: %s, %s\n",
+					t->stack.back().name.c_str(),
+					name.c_str());
+			return -1;
+		}
+
+		t->stack.pop_back();
+		op->engine = t->stack.back().engine;
+		return 1;
+	}
+
+	return trace_error("Incorrect marker format, suffix is missing", id);
+}
+
+/*
+ * trace_next -- extracts the next operation, returns 1 if there is one,
+ *	0 at the end of the log and -1 on error
+ */
+int
+trace_next(struct trace *t, struct op *op)
+{
+	struct span elem;
+	do {
+		if (t->pos >= t->end)
+			return 0;
+
+		struct span rest = {t->pos, (size_t)(t->end - t->pos)};
+		elem = span_next(&rest, '|');
+		t->pos = rest.ptr;
+	} while (span_trim(elem).len == 0);
+
+	struct span fields = elem;
+	struct span id = span_trim(span_next(&fields, ';'));
+
+	if (span_is(id, "STORE")) {
+		op->type = OP_STORE;
+		struct store *s = &op->store;
+		if (parse_hex(span_next(&fields, ';'), &s->addr))
+			return trace_error("Invalid store address", elem);
+		s->value = span_next(&fields, ';');
+		if (parse_hex(span_next(&fields, ';'), &s->size) ||
+				s->size == 0)
+			return trace_error("Invalid store size", elem);
+		s->trace = fields;
+		s->flushed = false;
+	} else if (span_is(id, "FLUSH")) {
+		op->type = OP_FLUSH;
+		if (parse_hex(span_next(&fields, ';'), &op->addr) ||
+				parse_hex(span_next(&fields, ';'), &op->size))
+			return trace_error("Invalid flush", elem);
+	} else if (span_is(id, "FENCE")) {
+		op->type = OP_FENCE;
+	} else if (span_is(id, "REGISTER_FILE")) {
+		op->type = OP_REGISTER_FILE;
+		op->name = span_trim(span_next(&fields, ';'));
+		if (op->name.len == 0 ||
+				parse_hex(span_next(&fields, ';'), &op->addr) ||
+				parse_hex(span_next(&fields, ';'), &op->size))
+			return trace_error("Invalid file registration", elem);
+	} else {
+		return trace_marker(t, id, op);
+	}
+
+	return 1;
+}
+
+/*
+ * store_value -- decodes the value of the store, in the native byte order
+ */
+void
+store_value(const struct store *s, uint8_t *buf)
+{
+	struct span v = hex_digits(s->value);
+
+	memset(buf, 0, s->size);
+	for (size_t b = 0; b < s->size && 2 * b < v.len; ++b) {
+		const char *lo = v.ptr + v.len - 1 - 2 * b;
+		int val = hex_digit(*lo);
+		if (lo > v.ptr)
+			val |= hex_digit(*(lo - 1)) << 4;
+		buf[b] = (uint8_t)val;
+	}
+}
+
+/*
+ * store_trace -- formats the stack trace of the store like utils.StackTrace
+ */
+std::string
+store_trace(const struct store *s)
+{
+	std::string out;
+	struct span rest = s->trace;
+
+	if (span_trim(rest).len == 0)
+		return "    by\tNo trace available\n";
+
+	while (rest.len > 0) {
+		struct span line = span_next(&rest, ';');
+		out += "    by\t";
+		out.append(line.ptr, line.len);
+		out += "\n";
+	}
+
+	return out;
+}
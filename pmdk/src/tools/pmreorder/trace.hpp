@@ -0,0 +1,109 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * trace.hpp -- pmemcheck store log reader of the native pmreorder
+ */
+
+#ifndef PMREORDER_TRACE_HPP
+#define PMREORDER_TRACE_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "engines.hpp"
+
+/* a part of the mapped store log */
+struct span {
+	const char *ptr;
+	size_t len;
+};
+
+struct store {
+	uint64_t addr;
+	uint64_t size;
+	struct span value;	/* the logged value, in hex */
+	struct span trace;	/* ';' separated stack trace, may be empty */
+	bool flushed;
+};
+
+enum op_type {
+	OP_STORE,
+	OP_FLUSH,
+	OP_FENCE,
+	OP_REGISTER_FILE,
+	OP_ENGINE,		/* a marker changing the reorder engine */
+};
+
+struct op {
+	enum op_type type;
+	struct store store;		/* OP_STORE */
+	uint64_t addr;			/* OP_FLUSH, OP_REGISTER_FILE */
+	uint64_t size;			/* OP_FLUSH, OP_REGISTER_FILE */
+	struct span name;		/* OP_REGISTER_FILE */
+	enum engine_type engine;	/* OP_ENGINE */
+};
+
+/* marker names assigned to engine names with -x */
+typedef std::map<std::string, std::string> marker_map;
+
+struct trace_marker {
+	std::string name;
+	enum engine_type engine;
+};
+
+struct trace {
+	const char *addr;	/* the mapped store log */
+	size_t size;
+
+	/* operations between the last START and the last STOP */
+	const char *begin;
+	const char *end;
+	const char *pos;
+
+	const marker_map *markers;
+	std::vector<struct trace_marker> stack;
+};
+
+int trace_open(struct trace *t, const char *path);
+void trace_close(struct trace *t);
+void trace_rewind(struct trace *t, const marker_map *markers,
+		enum engine_type default_engine);
+int trace_next(struct trace *t, struct op *op);
+
+void store_value(const struct store *s, uint8_t *buf);
+std::string store_trace(const struct store *s);
+
+#endif